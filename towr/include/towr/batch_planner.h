@@ -0,0 +1,117 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef TOWR_BATCH_PLANNER_H_
+#define TOWR_BATCH_PLANNER_H_
+
+#include <functional>
+#include <limits>
+#include <vector>
+
+#include <ifopt/solver.h>
+
+#include <towr/variables/spline_holder.h>
+
+#include <towr/models/robot_model.h>
+#include <towr/terrain/height_map.h>
+#include "parameters.h"
+
+namespace towr {
+
+/**
+ * @brief Solves the same locomotion problem towards several goals at once.
+ *
+ * Footstep-planning layers typically score a few dozen candidate goal
+ * poses per decision cycle. Running one TOWR instance per goal in sequence
+ * wastes both the cores and the fact that everything except the goal --
+ * initial state, robot model, terrain, gait -- is identical. This builds
+ * one problem per goal from the shared configuration and solves them on a
+ * pool of worker threads, returning cost and feasibility per goal so the
+ * caller can rank them.
+ *
+ * The model and terrain are shared read-only across all problems; solver
+ * instances cannot be shared across threads, so a fresh one is created
+ * per problem through the given maker.
+ */
+class BatchPlanner {
+public:
+  using FeetPos     = std::vector<Eigen::Vector3d>;
+  /// Creates one solver instance per problem (@sa TOWR::SolveMultiStart).
+  using SolverMaker = std::function<ifopt::Solver::Ptr()>;
+
+  /**
+   * @brief The outcome of one goal's solve.
+   */
+  struct GoalResult {
+    SplineHolder solution; ///< the optimized trajectory towards this goal.
+    double cost      = std::numeric_limits<double>::max();
+    double violation = std::numeric_limits<double>::max();
+    bool feasible    = false; ///< whether the solver found a feasible motion.
+  };
+
+  /**
+   * @param params   The parameters defining each optimization problem.
+   * @param model    The kinematic and dynamic model of the system.
+   * @param terrain  The height map of the terrain to walk over.
+   */
+  BatchPlanner(const Parameters& params, const RobotModel& model,
+               HeightMap::Ptr terrain);
+  virtual ~BatchPlanner() = default;
+
+  /**
+   * @brief The state of the robot all candidate solves start from.
+   * @param base  The linear and angular position and velocity of the 6D-base.
+   * @param feet  The current position of the end-effectors.
+   */
+  void SetInitialState(const BaseState& base, const FeetPos& feet);
+
+  /**
+   * @brief Solves one problem per goal on a pool of worker threads.
+   * @param goals        The candidate final base states to evaluate.
+   * @param make_solver  Creates a fresh solver per problem.
+   * @param n_threads    Number of worker threads; 0 uses the hardware
+   *                     concurrency.
+   * @returns One GoalResult per goal, in the order of @c goals.
+   */
+  std::vector<GoalResult> Solve(const std::vector<BaseState>& goals,
+                                const SolverMaker& make_solver,
+                                int n_threads = 0) const;
+
+private:
+  Parameters params_;
+  RobotModel model_;
+  HeightMap::Ptr terrain_;
+
+  BaseState initial_base_;
+  FeetPos initial_ee_W_;
+};
+
+} /* namespace towr */
+
+#endif /* TOWR_BATCH_PLANNER_H_ */
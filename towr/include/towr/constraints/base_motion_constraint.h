@@ -32,7 +32,9 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <towr/variables/spline_holder.h>
 #include <towr/variables/spline.h>
+#include <towr/variables/spline_state_grid.h>
 
+#include "hessian_provider.h"
 #include "time_discretization_constraint.h"
 
 namespace towr {
@@ -45,7 +47,8 @@ namespace towr {
  *
  * @ingroup Constraints
  */
-class BaseMotionConstraint : public TimeDiscretizationConstraint {
+class BaseMotionConstraint : public TimeDiscretizationConstraint,
+                             public HessianProvider {
 public:
   /**
    * @brief Links the base variables and sets hardcoded bounds on the state.
@@ -56,15 +59,39 @@ public:
   BaseMotionConstraint (double T, double dt, const SplineHolder& spline_holder);
   virtual ~BaseMotionConstraint () = default;
 
+  /**
+   * @brief Attaches a shared cache of spline states on this time grid.
+   *
+   * The grid times must match the constraint's own discretization; the
+   * base states are then read from the cache instead of evaluated
+   * privately (@sa SplineStateGrid).
+   */
+  void SetStateGrid(const SplineStateGrid::Ptr& grid);
+
   void UpdateConstraintAtInstance (double t, int k, VectorXd& g) const override;
   void UpdateBoundsAtInstance (double t, int k, VecBound&) const override;
-  void UpdateJacobianAtInstance(double t, int k, std::string, Jacobian&) const override;
+  void UpdateJacobianAtInstance(double t, int k, const id::VarSetId&,
+                                Jacobian&) const override;
+
+  /// the bounds don't depend on the optimization variables, so the full
+  /// vector is assembled once in the constructor and returned as is.
+  VecBound GetBounds() const override;
+
+  /// the constraint directly bounds the spline state, which is linear in
+  /// the node values, so the zero Hessian is exact.
+  bool HasHessian() const override { return true; };
 
 private:
   NodeSpline::Ptr base_linear_;
   NodeSpline::Ptr base_angular_;
 
   VecBound node_bounds_;     ///< same bounds for each discretized node
+  VecBound full_bounds_;     ///< node_bounds_ repeated over all instances.
+
+  /// optional shared cache of spline states on the discretization grid.
+  SplineStateGrid::Ptr state_grid_;
+
+  void PrimeEvaluationCaches() const override;
   int GetRow (int node, int dim) const;
 };
 
@@ -32,9 +32,11 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <towr/variables/spline.h>
 #include <towr/variables/spline_holder.h>
+#include <towr/variables/spline_state_grid.h>
 #include <towr/variables/euler_converter.h>
 
 #include <towr/models/dynamic_model.h>
+#include <towr/solve_monitor.h>
 
 #include "time_discretization_constraint.h"
 
@@ -74,16 +76,95 @@ public:
   DynamicConstraint (const DynamicModel::Ptr& model,
                      double T, double dt,
                      const SplineHolder& spline_holder);
+
+  /**
+   * @brief  Construct a Dynamic constraint on a custom time grid.
+   * @param model  The system dynamics to enforce (e.g. centroidal, LIP, ...)
+   * @param dts  The time instances at which to enforce the dynamics, e.g.
+   *             a grid refined where previous iterates violated them.
+   * @param spline_holder  A pointer to the current optimization variables.
+   */
+  DynamicConstraint (const DynamicModel::Ptr& model,
+                     const VecTimes& dts,
+                     const SplineHolder& spline_holder);
   virtual ~DynamicConstraint () = default;
 
+  /**
+   * @brief Attaches a monitor notified on every constraint evaluation.
+   *
+   * Since this constraint is evaluated once per solver iteration (plus
+   * line-search trials), the monitor can report solve progress and
+   * cooperatively cancel a running solve (@sa SolveMonitor).
+   */
+  void SetSolveMonitor(const SolveMonitor::Ptr& monitor);
+
+  /**
+   * @brief Replaces the base-orientation parameterization.
+   *
+   * By default the angular nodes are read as Euler-ZYX angles; the factory
+   * swaps in a RotationVectorConverter here when
+   * Parameters::UseRotationVectorBase() is set. Must be called before the
+   * first evaluation.
+   */
+  void SetAngularConverter(const AngularStateConverter::Ptr& converter);
+
+  /**
+   * @brief Attaches a shared cache of spline states on this time grid.
+   *
+   * The grid times must match the constraint's own discretization; states
+   * are then read from the cache instead of evaluated privately, so
+   * constraints sharing the grid evaluate each spline only once per
+   * solver iterate (@sa SplineStateGrid).
+   */
+  void SetStateGrid(const SplineStateGrid::Ptr& grid);
+
+  VectorXd GetValues() const override;
+
 private:
   NodeSpline::Ptr base_linear_;   ///< lin. base pos/vel/acc in world frame
-  EulerConverter base_angular_;        ///< angular base state
+  AngularStateConverter::Ptr base_angular_; ///< angular base state
   std::vector<NodeSpline::Ptr> ee_forces_; ///< endeffector forces in world frame.
   std::vector<NodeSpline::Ptr> ee_motion_; ///< endeffector position in world frame.
 
   mutable DynamicModel::Ptr model_;    ///< the dynamic model (e.g. Centroidal)
 
+  /** Scratch matrices for the model's Jacobian products, reused across
+   *  the instants of the discretization grid. This constraint therefore
+   *  evaluates its instants serially.
+   */
+  mutable DynamicModel::JacWorkspace jac_ws_;
+
+  /** Endeffector state passed to the model, sized once at construction
+   *  (the endeffector count is fixed) and overwritten per instant.
+   */
+  mutable std::vector<Eigen::Vector3d> ee_pos_, ee_force_;
+
+  SolveMonitor::Ptr monitor_; ///< optional progress/cancellation hook.
+
+  /// optional shared cache of spline states on the discretization grid.
+  SplineStateGrid::Ptr state_grid_;
+
+  /** The states of all instants gathered in structure-of-arrays form, and
+   *  the 6 x n violations the model's batch kernel computes from them.
+   *  Both keep their heap buffers between evaluations.
+   */
+  mutable DynamicModel::StateArrays state_arrays_;
+  mutable DynamicModel::Matrix6Xd violations_;
+
+  /** Dense scratch blocks of the column-window Jacobian path, reused
+   *  across instants (@sa DynamicModel::HasWindowJacobians()).
+   */
+  mutable Eigen::MatrixXd win_jac_a_, win_jac_b_, win_out_;
+
+  /**
+   * @brief Fills state_arrays_ from the state grid and angular converter.
+   *
+   * Only available with an attached state grid; the per-instant states
+   * are copied into contiguous coordinate rows so the model's violation
+   * kernel can vectorize across the instants (@sa ComputeViolationsBatch).
+   */
+  void GatherStateArrays() const;
+
   /**
    * @brief The row in the overall constraint for this evaluation time.
    * @param k The index of the constraint evaluation at t=k*dt.
@@ -95,12 +176,16 @@ private:
   /**
    * @brief Updates the model with the current state and forces.
    * @param t Time at which to query the state and force splines.
+   * @param k The index of the time t in the discretization grid.
    */
-  void UpdateModel(double t) const;
+  void UpdateModel(double t, int k) const;
 
+  void PrimeEvaluationCaches() const override;
+  std::size_t GetHeapBytes() const override;
   void UpdateConstraintAtInstance(double t, int k, VectorXd& g) const override;
   void UpdateBoundsAtInstance(double t, int k, VecBound& bounds) const override;
-  void UpdateJacobianAtInstance(double t, int k, std::string, Jacobian&) const override;
+  void UpdateJacobianAtInstance(double t, int k, const id::VarSetId&,
+                                Jacobian&) const override;
 };
 
 } /* namespace towr */
@@ -34,6 +34,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <towr/variables/phase_nodes.h>
 #include <towr/terrain/height_map.h> // for friction cone
+#include "jacobian_workspace.h"
 
 namespace towr {
 
@@ -70,6 +71,21 @@ public:
 
   void InitVariableDependedQuantities(const VariablesPtr& x) override;
 
+  /**
+   * @brief Rebinds the constraint to new elevation data.
+   *
+   * The friction coefficient is captured from the terrain at
+   * construction, so it is refreshed along with the pointer
+   * (@sa TOWR::SwapTerrain()).
+   */
+  void SetTerrain(const HeightMap::Ptr& terrain)
+  {
+    terrain_ = terrain;
+    mu_ = terrain->GetFrictionCoeff();
+    for (auto& f : frames_)
+      f.valid = false;
+  };
+
   VectorXd GetValues() const override;
   VecBound GetBounds() const override;
   void FillJacobianBlock (std::string var_set, Jacobian&) const override;
@@ -89,6 +105,36 @@ private:
    * stance phases, while all the others are already set to zero force (swing)
    **/
   std::vector<int> pure_stance_force_node_ids_;
+
+  // cache the Jacobian sparsity per variable set (it never changes)
+  mutable JacobianWorkspace jac_ws_force_;
+  mutable JacobianWorkspace jac_ws_motion_;
+
+  /**
+   * @brief The terrain contact frame at one stance phase's foothold.
+   *
+   * All five pyramid directions and their foothold derivatives are
+   * stacked into fixed-size matrices, so evaluating the constraint rows
+   * of one force node is a single 5x3 matrix-vector product.
+   */
+  struct TerrainFrame {
+    Eigen::Vector2d p; ///< the foothold (x,y) the frame was built at.
+    Eigen::Matrix<double,5,3> pyramid; ///< rows: n, t1-/+mu*n, t2-/+mu*n.
+    Eigen::Matrix<double,5,3> pyramid_deriv[k2D]; ///< change per foothold x,y.
+    bool valid = false;
+  };
+
+  /**
+   * @brief The terrain frame of the given phase, rebuilt only if needed.
+   *
+   * The frame is cached across evaluations and refreshed when the
+   * foothold has moved more than frame_tolerance_ since it was built, so
+   * the value and Jacobian passes of one solver iterate share a single
+   * set of terrain basis queries.
+   */
+  const TerrainFrame& GetFrame(int phase) const;
+  mutable std::vector<TerrainFrame> frames_; ///< one per phase of the spline.
+  double frame_tolerance_ = 1e-10; ///< foothold motion [m] forcing a rebuild.
 };
 
 } /* namespace towr */
@@ -0,0 +1,92 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef TOWR_CONSTRAINTS_HESSIAN_PROVIDER_H_
+#define TOWR_CONSTRAINTS_HESSIAN_PROVIDER_H_
+
+#include <string>
+
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+
+namespace towr {
+
+/**
+ * @brief Second-derivative interface for constraints that can provide one.
+ *
+ * ifopt has no Hessian callback, so solvers attached through it fall back
+ * to limited-memory quasi-Newton approximations, which typically cost many
+ * extra iterations on the timing-optimization problems. This interface is
+ * the towr-side support surface for exact second derivatives: a
+ * Hessian-capable solver adapter can downcast the constraint sets of the
+ * problem to this type and assemble the Hessian of the Lagrangian
+ * blockwise, analogous to how ifopt assembles the Jacobian through
+ * FillJacobianBlock().
+ *
+ * A constraint that derives from this interface and returns true from
+ * HasHessian() states that FillHessianBlock() provides all non-zero
+ * curvature blocks it implements; any block a constraint documents as
+ * omitted must be treated as a Gauss-Newton style approximation by the
+ * consumer.
+ *
+ * @ingroup Constraints
+ */
+class HessianProvider {
+public:
+  // no VectorXd alias on purpose: it would clash with the one a
+  // constraint already inherits from ifopt::ConstraintSet.
+  using Hessian = Eigen::SparseMatrix<double, Eigen::RowMajor>;
+
+  virtual ~HessianProvider () = default;
+
+  /**
+   * @returns True if this constraint implements FillHessianBlock().
+   *
+   * Linear constraints return true with an empty implementation, since
+   * their zero Hessian is exact.
+   */
+  virtual bool HasHessian() const { return false; };
+
+  /**
+   * @brief Adds d^2(lambda^T g)/(dw_row dw_col) to the given block.
+   * @param row_var_set  Name of the variables of the block rows.
+   * @param col_var_set  Name of the variables of the block columns.
+   * @param lambda  One multiplier per constraint row (@sa GetRows()).
+   * @param[in/out] hes  The block, pre-sized to the two variable sets,
+   *                     to which the weighted curvature is added.
+   */
+  virtual void FillHessianBlock(std::string row_var_set,
+                                std::string col_var_set,
+                                const Eigen::VectorXd& lambda,
+                                Hessian& hes) const {};
+};
+
+} /* namespace towr */
+
+#endif /* TOWR_CONSTRAINTS_HESSIAN_PROVIDER_H_ */
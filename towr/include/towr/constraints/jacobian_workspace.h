@@ -0,0 +1,110 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef TOWR_CONSTRAINTS_JACOBIAN_WORKSPACE_H_
+#define TOWR_CONSTRAINTS_JACOBIAN_WORKSPACE_H_
+
+#include <vector>
+
+#include <Eigen/Sparse>
+
+namespace towr {
+
+/**
+ * @brief Assembles a constraint Jacobian whose sparsity is fixed.
+ *
+ * Writing each coefficient through Jacobian::coeffRef() performs a binary
+ * search per entry, every solver iteration, although the sparsity pattern of
+ * a towr constraint never changes once the variables are connected. This
+ * workspace records the pattern during the first assembly pass and on all
+ * later passes copies it into the output Jacobian, so the values can be
+ * stored directly in the compressed value array by remembered flat index.
+ *
+ * Usage inside FillJacobianBlock() (one workspace per variable set):
+ * @code
+ *   workspace_.Start(jac);
+ *   for (...)
+ *     workspace_.Write(row, col, value);
+ *   workspace_.Finish();
+ * @endcode
+ *
+ * The assembly loops must visit the entries in the same order in every pass
+ * and write each (row,col) at most once, which deterministic loops over the
+ * constrained nodes guarantee.
+ */
+class JacobianWorkspace {
+public:
+  using Jacobian = Eigen::SparseMatrix<double, Eigen::RowMajor>;
+
+  JacobianWorkspace () = default;
+  virtual ~JacobianWorkspace () = default;
+
+  /**
+   * @brief Begins an assembly pass that fills @a jac.
+   *
+   * On all passes after the first this copies the cached sparsity pattern
+   * into @a jac, so Write() only has to store values.
+   */
+  void Start(Jacobian& jac);
+
+  /**
+   * @brief Sets the Jacobian entry at (row, col).
+   */
+  void Write(int row, int col, double value);
+
+  /**
+   * @brief Sets an entry whose value never changes between passes.
+   *
+   * The first pass records the entry like Write(); all later passes skip
+   * it entirely, since Start() restores the first-pass value along with
+   * the pattern. Lets constraints with partially constant Jacobians
+   * (e.g. TerrainConstraint's unit z-columns) update only the entries
+   * that actually depend on the variables.
+   */
+  void WriteConstant(int row, int col, double value);
+
+  /**
+   * @brief Ends the pass; the first pass builds the pattern and flat indices.
+   */
+  void Finish();
+
+private:
+  Jacobian* jac_ = nullptr; ///< the output bound by Start().
+  Jacobian pattern_;        ///< compressed sparsity, built on the first pass.
+
+  std::vector<Eigen::Triplet<double>> triplets_; ///< first-pass recording.
+  std::vector<bool> constant_flags_; ///< marks WriteConstant() recordings.
+  std::vector<int> ordered_indices_; ///< value-array slot of the i-th Write().
+  std::size_t write_count_ = 0;      ///< Write() calls in the current pass.
+  bool pattern_recorded_ = false;
+};
+
+} /* namespace towr */
+
+#endif /* TOWR_CONSTRAINTS_JACOBIAN_WORKSPACE_H_ */
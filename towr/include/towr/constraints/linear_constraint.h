@@ -32,6 +32,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <ifopt/constraint_set.h>
 
+#include "hessian_provider.h"
+
 namespace towr {
 
 /**
@@ -39,7 +41,8 @@ namespace towr {
  *
  * @ingroup Constraints
  */
-class LinearEqualityConstraint : public ifopt::ConstraintSet {
+class LinearEqualityConstraint : public ifopt::ConstraintSet,
+                                 public HessianProvider {
 public:
   using MatrixXd = Eigen::MatrixXd;
 
@@ -59,6 +62,9 @@ public:
   VecBound GetBounds() const final;
   void FillJacobianBlock (std::string var_set, Jacobian&) const final;
 
+  /// the constraint is linear, so the zero Hessian is exact.
+  bool HasHessian() const override { return true; };
+
 private:
   MatrixXd M_;
   VectorXd v_;
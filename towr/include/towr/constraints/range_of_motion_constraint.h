@@ -32,10 +32,12 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <towr/variables/spline.h>
 #include <towr/variables/spline_holder.h>
+#include <towr/variables/spline_state_grid.h>
 #include <towr/variables/euler_converter.h>
 
 #include <towr/models/kinematic_model.h>
 
+#include "hessian_provider.h"
 #include "time_discretization_constraint.h"
 
 namespace towr {
@@ -52,7 +54,8 @@ namespace towr {
   *
   * @ingroup Constraints
   */
-class RangeOfMotionConstraint : public TimeDiscretizationConstraint {
+class RangeOfMotionConstraint : public TimeDiscretizationConstraint,
+                                public HessianProvider {
 public:
   using EE = uint;
   using Vector3d = Eigen::Vector3d;
@@ -71,19 +74,83 @@ public:
                           const SplineHolder& spline_holder);
   virtual ~RangeOfMotionConstraint() = default;
 
+  /**
+   * @brief Replaces the base-orientation parameterization.
+   *
+   * By default the angular nodes are read as Euler-ZYX angles; the factory
+   * swaps in a RotationVectorConverter here when
+   * Parameters::UseRotationVectorBase() is set. Must be called before the
+   * first evaluation.
+   */
+  void SetAngularConverter(const AngularStateConverter::Ptr& converter);
+
+  /**
+   * @brief Attaches a shared cache of spline states on this time grid.
+   *
+   * The grid times must match the constraint's own discretization; the
+   * base and endeffector positions are then read from the cache instead
+   * of evaluated privately, so constraints sharing the grid evaluate each
+   * spline only once per solver iterate (@sa SplineStateGrid).
+   */
+  void SetStateGrid(const SplineStateGrid::Ptr& grid);
+
+  bool HasHessian() const override { return true; };
+
+  /**
+   * @brief The curvature from rotating the base-to-foot vector.
+   *
+   * The constraint is linear in the base and endeffector positions for a
+   * fixed orientation, so the only non-zero blocks couple the angular
+   * nodes with the linear base and endeffector nodes. These cross blocks
+   * are provided exactly through the derivative of the rotation matrix;
+   * the pure angular block (second derivative of the rotation matrix) is
+   * omitted, i.e. approximated Gauss-Newton style as zero.
+   */
+  void FillHessianBlock(std::string row_var_set, std::string col_var_set,
+                        const Eigen::VectorXd& lambda, Hessian& hes) const override;
+
 private:
   NodeSpline::Ptr base_linear_;     ///< the linear position of the base.
-  EulerConverter base_angular_; ///< the orientation of the base.
+  AngularStateConverter::Ptr base_angular_; ///< the orientation of the base.
   NodeSpline::Ptr ee_motion_;       ///< the linear position of the endeffectors.
 
   Eigen::Vector3d max_deviation_from_nominal_;
   Eigen::Vector3d nominal_ee_pos_B_;
   EE ee_;
 
+  /// the deviation box around the nominal stance; identical for every node,
+  /// so assembled once at construction instead of per bounds query.
+  std::vector<ifopt::Bounds> node_bounds_;
+
+  /**
+   * @brief The world-to-base rotation at grid instant k, cached per epoch.
+   *
+   * The Jacobian is filled once per variable set, and up to four of those
+   * passes need this rotation at every grid instant while the variables
+   * are unchanged. Caching per instant, invalidated through the spline's
+   * update counter, computes each rotation once per iteration instead of
+   * once per pass. Only used on the (serial) Jacobian path.
+   */
+  const AngularStateConverter::MatrixSXd& GetRotationWorldToBase(double t, int k) const;
+  mutable std::vector<AngularStateConverter::MatrixSXd> b_R_w_cache_;
+  mutable std::vector<bool> b_R_w_valid_;
+  mutable int b_R_w_epoch_ = -1;
+
+  /// optional shared cache of spline states on the discretization grid.
+  SplineStateGrid::Ptr state_grid_;
+
+  /// base position at grid instant k, from the shared grid when attached.
+  Vector3d GetBaseLinPos(double t, int k) const;
+
+  /// endeffector position at grid instant k, from the shared grid when attached.
+  Vector3d GetEEPos(double t, int k) const;
+
   // see TimeDiscretizationConstraint for documentation
+  void PrimeEvaluationCaches() const override;
   void UpdateConstraintAtInstance (double t, int k, VectorXd& g) const override;
   void UpdateBoundsAtInstance (double t, int k, VecBound&) const override;
-  void UpdateJacobianAtInstance(double t, int k, std::string, Jacobian&) const override;
+  void UpdateJacobianAtInstance(double t, int k, const id::VarSetId&,
+                                Jacobian&) const override;
 
   int GetRow(int node, int dimension) const;
 };
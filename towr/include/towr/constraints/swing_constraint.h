@@ -69,6 +69,14 @@ private:
   std::string ee_motion_id_;
 
   std::vector<int> pure_swing_node_ids_;
+
+  /**
+   * The constraint is linear in the node variables, so the full Jacobian
+   * is assembled once when the variables are known. Each evaluation is
+   * then a single matrix-vector product and each Jacobian query a copy,
+   * with no per-node index lookups.
+   */
+  Jacobian jac_const_;
 };
 
 } /* namespace towr */
@@ -34,6 +34,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <towr/variables/phase_nodes.h>
 #include <towr/terrain/height_map.h>
+#include "jacobian_workspace.h"
 
 namespace towr {
 
@@ -62,6 +63,14 @@ public:
 
   void InitVariableDependedQuantities(const VariablesPtr& x) override;
 
+  /**
+   * @brief Rebinds the constraint to new elevation data.
+   *
+   * All terrain values are queried per evaluation, so no cached state
+   * must be invalidated here (@sa TOWR::SwapTerrain()).
+   */
+  void SetTerrain(const HeightMap::Ptr& terrain) { terrain_ = terrain; };
+
   VectorXd GetValues() const override;
   VecBound GetBounds() const override;
   void FillJacobianBlock (std::string var_set, Jacobian&) const override;
@@ -72,6 +81,14 @@ private:
 
   std::string ee_motion_id_;  ///< the name of the endeffector variable set.
   std::vector<int> node_ids_; ///< the indices of the nodes constrained.
+
+  mutable JacobianWorkspace jac_ws_; ///< caches the Jacobian sparsity.
+
+  // scratch for the batched terrain queries, kept to avoid reallocating
+  // per evaluation (@sa HeightMap::GetHeights).
+  mutable Eigen::Matrix2Xd query_xy_;
+  mutable VectorXd query_heights_;
+  mutable Eigen::Matrix2Xd query_derivs_;
 };
 
 } /* namespace towr */
@@ -35,6 +35,9 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <ifopt/constraint_set.h>
 
+#include <towr/evaluation_stats.h>
+#include <towr/variables/variable_names.h>
+
 namespace towr {
 
 /**
@@ -47,7 +50,8 @@ namespace towr {
  *
  * @ingroup Constraints
  */
-class TimeDiscretizationConstraint : public ifopt::ConstraintSet {
+class TimeDiscretizationConstraint : public ifopt::ConstraintSet,
+                                     public EvaluationProfiler {
 public:
   using VecTimes = std::vector<double>;
   using Bounds   = ifopt::Bounds;
@@ -68,15 +72,83 @@ public:
   TimeDiscretizationConstraint (const VecTimes& dts, std::string name);
   virtual ~TimeDiscretizationConstraint () = default;
 
+  /**
+   * @brief The canonical time grid for a duration T discretized at dt.
+   * @param T  The total duration of the trajectory.
+   * @param dt The discretization interval.
+   *
+   * Both the constraints and the shared SplineStateGrid are built through
+   * this, so constraints with matching (T,dt) parameters evaluate on
+   * bitwise identical grids.
+   */
+  static VecTimes GetTimeGrid(double T, double dt);
+
   Eigen::VectorXd GetValues() const override;
   VecBound GetBounds() const override;
   void FillJacobianBlock (std::string var_set, Jacobian&) const override;
 
+  /**
+   * @returns Estimated heap bytes of this constraint's evaluation buffers.
+   *
+   * Subclasses carrying extra workspaces add them on top; feeds the
+   * per-subsystem memory report (@sa TOWR::GetProblemStats()).
+   */
+  virtual std::size_t GetHeapBytes() const;
+
 protected:
   int GetNumberOfNodes() const;
   VecTimes dts_; ///< times at which the constraint is evaluated.
 
+  /**
+   * @brief True if the time instances are evaluated in parallel (OpenMP).
+   *
+   * Every instance k writes disjoint rows of the constraint and bounds
+   * vectors, so subclasses whose Update*AtInstance() implementations don't
+   * mutate shared state can enable this to spread the time grid across
+   * cores. The Jacobian is always filled serially, since all instances
+   * write into the same sparse matrix.
+   */
+  bool parallelize_instances_ = false;
+
+  /**
+   * @brief Hook called serially at the start of each evaluation pass.
+   *
+   * Subclasses consulting shared caches (@sa SplineStateGrid) refresh
+   * them here, so the (possibly parallel) per-instance updates only read.
+   */
+  virtual void PrimeEvaluationCaches() const {};
+
+  /**
+   * @brief The row block instant k writes during Jacobian assembly.
+   * @param[out] row_start  First row of the block.
+   * @param[out] n_rows     Number of rows in the block.
+   *
+   * Scanning only these rows of the per-instance scratch matrix keeps the
+   * gather cost per instant independent of the total row count. The
+   * default assumes contiguous same-size blocks per instant, which every
+   * subclass in this tree lays its rows out as.
+   */
+  virtual void GetActiveRows(int k, int& row_start, int& n_rows) const;
+
+  /**
+   * @brief Appends one Jacobian entry directly to the assembly buffer.
+   *
+   * Subclasses computing an instant's rows on a narrow dense column
+   * window emit them here instead of routing them through the sparse
+   * scratch matrix. Explicit zeros must be emitted too, so the assembled
+   * sparsity stays identical across evaluations.
+   */
+  void AddJacobianTriplet(int row, int col, double value) const;
+
 private:
+  /** Scratch holding the rows of one time instance during Jacobian
+   *  assembly; its entries are gathered into triplets_ and the output
+   *  Jacobian is built once per FillJacobianBlock(). Both buffers keep
+   *  their heap capacity between passes.
+   */
+  mutable Jacobian jac_instance_;
+  mutable std::vector<Eigen::Triplet<double>> triplets_;
+
   /**
    * @brief Sets the constraint value a specific time t, corresponding to node k.
    * @param t  The time along the trajectory to set the constraint.
@@ -99,11 +171,14 @@ private:
    * @brief Sets Jacobian rows at a specific time t, corresponding to node k.
    * @param t  The time along the trajcetory to set the bounds.
    * @param k  The index of the time t, so t=k*dt
-   * @param var_set The name of the ifopt variables currently being queried for.
+   * @param var_set The interned identity of the ifopt variables currently
+   *                being queried for, resolved once per assembly pass so
+   *                the per-instance dispatch avoids string comparisons.
    * @param[in/out] jac  The complete Jacobian, for which the corresponding
    *                     row and columns must be set.
    */
-  virtual void UpdateJacobianAtInstance(double t, int k, std::string var_set,
+  virtual void UpdateJacobianAtInstance(double t, int k,
+                                        const id::VarSetId& var_set,
                                         Jacobian& jac) const = 0;
 };
 
@@ -30,11 +30,15 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef TOWR_COSTS_NODE_COST_H_
 #define TOWR_COSTS_NODE_COST_H_
 
+#include <map>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <ifopt/cost_term.h>
 
+#include <towr/evaluation_stats.h>
 #include <towr/variables/nodes.h>
 
 
@@ -43,10 +47,16 @@ namespace towr {
 /**
  * @brief  Assigns a cost to node values.
  *
+ * One cost object can penalize several (derivative, dimension)
+ * selections on several node variable sets at once, so e.g. the force
+ * cost is a single ifopt component instead of one per endeffector.
+ *
  * @ingroup Costs
  */
-class NodeCost : public ifopt::CostTerm {
+class NodeCost : public ifopt::CostTerm, public EvaluationProfiler {
 public:
+  using Penalty = std::pair<Dx,int>; ///< derivative and dimension to penalize.
+
   /**
    * @brief Constructs a cost term for the optimization problem.
    * @param nodes_id  The name of the node variables.
@@ -54,6 +64,15 @@ public:
    * @param dim       The node dimension which should be penalized.
    */
   NodeCost (const std::string& nodes_id, Dx deriv, int dim);
+
+  /**
+   * @brief Constructs a cost over multiple node sets and selections.
+   * @param node_ids   The names of the penalized node variable sets.
+   * @param penalties  The (derivative, dimension) values to penalize,
+   *                   applied to every set.
+   */
+  NodeCost (const std::vector<std::string>& node_ids,
+            const std::vector<Penalty>& penalties);
   virtual ~NodeCost () = default;
 
   void InitVariableDependedQuantities(const VariablesPtr& x) override;
@@ -61,11 +80,27 @@ public:
   double GetCost () const override;
 
 private:
-  std::shared_ptr<Nodes> nodes_;
-
-  std::string node_id_;
-  Dx deriv_;
-  int dim_;
+  std::vector<std::string> node_ids_;
+  std::vector<Penalty> penalties_;
+
+  /// one value of the precomputed gradient: which nonzero slot of the
+  /// structure it adds to, and which node value it reads.
+  struct GradEntry {
+    int col;     ///< the optimization index (sparse column).
+    int slot;    ///< position in the compressed value array.
+    int node_id; ///< the node whose value enters the gradient.
+    Dx deriv;
+    int dim;
+  };
+
+  /// the per-variable-set gradient structure, assembled once at
+  /// InitVariableDependedQuantities(); evaluations only write values.
+  struct SetData {
+    std::shared_ptr<Nodes> nodes;
+    Jacobian structure; ///< compressed sparsity of the gradient row.
+    std::vector<GradEntry> entries;
+  };
+  std::map<std::string, SetData> sets_;
 
   void FillJacobianBlock(std::string var_set, Jacobian&) const override;
 };
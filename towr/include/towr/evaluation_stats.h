@@ -0,0 +1,130 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef TOWR_EVALUATION_STATS_H_
+#define TOWR_EVALUATION_STATS_H_
+
+#include <chrono>
+#include <string>
+
+#include "evaluation_trace.h"
+
+namespace towr {
+
+/**
+ * @brief Call counts and wall time of one constraint/cost during a solve.
+ *
+ * @sa TOWR::GetEvaluationStats()
+ */
+struct EvaluationStats {
+  int n_values    = 0;      ///< evaluations of the constraint/cost values.
+  int n_jacobians = 0;      ///< evaluations of the Jacobian.
+  double t_values    = 0.0; ///< cumulative wall time [s] spent on values.
+  double t_jacobians = 0.0; ///< cumulative wall time [s] spent on Jacobians.
+};
+
+/**
+ * @brief Opt-in evaluation profiling, mixed into constraints and costs.
+ *
+ * When a solve is slow this identifies which constraint set eats the time,
+ * without attaching an external profiler to the running planner. Profiling
+ * is off by default and then costs a single branch per evaluation.
+ */
+class EvaluationProfiler {
+public:
+  void SetProfilingEnabled(bool enable) { profile_ = enable; }
+  bool IsProfilingEnabled() const { return profile_; }
+
+  const EvaluationStats& GetEvaluationStats() const { return stats_; }
+  void ResetEvaluationStats() { stats_ = EvaluationStats(); }
+
+  /**
+   * @brief Streams every evaluation as a span into the given trace.
+   * @param trace  The shared trace buffer, nullptr to detach.
+   * @param name   The set name the spans are recorded under.
+   *
+   * The name is registered once here, so the recording itself stays a
+   * few stores per evaluation (@sa EvaluationTrace).
+   */
+  void AttachTrace(const EvaluationTrace::Ptr& trace, const std::string& name) {
+    trace_ = trace;
+    trace_name_id_ = trace? trace->RegisterName(name) : -1;
+  }
+
+protected:
+  using Clock = std::chrono::steady_clock;
+
+  /// The start time of one evaluation; dummy when profiling is off.
+  Clock::time_point StartMeasurement() const {
+    return (profile_ || trace_)? Clock::now() : Clock::time_point();
+  }
+
+  /// Books the elapsed time since @a t0 as one value evaluation.
+  void StopValueMeasurement(Clock::time_point t0) const {
+    if (!profile_ && !trace_)
+      return;
+
+    auto t1 = Clock::now();
+    if (profile_) {
+      stats_.t_values += GetSecondsBetween(t0, t1);
+      stats_.n_values++;
+    }
+    if (trace_)
+      trace_->Record(trace_name_id_, EvaluationTrace::Values, t0, t1);
+  }
+
+  /// Books the elapsed time since @a t0 as one Jacobian evaluation.
+  void StopJacobianMeasurement(Clock::time_point t0) const {
+    if (!profile_ && !trace_)
+      return;
+
+    auto t1 = Clock::now();
+    if (profile_) {
+      stats_.t_jacobians += GetSecondsBetween(t0, t1);
+      stats_.n_jacobians++;
+    }
+    if (trace_)
+      trace_->Record(trace_name_id_, EvaluationTrace::Jacobian, t0, t1);
+  }
+
+private:
+  static double GetSecondsBetween(Clock::time_point t0, Clock::time_point t1) {
+    return std::chrono::duration<double>(t1 - t0).count();
+  }
+
+  mutable EvaluationStats stats_;
+  bool profile_ = false;
+
+  EvaluationTrace::Ptr trace_; ///< receives per-evaluation spans, if set.
+  int trace_name_id_ = -1;     ///< this set's name in the trace.
+};
+
+} /* namespace towr */
+
+#endif /* TOWR_EVALUATION_STATS_H_ */
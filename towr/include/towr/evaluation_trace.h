@@ -0,0 +1,123 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef TOWR_EVALUATION_TRACE_H_
+#define TOWR_EVALUATION_TRACE_H_
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace towr {
+
+/**
+ * @brief Records every constraint/cost evaluation as a timed span.
+ *
+ * While EvaluationStats aggregates wall time per set over a whole solve,
+ * this keeps the individual evaluations: one span per value or Jacobian
+ * evaluation with its set name, start time and duration. Exported as a
+ * Chrome trace file it gives a timeline across the solver iterations,
+ * so a single pathological iteration stands out instead of drowning in
+ * the totals.
+ *
+ * The span storage is preallocated and each record is a few stores into
+ * it, so tracing adds nanoseconds per evaluation. When the capacity is
+ * reached further spans are dropped (and counted), never reallocated
+ * mid-solve.
+ *
+ * @sa TOWR::SetEvaluationTrace()
+ */
+class EvaluationTrace {
+public:
+  using Ptr   = std::shared_ptr<EvaluationTrace>;
+  using Clock = std::chrono::steady_clock;
+
+  /// What an evaluation span measured.
+  enum SpanKind : int32_t { Values=0, Jacobian };
+
+  /// One recorded evaluation, kept as plain data (@sa Record()).
+  struct Span {
+    int32_t name_id;    ///< index into the registered set names.
+    int32_t kind;       ///< SpanKind of the evaluation.
+    int64_t t_start_ns; ///< start relative to the trace epoch [ns].
+    int64_t duration_ns;///< wall time of the evaluation [ns].
+  };
+
+  /**
+   * @param capacity  The maximum number of spans kept; at ~150 bytes of
+   *                  JSON each the default traces minutes of solving.
+   */
+  explicit EvaluationTrace(std::size_t capacity = 1 << 20);
+
+  /**
+   * @brief Registers a constraint/cost name, returning its span id.
+   *
+   * Called once per set when the trace is attached, so recording itself
+   * never touches strings.
+   */
+  int RegisterName(const std::string& name);
+
+  /**
+   * @brief Stores one evaluation span; called from the solver thread.
+   */
+  void Record(int name_id, SpanKind kind,
+              Clock::time_point t0, Clock::time_point t1);
+
+  /// Drops all recorded spans (registered names are kept).
+  void Clear();
+
+  std::size_t GetSpanCount() const { return n_spans_; };
+
+  /// Spans not recorded because the capacity was reached.
+  std::size_t GetDroppedCount() const { return n_dropped_; };
+
+  /**
+   * @brief Writes the spans as a Chrome trace-event file.
+   * @param path  The .json file to (over-)write.
+   * @throws std::runtime_error if the file cannot be written.
+   *
+   * The format is the Trace Event JSON understood by chrome://tracing,
+   * Perfetto and speedscope; value and Jacobian evaluations appear as
+   * separate tracks of complete events.
+   */
+  void WriteChromeTrace(const std::string& path) const;
+
+private:
+  std::vector<std::string> names_; ///< registered set names, by name id.
+  std::vector<Span> spans_;        ///< preallocated span storage.
+  std::size_t n_spans_ = 0;        ///< spans recorded so far.
+  std::size_t n_dropped_ = 0;      ///< spans dropped at full capacity.
+  Clock::time_point epoch_;        ///< construction time; span times are relative.
+};
+
+} /* namespace towr */
+
+#endif /* TOWR_EVALUATION_TRACE_H_ */
@@ -56,7 +56,7 @@ private:
   GaitInfo GetStrideRightHop() const;
   GaitInfo GetStrideGallopHop() const;
 
-  void SetCombo(Combos combo) override;
+  void ExpandCombo(Combos combo) override;
 
   // naming convention:, where the circle is is contact, front is right ->.
   ContactState I_; // flight
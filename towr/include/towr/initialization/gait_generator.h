@@ -30,6 +30,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef TOWR_MODELS_GAIT_GENERATOR_H_
 #define TOWR_MODELS_GAIT_GENERATOR_H_
 
+#include <array>
 #include <memory>
 #include <string>
 #include <utility>
@@ -80,10 +81,21 @@ public:
   /**
    * @brief Sets a specific sequence of gaits.
    *
-   * The derived class decides what each combo maps to. This function then fills
-   * the times_ and contacts_ variables accordingly.
+   * The derived class decides what each combo maps to (@sa ExpandCombo). The
+   * first time a combo is set its gait chain is expanded into flat
+   * duration/contact arrays; every further set of the same combo is just an
+   * array copy from this library, so e.g. an MPC loop that regenerates the
+   * gait every replan skips the vector concatenation entirely.
    */
-  virtual void SetCombo(Combos combo) = 0;
+  void SetCombo(Combos combo);
+
+  /**
+   * @brief Expands every combo into the gait library up front.
+   *
+   * Optional; combos not precomputed are expanded lazily on first use. The
+   * currently set gait is left untouched.
+   */
+  void PrecomputeGaitLibrary();
 
 protected:
   /// Phase times for the complete robot during which no contact state changes.
@@ -95,6 +107,15 @@ protected:
    */
   std::vector<ContactState> contacts_;
 
+  /**
+   * @brief Fills times_ and contacts_ for the given combo.
+   *
+   * The derived class decides what each combo maps to, typically through a
+   * chain of SetGaits() calls. Called at most once per combo; the result is
+   * cached in the gait library (@sa SetCombo).
+   */
+  virtual void ExpandCombo(Combos combo) = 0;
+
   /// Sets the times_ and contacts_ variables according to the gaits.
   void SetGaits(const std::vector<Gaits>& gaits);
 
@@ -105,9 +126,22 @@ protected:
   GaitInfo RemoveTransition(const GaitInfo& g) const;
 
 private:
+  /// One expanded combo: the flat arrays SetCombo() restores on a cache hit.
+  struct ComboGait {
+    bool built = false;
+    std::vector<double> times;
+    std::vector<ContactState> contacts;
+    FootDurations normalized_durations;
+  };
+  std::array<ComboGait, COMBO_COUNT> library_;
+
+  /// Per-foot phase durations normalized to a total of 1, kept in sync with
+  /// times_/contacts_ by SetGaits() so queries are plain lookups.
+  FootDurations normalized_durations_;
+
   FootDurations GetPhaseDurations() const;
   virtual GaitInfo GetGait(Gaits gait) const = 0;
-  VecTimes GetNormalizedPhaseDurations(EE ee) const;
+  const VecTimes& GetNormalizedPhaseDurations(EE ee) const;
 };
 
 } /* namespace towr */
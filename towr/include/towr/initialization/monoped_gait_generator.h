@@ -55,7 +55,7 @@ private:
   ContactState o_ = ContactState(1, true);  // stance
   ContactState x_ = ContactState(1, false); // flight
 
-  void SetCombo(Combos combo) override;
+  void ExpandCombo(Combos combo) override;
 };
 
 } /* namespace towr */
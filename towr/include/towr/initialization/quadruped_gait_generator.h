@@ -62,7 +62,7 @@ private:
   GaitInfo GetStridePronk() const;
   GaitInfo GetStrideLimp() const;
 
-  void SetCombo(Combos combo) override;
+  void ExpandCombo(Combos combo) override;
 
 
   // naming convention:, where the circle is is contact, front is right ->.
@@ -0,0 +1,154 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef TOWR_ITERATE_STORE_H_
+#define TOWR_ITERATE_STORE_H_
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <Eigen/Dense>
+
+namespace towr {
+
+/**
+ * @brief Bounded, delta-compressed history of solver iterates.
+ *
+ * Understanding how the solver reached a solution means replaying its
+ * iterates (@sa TOWR::SetSolution()), but keeping every variable vector
+ * verbatim grows linearly with iteration count -- on long solves that is
+ * the dominant memory consumer, and dumping each iterate to disk
+ * multiplies the problem. Successive iterates differ only in the low
+ * mantissa bits of most variables though, so their XOR is mostly zero
+ * bytes and compresses well.
+ *
+ * The store keeps a raw keyframe every @c keyframe_interval iterates and
+ * encodes the others as per-value XOR deltas against the reconstruction
+ * of their predecessor, dropping the leading zero bytes of each delta.
+ * Retention is bounded: once more than @c max_iterates are held, the
+ * oldest keyframe group is dropped whole, so the store degrades to a
+ * sliding window over the most recent iterations instead of growing.
+ *
+ * Attach one via TOWR::SetIterateStore(); SolveNLP() then fills it from
+ * the solver's history and SetSolution() restores from it, including
+ * iterations whose verbatim copy the solver no longer holds (e.g. after
+ * Save()/Load() in a different process).
+ */
+class IterateStore {
+public:
+  using Ptr = std::shared_ptr<IterateStore>;
+
+  /**
+   * @param keyframe_interval  Every how many iterates a raw copy is kept;
+   *                           the others cost only their changed bytes.
+   * @param max_iterates       Iterate count above which the oldest
+   *                           keyframe group is evicted.
+   */
+  explicit IterateStore (int keyframe_interval = 16, int max_iterates = 512);
+  virtual ~IterateStore () = default;
+
+  /**
+   * @brief Appends the next iterate; evicts the oldest group when full.
+   * @param x  The full optimization-variable vector of this iterate.
+   *
+   * Iterates must be pushed in order; the vector dimension must not
+   * change between Clear() calls.
+   */
+  void Push(const Eigen::VectorXd& x);
+
+  /// Drops all iterates; the next Push() is iteration 0 again.
+  void Clear();
+
+  /// @returns true if this iteration is still retained.
+  bool Contains(int iteration) const;
+
+  /**
+   * @brief Reconstructs the variable vector of a retained iteration.
+   * @param iteration  Absolute iteration number, as the solver counted.
+   *
+   * Decodes at most keyframe_interval-1 deltas from the preceding
+   * keyframe; asserts that the iteration is retained (@sa Contains()).
+   */
+  Eigen::VectorXd Get(int iteration) const;
+
+  /// @returns the oldest retained iteration, 0 until eviction kicks in.
+  int GetFirstIteration() const;
+
+  /// @returns how many iterates are currently retained.
+  int GetCount() const;
+
+  /// @returns the compressed bytes currently held, keyframes included.
+  std::size_t GetMemoryBytes() const;
+
+  /**
+   * @brief Writes the retained history to a compact binary file.
+   * @param path  Written atomically in one pass; throws on I/O failure.
+   *
+   * The blobs go to disk as stored, so the file is as small as the
+   * in-memory footprint -- suitable for shipping iteration forensics off
+   * a robot instead of one bag per iteration.
+   */
+  void Save(const std::string& path) const;
+
+  /**
+   * @brief Replaces the content with a history written by Save().
+   * @param path  File to read; throws if missing or malformed.
+   */
+  void Load(const std::string& path);
+
+private:
+  /// one iterate: a raw keyframe or an XOR delta against its predecessor.
+  struct Blob {
+    bool keyframe;
+    std::vector<unsigned char> bytes;
+  };
+
+  /// a keyframe and the deltas hanging off it; evicted as one unit.
+  struct Group {
+    int first_iteration;
+    std::vector<Blob> blobs;
+  };
+
+  int keyframe_interval_;
+  int max_iterates_;
+  int n_values_ = 0;    ///< dimension of the stored vectors.
+  int n_pushed_ = 0;    ///< iterates pushed since Clear(), evicted included.
+  std::vector<Group> groups_;
+
+  Eigen::VectorXd last_; ///< the last pushed iterate, the delta baseline.
+
+  Blob Encode(const Eigen::VectorXd& x, const Eigen::VectorXd& base) const;
+  void Decode(const Blob& blob, Eigen::VectorXd& x) const;
+};
+
+} /* namespace towr */
+
+#endif /* TOWR_ITERATE_STORE_H_ */
@@ -0,0 +1,150 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef TOWR_MEMORY_TALLY_H_
+#define TOWR_MEMORY_TALLY_H_
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace towr {
+
+/**
+ * @brief Per-subsystem accounting of heap memory, live and peak.
+ *
+ * Long-horizon problems reach hundreds of megabytes, and sizing a host
+ * for several planner instances needs to know which subsystem -- node
+ * variables, spline caches, constraint workspaces, Jacobian storage --
+ * carries how much of that. The tally keeps one live/peak byte pair per
+ * subsystem name; it is fed either by the TallyAllocator below or by
+ * capacity snapshots of the Eigen-backed containers, which cannot take a
+ * custom allocator (@sa TOWR::GetProblemStats(), TOWR::SetMemoryTally()).
+ *
+ * Thread-safe, since background solves may account concurrently.
+ */
+class MemoryTally {
+public:
+  using Ptr = std::shared_ptr<MemoryTally>;
+
+  /// The bytes one subsystem holds now and the most it ever held.
+  struct Usage {
+    std::size_t live = 0;
+    std::size_t peak = 0;
+  };
+
+  /**
+   * @brief Records an allocation of the given subsystem.
+   */
+  void Add(const std::string& subsystem, std::size_t bytes);
+
+  /**
+   * @brief Records a deallocation of the given subsystem.
+   */
+  void Release(const std::string& subsystem, std::size_t bytes);
+
+  /**
+   * @brief Replaces a subsystem's live bytes with a measured snapshot.
+   *
+   * Used by containers accounted by capacity rather than per allocation;
+   * the peak still accumulates across snapshots.
+   */
+  void Set(const std::string& subsystem, std::size_t live_bytes);
+
+  /**
+   * @returns The usage of every subsystem recorded so far.
+   */
+  std::map<std::string, Usage> GetUsage() const;
+
+  /**
+   * @returns The live bytes summed over all subsystems.
+   */
+  std::size_t GetTotalLiveBytes() const;
+
+private:
+  std::map<std::string, Usage> usage_;
+  mutable std::mutex mutex_;
+};
+
+/**
+ * @brief Minimal std allocator charging every byte to a MemoryTally.
+ *
+ * Drop-in for std containers whose footprint should show up in the
+ * per-subsystem report; without a tally attached it is plain operator
+ * new/delete. Same shape as ArenaAllocator (@sa object_arena.h).
+ */
+template <typename T>
+class TallyAllocator {
+public:
+  using value_type = T;
+
+  TallyAllocator () = default;
+
+  TallyAllocator (const MemoryTally::Ptr& tally, const std::string& subsystem)
+      : tally_(tally), subsystem_(subsystem) {}
+
+  template <typename U>
+  TallyAllocator (const TallyAllocator<U>& other)
+      : tally_(other.tally_), subsystem_(other.subsystem_) {}
+
+  T* allocate (std::size_t n)
+  {
+    if (tally_)
+      tally_->Add(subsystem_, n*sizeof(T));
+    return static_cast<T*>(::operator new(n*sizeof(T)));
+  }
+
+  void deallocate (T* p, std::size_t n)
+  {
+    if (tally_)
+      tally_->Release(subsystem_, n*sizeof(T));
+    ::operator delete(p);
+  }
+
+  MemoryTally::Ptr tally_;
+  std::string subsystem_;
+};
+
+template <typename T, typename U>
+bool operator== (const TallyAllocator<T>& a, const TallyAllocator<U>& b)
+{
+  return a.tally_ == b.tally_ && a.subsystem_ == b.subsystem_;
+}
+
+template <typename T, typename U>
+bool operator!= (const TallyAllocator<T>& a, const TallyAllocator<U>& b)
+{
+  return !(a == b);
+}
+
+} /* namespace towr */
+
+#endif /* TOWR_MEMORY_TALLY_H_ */
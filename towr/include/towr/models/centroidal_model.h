@@ -77,23 +77,91 @@ public:
 
   virtual ~CentroidalModel () = default;
 
+  /**
+   * @brief Sets the current state and precomputes shared intermediates.
+   *
+   * The inertia expressed in world frame, the sum of the forces and their
+   * torque around the CoM are used by GetDynamicViolation() and several of
+   * the Jacobians for the same instant, so they are computed once here.
+   */
+  void SetCurrent(const ComPos& com_W, const Vector3d com_acc_W,
+                  const Matrix3d& w_R_b, const AngVel& omega_W,
+                  const Vector3d& omega_dot_W,
+                  const EELoad& force_W, const EEPos& pos_W) override;
+
   // for documentation, see definition in base class DynamicModel
   BaseAcc GetDynamicViolation() const override;
 
-  Jac GetJacobianWrtBaseLin(const Jac& jac_base_lin_pos,
-                            const Jac& jac_acc_base_lin) const override;
-  Jac GetJacobianWrtBaseAng(const EulerConverter& base_angular,
-                            double t) const override;
-  Jac GetJacobianWrtForce(const Jac& jac_force, EE) const override;
-  Jac GetJacobianWrtEEPos(const Jac& jac_ee_pos, EE) const override;
+  DynamicModel::Ptr Clone() const override;
 
-private:
+  BaseAcc ComputeViolation(const ComPos& com_W, const Vector3d com_acc_W,
+                           const Matrix3d& w_R_b, const AngVel& omega_W,
+                           const Vector3d& omega_dot_W,
+                           const EELoad& force_W, const EEPos& pos_W) const override;
+
+  /**
+   * @brief All violations in one pass over coordinate rows.
+   *
+   * The force sum, the torque cross products and the linear rows are
+   * elementwise across instants and work on whole rows of the
+   * structure-of-arrays input, so they compile to SIMD loops over
+   * contiguous memory; only rotating the inertia per instant stays a
+   * small fixed-size loop. The scratch rows persist in the model, so
+   * like the Jacobian workspace this path assumes serial evaluation.
+   */
+  void ComputeViolationsBatch(const StateArrays& states,
+                              Matrix6Xd& out) const override;
+
+  const Jac& GetJacobianWrtBaseLin(const Jac& jac_base_lin_pos,
+                                   const Jac& jac_acc_base_lin,
+                                   JacWorkspace& ws) const override;
+  const Jac& GetJacobianWrtBaseAng(const AngularStateConverter& base_angular,
+                                   double t, JacWorkspace& ws) const override;
+  const Jac& GetJacobianWrtForce(const Jac& jac_force, EE,
+                                 JacWorkspace& ws) const override;
+  const Jac& GetJacobianWrtEEPos(const Jac& jac_ee_pos, EE,
+                                 JacWorkspace& ws) const override;
+
+  bool HasWindowJacobians() const override { return true; };
+
+  /**
+   * @brief The window Jacobians are dense 3x3-block products.
+   *
+   * Every sensitivity of this model is a constant or a cross-product
+   * matrix applied to the incoming spline Jacobian, so on a narrow dense
+   * window the chain rule collapses to fixed-size matrix products with
+   * no sparse bookkeeping at all.
+   */
+  void GetJacobianWrtBaseLinWindow(const Eigen::MatrixXd& jac_pos,
+                                   const Eigen::MatrixXd& jac_acc,
+                                   Eigen::MatrixXd& out) const override;
+  void GetJacobianWrtForceWindow(const Eigen::MatrixXd& jac_force, EE ee,
+                                 Eigen::MatrixXd& out) const override;
+  void GetJacobianWrtEEPosWindow(const Eigen::MatrixXd& jac_ee_pos, EE ee,
+                                 Eigen::MatrixXd& out) const override;
+
+protected:
   /** Inertia of entire robot around the CoM expressed in a frame anchored
    *  in the base.
    */
   Eigen::SparseMatrix<double, Eigen::RowMajor> I_b;
+  Matrix3d I_b_d_; ///< dense copy of I_b for the fixed-size violation math.
+
+  // intermediates shared between the violation and the Jacobians of one
+  // instant, updated by SetCurrent().
+  Jac I_w_;          ///< world-frame inertia for the sparse Jacobian products.
+  Matrix3d I_w_d_;   ///< world-frame inertia for the fixed-size violation math.
+  Vector3d f_sum_;   ///< sum of the endeffector forces.
+  Vector3d tau_sum_; ///< torque of the forces around the CoM.
+
+  // scratch rows of ComputeViolationsBatch(), kept so their heap buffers
+  // survive between the evaluations of one solve.
+  mutable Matrix3Xd batch_f_sum_, batch_tau_sum_, batch_r_;
+  mutable Matrix3Xd batch_Iw_, batch_Iwd_;
 };
 
+/// builds a cross product matrix out of "in", so in x v = X(in)*v
+CentroidalModel::Jac Cross(const Eigen::Vector3d& in);
 
 } /* namespace towr */
 
@@ -0,0 +1,142 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef TOWR_MODELS_CENTROIDAL_MODEL_T_H_
+#define TOWR_MODELS_CENTROIDAL_MODEL_T_H_
+
+#include <array>
+#include <cassert>
+
+#include <towr/variables/cartesian_dimensions.h>
+
+#include "centroidal_model.h"
+
+namespace towr {
+
+/**
+ * @brief Centroidal Dynamics model for a compile-time fixed endeffector count.
+ *
+ * For a specific robot the number of endeffectors is known when the model is
+ * written down (e.g. 4 for the quadrupeds in examples/). Fixing this count as
+ * a template parameter lets the compiler unroll the per-endeffector loops of
+ * the dynamics and keeps the endeffector state in std::array instead of
+ * heap-allocated vectors. The model is selected through the RobotModel
+ * examples (e.g. anymal_model.h), so users of DynamicModel::Ptr are
+ * unaffected.
+ *
+ * @tparam NumEE  The number of endeffectors/forces of this robot.
+ *
+ * @ingroup Robots
+ */
+template<std::size_t NumEE>
+class CentroidalModelT : public CentroidalModel {
+public:
+  /**
+   * @brief Constructs a Centroidal model with NumEE endeffectors.
+   * @param mass       The mass of the robot.
+   * @param inertia_b  The elements of the 3x3 Inertia matrix around the CoM.
+   */
+  CentroidalModelT (double mass, const Eigen::Matrix3d& inertia_b)
+      : CentroidalModel(mass, inertia_b, NumEE)
+  {
+  }
+
+  /**
+   * @brief Constructs a Centroidal model with NumEE endeffectors.
+   * @param mass  Mass of the robot.
+   * @param I..   Elements of the 3x3 Inertia matrix (@see CentroidalModel())
+   */
+  CentroidalModelT (double mass,
+                    double Ixx, double Iyy, double Izz,
+                    double Ixy, double Ixz, double Iyz)
+      : CentroidalModel(mass, Ixx, Iyy, Izz, Ixy, Ixz, Iyz, NumEE)
+  {
+  }
+
+  virtual ~CentroidalModelT () = default;
+
+  void SetCurrent(const ComPos& com_W, const Vector3d com_acc_W,
+                  const Matrix3d& w_R_b, const AngVel& omega_W,
+                  const Vector3d& omega_dot_W,
+                  const EELoad& force_W, const EEPos& pos_W) override
+  {
+    assert(force_W.size() == NumEE && pos_W.size() == NumEE);
+    CentroidalModel::SetCurrent(com_W, com_acc_W, w_R_b, omega_W, omega_dot_W,
+                                force_W, pos_W);
+
+    // mirror the endeffector state into the fixed-size arrays read by the
+    // per-endeffector Jacobians below; trip count known at compile time,
+    // so this unrolls across the legs.
+    for (std::size_t ee=0; ee<NumEE; ++ee) {
+      ee_force_fixed_[ee] = force_W[ee];
+      ee_pos_fixed_[ee]   = pos_W[ee];
+    }
+  }
+
+  DynamicModel::Ptr Clone () const override
+  {
+    // clone as CentroidalModelT, so the copy keeps the unrolled overrides
+    return std::make_shared<CentroidalModelT<NumEE>>(*this);
+  }
+
+  const Jac& GetJacobianWrtForce (const Jac& jac_force, EE ee,
+                                  JacWorkspace& ws) const override
+  {
+    Vector3d r = com_pos_ - ee_pos_fixed_[ee];
+    ws.jac_tau = -Cross(r)*jac_force;
+
+    int n = jac_force.cols();
+    ws.jac_model.resize(k6D, n);
+    ws.jac_model.middleRows(AX, k3D) = -ws.jac_tau;
+    ws.jac_model.middleRows(LX, k3D) = -jac_force;
+
+    return ws.jac_model;
+  }
+
+  const Jac& GetJacobianWrtEEPos (const Jac& jac_ee_pos, EE ee,
+                                  JacWorkspace& ws) const override
+  {
+    const Vector3d& f = ee_force_fixed_[ee];
+    ws.jac_tau = Cross(f)*(-jac_ee_pos);
+
+    ws.jac_model.resize(k6D, ws.jac_tau.cols());
+    ws.jac_model.middleRows(AX, k3D) = -ws.jac_tau;
+
+    // linear dynamics don't depend on endeffector position.
+    return ws.jac_model;
+  }
+
+private:
+  std::array<Vector3d, NumEE> ee_force_fixed_; ///< endeffector forces in world frame.
+  std::array<Vector3d, NumEE> ee_pos_fixed_;   ///< endeffector positions in world frame.
+};
+
+} /* namespace towr */
+
+#endif /* TOWR_MODELS_CENTROIDAL_MODEL_T_H_ */
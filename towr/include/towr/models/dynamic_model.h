@@ -36,7 +36,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <Eigen/Dense>
 #include <Eigen/Sparse>
 
-#include <towr/variables/euler_converter.h>
+#include <towr/variables/angular_state_converter.h>
 
 namespace towr {
 
@@ -59,16 +59,52 @@ namespace towr {
  */
 class DynamicModel {
 public:
-  using Ptr      = std::shared_ptr<DynamicModel>;
-  using Vector3d = Eigen::Vector3d;
-  using Matrix3d = Eigen::Matrix3d;
-  using ComPos   = Eigen::Vector3d;
-  using AngVel   = Eigen::Vector3d;
-  using BaseAcc  = Eigen::Matrix<double,6,1>;
-  using Jac      = Eigen::SparseMatrix<double, Eigen::RowMajor>;
-  using EEPos    = std::vector<Eigen::Vector3d>;
-  using EELoad   = EEPos;
-  using EE       = uint;
+  using Ptr       = std::shared_ptr<DynamicModel>;
+  using Vector3d  = Eigen::Vector3d;
+  using Matrix3d  = Eigen::Matrix3d;
+  using Matrix3Xd = Eigen::Matrix3Xd;
+  using Matrix6Xd = Eigen::Matrix<double, 6, Eigen::Dynamic>;
+  using ComPos    = Eigen::Vector3d;
+  using AngVel    = Eigen::Vector3d;
+  using BaseAcc   = Eigen::Matrix<double,6,1>;
+  using Jac       = Eigen::SparseMatrix<double, Eigen::RowMajor>;
+  using EEPos     = std::vector<Eigen::Vector3d>;
+  using EELoad    = EEPos;
+  using EE        = uint;
+
+  /**
+   * @brief The states of all discretization instants, one per column.
+   *
+   * Structure-of-arrays layout: each row of e.g. com_pos holds one
+   * cartesian coordinate across all instants contiguously, so a violation
+   * kernel working on whole rows vectorizes across the instants
+   * (@sa ComputeViolationsBatch()).
+   */
+  struct StateArrays {
+    Matrix3Xd com_pos;   ///< CoM position per instant.
+    Matrix3Xd com_acc;   ///< CoM acceleration per instant.
+    Matrix3Xd omega;     ///< angular velocity in world frame per instant.
+    Matrix3Xd omega_dot; ///< angular acceleration in world frame per instant.
+    std::vector<Matrix3d>  w_R_b;    ///< base-to-world rotation per instant.
+    std::vector<Matrix3Xd> ee_force; ///< per endeffector: force per instant.
+    std::vector<Matrix3Xd> ee_pos;   ///< per endeffector: position per instant.
+
+    void Resize(int n_instants, int ee_count);
+    int GetCount() const { return com_pos.cols(); };
+  };
+
+  /**
+   * @brief Preallocated matrices reused across GetJacobianWrt* calls.
+   *
+   * The dynamic constraint queries these Jacobians at every instant of its
+   * discretization grid. The caller owns one workspace and passes it into
+   * every call, so the result and scratch matrices keep their heap buffers
+   * between the instants instead of being constructed anew each time.
+   */
+  struct JacWorkspace {
+    Jac jac_model; ///< the 6xn result of a GetJacobianWrt* call.
+    Jac jac_tau;   ///< 3xn scratch holding torque sensitivities.
+  };
 
   /**
    * @brief Sets the current state and input of the system.
@@ -79,8 +115,11 @@ public:
    * @param omega_dot_W  Current angular acceleration in world frame.
    * @param force_W      Force at each foot expressed in world frame.
    * @param pos_W        Position of each foot expressed in world frame
+   *
+   * Virtual so derived models can mirror the state into their own storage,
+   * e.g. the fixed-size arrays of CentroidalModelT.
    */
-  void SetCurrent(const ComPos& com_W, const Vector3d com_acc_W,
+  virtual void SetCurrent(const ComPos& com_W, const Vector3d com_acc_W,
                   const Matrix3d& w_R_b, const AngVel& omega_W, const Vector3d& omega_dot_W,
                   const EELoad& force_W, const EEPos& pos_W);
 
@@ -90,47 +129,137 @@ public:
    */
   virtual BaseAcc GetDynamicViolation() const = 0;
 
+  /**
+   * @brief A deep copy of this model with its own mutable state.
+   *
+   * SetCurrent() writes into the model, so one instance cannot be used by
+   * concurrently evaluating threads. Cloning hands each thread its own
+   * copy; the physical parameters (mass, inertia, gravity) are identical.
+   */
+  virtual Ptr Clone() const = 0;
+
+  /**
+   * @brief The dynamic violation for the given state, without SetCurrent().
+   *
+   * Stateless variant of SetCurrent() followed by GetDynamicViolation():
+   * nothing is written to the model, so concurrent callers can share one
+   * instance. Parameters as in SetCurrent().
+   */
+  virtual BaseAcc ComputeViolation(const ComPos& com_W, const Vector3d com_acc_W,
+                  const Matrix3d& w_R_b, const AngVel& omega_W, const Vector3d& omega_dot_W,
+                  const EELoad& force_W, const EEPos& pos_W) const = 0;
+
+  /**
+   * @brief The dynamic violations of many instants in one call.
+   * @param states  The gathered states, one instant per column.
+   * @param[out] out  Resized to 6 x n, one violation column per instant.
+   *
+   * The default forwards column by column to ComputeViolation(). Models
+   * whose violation is an elementwise expression override this with a
+   * kernel working on whole coordinate rows, which the compiler
+   * vectorizes across the instants (@sa CentroidalModel).
+   */
+  virtual void ComputeViolationsBatch(const StateArrays& states,
+                                      Matrix6Xd& out) const;
+
   /**
    * @brief How the base position affects the dynamic violation.
    * @param jac_base_lin_pos  The 3xn Jacobian of the base linear position.
    * @param jac_base_lin_acc  The 3xn Jacobian of the base linear acceleration.
+   * @param ws  The workspace whose matrices hold the result.
    *
    * @return The 6xn Jacobian of dynamic violations with respect to
-   *         variables defining the base linear spline (e.g. node values).
+   *         variables defining the base linear spline (e.g. node values),
+   *         referencing ws.jac_model.
    */
-  virtual Jac GetJacobianWrtBaseLin(const Jac& jac_base_lin_pos,
-                                    const Jac& jac_base_lin_acc) const = 0;
+  virtual const Jac& GetJacobianWrtBaseLin(const Jac& jac_base_lin_pos,
+                                           const Jac& jac_base_lin_acc,
+                                           JacWorkspace& ws) const = 0;
 
   /**
    * @brief How the base orientation affects the dynamic violation.
-   * @param base_angular  provides Euler angles Jacobians.
-   * @param t  Time at which euler angles values are queried.
+   * @param base_angular  provides the orientation node Jacobians, under
+   *                      either parameterization (@sa AngularStateConverter).
+   * @param t  Time at which the orientation spline is queried.
+   * @param ws  The workspace whose matrices hold the result.
    *
    * @return The 6xn Jacobian of dynamic violations with respect to
-   *         variables defining the base angular spline (e.g. node values).
+   *         variables defining the base angular spline (e.g. node values),
+   *         referencing ws.jac_model.
    */
-  virtual Jac GetJacobianWrtBaseAng(const EulerConverter& base_angular,
-                                    double t) const = 0;
+  virtual const Jac& GetJacobianWrtBaseAng(const AngularStateConverter& base_angular,
+                                           double t, JacWorkspace& ws) const = 0;
 
   /**
    * @brief How the endeffector forces affect the dynamic violation.
    * @param ee_force  The 3xn Jacobian of the foot force x,y,z.
    * @param ee        The endeffector for which the senstivity is required.
+   * @param ws        The workspace whose matrices hold the result.
    *
    * @return The 6xn Jacobian of dynamic violations with respect to
-   *         variables defining the endeffector forces (e.g. node values).
+   *         variables defining the endeffector forces (e.g. node values),
+   *         referencing ws.jac_model.
    */
-  virtual Jac GetJacobianWrtForce(const Jac& ee_force, EE ee) const = 0;
+  virtual const Jac& GetJacobianWrtForce(const Jac& ee_force, EE ee,
+                                         JacWorkspace& ws) const = 0;
 
   /**
    * @brief How the endeffector positions affect the dynamic violation.
    * @param ee_force  The 3xn Jacobian of the foot position x,y,z.
    * @param ee        The endeffector for which the senstivity is required.
+   * @param ws        The workspace whose matrices hold the result.
    *
    * @return The 6xn Jacobian of dynamic violations with respect to
-   *         variables defining the foot positions (e.g. node values).
+   *         variables defining the foot positions (e.g. node values),
+   *         referencing ws.jac_model.
+   */
+  virtual const Jac& GetJacobianWrtEEPos(const Jac& ee_pos, EE ee,
+                                         JacWorkspace& ws) const = 0;
+
+  /**
+   * @returns True if the dense column-window Jacobian variants below are
+   *          implemented by this model.
+   *
+   * At any instant the spline Jacobians are nonzero only on the few
+   * columns of the two bounding nodes, so the chain-rule products can run
+   * on a dense block of that width instead of full-width sparse matrices.
+   * Callers (@sa DynamicConstraint) check this flag and fall back to the
+   * sparse GetJacobianWrt* calls when a model does not provide them.
+   */
+  virtual bool HasWindowJacobians() const { return false; };
+
+  /**
+   * @brief Dense column-window variant of GetJacobianWrtBaseLin().
+   * @param jac_pos  Dense 3xw block of the base position Jacobian.
+   * @param jac_acc  Dense 3xw block of the base acceleration Jacobian.
+   * @param[out] out  Resized to 6xw, the violation sensitivity on the
+   *                  same columns.
+   */
+  virtual void GetJacobianWrtBaseLinWindow(const Eigen::MatrixXd& jac_pos,
+                                           const Eigen::MatrixXd& jac_acc,
+                                           Eigen::MatrixXd& out) const { assert(false); };
+
+  /**
+   * @brief Dense column-window variant of GetJacobianWrtForce().
+   * @param jac_force  Dense 3xw block of the foot force Jacobian.
+   * @param ee         The endeffector for which the sensitivity is required.
+   * @param[out] out   Resized to 6xw, the violation sensitivity on the
+   *                   same columns.
+   */
+  virtual void GetJacobianWrtForceWindow(const Eigen::MatrixXd& jac_force,
+                                         EE ee,
+                                         Eigen::MatrixXd& out) const { assert(false); };
+
+  /**
+   * @brief Dense column-window variant of GetJacobianWrtEEPos().
+   * @param jac_ee_pos  Dense 3xw block of the foot position Jacobian.
+   * @param ee          The endeffector for which the sensitivity is required.
+   * @param[out] out    Resized to 3xw, the angular-row sensitivity only;
+   *                    the linear dynamics do not depend on foot position.
    */
-  virtual Jac GetJacobianWrtEEPos(const Jac& ee_pos, EE ee) const = 0;
+  virtual void GetJacobianWrtEEPosWindow(const Eigen::MatrixXd& jac_ee_pos,
+                                         EE ee,
+                                         Eigen::MatrixXd& out) const { assert(false); };
 
   /**
    * @returns The gravity acceleration [m/s^2] (positive)
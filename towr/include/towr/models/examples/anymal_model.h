@@ -30,8 +30,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef TOWR_TOWR_ROS_INCLUDE_TOWR_ROS_ANYMAL_MODEL_H_
 #define TOWR_TOWR_ROS_INCLUDE_TOWR_ROS_ANYMAL_MODEL_H_
 
-#include <towr/models/kinematic_model.h>
-#include <towr/models/centroidal_model.h>
+#include <towr/models/kinematic_model_t.h>
+#include <towr/models/centroidal_model_t.h>
 #include <towr/models/endeffector_mappings.h>
 
 namespace towr {
@@ -44,32 +44,26 @@ namespace towr {
 /**
  * @brief The Kinematics of the quadruped robot ANYmal.
  */
-class AnymalKinematicModel : public KinematicModel {
+class AnymalKinematicModel : public KinematicModelT<4> {
 public:
-  AnymalKinematicModel () : KinematicModel(4)
-  {
-    const double x_nominal_b = 0.34;
-    const double y_nominal_b = 0.19;
-    const double z_nominal_b = -0.42;
-
-    nominal_stance_.at(LF) <<  x_nominal_b,   y_nominal_b, z_nominal_b;
-    nominal_stance_.at(RF) <<  x_nominal_b,  -y_nominal_b, z_nominal_b;
-    nominal_stance_.at(LH) << -x_nominal_b,   y_nominal_b, z_nominal_b;
-    nominal_stance_.at(RH) << -x_nominal_b,  -y_nominal_b, z_nominal_b;
-
-    max_dev_from_nominal_ << 0.15, 0.1, 0.10;
-  }
+  AnymalKinematicModel () : KinematicModelT(
+      // nominal stance (x,y,z) in base frame, order LF, RF, LH, RH
+      {{ {{ 0.34,  0.19, -0.42}},
+         {{ 0.34, -0.19, -0.42}},
+         {{-0.34,  0.19, -0.42}},
+         {{-0.34, -0.19, -0.42}} }},
+      {{ 0.15, 0.1, 0.10}}) // max deviation from nominal
+  {}
 };
 
 /**
  * @brief The Dynamics of the quadruped robot ANYmal.
  */
-class AnymalDynamicModel : public CentroidalModel {
+class AnymalDynamicModel : public CentroidalModelT<4> {
 public:
   AnymalDynamicModel()
-  : CentroidalModel(29.5,
-                    0.946438, 1.94478, 2.01835, 0.000938112, -0.00595386, -0.00146328,
-                    4) {}
+  : CentroidalModelT(29.5,
+                     0.946438, 1.94478, 2.01835, 0.000938112, -0.00595386, -0.00146328) {}
 };
 /** @}*/
 
@@ -30,8 +30,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef TOWR_TOWR_ROS_INCLUDE_TOWR_ROS_BIPED_MODEL_H_
 #define TOWR_TOWR_ROS_INCLUDE_TOWR_ROS_BIPED_MODEL_H_
 
-#include <towr/models/kinematic_model.h>
-#include <towr/models/centroidal_model.h>
+#include <towr/models/kinematic_model_t.h>
+#include <towr/models/centroidal_model_t.h>
 #include <towr/models/endeffector_mappings.h>
 
 namespace towr {
@@ -44,29 +44,24 @@ namespace towr {
 /**
  * @brief The Kinematics of a tow-legged robot built from HyQ legs.
  */
-class BipedKinematicModel : public KinematicModel {
+class BipedKinematicModel : public KinematicModelT<2> {
 public:
-  BipedKinematicModel () : KinematicModel(2)
-  {
-    const double z_nominal_b = -0.65;
-    const double y_nominal_b =  0.20;
-
-    nominal_stance_.at(L) << 0.0,  y_nominal_b, z_nominal_b;
-    nominal_stance_.at(R) << 0.0, -y_nominal_b, z_nominal_b;
-
-    max_dev_from_nominal_  << 0.25, 0.15, 0.15;
-  }
+  BipedKinematicModel () : KinematicModelT(
+      // nominal stance (x,y,z) in base frame, order L, R
+      {{ {{ 0.0,  0.20, -0.65}},
+         {{ 0.0, -0.20, -0.65}} }},
+      {{ 0.25, 0.15, 0.15}}) // max deviation from nominal
+  {}
 };
 
 /**
  * @brief The Dynamics of a tow-legged robot built from HyQ legs.
  */
-class BipedDynamicModel : public CentroidalModel {
+class BipedDynamicModel : public CentroidalModelT<2> {
 public:
   BipedDynamicModel()
-  : CentroidalModel(20,
-                    1.209,5.583,6.056,0.005,-0.190,-0.012,
-                    2) {}
+  : CentroidalModelT(20,
+                     1.209,5.583,6.056,0.005,-0.190,-0.012) {}
 };
 /** @}*/
 
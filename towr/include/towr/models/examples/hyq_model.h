@@ -30,8 +30,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef TOWR_TOWR_ROS_INCLUDE_TOWR_ROS_HYQ_MODEL_H_
 #define TOWR_TOWR_ROS_INCLUDE_TOWR_ROS_HYQ_MODEL_H_
 
-#include <towr/models/kinematic_model.h>
-#include <towr/models/centroidal_model.h>
+#include <towr/models/kinematic_model_t.h>
+#include <towr/models/centroidal_model_t.h>
 #include <towr/models/endeffector_mappings.h>
 
 namespace towr {
@@ -44,31 +44,25 @@ namespace towr {
 /**
  * @brief The Kinematics of the quadruped robot HyQ.
  */
-class HyqKinematicModel : public KinematicModel {
+class HyqKinematicModel : public KinematicModelT<4> {
 public:
-  HyqKinematicModel () : KinematicModel(4)
-  {
-    const double x_nominal_b = 0.31;
-    const double y_nominal_b = 0.29;
-    const double z_nominal_b = -0.58;
-
-    nominal_stance_.at(LF) <<  x_nominal_b,   y_nominal_b, z_nominal_b;
-    nominal_stance_.at(RF) <<  x_nominal_b,  -y_nominal_b, z_nominal_b;
-    nominal_stance_.at(LH) << -x_nominal_b,   y_nominal_b, z_nominal_b;
-    nominal_stance_.at(RH) << -x_nominal_b,  -y_nominal_b, z_nominal_b;
-
-    max_dev_from_nominal_ << 0.25, 0.20, 0.10;
-  }
+  HyqKinematicModel () : KinematicModelT(
+      // nominal stance (x,y,z) in base frame, order LF, RF, LH, RH
+      {{ {{ 0.31,  0.29, -0.58}},
+         {{ 0.31, -0.29, -0.58}},
+         {{-0.31,  0.29, -0.58}},
+         {{-0.31, -0.29, -0.58}} }},
+      {{ 0.25, 0.20, 0.10}}) // max deviation from nominal
+  {}
 };
 
 /**
  * @brief The Dynamics of the quadruped robot HyQ.
  */
-class HyqDynamicModel : public CentroidalModel {
+class HyqDynamicModel : public CentroidalModelT<4> {
 public:
-  HyqDynamicModel() : CentroidalModel(83,
-                      4.26, 8.97, 9.88, -0.0063, 0.193, 0.0126,
-                      4) {}
+  HyqDynamicModel() : CentroidalModelT(83,
+                      4.26, 8.97, 9.88, -0.0063, 0.193, 0.0126) {}
 };
 /** @}*/
 
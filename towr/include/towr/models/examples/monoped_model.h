@@ -30,8 +30,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef TOWR_TOWR_ROS_INCLUDE_TOWR_ROS_MONOPED_MODEL_H_
 #define TOWR_TOWR_ROS_INCLUDE_TOWR_ROS_MONOPED_MODEL_H_
 
-#include <towr/models/kinematic_model.h>
-#include <towr/models/centroidal_model.h>
+#include <towr/models/kinematic_model_t.h>
+#include <towr/models/centroidal_model_t.h>
 
 namespace towr {
 
@@ -43,24 +43,22 @@ namespace towr {
 /**
  * @brief The Kinematics of a one-legged hopper with HyQ leg.
  */
-class MonopedKinematicModel : public KinematicModel {
+class MonopedKinematicModel : public KinematicModelT<1> {
 public:
-  MonopedKinematicModel () : KinematicModel(1)
-  {
-    nominal_stance_.at(0) = Eigen::Vector3d( 0.0, 0.0, -0.58);
-    max_dev_from_nominal_ << 0.25, 0.15, 0.2;
-  }
+  MonopedKinematicModel () : KinematicModelT(
+      {{ {{ 0.0, 0.0, -0.58}} }}, // nominal stance (x,y,z) in base frame
+      {{ 0.25, 0.15, 0.2}})       // max deviation from nominal
+  {}
 };
 
 /**
  * @brief The Dynamics of a one-legged hopper with HyQ leg.
  */
-class MonopedDynamicModel : public CentroidalModel {
+class MonopedDynamicModel : public CentroidalModelT<1> { // one endeffector
 public:
   MonopedDynamicModel()
-  : CentroidalModel(20,                              // mass of the robot
-                    1.2, 5.5, 6.0, 0.0, -0.2, -0.01, // base inertia
-                    1) {}                            // number of endeffectors
+  : CentroidalModelT(20,                               // mass of the robot
+                     1.2, 5.5, 6.0, 0.0, -0.2, -0.01) {} // base inertia
 };
 /** @}*/
 
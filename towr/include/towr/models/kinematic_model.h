@@ -43,6 +43,11 @@ namespace towr {
  * This class is mainly used to formulate the @ref RangeOfMotionConstraint,
  * restricting each endeffector to stay inside it's kinematic range.
  *
+ * The model is immutable after construction: the derived robot models fill
+ * the protected members in their constructor and nothing writes to them
+ * afterwards, so one instance can be shared read-only across problems and
+ * threads (@sa RobotModel::GetShared()).
+ *
  * @ingroup Robots
  */
 class KinematicModel {
@@ -66,8 +71,11 @@ public:
   /**
    * @brief  The xyz-position [m] of each foot in default stance.
    * @returns The vector from base to each foot expressed in the base frame.
+   *
+   * Returned by const reference so the per-endeffector loops in the
+   * factory don't copy the whole stance vector per access.
    */
-  virtual EEPos GetNominalStanceInBase() const
+  virtual const EEPos& GetNominalStanceInBase() const
   {
     return nominal_stance_;
   }
@@ -76,7 +84,7 @@ public:
    * @brief How far each foot can deviate from its nominal position.
    * @return The deviation [m] expresed in the base frame.
    */
-  virtual Vector3d GetMaximumDeviationFromNominal() const
+  virtual const Vector3d& GetMaximumDeviationFromNominal() const
   {
     return max_dev_from_nominal_;
   }
@@ -0,0 +1,102 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef TOWR_MODELS_KINEMATIC_MODEL_T_H_
+#define TOWR_MODELS_KINEMATIC_MODEL_T_H_
+
+#include <array>
+
+#include <towr/variables/cartesian_dimensions.h>
+
+#include "kinematic_model.h"
+
+namespace towr {
+
+/**
+ * @brief Kinematic model for a compile-time fixed endeffector count.
+ *
+ * The nominal stance and deviation box of a specific robot are constants
+ * known when the model is written down. This variant takes them as plain
+ * double arrays -- compile-time data the robot headers can spell out in
+ * one brace expression -- and fills the base-class members from them with
+ * a trip count the compiler knows, so construction unrolls across the
+ * legs. Code holding the concrete type reads the constants without a
+ * virtual dispatch; users of KinematicModel::Ptr are unaffected, exactly
+ * as with CentroidalModelT.
+ *
+ * Note that the per-evaluation hot path is not affected either way: the
+ * RangeOfMotionConstraint copies both constants into members once at
+ * construction and never queries the model again.
+ *
+ * @tparam NumEE  The number of endeffectors of this robot.
+ *
+ * @ingroup Robots
+ */
+template<std::size_t NumEE>
+class KinematicModelT : public KinematicModel {
+public:
+  /// xyz-position [m] of each foot in default stance, base frame.
+  using StanceData = std::array<std::array<double,k3D>, NumEE>;
+  /// allowed xyz-deviation [m] from the nominal position, base frame.
+  using BoxData    = std::array<double,k3D>;
+
+  /**
+   * @brief Constructs a kinematic model from compile-time constants.
+   * @param nominal_stance_b  Base-to-foot vector per endeffector.
+   * @param max_dev           Deviation box around the nominal position.
+   */
+  KinematicModelT (const StanceData& nominal_stance_b, const BoxData& max_dev)
+      : KinematicModel(NumEE)
+  {
+    for (std::size_t ee=0; ee<NumEE; ++ee)
+      nominal_stance_.at(ee) << nominal_stance_b[ee][X],
+                                nominal_stance_b[ee][Y],
+                                nominal_stance_b[ee][Z];
+
+    max_dev_from_nominal_ << max_dev[X], max_dev[Y], max_dev[Z];
+  }
+
+  virtual ~KinematicModelT () = default;
+
+  /// the virtual getters resolve to these; final, so calls through the
+  /// concrete robot type inline instead of dispatching.
+  const EEPos& GetNominalStanceInBase() const final
+  {
+    return nominal_stance_;
+  }
+
+  const Vector3d& GetMaximumDeviationFromNominal() const final
+  {
+    return max_dev_from_nominal_;
+  }
+};
+
+} /* namespace towr */
+
+#endif /* TOWR_MODELS_KINEMATIC_MODEL_T_H_ */
@@ -30,6 +30,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef TOWR_MODELS_ROBOT_MODEL_H_
 #define TOWR_MODELS_ROBOT_MODEL_H_
 
+#include <functional>
 #include <map>
 #include <string>
 
@@ -62,9 +63,56 @@ struct RobotModel {
   enum Robot { Monoped, Biped, Hyq, Anymal, ROBOT_COUNT };
 
 
+  using MakerFcn = std::function<RobotModel()>;
+
   RobotModel() = default;
   RobotModel(Robot robot);
 
+  /**
+   * @brief Makes the robot model registered under the given ID.
+   *
+   * The example robots occupy the IDs of Robot; custom robots registered
+   * through Registrar are constructed the same way, so user code never
+   * has to patch the factory (@sa RegisterRobot()).
+   */
+  static RobotModel MakeRobot(int robot);
+
+  /**
+   * @brief Adds a robot-model factory under the given ID.
+   * @param id     The ID MakeRobot() resolves to this model. IDs below
+   *               ROBOT_COUNT are taken by the example robots.
+   * @param maker  Builds the kinematic and dynamic model.
+   *
+   * Intended to be called from static Registrar objects before main()
+   * runs; registrations are not synchronized against concurrent
+   * MakeRobot() calls.
+   */
+  static void RegisterRobot(int id, const MakerFcn& maker);
+
+  /**
+   * @brief Registers a robot-model factory at static-initialization time.
+   *
+   * Place one static instance next to the model classes:
+   * @code
+   * static RobotModel::Registrar reg(MyRobotID, []{ return MyRobotModel(); });
+   * @endcode
+   */
+  struct Registrar {
+    Registrar(int id, const MakerFcn& maker) { RegisterRobot(id, maker); };
+  };
+
+  /**
+   * @brief One shared instance of each example robot model.
+   *
+   * Multi-start and batch usage constructs the same robot model per
+   * problem; this returns a process-wide instance built on first use
+   * instead. Sharing is safe because the kinematic model is immutable
+   * after construction and the dynamic model only serves as a prototype:
+   * DynamicConstraint clones it, so the per-evaluation state never
+   * touches the registry instance.
+   */
+  static const RobotModel& GetShared(Robot robot);
+
   KinematicModel::Ptr kinematic_model_;
   DynamicModel::Ptr   dynamic_model_;
 };
@@ -30,15 +30,23 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef TOWR_NLP_FACTORY_H_
 #define TOWR_NLP_FACTORY_H_
 
+#include <functional>
+#include <map>
+#include <string>
+
 #include <ifopt/variable_set.h>
 #include <ifopt/constraint_set.h>
 #include <ifopt/cost_term.h>
 
 #include <towr/variables/spline_holder.h>
+#include <towr/variables/spline_state_grid.h>
 
 #include <towr/models/robot_model.h>
 #include <towr/terrain/height_map.h>
+#include "evaluation_stats.h"
+#include "object_arena.h"
 #include "parameters.h"
+#include "solve_monitor.h"
 
 namespace towr {
 
@@ -112,6 +120,64 @@ public:
    */
   ContraintPtrVec GetCosts() const;
 
+  /**
+   * @brief Re-applies the initial- and final-state bounds to the existing
+   *        variable sets.
+   *
+   * Used when re-solving the previously constructed problem (receding
+   * horizon): only the boundary values change between cycles, so the
+   * variable/constraint graph can stay alive.
+   */
+  void UpdateBoundaryState();
+
+  /**
+   * @brief Rebinds the terrain in the factory and the constructed problem.
+   *
+   * The terrain and force constraints capture the HeightMap at
+   * construction, so replacing only terrain_ would leave an already
+   * constructed problem evaluating stale elevation data. This swaps the
+   * pointer in those constraint sets too (@sa TOWR::SwapTerrain()).
+   */
+  void SwapTerrain(const HeightMap::Ptr& terrain);
+
+  /**
+   * @brief Turns evaluation profiling of constraints/costs on or off.
+   *
+   * Applies to the already constructed sets and to all sets built later.
+   */
+  void SetProfilingEnabled(bool enable);
+
+  /**
+   * @brief Streams every constraint/cost evaluation into a trace buffer.
+   *
+   * Applies to the already constructed sets and to all sets built later;
+   * nullptr detaches (@sa TOWR::SetEvaluationTrace()).
+   */
+  void SetEvaluationTrace(const EvaluationTrace::Ptr& trace);
+
+  /**
+   * @returns Wall time and call counts per profiled constraint/cost,
+   *          keyed on the set name (@sa EvaluationStats).
+   */
+  std::map<std::string, EvaluationStats> GetEvaluationStats() const;
+
+  /**
+   * @returns The constraint sets of the last constructed problem
+   *          (@sa TOWR::GetProblemStats()).
+   */
+  const ContraintPtrVec& GetConstraintSets() const { return constraints_; };
+
+  /**
+   * @brief Places each constructed problem's object graph in one arena.
+   *
+   * With arena allocation on, every call to GetVariableSets() opens a
+   * fresh ObjectArena and the variable, constraint and cost sets built
+   * for that problem are packed into it, object and control block
+   * side by side. The arena is released wholesale once the last of
+   * those objects is dropped (@sa ObjectArena).
+   */
+  void SetArenaAllocation(bool enable) { use_arena_ = enable; };
+
 
   BaseState initial_base_;
   BaseState final_base_;
@@ -120,15 +186,114 @@ public:
   HeightMap::Ptr terrain_;
   Parameters params_;
 
+  // optional progress/cancellation hook (@sa TOWR::SolveAsync)
+  SolveMonitor::Ptr solve_monitor_;
+
+  // when non-empty, the dynamic constraint is enforced at exactly these
+  // times instead of the uniform dt_constraint_dynamic_ grid
+  // (@sa TOWR::SolveAdaptive)
+  std::vector<double> dynamic_constraint_times_;
+
+  // optional warm start from a previous solution (@sa TOWR::SetInitialGuess)
+  SplineHolder initial_guess_;
+  double initial_guess_t_shift_ = 0.0;
+  bool use_initial_guess_ = false;
+
+  // optional second guess segment covering the horizon from
+  // initial_guess_split_time_ onwards; the node variables are then
+  // initialized by sampling the two segments back to back
+  // (@sa TOWR::SolveSplitHorizon)
+  SplineHolder initial_guess_second_;
+  double initial_guess_split_time_ = -1.0;
+
   SplineHolder spline_holder_;
 
 private:
+  // the variable sets of the constructed problem, kept so the boundary
+  // bounds can be updated without rebuilding the problem.
+  std::vector<Nodes::Ptr> base_vars_;
+  std::vector<PhaseNodes::Ptr> ee_motion_vars_;
+  std::vector<PhaseNodes::Ptr> ee_force_vars_;
+
+  // the constraint/cost sets of the constructed problem, kept so their
+  // evaluation statistics can be queried after the solve.
+  mutable ContraintPtrVec constraints_;
+  mutable ContraintPtrVec costs_;
+  bool profile_evaluations_ = false;
+  EvaluationTrace::Ptr trace_; ///< receives per-evaluation spans, if set.
+
+  // the arena holding the current problem's objects; renewed per problem
+  // construction when arena allocation is enabled.
+  bool use_arena_ = false;
+  ObjectArena::Ptr arena_;
+
+  /// Constructs a problem object, placed in the arena when one is open.
+  template <typename T, typename... Args>
+  std::shared_ptr<T> Create(Args&&... args) const
+  {
+    if (arena_)
+      return arena_->Make<T>(std::forward<Args>(args)...);
+    return std::make_shared<T>(std::forward<Args>(args)...);
+  }
+
+  /**
+   * @brief Runs the given job once per endeffector, each on its own thread.
+   *
+   * The per-EE variable and constraint sets are built from read-only shared
+   * state, so for many-legged robots their construction can overlap. Each
+   * job must only write to its own endeffector's slot.
+   */
+  void RunForEachEE(const std::function<void(int)>& job) const;
+
   // variables
   std::vector<Nodes::Ptr> MakeBaseVariables() const;
   std::vector<PhaseNodes::Ptr> MakeEndeffectorVariables() const;
   std::vector<PhaseNodes::Ptr> MakeForceVariables() const;
+
+  /**
+   * @brief Refines one endeffector's initial nodes to feasible footholds.
+   *
+   * Places each stance node on the terrain surface at the flattest spot
+   * within the kinematic box around the interpolated base path, then
+   * re-seeds the swing nodes between the refined footholds
+   * (@sa Parameters::PresolveFootholds()). Independent per endeffector,
+   * so it runs inside the parallel per-EE construction.
+   */
+  void PresolveFootholds(const PhaseNodes::Ptr& nodes, int ee) const;
   std::vector<PhaseDurations::Ptr> MakeContactScheduleVariables() const;
 
+  /// Pushes the current profiling flag into the given constraint/cost sets.
+  void ApplyProfiling(const ContraintPtrVec& sets) const;
+
+  /**
+   * @brief Overwrites the default variable initialization with values
+   *        sampled from the previous solution in initial_guess_.
+   */
+  void ApplyInitialGuess(const std::vector<Nodes::Ptr>& base_motion,
+                         const std::vector<PhaseNodes::Ptr>& ee_motion,
+                         const std::vector<PhaseNodes::Ptr>& ee_force,
+                         const std::vector<PhaseDurations::Ptr>& schedule) const;
+
+  /**
+   * @brief Initializes one node set by sampling two guess splines in
+   *        sequence: @a first up to initial_guess_split_time_, @a second
+   *        (with its time starting at zero there) for the remainder.
+   */
+  void InitializeNodesPiecewise(const Nodes::Ptr& nodes,
+                                const Spline& first, const Spline& second,
+                                const Parameters::VecTimes& poly_durations) const;
+
+  /**
+   * @brief The shared spline-state cache for discretization interval dt.
+   *
+   * Constraints with the same dt evaluate on the same time grid, so they
+   * also share one SplineStateGrid and with it the spline states at every
+   * grid instant. The grids are renewed per problem construction, since
+   * they cache states keyed on the current problem's spline objects.
+   */
+  SplineStateGrid::Ptr GetStateGrid(double dt) const;
+  mutable std::map<double, SplineStateGrid::Ptr> state_grids_;
+
   // constraints
   ContraintPtrVec GetConstraint(Parameters::ConstraintName name) const;
   ContraintPtrVec MakeDynamicConstraint() const;
@@ -140,6 +305,13 @@ private:
   ContraintPtrVec MakeBaseRangeOfMotionConstraint() const;
   ContraintPtrVec MakeBaseAccConstraint() const;
 
+  /// Desired final base position, with height relative to the terrain.
+  Vector3d GetFinalBaseLinPos() const;
+
+  /// Initial/final base orientation in the active node parameterization.
+  Vector3d GetInitialBaseAng() const;
+  Vector3d GetFinalBaseAng() const;
+
   // costs
   CostPtrVec GetCost(const Parameters::CostName& id, double weight) const;
   CostPtrVec MakeForcesCost(double weight) const;
@@ -0,0 +1,150 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef TOWR_OBJECT_ARENA_H_
+#define TOWR_OBJECT_ARENA_H_
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace towr {
+
+/**
+ * @brief Bump allocator that packs one problem's object graph together.
+ *
+ * The variable, constraint and cost sets of one problem are built once,
+ * traversed every solver iteration and then discarded together. Placing
+ * them (including their shared_ptr control blocks) in a few large
+ * contiguous blocks keeps that traversal on neighboring cache lines and
+ * replaces one malloc/free pair per object with a pointer bump.
+ *
+ * Memory is never returned per object: deallocation is a no-op and the
+ * blocks are released wholesale when the arena is destroyed. Every
+ * shared_ptr created through Make() keeps the arena alive via its
+ * allocator, so the arena outlives the last object it holds.
+ */
+class ObjectArena : public std::enable_shared_from_this<ObjectArena> {
+public:
+  using Ptr = std::shared_ptr<ObjectArena>;
+
+  /**
+   * @param block_size  The granularity [bytes] at which the arena grows.
+   */
+  explicit ObjectArena (std::size_t block_size = 64*1024);
+  virtual ~ObjectArena () = default;
+
+  /**
+   * @brief Reserves size bytes with the given alignment in the arena.
+   *
+   * Thread-safe, since per-endeffector sets are constructed concurrently.
+   */
+  void* Allocate(std::size_t size, std::size_t align);
+
+  /**
+   * @brief Constructs a T in the arena, wrapped in a shared_ptr.
+   *
+   * Object and control block share one allocation through
+   * std::allocate_shared.
+   */
+  template <typename T, typename... Args>
+  std::shared_ptr<T> Make(Args&&... args);
+
+  /**
+   * @returns The bytes handed out so far, excluding block-internal padding.
+   */
+  std::size_t GetBytesUsed() const;
+
+private:
+  struct Block {
+    std::unique_ptr<char[]> data_;
+    std::size_t size_;
+    std::size_t used_;
+  };
+
+  std::vector<Block> blocks_;
+  std::size_t block_size_;
+  std::size_t bytes_used_ = 0;
+  mutable std::mutex mutex_;
+};
+
+/**
+ * @brief Minimal std allocator placing everything in an ObjectArena.
+ *
+ * Holds the arena by shared_ptr, so containers and control blocks using
+ * this allocator keep the arena's memory alive.
+ */
+template <typename T>
+class ArenaAllocator {
+public:
+  using value_type = T;
+
+  explicit ArenaAllocator (const ObjectArena::Ptr& arena) : arena_(arena) {}
+
+  template <typename U>
+  ArenaAllocator (const ArenaAllocator<U>& other) : arena_(other.arena_) {}
+
+  T* allocate (std::size_t n)
+  {
+    return static_cast<T*>(arena_->Allocate(n*sizeof(T), alignof(T)));
+  }
+
+  void deallocate (T*, std::size_t)
+  {
+    // freed wholesale when the arena is destroyed
+  }
+
+  ObjectArena::Ptr arena_;
+};
+
+template <typename T, typename U>
+bool operator== (const ArenaAllocator<T>& a, const ArenaAllocator<U>& b)
+{
+  return a.arena_ == b.arena_;
+}
+
+template <typename T, typename U>
+bool operator!= (const ArenaAllocator<T>& a, const ArenaAllocator<U>& b)
+{
+  return !(a == b);
+}
+
+template <typename T, typename... Args>
+std::shared_ptr<T>
+ObjectArena::Make (Args&&... args)
+{
+  return std::allocate_shared<T>(ArenaAllocator<T>(shared_from_this()),
+                                 std::forward<Args>(args)...);
+}
+
+} /* namespace towr */
+
+#endif /* TOWR_OBJECT_ARENA_H_ */
@@ -159,6 +159,7 @@ struct Parameters {
   using EEID             = unsigned int;
 
   friend class NlpFactory;
+  friend class TOWR; // reads the dynamic grid for adaptive refinement
 
   /**
    * @brief Default parameters to use.
@@ -193,6 +194,82 @@ struct Parameters {
    */
   void PenalizeEndeffectorForces();
 
+  /**
+   * @brief Parameterize the base orientation by rotation-vector nodes.
+   *
+   * By default the angular base nodes are interpreted as Euler-ZYX angles,
+   * whose mapping to angular velocities is singular at 90deg pitch and
+   * requires the trigonometric M/Mdot matrices and their node derivatives
+   * at every dynamic-constraint instant. With this set, the nodes are read
+   * as exponential-map rotation vectors instead
+   * (@sa RotationVectorConverter): the mapping is singularity-free below
+   * full turns and is built from one set of scalar coefficients.
+   *
+   * The user-facing initial/final base states remain Euler angles and are
+   * converted internally. Angular velocity bounds are applied to the
+   * rotation-vector rates, which coincide with Euler rates when zero (the
+   * default). Warm starts (@sa TOWR::SetInitialGuess) only transfer between
+   * solves using the same parameterization.
+   */
+  void UseRotationVectorBase();
+
+  /**
+   * @brief Optimizes only the force node values, not the force rates.
+   *
+   * By default every force node carries its value and its rate as
+   * optimization variables. For most gaits the force profile needs no
+   * curvature control: the dynamic constraint samples forces pointwise
+   * and the force constraint bounds them nodewise. With this set, the
+   * rate values are dropped from the force variable sets and pinned to
+   * zero, so each stance polynomial is parameterized by its two endpoint
+   * forces only. This halves the force-related variable count and the
+   * corresponding Jacobian columns, which is usually the most reliable
+   * solve-time lever available.
+   */
+  void OptimizeForceValuesOnly();
+
+  /**
+   * @brief Scales the node variables to similar magnitudes for the solver.
+   *
+   * Forces (hundreds of newtons) and positions (meters) otherwise share
+   * one unscaled variable vector, producing poorly conditioned KKT
+   * systems that cost solver iterations. With this set, the factory
+   * divides each force set by the nominal stance force m*g/n_ee at the
+   * solver boundary; motion and base nodes are already of order one and
+   * keep unit scale. Everything inside towr stays in physical units --
+   * only values, bounds and Jacobian columns seen by the solver change.
+   *
+   * Motion sets are deliberately left unscaled: the analytic Hessians of
+   * the range-of-motion and base-motion constraints are expressed w.r.t
+   * those sets and do not carry scaling factors.
+   */
+  void EnableVariableScaling();
+
+  /**
+   * @brief Accept any iterate whose constraint violation is below this.
+   * @param tolerance  The maximum acceptable violation of any constraint.
+   *
+   * Used by TOWR::SolveFeasible(): the solve is stopped as soon as an
+   * iterate satisfies all constraints to this tolerance, skipping the
+   * remaining optimality polish. Useful for reactive replanning, where a
+   * dynamically feasible plan now beats an optimal plan later.
+   */
+  void StopAtFeasible(double tolerance);
+
+  /**
+   * @brief Seeds the footholds terrain-feasibly before the full solve.
+   *
+   * By default every foothold is initialized on the straight line from
+   * initial to final stance, so on uneven terrain the coupled solve
+   * spends its early iterations just moving footholds into feasible
+   * terrain regions. With this set, a per-endeffector presolve places
+   * each stance node on the terrain surface at the flattest spot within
+   * the kinematic box around the interpolated base path, and re-seeds
+   * the swing nodes between the refined footholds. The subproblems are
+   * independent per endeffector and take well under a millisecond each.
+   */
+  void PresolveFootholds();
+
 private:
   /// Which constraints should be used in the optimization problem.
   UsedConstraints constraints_;
@@ -209,6 +286,23 @@ private:
   /// True if the phase durations should be optimized over.
   bool IsOptimizeTimings() const;
 
+  /// True if the base orientation nodes are read as rotation vectors.
+  bool use_rotation_vector_base_ = false;
+
+  /// True if the force node rates are excluded from the optimization.
+  bool optimize_force_values_only_ = false;
+
+  /// True if the force sets are scaled at the solver boundary.
+  bool scale_node_variables_ = false;
+
+  /// Max acceptable constraint violation for early termination;
+  /// negative means solve to optimality (@sa StopAtFeasible()).
+  double feasibility_tolerance_ = -1.0;
+
+  /// True if the footholds are presolved terrain-feasibly
+  /// (@sa PresolveFootholds()).
+  bool presolve_footholds_ = false;
+
   /// The number of endeffectors.
   int GetEECount() const;
 
@@ -0,0 +1,70 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef TOWR_PROBLEM_STATS_H_
+#define TOWR_PROBLEM_STATS_H_
+
+#include <cstddef>
+#include <map>
+#include <string>
+
+namespace towr {
+
+/**
+ * @brief The size of a constructed optimization problem, before solving.
+ *
+ * The variable and constraint counts grow quickly with finer discretization
+ * intervals, more polynomials per phase and more phases, and an over-sized
+ * problem only reveals itself through a slow solve. This report makes the
+ * scale visible up front, so tooling can reject a configuration before
+ * spending solver time on it.
+ *
+ * @sa TOWR::GetProblemStats()
+ */
+struct ProblemStats {
+  int n_variables = 0;       ///< total number of optimization variables.
+  int n_constraints = 0;     ///< total number of constraint rows.
+  long jacobian_nonzeros = 0;   ///< structural nonzeros of the constraint Jacobian.
+  double jacobian_density = 0.0; ///< nonzeros relative to the dense row*col count.
+  std::size_t jacobian_memory_bytes = 0; ///< estimated sparse-storage footprint.
+
+  std::map<std::string, int> variable_rows;   ///< variables per variable set.
+  std::map<std::string, int> constraint_rows; ///< rows per constraint set.
+
+  /**
+   * Live heap bytes per subsystem (node variables, splines, constraint
+   * workspaces) at measurement time. Attach a persistent tally through
+   * TOWR::SetMemoryTally() to also track peaks across a solve session.
+   */
+  std::map<std::string, std::size_t> memory_bytes;
+};
+
+} /* namespace towr */
+
+#endif /* TOWR_PROBLEM_STATS_H_ */
@@ -0,0 +1,110 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef TOWR_SOLUTION_CACHE_H_
+#define TOWR_SOLUTION_CACHE_H_
+
+#include <cstddef>
+#include <list>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <towr/variables/spline_holder.h>
+
+namespace towr {
+
+/**
+ * @brief Remembers solved trajectories of recently seen scenarios.
+ *
+ * Replanning fleets solve near-identical problems over and over (same
+ * start, same goal, same gait, same ground). The cache maps a quantized
+ * description of the scenario -- built by TOWR from initial state, goal,
+ * phase durations and terrain probes -- to the solved trajectory, so a
+ * recurring scenario either skips the solve entirely (kReuse) or starts
+ * it from the previous optimum (kWarmStart).
+ *
+ * Entries are evicted least-recently-used. The cache only stores and
+ * returns trajectories; the key construction and the decision what to do
+ * on a hit live in TOWR::SolveNLP() (@sa TOWR::SetSolutionCache()).
+ */
+class SolutionCache {
+public:
+  using Ptr = std::shared_ptr<SolutionCache>;
+  using Key = std::vector<long>; ///< the quantized scenario description.
+
+  /**
+   * @brief What a cache hit is used for.
+   */
+  enum Policy {
+    kWarmStart, ///< solve anyway, initialized from the stored trajectory.
+    kReuse      ///< return the stored trajectory without solving.
+  };
+
+  /**
+   * @param policy       What TOWR should do with a hit.
+   * @param max_entries  Entry count above which the LRU entry is evicted.
+   */
+  explicit SolutionCache (Policy policy = kWarmStart,
+                          std::size_t max_entries = 32);
+  virtual ~SolutionCache () = default;
+
+  /**
+   * @brief Retrieves the trajectory stored for this scenario, if any.
+   * @param key  The quantized scenario description.
+   * @param[out] solution  Filled with the stored trajectory on a hit.
+   * @return true on a hit; also refreshes the entry's LRU position.
+   */
+  bool Lookup(const Key& key, SplineHolder& solution);
+
+  /**
+   * @brief Stores (or refreshes) the trajectory for this scenario.
+   */
+  void Insert(const Key& key, const SplineHolder& solution);
+
+  Policy GetPolicy() const { return policy_; };
+
+  int GetHitCount() const  { return hits_; };
+  int GetMissCount() const { return misses_; };
+
+private:
+  Policy policy_;
+  std::size_t max_entries_;
+  int hits_   = 0;
+  int misses_ = 0;
+
+  using LruList = std::list<Key>;
+  LruList lru_; ///< most recently used key in front.
+  std::map<Key, std::pair<SplineHolder, LruList::iterator>> entries_;
+};
+
+} /* namespace towr */
+
+#endif /* TOWR_SOLUTION_CACHE_H_ */
@@ -0,0 +1,119 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef TOWR_SOLVE_MONITOR_H_
+#define TOWR_SOLVE_MONITOR_H_
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+
+#include "telemetry_buffer.h"
+
+namespace towr {
+
+/**
+ * @brief Thrown out of a constraint evaluation to abort a running solve.
+ *
+ * @sa SolveMonitor::RequestCancel()
+ */
+struct SolveCancelled : public std::runtime_error {
+  SolveCancelled() : std::runtime_error("NLP solve cancelled") {}
+};
+
+/**
+ * @brief Reports solve progress and allows cancelling a running solve.
+ *
+ * The ifopt solver interface exposes no per-iteration hook, so this monitor
+ * taps the evaluation of the dynamic constraint instead, which the solver
+ * queries once per iteration (plus line-search trials). The evaluation count
+ * is therefore an upper bound on the solver iterations.
+ *
+ * Cancellation is cooperative: RequestCancel() can be called from any
+ * thread, and the next constraint evaluation throws SolveCancelled, which
+ * unwinds out of the solver.
+ *
+ * @sa TOWR::SolveAsync()
+ */
+class SolveMonitor {
+public:
+  using Ptr = std::shared_ptr<SolveMonitor>;
+
+  /**
+   * @brief Invoked on every dynamic-constraint evaluation.
+   * @param n_evals    How often the constraint was evaluated so far.
+   * @param violation  The current maximum dynamic violation.
+   *
+   * Runs on the solver thread, so it must be fast and must not touch the
+   * problem being solved.
+   */
+  using ProgressCallback = std::function<void(int n_evals, double violation)>;
+
+  SolveMonitor() = default;
+  virtual ~SolveMonitor() = default;
+
+  void SetProgressCallback(const ProgressCallback& callback);
+
+  /**
+   * @brief Streams one SolveSample per evaluation into the given ring.
+   *
+   * The buffer can be drained from another thread while the solver runs
+   * (@sa TelemetryBuffer), e.g. for a live dashboard of planner health.
+   */
+  void SetTelemetryBuffer(const TelemetryBuffer::Ptr& buffer);
+
+  /**
+   * @brief Stops the running solve at the next constraint evaluation.
+   */
+  void RequestCancel();
+
+  bool IsCancelRequested() const;
+
+  /**
+   * @brief Called by the monitored constraint from the solver thread.
+   * @param violation  The current maximum constraint violation.
+   * @throws SolveCancelled if RequestCancel() was called in the meantime.
+   */
+  void ReportEvaluation(double violation);
+
+private:
+  ProgressCallback progress_callback_;
+  TelemetryBuffer::Ptr telemetry_;
+  std::atomic<bool> cancel_requested_{false};
+
+  // only touched from the solver thread.
+  int n_evals_ = 0;
+  std::chrono::steady_clock::time_point t_start_; ///< set on first evaluation.
+};
+
+} /* namespace towr */
+
+#endif /* TOWR_SOLVE_MONITOR_H_ */
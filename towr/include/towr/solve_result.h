@@ -0,0 +1,88 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef TOWR_SOLVE_RESULT_H_
+#define TOWR_SOLVE_RESULT_H_
+
+#include <Eigen/Dense>
+
+namespace towr {
+
+/**
+ * @brief Outcome and timing breakdown of one solve, machine-readable.
+ *
+ * A planner that tracks its latency budget needs these numbers per solve;
+ * parsing them out of the solver's console output is neither robust nor
+ * cheap. All quality figures are measured on the returned variables, so
+ * they hold regardless of how the solver terminated.
+ *
+ * @sa TOWR::SolveNLP()
+ */
+struct SolveResult {
+  /// all constraints satisfied to 1e-4 at the returned solution (the same
+  /// threshold TOWR::SolveMultiStart() uses to rank candidates).
+  bool feasible = false;
+
+  /// the trajectory came from the solution cache; no problem was built or
+  /// solved, and all other fields except t_total stay zero.
+  bool from_cache = false;
+
+  int iterations = 0;                 ///< iterations the solver recorded.
+  double objective = 0.0;             ///< cost value, zero without cost terms.
+  double constraint_violation = 0.0;  ///< worst violation of any constraint bound.
+
+  double t_construction = 0.0; ///< [s] building variables, constraints and costs.
+  double t_solve = 0.0;        ///< [s] inside the solver, evaluations included.
+
+  /// [s] of t_solve spent in towr's constraint/cost evaluations; zero unless
+  /// profiling was enabled (@sa TOWR::SetProfilingEnabled()).
+  double t_evaluation = 0.0;
+
+  double t_total = 0.0; ///< [s] wall time of the whole SolveNLP() call.
+};
+
+/**
+ * @brief Values and bound violations of one constraint set at an iterate.
+ *
+ * Outer loops that adjust Parameters between solves (e.g. relaxing a
+ * discretization or phase bound when infeasible) need to know which
+ * constraint failed and by how much; re-sampling the returned splines to
+ * find out duplicates a full constraint pass.
+ *
+ * @sa TOWR::GetConstraintReports()
+ */
+struct ConstraintReport {
+  Eigen::VectorXd values;      ///< the constraint value vector g(x) of the set.
+  double max_violation = 0.0;  ///< worst violation of this set's bounds.
+  double violation_norm = 0.0; ///< Euclidean norm of all bound violations.
+};
+
+} /* namespace towr */
+
+#endif /* TOWR_SOLVE_RESULT_H_ */
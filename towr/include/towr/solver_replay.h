@@ -0,0 +1,137 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef TOWR_SOLVER_REPLAY_H_
+#define TOWR_SOLVER_REPLAY_H_
+
+#include <functional>
+#include <iosfwd>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <ifopt/solver.h>
+
+#include "towr.h"
+
+namespace towr {
+
+/**
+ * @brief Replays recorded problems against a matrix of solver configs.
+ *
+ * Solver options (tolerances, linear solver, hessian approximation) are
+ * usually tuned by intuition on whatever problem happens to be open. This
+ * runs every registered solver configuration against every registered
+ * problem and reports wall time, iteration count, objective and worst
+ * constraint violation per cell, so the choice can be made on data.
+ *
+ * Problems are described by a setup callback that configures a TOWR
+ * instance (initial state, parameters, model, terrain), exactly as
+ * application code would, so each cell exercises the real BuildNLP()
+ * path. A problem can additionally name a snapshot written by
+ * TOWR::SaveProblemState(); the cell then restores the recorded variable
+ * values and re-solves from them, which pins down the starting point a
+ * tuning run is judged on.
+ *
+ * All cells run sequentially on the calling thread so the timings are not
+ * distorted by each other -- this is a tuning tool, not a planner, and a
+ * deterministic ranking is worth more here than throughput.
+ */
+class SolverReplay {
+public:
+  /// Creates one solver instance per cell (@sa BatchPlanner::SolverMaker).
+  using SolverMaker   = std::function<ifopt::Solver::Ptr()>;
+  /// Configures a fresh TOWR instance to define one problem.
+  using ScenarioSetup = std::function<void(TOWR&)>;
+
+  /**
+   * @brief The outcome of solving one problem with one configuration.
+   */
+  struct CellResult {
+    std::string problem; ///< name of the problem this cell solved.
+    std::string config;  ///< name of the solver configuration used.
+    double wall_time_s = 0.0; ///< wall-clock duration of the solve.
+    int iterations     = 0;   ///< solver iterations until termination.
+    double cost        = std::numeric_limits<double>::max();
+    double violation   = std::numeric_limits<double>::max();
+    bool solved        = false; ///< false if the solve threw.
+  };
+
+  SolverReplay () = default;
+  virtual ~SolverReplay () = default;
+
+  /**
+   * @brief Registers a solver configuration to evaluate.
+   * @param name         Label used in the report.
+   * @param make_solver  Creates a solver with this configuration applied.
+   */
+  void AddConfig(const std::string& name, const SolverMaker& make_solver);
+
+  /**
+   * @brief Registers a problem to solve with every configuration.
+   * @param name           Label used in the report.
+   * @param setup          Configures the TOWR instance for this problem.
+   * @param snapshot_path  Optional snapshot from TOWR::SaveProblemState();
+   *                       if given, its variable values seed the solve.
+   */
+  void AddProblem(const std::string& name, const ScenarioSetup& setup,
+                  const std::string& snapshot_path = "");
+
+  /**
+   * @brief Solves every problem with every configuration, sequentially.
+   * @returns One CellResult per (problem, config) pair, problems outermost,
+   *          in registration order.
+   */
+  std::vector<CellResult> Run() const;
+
+  /**
+   * @brief Writes the results as an aligned table, one row per cell.
+   */
+  static void PrintReport(const std::vector<CellResult>& cells,
+                          std::ostream& out);
+
+private:
+  struct Config {
+    std::string name;
+    SolverMaker make_solver;
+  };
+
+  struct Problem {
+    std::string name;
+    ScenarioSetup setup;
+    std::string snapshot_path;
+  };
+
+  std::vector<Config> configs_;
+  std::vector<Problem> problems_;
+};
+
+} /* namespace towr */
+
+#endif /* TOWR_SOLVER_REPLAY_H_ */
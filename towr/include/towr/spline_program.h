@@ -0,0 +1,130 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef TOWR_SPLINE_PROGRAM_H_
+#define TOWR_SPLINE_PROGRAM_H_
+
+#include <string>
+#include <vector>
+
+#include <towr/variables/spline_holder.h>
+#include <towr/variables/state.h>
+
+namespace towr {
+
+/**
+ * @brief Evaluates a 3-dimensional cubic spline given by plain coefficients.
+ *
+ * Unlike Spline this class is not connected to the optimization variables;
+ * it holds the final polynomial coefficients directly and only evaluates
+ * them. This makes it suitable for running on the robot, e.g. inside a
+ * 1 kHz whole-body controller, where the state at arbitrary t is obtained
+ * exactly instead of interpolating between pre-sampled values.
+ *
+ * @sa SplineProgram
+ */
+class CubicSplineEvaluator {
+public:
+  /**
+   * One column per polynomial coefficient A..D, one row per dimension, so
+   * f(t) = coeff*(1, t, t^2, t^3)^T. Unaligned so it can be stored in a
+   * plain std::vector.
+   */
+  using CoeffMatrix = Eigen::Matrix<double, k3D, 4, Eigen::ColMajor|Eigen::DontAlign>;
+
+  CubicSplineEvaluator() = default;
+
+  /**
+   * @brief Defines the spline by explicit segment durations and coefficients.
+   */
+  CubicSplineEvaluator(const std::vector<double>& durations,
+                       const std::vector<CoeffMatrix>& coeff);
+
+  /**
+   * @brief Copies durations and coefficients out of an optimized spline.
+   */
+  explicit CubicSplineEvaluator(const Spline& spline);
+
+  /**
+   * @returns Position, velocity and acceleration at time t, clamped to
+   *          the spline's time range.
+   */
+  State GetPoint(double t) const;
+
+  double GetTotalTime() const;
+  int GetSegmentCount() const;
+  const std::vector<double>& GetDurations() const;
+  const CoeffMatrix& GetCoefficients(int segment) const;
+
+private:
+  std::vector<double> durations_;             ///< duration [s] per segment.
+  std::vector<double> cumulative_durations_;  ///< running sum for segment lookup.
+  std::vector<CoeffMatrix> coeff_;            ///< coefficients per segment.
+};
+
+/**
+ * @brief The exact optimization result as a set of evaluable splines.
+ *
+ * The true solution of the NLP is only a handful of cubic-Hermite segments
+ * per spline, so shipping these coefficients instead of a densely sampled
+ * trajectory reduces a plan from megabytes to kilobytes and lets consumers
+ * evaluate at whatever rate and times they need with zero interpolation
+ * error. The member layout mirrors SplineHolder.
+ */
+class SplineProgram {
+public:
+  SplineProgram() = default;
+
+  /**
+   * @brief Extracts the spline coefficients from an optimized solution.
+   * @param solution  The optimized splines (@sa TOWR::GetSolution()).
+   */
+  explicit SplineProgram(const SplineHolder& solution);
+
+  /**
+   * @brief Writes this program as a small binary file.
+   * @throws std::runtime_error if the file cannot be written.
+   */
+  void Save(const std::string& path) const;
+
+  /**
+   * @brief Reads a program written by Save().
+   * @throws std::runtime_error if the file cannot be read or is invalid.
+   */
+  static SplineProgram Load(const std::string& path);
+
+  CubicSplineEvaluator base_linear_;  ///< linear base position x,y,z.
+  CubicSplineEvaluator base_angular_; ///< base Euler angles x,y,z.
+  std::vector<CubicSplineEvaluator> ee_motion_; ///< endeffector position per foot.
+  std::vector<CubicSplineEvaluator> ee_force_;  ///< contact force per foot.
+};
+
+} /* namespace towr */
+
+#endif /* TOWR_SPLINE_PROGRAM_H_ */
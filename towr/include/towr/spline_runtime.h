@@ -0,0 +1,220 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef TOWR_SPLINE_RUNTIME_H_
+#define TOWR_SPLINE_RUNTIME_H_
+
+/**
+ * @file spline_runtime.h
+ *
+ * Evaluation-only runtime for optimized trajectories.
+ *
+ * This single header is deliberately self-contained: it includes nothing
+ * but the C++ standard library -- no Eigen, no ifopt, no other towr
+ * header -- and defines everything inline, so an on-robot controller can
+ * evaluate a trajectory exported with SplineProgram::Save() without
+ * linking libtowr or its solver dependencies. The planning side keeps
+ * using SplineProgram (@ref spline_program.h); only the consuming side
+ * switches to towr::runtime.
+ *
+ * The binary layout read by runtime::Program::Load() mirrors the one
+ * written by SplineProgram::Save() in spline_program.cc; the two must be
+ * changed together.
+ */
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace towr {
+namespace runtime {
+
+/**
+ * @brief Position, velocity and acceleration of one 3D quantity.
+ *
+ * Plain arrays instead of Eigen types, so the header stays free of
+ * external dependencies. The x,y,z components are at indices 0,1,2.
+ */
+struct State {
+  std::array<double,3> p; ///< position [m] (or force [N], angles [rad]).
+  std::array<double,3> v; ///< first time derivative.
+  std::array<double,3> a; ///< second time derivative.
+};
+
+/**
+ * @brief Evaluates one 3-dimensional cubic spline from plain coefficients.
+ *
+ * Dependency-free equivalent of CubicSplineEvaluator: per segment the
+ * duration and the coefficients of f(t) = A + B*t + C*t^2 + D*t^3 per
+ * dimension, plus the cumulative-duration segment lookup.
+ */
+class CubicSpline {
+public:
+  /// The 12 coefficient doubles of one segment, column major like the
+  /// planner's CoeffMatrix: coefficient c of dimension d at index 3*c+d.
+  using SegmentCoeff = std::array<double,12>;
+
+  CubicSpline() = default;
+
+  CubicSpline(const std::vector<double>& durations,
+              const std::vector<SegmentCoeff>& coeff)
+      : durations_(durations), coeff_(coeff)
+  {
+    double t = 0.0;
+    for (double d : durations_) {
+      t += d;
+      cumulative_durations_.push_back(t);
+    }
+  }
+
+  /**
+   * @returns Position, velocity and acceleration at time t, clamped to
+   *          the spline's time range.
+   */
+  State GetPoint (double t) const
+  {
+    t = std::max(0.0, std::min(t, GetTotalTime()));
+
+    // first segment whose end time lies beyond t
+    auto it = std::upper_bound(cumulative_durations_.begin(),
+                               cumulative_durations_.end(), t);
+    int id = std::min<int>(it - cumulative_durations_.begin(),
+                           durations_.size()-1);
+    double tl = t - (cumulative_durations_.at(id) - durations_.at(id));
+
+    const SegmentCoeff& m = coeff_.at(id);
+
+    State out;
+    for (int d=0; d<3; ++d) {
+      double A = m[0+d], B = m[3+d], C = m[6+d], D = m[9+d];
+      out.p[d] = A + tl*(B + tl*(C + tl*D));
+      out.v[d] = B + tl*(2*C + tl*3*D);
+      out.a[d] = 2*C + tl*6*D;
+    }
+
+    return out;
+  }
+
+  double GetTotalTime () const
+  {
+    return cumulative_durations_.empty()? 0.0 : cumulative_durations_.back();
+  }
+
+  int GetSegmentCount () const { return coeff_.size(); };
+  const std::vector<double>& GetDurations () const { return durations_; };
+
+private:
+  std::vector<double> durations_;             ///< duration [s] per segment.
+  std::vector<double> cumulative_durations_;  ///< running sum for segment lookup.
+  std::vector<SegmentCoeff> coeff_;           ///< coefficients per segment.
+};
+
+/**
+ * @brief A full optimized motion, loaded from a spline-program file.
+ *
+ * The member layout mirrors SplineProgram (and thereby SplineHolder).
+ * Loading parses kilobytes of coefficients, so construction is trivially
+ * fast and the object is safe to evaluate from a real-time control loop:
+ * GetPoint() allocates nothing and touches only this object.
+ */
+class Program {
+public:
+  Program() = default;
+
+  /**
+   * @brief Reads a file written by SplineProgram::Save().
+   * @throws std::runtime_error if the file cannot be read or is invalid.
+   */
+  static Program Load (const std::string& path)
+  {
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+      throw std::runtime_error("runtime::Program: cannot open " + path);
+
+    // must match FileHeader/kMagic/kVersion in spline_program.cc
+    struct FileHeader {
+      char magic[4];
+      uint32_t version;
+      uint32_t n_ee;
+    };
+    const char magic[4] = {'T','W','R','S'};
+    const uint32_t version = 1;
+
+    FileHeader header;
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file
+        || std::memcmp(header.magic, magic, sizeof(magic)) != 0
+        || header.version != version)
+      throw std::runtime_error("runtime::Program: " + path
+                               + " is no spline-program file");
+
+    auto read_spline = [&file, &path]() {
+      uint32_t n = 0;
+      file.read(reinterpret_cast<char*>(&n), sizeof(n));
+
+      std::vector<double> durations(n);
+      std::vector<CubicSpline::SegmentCoeff> coeff(n);
+      for (uint32_t id=0; id<n; ++id) {
+        file.read(reinterpret_cast<char*>(&durations.at(id)), sizeof(double));
+        file.read(reinterpret_cast<char*>(coeff.at(id).data()),
+                  sizeof(CubicSpline::SegmentCoeff));
+      }
+
+      if (!file)
+        throw std::runtime_error("runtime::Program: " + path + " is truncated");
+
+      return CubicSpline(durations, coeff);
+    };
+
+    Program program;
+    program.base_linear_  = read_spline();
+    program.base_angular_ = read_spline();
+    for (uint32_t ee=0; ee<header.n_ee; ++ee)
+      program.ee_motion_.push_back(read_spline());
+    for (uint32_t ee=0; ee<header.n_ee; ++ee)
+      program.ee_force_.push_back(read_spline());
+
+    return program;
+  }
+
+  CubicSpline base_linear_;  ///< linear base position x,y,z.
+  CubicSpline base_angular_; ///< base Euler angles x,y,z.
+  std::vector<CubicSpline> ee_motion_; ///< endeffector position per foot.
+  std::vector<CubicSpline> ee_force_;  ///< contact force per foot.
+};
+
+} /* namespace runtime */
+} /* namespace towr */
+
+#endif /* TOWR_SPLINE_RUNTIME_H_ */
@@ -0,0 +1,100 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef TOWR_TELEMETRY_BUFFER_H_
+#define TOWR_TELEMETRY_BUFFER_H_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace towr {
+
+/**
+ * @brief One telemetry sample recorded during a solve.
+ *
+ * Holds what the evaluation hook can observe at the ifopt boundary; the
+ * evaluation count is an upper bound on the solver iterations, since line
+ * search trials also evaluate the constraints.
+ */
+struct SolveSample {
+  int n_evals;      ///< constraint evaluations so far (@sa SolveMonitor).
+  double violation; ///< maximum dynamic violation at this evaluation.
+  double t_wall;    ///< wall time [s] since the first evaluation.
+};
+
+/**
+ * @brief Lock-free single-producer/single-consumer ring of solve samples.
+ *
+ * The solver thread pushes one sample per constraint evaluation and a
+ * monitoring thread (e.g. a dashboard) drains them concurrently, without
+ * locks and so without perturbing solver timing. When the consumer falls
+ * behind, the newest samples are dropped and counted instead of blocking
+ * the producer.
+ */
+class TelemetryBuffer {
+public:
+  using Ptr = std::shared_ptr<TelemetryBuffer>;
+
+  /**
+   * @param capacity  Number of samples the ring holds, rounded up to the
+   *                  next power of two.
+   */
+  explicit TelemetryBuffer(std::size_t capacity = 1024);
+  virtual ~TelemetryBuffer() = default;
+
+  /**
+   * @brief Appends a sample; solver thread only.
+   * @returns False if the ring was full and the sample was dropped.
+   */
+  bool Push(const SolveSample& sample);
+
+  /**
+   * @brief Removes and returns all buffered samples; consumer thread only.
+   */
+  std::vector<SolveSample> Drain();
+
+  /**
+   * @returns How many samples were dropped because the ring was full.
+   */
+  std::size_t GetDroppedCount() const;
+
+private:
+  std::vector<SolveSample> buffer_; ///< fixed storage, sized to a power of two.
+  std::size_t mask_;                ///< capacity-1, for cheap index wrapping.
+
+  std::atomic<std::size_t> head_{0};    ///< next slot the consumer reads.
+  std::atomic<std::size_t> tail_{0};    ///< next slot the producer writes.
+  std::atomic<std::size_t> dropped_{0}; ///< samples lost to a full ring.
+};
+
+} /* namespace towr */
+
+#endif /* TOWR_TELEMETRY_BUFFER_H_ */
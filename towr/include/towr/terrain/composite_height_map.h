@@ -0,0 +1,154 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef TOWR_TERRAIN_COMPOSITE_HEIGHT_MAP_H_
+#define TOWR_TERRAIN_COMPOSITE_HEIGHT_MAP_H_
+
+#include <vector>
+
+#include "height_map.h"
+
+namespace towr {
+
+/**
+ * @brief Terrain composed of rectangular patches of other terrains.
+ *
+ * Courses are built by placing terrain primitives (Block, Gap, Stairs, ...)
+ * on a flat base, each restricted to an axis-aligned rectangle. Without this
+ * class every course needs a hand-written HeightMap subclass chaining
+ * if/else range checks (@sa Stairs), which scans the patches linearly per
+ * query and leaves the derivatives discontinuous at the seams.
+ *
+ * Queries here go through a uniform bucket grid built over the patch
+ * rectangles, so dispatch costs O(patches per bucket) -- practically O(1) --
+ * instead of O(N). Inside a margin along each patch border the patch is
+ * blended into the terrain underneath with a quintic ramp, which keeps the
+ * composed height and its first and second derivatives continuous across
+ * seams; those derivatives feed the terrain normals the force constraint
+ * linearizes, so kinks there directly degrade solver convergence. Patches
+ * added later sit on top of earlier ones, and neighboring patches should
+ * overlap by the blend margin so the seam blends patch-to-patch instead of
+ * dipping to the base height.
+ *
+ * @ingroup Terrains
+ */
+class CompositeHeightMap : public HeightMap {
+public:
+  using Ptr = std::shared_ptr<CompositeHeightMap>;
+
+  /**
+   * @param base_height   The flat height [m] outside all patches.
+   * @param blend_margin  Width [m] of the strip inside each patch border
+   *                      over which the patch blends into the terrain below.
+   */
+  CompositeHeightMap(double base_height = 0.0, double blend_margin = 0.1);
+
+  /**
+   * @brief Places a terrain primitive on the composite.
+   * @param patch  The terrain evaluated inside the rectangle; later patches
+   *               override earlier ones where they overlap.
+   * @param x_min,x_max,y_min,y_max  The rectangle [m] the patch covers.
+   * @param x_offset,y_offset  Shift [m] applied to the query before it is
+   *               passed to the patch, so primitives with baked-in geometry
+   *               (e.g. Gap's gap_start_) can be repositioned.
+   * @param z_offset  Height [m] added to the patch's height values.
+   */
+  void AddPatch(const HeightMap::Ptr& patch,
+                double x_min, double x_max,
+                double y_min, double y_max,
+                double x_offset = 0.0, double y_offset = 0.0,
+                double z_offset = 0.0);
+
+  double GetHeight(double x, double y) const override;
+
+private:
+  /// A terrain primitive restricted to a rectangle (@sa AddPatch()).
+  struct Patch {
+    HeightMap::Ptr terrain;
+    double x_min, x_max, y_min, y_max;
+    double x_offset, y_offset, z_offset;
+  };
+
+  /// Height and derivatives of the composed surface at one position.
+  struct Surface {
+    double h = 0.0;
+    double dx = 0.0, dy = 0.0;
+    double dxx = 0.0, dxy = 0.0, dyx = 0.0, dyy = 0.0;
+  };
+
+  double GetHeightDerivWrtX(double x, double y) const override;
+  double GetHeightDerivWrtY(double x, double y) const override;
+  double GetHeightDerivWrtXX(double x, double y) const override;
+  double GetHeightDerivWrtXY(double x, double y) const override;
+  double GetHeightDerivWrtYX(double x, double y) const override;
+  double GetHeightDerivWrtYY(double x, double y) const override;
+
+  /**
+   * @brief Blends the patches covering (x,y) over the base, bottom-up.
+   *
+   * Every step applies s_new = s + w*(patch - s) to the height and, via the
+   * product rule, to all derivatives, where w is the patch's C2 border
+   * ramp. The result is memoized per thread for the single position the
+   * base class's derivative cache queries repeatedly, so concurrent
+   * queries from parallel construction or solves don't race.
+   */
+  const Surface& Evaluate(double x, double y) const;
+
+  /// The blend weight of one patch and its derivatives at (x,y).
+  struct Weight {
+    double w, dx, dy, dxx, dxy, dyy;
+  };
+  Weight GetWeight(const Patch& p, double x, double y) const;
+
+  /**
+   * @brief Indices of the patches whose rectangle may contain (x,y).
+   *
+   * Looks the containing bucket up in the uniform grid, (re-)building the
+   * grid first if patches were added since the last query. Positions
+   * outside every patch return an empty list.
+   */
+  const std::vector<int>& GetCandidates(double x, double y) const;
+  void BuildIndex() const;
+
+  std::vector<Patch> patches_;
+  double base_height_;
+  double margin_;
+
+  // the spatial index: n_ x n_ buckets spanning the patches' bounding box,
+  // each holding the (ascending) indices of the rectangles overlapping it.
+  mutable bool index_built_ = false;
+  mutable int n_ = 0;
+  mutable double grid_x0_, grid_y0_;    ///< lower-left corner of the grid.
+  mutable double cell_x_, cell_y_;      ///< bucket extent per axis.
+  mutable std::vector<std::vector<int>> buckets_;
+};
+
+} /* namespace towr */
+
+#endif /* TOWR_TERRAIN_COMPOSITE_HEIGHT_MAP_H_ */
@@ -0,0 +1,118 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef TOWR_TERRAIN_GRID_HEIGHT_MAP_H_
+#define TOWR_TERRAIN_GRID_HEIGHT_MAP_H_
+
+#include <cstdint>
+#include <string>
+
+#include "height_map.h"
+
+namespace towr {
+
+/**
+ * @brief Terrain defined by elevation samples on a regular grid.
+ *
+ * The elevation data is memory-mapped directly from a binary file, so
+ * swapping in a new terrain patch (e.g. from a LIDAR elevation map) costs no
+ * parsing and no copy. Height queries bilinearly interpolate the four
+ * surrounding samples; the derivatives are those of the bilinear patch, so
+ * they are exact inside each grid cell.
+ *
+ * The file starts with a GridHeightMap::FileHeader, followed by
+ * n_x*n_y doubles in row-major order with x varying fastest:
+ * height(ix,iy) is stored at index iy*n_x + ix.
+ *
+ * @ingroup Terrains
+ */
+class GridHeightMap : public HeightMap {
+public:
+  /**
+   * @brief The fixed-size header at the start of the elevation file.
+   */
+  struct FileHeader {
+    uint32_t n_x;      ///< number of samples in x-direction.
+    uint32_t n_y;      ///< number of samples in y-direction.
+    double resolution; ///< distance [m] between two neighboring samples.
+    double origin_x;   ///< world x-coordinate [m] of sample (0,0).
+    double origin_y;   ///< world y-coordinate [m] of sample (0,0).
+  };
+
+  /**
+   * @brief Memory-maps the elevation grid stored in @a filename.
+   *
+   * Throws std::runtime_error if the file cannot be opened or is too small
+   * for the dimensions announced in its header.
+   */
+  explicit GridHeightMap(const std::string& filename);
+  virtual ~GridHeightMap();
+
+  GridHeightMap(const GridHeightMap&) = delete;
+  GridHeightMap& operator=(const GridHeightMap&) = delete;
+
+  double GetHeight(double x, double y) const override;
+
+  // vectorized: gathers the four corner samples per query and blends all
+  // queries with Eigen array expressions, letting the compiler use SIMD.
+  void GetHeights(const Eigen::Matrix2Xd& xy,
+                  Eigen::VectorXd& heights) const override;
+  void GetHeightDerivatives(const Eigen::Matrix2Xd& xy,
+                            Eigen::Matrix2Xd& derivs) const override;
+  double GetHeightDerivWrtX(double x, double y) const override;
+  double GetHeightDerivWrtY(double x, double y) const override;
+
+  // XX and YY vanish inside each bilinear cell (base-class default of 0.0),
+  // only the mixed derivative is nonzero.
+  double GetHeightDerivWrtXY(double x, double y) const override;
+  double GetHeightDerivWrtYX(double x, double y) const override;
+
+private:
+  const FileHeader* header_ = nullptr; ///< points into the mapped file.
+  const double* heights_ = nullptr;    ///< the elevation samples.
+  std::size_t file_size_ = 0;          ///< bytes mapped, for munmap().
+  int row_stride_ = 0;                 ///< samples per y-row (= n_x).
+
+  /**
+   * @brief The grid cell containing (x,y) and the position within it.
+   * @param[out] idx,idy  Index of the lower-left sample of the cell.
+   * @param[out] u,v      Position in the cell, each in [0,1].
+   *
+   * Queries outside the grid are clamped to the border cells.
+   */
+  void GetCell(double x, double y, int& idx, int& idy,
+               double& u, double& v) const;
+
+  /// The stored elevation sample at grid index (ix,iy).
+  double GetSample(int ix, int iy) const;
+};
+
+} /* namespace towr */
+
+#endif /* TOWR_TERRAIN_GRID_HEIGHT_MAP_H_ */
@@ -30,6 +30,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef TOWR_HEIGHT_MAP_H_
 #define TOWR_HEIGHT_MAP_H_
 
+#include <functional>
 #include <memory>
 #include <vector>
 #include <map>
@@ -85,7 +86,41 @@ public:
                    ChimneyLRID,
                    TERRAIN_COUNT };
 
-  static HeightMap::Ptr MakeTerrain(TerrainID type);
+  using MakerFcn = std::function<HeightMap::Ptr()>;
+
+  /**
+   * @brief Makes the terrain registered under the given ID.
+   *
+   * The example terrains occupy the IDs of TerrainID; custom terrains
+   * registered through Registrar are constructed the same way, so user
+   * code never has to patch this factory (@sa RegisterTerrain()).
+   */
+  static HeightMap::Ptr MakeTerrain(int type);
+
+  /**
+   * @brief Adds a terrain factory under the given ID.
+   * @param id     The ID MakeTerrain() resolves to this terrain. IDs below
+   *               TERRAIN_COUNT are taken by the example terrains.
+   * @param maker  Constructs a fresh instance of the terrain.
+   *
+   * Intended to be called from static Registrar objects before main()
+   * runs; registrations are not synchronized against concurrent
+   * MakeTerrain() calls.
+   */
+  static void RegisterTerrain(int id, const MakerFcn& maker);
+
+  /**
+   * @brief Registers a terrain factory at static-initialization time.
+   *
+   * Place one static instance next to the terrain class:
+   * @code
+   * static HeightMap::Registrar reg(MyTerrainID,
+   *                                 []{ return std::make_shared<MyTerrain>(); });
+   * @endcode
+   */
+  struct Registrar {
+    Registrar(int id, const MakerFcn& maker) { RegisterTerrain(id, maker); };
+  };
 
   enum Direction { Normal, Tangent1, Tangent2 };
 
@@ -99,6 +134,31 @@ public:
    */
   virtual double GetHeight(double x, double y) const = 0;
 
+  /**
+   * @brief The terrain height at many 2D positions in one call.
+   * @param xy  One query position per column.
+   * @param[out] heights  Resized to xy.cols(), one height [m] per query.
+   *
+   * The default forwards to GetHeight() per column; terrains backed by a
+   * regular grid override this with a vectorized implementation, so
+   * constraints batching their per-node queries pay the virtual dispatch
+   * once per fill instead of once per node.
+   */
+  virtual void GetHeights(const Eigen::Matrix2Xd& xy,
+                          Eigen::VectorXd& heights) const;
+
+  /**
+   * @brief The terrain slope (dh/dx, dh/dy) at many 2D positions in one call.
+   * @param xy  One query position per column.
+   * @param[out] derivs  Resized to 2 x xy.cols(), one slope pair per query.
+   *
+   * Batched counterpart of GetDerivativeOfHeightWrt(), analogous to
+   * GetHeights(): the default forwards per column, grid terrains override
+   * it vectorized (@sa GridHeightMap).
+   */
+  virtual void GetHeightDerivatives(const Eigen::Matrix2Xd& xy,
+                                    Eigen::Matrix2Xd& derivs) const;
+
   /**
    * @brief How the height value changes at a 2D position in direction dim.
    * @param dim  The direction (x,y) w.r.t. which the height change is desired.
@@ -127,6 +187,20 @@ public:
    */
   Vector3d GetDerivativeOfNormalizedBasisWrt(Direction direction, Dim2D dim,
                                              double x, double y) const;
+  /**
+   * @brief How the height derivative w.r.t dim1 changes in direction dim2.
+   * @param dim1  The dimension (x,y) of the inner derivative.
+   * @param dim2  The dimension (x,y) w.r.t which the change is desired.
+   * @param x  The x position on the terrain.
+   * @param y  The y position on the terrain.
+   * @return  The second derivative of the height.
+   *
+   * Used internally to build the basis-vector derivatives; public so
+   * terrain adapters (e.g. CompositeHeightMap) can chain through it.
+   */
+  double GetSecondDerivativeOfHeightWrt(Dim2D dim1, Dim2D dim2,
+                                        double x, double y) const;
+
   /**
    * @returns The constant friction coefficient over the whole terrain.
    */
@@ -153,11 +227,27 @@ private:
   Vector3d GetTangent1(double x, double y, const DimDerivs& = {}) const;
   Vector3d GetTangent2(double x, double y, const DimDerivs& = {}) const;
 
-  double GetSecondDerivativeOfHeightWrt(Dim2D dim1, Dim2D dim2,
-                                        double x, double y) const;
+  /**
+   * @brief All height derivatives at one position, memoized.
+   *
+   * The basis vectors and their derivatives are assembled from the same
+   * handful of virtual derivative queries, and the constraints evaluate
+   * them repeatedly for the same foothold within one Jacobian pass. The
+   * derivatives are therefore computed once per unique (x,y) and looked up
+   * from a small ring buffer of recently queried positions. The buffer
+   * lives in thread-local storage, so one terrain instance can be queried
+   * from concurrent solves without synchronization.
+   */
+  struct DerivativeCacheEntry {
+    double x, y;                 ///< the queried position.
+    double dx, dy;               ///< first derivatives of the height.
+    double dxx, dxy, dyx, dyy;   ///< second derivatives of the height.
+    bool valid = false;
+  };
+  static constexpr int kCacheSize = 4; ///< positions remembered at once.
 
-  Vector3d GetDerivativeOfNormalizedVectorWrtNonNormalizedIndex(
-      const Vector3d& non_normalized, int index) const;
+  /// The cached derivatives at (x,y), computing them on a cache miss.
+  const DerivativeCacheEntry& GetCachedDerivatives(double x, double y) const;
 
   // first derivatives that must be implemented by the user
   virtual double GetHeightDerivWrtX(double x, double y) const { return 0.0; };
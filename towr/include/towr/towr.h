@@ -30,7 +30,10 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef TOWR_TOWR_H_
 #define TOWR_TOWR_H_
 
-#include <iostream>
+#include <functional>
+#include <future>
+#include <map>
+#include <string>
 
 #include <ifopt/problem.h>
 #include <ifopt/solver.h>
@@ -41,6 +44,11 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <towr/terrain/height_map.h>
 #include "nlp_factory.h"
 #include "parameters.h"
+#include "iterate_store.h"
+#include "memory_tally.h"
+#include "problem_stats.h"
+#include "solution_cache.h"
+#include "solve_result.h"
 
 
 /**
@@ -84,13 +92,245 @@ public:
                      const RobotModel& model,
                      HeightMap::Ptr terrain);
 
+  /**
+   * @brief Warm-starts the next solve from a previous solution.
+   * @param prior  The splines of a previous solve (@sa GetSolution()).
+   * @param t_shift  Time [s] by which the previous solution is shifted
+   *                 forward, e.g. the replan interval when running in a
+   *                 receding-horizon fashion.
+   *
+   * Instead of the default straight-line interpolation, the node variables
+   * and phase durations of the new problem are initialized by sampling the
+   * previous solution. A warm-started solver typically converges in a
+   * fraction of the iterations.
+   */
+  void SetInitialGuess(const SplineHolder& prior, double t_shift = 0.0);
+
   /**
    * @brief Constructs the problem and solves it with IPOPT.
+   * @returns The solve status, iteration count and a timing breakdown
+   *          (@sa SolveResult), so callers get these figures without
+   *          parsing console output.
    *
    * Could use any ifopt solver interface, see (http://wiki.ros.org/ifopt).
    * Currently IPOPT and SNOPT are implemented.
    */
-  void SolveNLP(const ifopt::Solver::Ptr& solver);
+  SolveResult SolveNLP(const ifopt::Solver::Ptr& solver);
+
+  /**
+   * @brief Solves the problem on a background thread.
+   * @param solver    The solver to run, owned by the background thread
+   *                  until the future is ready.
+   * @param progress  Optional callback reporting the evaluation count and
+   *                  current dynamic violation (@sa SolveMonitor). Runs on
+   *                  the solver thread.
+   * @returns A future that becomes true when the solve finished and false
+   *          when it was stopped through Cancel().
+   *
+   * Useful when solving inside an event loop (e.g. a ROS callback) that
+   * must stay responsive during the seconds a hard problem can take. This
+   * object must not be touched until the returned future is ready.
+   */
+  std::future<bool> SolveAsync(const ifopt::Solver::Ptr& solver,
+                               const SolveMonitor::ProgressCallback& progress
+                                   = SolveMonitor::ProgressCallback());
+
+  /**
+   * @brief Cooperatively stops a solve started with SolveAsync().
+   *
+   * Safe to call from any thread; the solve aborts at the next constraint
+   * evaluation and the future returns false. The variables hold the last
+   * values the solver set, so the solution is not meaningful.
+   */
+  void Cancel();
+
+  /**
+   * @brief Records per-evaluation telemetry of subsequent solves.
+   * @param buffer  The ring receiving one SolveSample per constraint
+   *                evaluation, drainable from another thread while the
+   *                solver runs (@sa TelemetryBuffer).
+   *
+   * The lock-free ring keeps the recording overhead on the solver thread
+   * to a few nanoseconds per sample, so it is safe to leave enabled in
+   * planners. Pass a nullptr to stop recording.
+   */
+  void SetTelemetry(const TelemetryBuffer::Ptr& buffer);
+
+  /**
+   * @brief Caches solved trajectories of recurring scenarios.
+   * @param cache  Shared across solves (and possibly TOWR instances);
+   *               nullptr disables caching.
+   *
+   * Before each SolveNLP() the scenario -- initial state, goal, phase
+   * durations and terrain probes along the start-goal line, all
+   * quantized -- is looked up in the cache. Depending on the cache's
+   * policy a hit either skips the solve and returns the stored
+   * trajectory, or warm-starts the solve from it. Every successful
+   * solve is stored back.
+   *
+   * The terrain enters the key only through sampled heights and the
+   * friction coefficient, so two terrains that differ away from the
+   * direct start-goal line can collide; use the kWarmStart policy if
+   * that cannot be ruled out.
+   */
+  void SetSolutionCache(const SolutionCache::Ptr& cache);
+
+  /**
+   * @brief Retains the solver's iterate history in bounded, compressed form.
+   * @param store  Filled by every SolveNLP(); nullptr disables retention.
+   *
+   * With a store attached, SetSolution() restores iterates from it, so
+   * iteration forensics keep working with a sliding retention window and
+   * at a fraction of the verbatim history's footprint. The store can also
+   * be saved to a compact file and inspected in another process
+   * (@sa IterateStore::Save()).
+   */
+  void SetIterateStore(const IterateStore::Ptr& store);
+
+  /**
+   * @brief Solves with a dynamic-constraint grid refined where needed.
+   * @param solver  The solver used for every refinement pass.
+   * @param tol     Dynamic violation [m/s^2, rad/s^2] above which a sample
+   *                is inserted between two existing grid points.
+   * @param max_refinements  Additional solves after the initial one.
+   *
+   * A uniform dt_constraint_dynamic_ grid must be fine everywhere to rule
+   * out dynamics violations between samples, which inflates the number of
+   * constraint rows. This instead starts from the (coarse) uniform grid,
+   * solves, measures the violation midway between the samples of the
+   * found solution and re-solves with extra samples only where the
+   * dynamics tunneled through, warm-started from the previous pass.
+   * Fewer constraint rows keep the solver's KKT systems small.
+   */
+  void SolveAdaptive(const ifopt::Solver::Ptr& solver,
+                     double tol = 1e-3, int max_refinements = 3);
+
+  /**
+   * @brief Solves a coarse version of the problem first, then the real one.
+   * @param solver      The solver used for both levels.
+   * @param coarsening  Factor by which the coarse level's discretization
+   *                    intervals are enlarged.
+   *
+   * Long-horizon problems take minutes from a cold start, and most of
+   * those iterations are spent discovering the rough motion that a much
+   * smaller problem finds in seconds. This derives a coarse Parameters
+   * set from the current one (larger constraint discretization and base
+   * polynomial durations, half the polynomials per swing/stance phase),
+   * solves it, and maps the solution onto the fine problem through
+   * SetInitialGuess(), which samples the coarse splines at the fine node
+   * times regardless of the differing discretizations. The fine solve
+   * then starts near the optimum. The parameters set through
+   * SetParameters() are restored before the fine solve.
+   */
+  void SolveCoarseToFine(const ifopt::Solver::Ptr& solver,
+                         double coarsening = 2.0);
+
+  /**
+   * @brief Solves only until an acceptably feasible iterate appears.
+   * @param solver  Solver with which to solve the problem.
+   *
+   * For reactive replanning a dynamically feasible plan now often beats
+   * an optimal plan later; feasibility is typically reached in the first
+   * third of the iterations and the rest is optimality polish. This
+   * installs a monitor on the dynamic constraint (evaluated once per
+   * iteration plus line-search trials) and cancels the solve
+   * cooperatively as soon as the dynamics are satisfied to the tolerance
+   * set through Parameters::StopAtFeasible(). The returned solution is
+   * then rewound to the first stored iterate whose violation of *all*
+   * constraints is within that tolerance; if the cheap dynamics proxy
+   * triggered before such an iterate exists, the last iterate is kept.
+   */
+  void SolveFeasible(const ifopt::Solver::Ptr& solver);
+
+  /**
+   * @brief Solves, reusing the constructed problem whenever possible.
+   *
+   * Intended as the single entry point of a replanning loop: when the
+   * problem structure (variable and constraint dimensions, Jacobian
+   * sparsity) is unchanged since the last solve, this re-solves the
+   * existing problem object via ResolveNLP(), so a solver kept across
+   * calls sees stable dimensions and can reuse its workspace — in
+   * particular the symbolic factorization of the KKT system, a fixed
+   * multi-millisecond tax per replan when recomputed. Changing e.g. the
+   * gait, horizon or discretization falls back to a full rebuild
+   * transparently.
+   */
+  void SolvePersistent(const ifopt::Solver::Ptr& solver);
+
+  /**
+   * @brief Re-solves the problem constructed by a previous SolveNLP() call.
+   *
+   * Intended for receding-horizon replanning: only the boundary values
+   * (initial state, goal) set through SetInitialState()/SetParameters()
+   * are re-applied to the existing variable sets. The variable/constraint
+   * graph, the Jacobian structures and the current variable values are all
+   * kept alive, avoiding the full problem reconstruction per cycle.
+   */
+  void ResolveNLP(const ifopt::Solver::Ptr& solver);
+
+  /**
+   * @brief Lengthens the planned motion by appending phases to each foot.
+   * @param appended_phase_durations  Per endeffector the durations [s] of
+   *        the phases to append; the contact pattern continues alternating
+   *        and every foot's appended total must be identical so the feet
+   *        keep a common horizon.
+   *
+   * The ifopt/IPOPT interface fixes the problem dimensions per instance,
+   * so the extended problem is still constructed anew -- but structure
+   * preserving: the already optimized phase durations are carried over
+   * into the parameters before appending, and all node variables are
+   * warm-started by sampling the current solution (the appended tail
+   * holds its final state). Construction takes milliseconds, and the
+   * warm-started solve only has to work on the appended steps instead
+   * of rediscovering the whole motion. Requires a previous solve.
+   */
+  void ExtendHorizon(const std::vector<Parameters::VecTimes>& appended_phase_durations);
+
+  /// Creates one solver instance per multi-start candidate.
+  using SolverMaker = std::function<ifopt::Solver::Ptr()>;
+
+  /**
+   * @brief Solves several perturbed instances of the problem in parallel.
+   * @param make_solver  Creates a fresh solver per candidate, since solver
+   *                     instances cannot be shared across threads.
+   * @param n_candidates Number of problem instances to launch.
+   *
+   * When optimizing over phase durations the problem is non-convex and the
+   * solver can land in poor local minima depending on the initialization.
+   * Candidate 0 uses the nominal initialization, all others jitter the
+   * initial phase durations (keeping the total duration per foot). The
+   * feasible candidate with the lowest cost wins and becomes the solution
+   * returned by GetSolution().
+   */
+  void SolveMultiStart(const SolverMaker& make_solver, int n_candidates);
+
+  /**
+   * @brief Splits the horizon in two, solves the halves in parallel and
+   *        uses the stitched result to warm-start the full problem.
+   * @param make_solver  Creates a fresh solver per half problem, since
+   *                     solver instances cannot be shared across threads.
+   * @param rounds  Coordination rounds before the full solve (>= 1).
+   *
+   * Solve time grows superlinearly with horizon length, so on long plans
+   * two half-horizon problems plus a warm-started full solve beat one
+   * cold full solve by a wide margin. The horizon is cut at the base
+   * polynomial boundary closest to the middle (phases spanning the cut
+   * are split in two, keeping their contact state), and both halves are
+   * built by the regular NlpFactory with a consensus midpoint state
+   * acting as the first half's goal and the second half's start. Each
+   * round solves the halves on separate threads and then pulls the two
+   * copies of the shared state together, ADMM style: the first round
+   * leaves the crossing velocity free and averages what the halves
+   * propose, later rounds pin the averaged state and re-solve warm
+   * started. The gait is kept fixed inside the halves even when the full
+   * problem optimizes phase durations, since a drifting split instant
+   * would invalidate the consensus state.
+   *
+   * Experimental: the stitched trajectory is only near-feasible at the
+   * seam, which is exactly what the final warm-started full solve
+   * cleans up.
+   */
+  void SolveSplitHorizon(const SolverMaker& make_solver, int rounds = 2);
 
   /**
    * @returns the optimized motion for base, feet and force as splines.
@@ -115,6 +355,193 @@ public:
    */
   int GetIterationCount() const;
 
+  /**
+   * @returns The cost function value at the current optimization variables.
+   *
+   * Requires a constructed problem (@sa SolveNLP()). Together with
+   * GetConstraintViolation() this lets tooling such as SolverReplay score
+   * a solve without reaching into the ifopt problem directly.
+   */
+  double GetObjective();
+
+  /**
+   * @returns The worst violation of any constraint bound at the current
+   *          optimization variables, zero if all are satisfied.
+   */
+  double GetConstraintViolation();
+
+  /**
+   * @returns Per constraint set the values and bound violations at the
+   *          final iterate of the last SolveNLP() call, keyed on the set
+   *          name (e.g. "dynamic", "terrain-ee_motion_0").
+   *
+   * Captured from the same evaluation that produced
+   * SolveResult::constraint_violation, so reading it costs no extra
+   * constraint pass. Outer loops can decide which Parameters to relax
+   * from these figures instead of re-sampling the returned splines.
+   */
+  const std::map<std::string, ConstraintReport>& GetConstraintReports() const;
+
+  /**
+   * @returns Per constraint set the values and bound violations at the
+   *          current optimization variables.
+   *
+   * One constraint pass; useful for inspecting stored solver iterates by
+   * calling SetSolution() first (@sa GetConstraintReports() for the final
+   * iterate, which is free).
+   */
+  std::map<std::string, ConstraintReport> EvaluateConstraintReports() const;
+
+  /**
+   * @brief Builds the problem without solving it and reports its scale.
+   *
+   * Call after SetInitialState()/SetParameters(). Construction takes
+   * milliseconds while a solve can take seconds, so this is cheap enough
+   * for deployment tooling to vet a configuration (discretization
+   * intervals, polynomial and phase counts) and reject an over-sized
+   * problem before any solver time is spent. The counts are measured on
+   * the actually constructed problem, not estimated.
+   */
+  ProblemStats GetProblemStats();
+
+  /**
+   * @brief Replaces the terrain without reconstructing the problem.
+   * @param terrain  The new height map; friction is re-read from it.
+   *
+   * Perception stacks update elevation maps many times per second, and a
+   * full SetParameters() + rebuild per update discards most of them. This
+   * rebinds the terrain pointer inside the already constructed terrain
+   * and force constraints, so the next ResolveNLP()/SolvePersistent()
+   * sees the new elevation data warm-started from the current solution.
+   * The problem structure is unchanged by design; call between solves,
+   * not while one is running (@sa SolveAsync()).
+   */
+  void SwapTerrain(const HeightMap::Ptr& terrain);
+
+  /**
+   * @brief Snapshots the constructed problem's variable values to a file.
+   * @param path  The file to (over-)write.
+   * @throws std::runtime_error if the file cannot be written.
+   *
+   * Writes a small versioned binary file holding the values of every
+   * variable set (nodes, phase durations) plus the structure fingerprint
+   * of the problem, each vector dumped in one contiguous block. Together
+   * with RestoreProblemState() this allows reproducing or resuming a
+   * production solve in milliseconds instead of replaying the inputs
+   * that led to it. Requires a constructed problem (@sa SolveNLP()).
+   */
+  void SaveProblemState(const std::string& path) const;
+
+  /**
+   * @brief Restores variable values saved with SaveProblemState().
+   * @param path  The file written by SaveProblemState().
+   * @throws std::runtime_error if the file is invalid or was taken from a
+   *         differently structured problem.
+   *
+   * The same problem must be configured first through SetInitialState()
+   * and SetParameters(); the model, terrain and parameters themselves are
+   * not part of the snapshot, only checked against it via the structure
+   * fingerprint. The problem is built if necessary and every variable set
+   * is loaded with its stored values, so GetSolution() returns the
+   * snapshotted trajectory immediately and ResolveNLP() resumes solving
+   * from it. Solver-internal state (e.g. the barrier parameter) is not
+   * restorable through ifopt and restarts fresh.
+   */
+  void RestoreProblemState(const std::string& path);
+
+  /**
+   * @brief Turns per-constraint/cost evaluation profiling on or off.
+   *
+   * Off by default; when off the instrumentation costs a single branch
+   * per evaluation, so it is safe to leave compiled into planners.
+   */
+  void SetProfilingEnabled(bool enable);
+
+  /**
+   * @brief Records every constraint/cost evaluation as a timed span.
+   * @param trace  The trace buffer receiving the spans; nullptr stops
+   *               the recording.
+   *
+   * While GetEvaluationStats() only shows totals, the trace keeps the
+   * individual evaluations with their timestamps, so a pathological
+   * solver iteration can be spotted on a timeline. Export it with
+   * EvaluationTrace::WriteChromeTrace() and open the file in
+   * chrome://tracing, Perfetto or speedscope. Recording costs a few
+   * stores per evaluation, toggled at runtime like profiling.
+   */
+  void SetEvaluationTrace(const EvaluationTrace::Ptr& trace);
+
+  /**
+   * @brief Packs each built problem's objects into one memory arena.
+   *
+   * Off by default. When on, the variable, constraint and cost sets of
+   * every subsequently built problem are allocated back-to-back in a
+   * single arena instead of individually on the heap, which keeps the
+   * per-iteration traversal of the problem graph cache-friendly and
+   * removes the allocation churn of rapid construct/solve/discard
+   * cycles (receding-horizon replanning). The arena is released as a
+   * whole once the problem it holds is dropped.
+   */
+  void SetArenaAllocation(bool enable);
+
+  /**
+   * @brief Runs every evaluation path once right after problem construction.
+   *
+   * Off by default. The scratch buffers of the constraints and splines
+   * (triplet buffers, Jacobian workspaces, shared state grids) are grown
+   * on demand, so the first solver iterations otherwise pay their
+   * allocations. When on, SolveNLP() evaluates the constraint values,
+   * bounds, Jacobian and cost gradient once at the initial variables
+   * before handing the problem to the solver, which brings all towr-side
+   * buffers to their final capacity up front. This trades one extra
+   * evaluation pass per construction for allocation-free, deterministic
+   * iterations, which matters in soft-realtime replanning loops.
+   *
+   * Backing the prewarmed memory with huge pages is left to the process
+   * environment (e.g. transparent huge pages); this only removes the
+   * on-demand growth.
+   */
+  void SetPrewarmEnabled(bool enable);
+
+  /**
+   * @brief Accounts per-subsystem heap usage into the given tally.
+   * @param tally  Receives live/peak bytes per subsystem; nullptr (the
+   *               default) disables the accounting.
+   *
+   * After every SolveNLP() the capacities of the node variables, splines
+   * and constraint workspaces are snapshotted into the tally, so across a
+   * session of solves it reports where the peak memory of a planner
+   * instance goes (@sa MemoryTally). One-off measurements are also part
+   * of GetProblemStats() without attaching anything here.
+   */
+  void SetMemoryTally(const MemoryTally::Ptr& tally);
+
+  /// Receives each log message as one string (@sa SetLogSink()).
+  using LogSink = std::function<void(const std::string&)>;
+
+  /**
+   * @brief Routes all of towr's logging through the given sink.
+   * @param sink  Called with one string per message; nullptr (the default)
+   *              disables logging altogether.
+   *
+   * By default nothing is printed: console I/O inside the solve path
+   * measurably slows short solves while producing nothing machine-readable
+   * (the numbers a dashboard wants are in the SolveResult instead). With a
+   * sink installed, the version banner and the per-solve problem report
+   * are formatted and handed to it; without one, not even the formatting
+   * happens.
+   */
+  void SetLogSink(const LogSink& sink);
+
+  /**
+   * @returns Wall time and call counts per constraint/cost of the last
+   *          solve, keyed on the set name.
+   *
+   * Requires SetProfilingEnabled(true) before SolveNLP(), otherwise all
+   * counters are zero. Shows which constraint eats the solve time.
+   */
+  std::map<std::string, EvaluationStats> GetEvaluationStats() const;
+
 private:
   /**
    * @brief The solver independent optimization problem formulation.
@@ -126,10 +553,67 @@ private:
 
   NlpFactory factory_;
 
+  bool nlp_built_ = false; ///< true once SolveNLP() constructed the problem.
+
+  /// the structure of the problem built by the last SolveNLP() call
+  /// (@sa GetStructureFingerprint(), SolvePersistent()).
+  std::vector<double> structure_fingerprint_;
+
+  /**
+   * @returns Everything in the current parameters that determines the
+   *          problem dimensions and Jacobian sparsity.
+   */
+  std::vector<double> GetStructureFingerprint() const;
+
+  SolveMonitor::Ptr monitor_; ///< hook of the currently running async solve.
+
+  TelemetryBuffer::Ptr telemetry_; ///< receives per-evaluation samples, if set.
+
+  SolutionCache::Ptr solution_cache_; ///< remembers recurring scenarios, if set.
+
+  IterateStore::Ptr iterate_store_; ///< compressed iterate history, if set.
+
+  /// per constraint set the report at the last solve's final iterate
+  /// (@sa GetConstraintReports()).
+  std::map<std::string, ConstraintReport> constraint_reports_;
+
+  bool prewarm_ = false; ///< run one evaluation pass after construction.
+
+  LogSink log_sink_; ///< receives all log output; logging is off while unset.
+
+  MemoryTally::Ptr memory_tally_; ///< per-subsystem memory report, if set.
+
+  /**
+   * @brief Snapshots the subsystems' heap capacities into the tally.
+   * @param nlp  The constructed problem whose components are measured.
+   */
+  void AccountMemory(ifopt::Problem& nlp, MemoryTally& tally) const;
+
+  /**
+   * @brief Hands the problem report of PrintCurrent() to the log sink.
+   *
+   * Does nothing -- not even the formatting -- while no sink is installed.
+   */
+  void LogProblemSummary();
+
+  /**
+   * @brief Evaluates every constraint/cost path of the built problem once,
+   *        so all lazily grown buffers reach their final capacity
+   *        (@sa SetPrewarmEnabled()).
+   */
+  void PrewarmNLP();
+
+  /**
+   * @returns The current scenario, quantized for cache lookup
+   *          (@sa SetSolutionCache()).
+   */
+  SolutionCache::Key GetCacheKey() const;
+
   /**
    * @returns the solver independent optimization problem.
+   * @param factory  Builds the variables, constraints and costs.
    */
-  ifopt::Problem BuildNLP();
+  static ifopt::Problem BuildNLP(NlpFactory& factory);
 };
 
 } /* namespace towr */
@@ -0,0 +1,120 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef TOWR_TRAJECTORY_IO_H_
+#define TOWR_TRAJECTORY_IO_H_
+
+#include <string>
+#include <vector>
+
+#include <towr/variables/spline_holder.h>
+#include <towr/variables/state.h>
+
+namespace towr {
+
+/**
+ * @brief One sampled instant of an optimized trajectory.
+ *
+ * The base orientation is given as Euler angles (x,y,z and derivatives),
+ * matching the parameterization towr optimizes over.
+ *
+ * @sa TrajectoryIo
+ */
+struct TrajectoryState {
+  double t_;                ///< global time [s] along the trajectory.
+  State base_lin_{3,3};     ///< linear base position/velocity/acceleration.
+  State base_ang_{3,3};     ///< Euler angles and derivatives of the base.
+  std::vector<State> ee_motion_;            ///< endeffector motion per foot.
+  std::vector<Eigen::Vector3d> ee_force_;   ///< contact force per foot.
+  std::vector<bool> ee_contact_;            ///< whether each foot is in contact.
+};
+
+/**
+ * @brief Writes an optimized trajectory as a compact binary file.
+ *
+ * The file holds a small header followed by packed fixed-stride state
+ * records, assembled in memory and written in one chunk. Compared to
+ * serializing tens of thousands of individual messages this makes the
+ * export time negligible next to the solve. The file is read back with
+ * TrajectoryReader.
+ */
+class TrajectoryIo {
+public:
+  /**
+   * @brief Samples the solution and writes it to the given file.
+   * @param path      The file to (over-)write.
+   * @param solution  The optimized splines (@sa TOWR::GetSolution()).
+   * @param dt        The sampling interval [s].
+   * @throws std::runtime_error if the file cannot be written.
+   */
+  static void Write(const std::string& path, const SplineHolder& solution,
+                    double dt);
+};
+
+/**
+ * @brief Reads a trajectory file written by TrajectoryIo.
+ *
+ * The file is mapped read-only into memory, so construction does not copy
+ * the state records; they are unpacked on access.
+ */
+class TrajectoryReader {
+public:
+  /**
+   * @brief Maps the given trajectory file into memory.
+   * @throws std::runtime_error if the file cannot be opened or is invalid.
+   */
+  explicit TrajectoryReader(const std::string& path);
+  virtual ~TrajectoryReader();
+
+  int GetStateCount() const;
+  int GetEECount() const;
+  double GetDt() const; ///< the sampling interval [s] used when writing.
+
+  /**
+   * @returns The k-th sampled state, 0 <= k < GetStateCount().
+   */
+  TrajectoryState GetState(int k) const;
+
+private:
+  const double* records_; ///< the packed state records of the mapped file.
+  void* mapped_ = nullptr;
+  std::size_t mapped_size_ = 0;
+
+  int n_states_;
+  int n_ee_;
+  double dt_;
+
+  // the mapping is tied to this object's lifetime
+  TrajectoryReader(const TrajectoryReader&) = delete;
+  TrajectoryReader& operator=(const TrajectoryReader&) = delete;
+};
+
+} /* namespace towr */
+
+#endif /* TOWR_TRAJECTORY_IO_H_ */
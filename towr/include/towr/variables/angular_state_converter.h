@@ -0,0 +1,142 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef TOWR_VARIABLES_ANGULAR_STATE_CONVERTER_H_
+#define TOWR_VARIABLES_ANGULAR_STATE_CONVERTER_H_
+
+#include <array>
+#include <memory>
+
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+
+#include "cartesian_dimensions.h"
+
+namespace towr {
+
+/**
+ * @brief Interprets a 3-dimensional node spline as a base orientation.
+ *
+ * The base orientation is optimized over as a spline of plain 3-dimensional
+ * node values, but the constraints reason about rotation matrices, angular
+ * velocities and angular accelerations. How the node values map to these
+ * quantities depends on the chosen parameterization: EulerConverter reads
+ * them as Euler-ZYX angles, RotationVectorConverter as exponential-map
+ * rotation vectors. This interface lets the constraints and the dynamic
+ * model work with either without knowing which one is active.
+ *
+ * All Jacobians are with respect to the node values defining the underlying
+ * spline, so a converter can be swapped without touching the sensitivity
+ * bookkeeping of its users.
+ */
+class AngularStateConverter {
+public:
+  using Ptr         = std::shared_ptr<AngularStateConverter>;
+  using Vector3d    = Eigen::Vector3d;
+
+  using JacobianRow  = Eigen::SparseVector<double, Eigen::RowMajor>;
+  using MatrixSXd    = Eigen::SparseMatrix<double, Eigen::RowMajor>;
+  using Jacobian     = MatrixSXd;
+  using JacRowMatrix = std::array<std::array<JacobianRow, k3D>, k3D>;
+
+  AngularStateConverter () = default;
+  virtual ~AngularStateConverter () = default;
+
+  /**
+   * @brief The orientation at time t as a rotation matrix.
+   * @param t The current time in the orientation spline.
+   * @return A 3x3 rotation matrix that maps a vector from base to world frame.
+   */
+  virtual MatrixSXd GetRotationMatrixBaseToWorld(double t) const = 0;
+
+  /**
+   * @brief The angular velocity at time t.
+   * @param t The current time in the orientation spline.
+   * @return A 3-dim vector (x,y,z) of the angular velocities in world frame.
+   */
+  virtual Vector3d GetAngularVelocityInWorld(double t) const = 0;
+
+  /**
+   * @brief The angular acceleration at time t.
+   * @param t The current time in the orientation spline.
+   * @return A 3-dim vector (x,y,z) of the angular accelerations in world frame.
+   */
+  virtual Vector3d GetAngularAccelerationInWorld(double t) const = 0;
+
+  /**
+   * @brief Jacobian of the angular velocity with respect to the node values.
+   * @param t  The current time in the orientation spline.
+   * @return  The 3xn Jacobian Matrix of derivatives.
+   *          3: because angular velocity has an x,y,z component.
+   *          n: the number of optimized node values defining the spline.
+   */
+  virtual Jacobian GetDerivOfAngVelWrtNodes(double t) const = 0;
+
+  /**
+   * @brief Jacobian of the angular acceleration w.r.t the node values.
+   * @param t  The current time in the orientation spline.
+   * @return The 3xn Jacobian Matrix of derivatives.
+   *          3: because angular acceleration has an x,y,z component
+   *          n: the number of optimized node values defining the spline.
+   */
+  virtual Jacobian GetDerivOfAngAccWrtNodes(double t) const = 0;
+
+  /** @brief Returns the derivative of result of the linear equation M*v.
+   *
+   * M is the rotation matrix from base to world defined by the orientation
+   * nodes. v is any vector independent of those nodes. The sensitivity
+   * of the 3-dimensional vector w.r.t the node values is given.
+   *
+   * @param t        time at which the orientation spline is evaluated.
+   * @param v        vector (e.g. relative position, velocity, acceleration).
+   * @param inverse  if true, the derivative for M^(-1)*v is evaluated.
+   * @returns        3 x n dimensional matrix (n = number of node values).
+   */
+  virtual Jacobian DerivOfRotVecMult(double t, const Vector3d& v,
+                                     bool inverse) const = 0;
+
+  /** @brief matrix of derivatives of each cell w.r.t node values.
+   *
+   * This 2d-array has the same dimensions as the rotation matrix M_IB, but
+   * each cell if filled with a row vector.
+   */
+  virtual JacRowMatrix GetDerivativeOfRotationMatrixWrtNodes(double t) const = 0;
+
+  /**
+   * @brief The update counter of the underlying orientation spline.
+   *
+   * Lets callers key their own caches on the spline state
+   * (@sa Spline::GetUpdateCount()).
+   */
+  virtual int GetUpdateCount() const = 0;
+};
+
+} /* namespace towr */
+
+#endif /* TOWR_VARIABLES_ANGULAR_STATE_CONVERTER_H_ */
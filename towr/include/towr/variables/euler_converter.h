@@ -27,14 +27,15 @@ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 ******************************************************************************/
 
-#ifndef TOWR_VARIABLES_ANGULAR_STATE_CONVERTER_H_
-#define TOWR_VARIABLES_ANGULAR_STATE_CONVERTER_H_
+#ifndef TOWR_VARIABLES_EULER_CONVERTER_H_
+#define TOWR_VARIABLES_EULER_CONVERTER_H_
 
 #include <array>
 
 #include <Eigen/Dense>
 #include <Eigen/Sparse>
 
+#include "angular_state_converter.h"
 #include "cartesian_dimensions.h"
 #include "node_spline.h"
 
@@ -59,17 +60,11 @@ namespace towr {
  *
  * See matlab script "matlab/euler_converter.m" for derivation.
  */
-class EulerConverter {
+class EulerConverter : public AngularStateConverter {
 public:
-  using Vector3d    = Eigen::Vector3d;
   using EulerAngles = Vector3d; ///< roll, pitch, yaw.
   using EulerRates  = Vector3d; ///< derivative of the above
 
-  using JacobianRow = Eigen::SparseVector<double, Eigen::RowMajor>;
-  using MatrixSXd   = Eigen::SparseMatrix<double, Eigen::RowMajor>;
-  using Jacobian    = MatrixSXd;
-  using JacRowMatrix = std::array<std::array<JacobianRow, k3D>, k3D>;
-
   EulerConverter () = default;
 
   /**
@@ -102,7 +97,7 @@ public:
    * @param t The current time in the euler angles spline.
    * @return A 3x3 rotation matrix that maps a vector from base to world frame.
    */
-  MatrixSXd GetRotationMatrixBaseToWorld(double t) const;
+  MatrixSXd GetRotationMatrixBaseToWorld(double t) const override;
 
   /** @see GetRotationMatrixBaseToWorld(t)  */
   static MatrixSXd GetRotationMatrixBaseToWorld(const EulerAngles& xyz);
@@ -112,14 +107,14 @@ public:
    * @param t The current time in the euler angles spline.
    * @return A 3-dim vector (x,y,z) of the angular velocities in world frame.
    */
-  Vector3d GetAngularVelocityInWorld(double t) const;
+  Vector3d GetAngularVelocityInWorld(double t) const override;
 
   /**
    * @brief Converts Euler angles, rates and rate derivatives  o angular accelerations.
    * @param t The current time in the euler angles spline.
    * @return A 3-dim vector (x,y,z) of the angular accelerations in world frame.
    */
-  Vector3d GetAngularAccelerationInWorld(double t) const;
+  Vector3d GetAngularAccelerationInWorld(double t) const override;
 
   /**
    * @brief Jacobian of the angular velocity with respect to the Euler nodes.
@@ -139,6 +134,14 @@ public:
    */
   Jacobian GetDerivOfAngAccWrtEulerNodes(double t) const;
 
+  /** @see GetDerivOfAngVelWrtEulerNodes(t), under its parameterization-neutral
+   *  name (@sa AngularStateConverter). */
+  Jacobian GetDerivOfAngVelWrtNodes(double t) const override { return GetDerivOfAngVelWrtEulerNodes(t); };
+
+  /** @see GetDerivOfAngAccWrtEulerNodes(t), under its parameterization-neutral
+   *  name (@sa AngularStateConverter). */
+  Jacobian GetDerivOfAngAccWrtNodes(double t) const override { return GetDerivOfAngAccWrtEulerNodes(t); };
+
   /** @brief Returns the derivative of result of the linear equation M*v.
    *
    * M is the rotation matrix from base to world, defined by the Euler nodes.
@@ -150,14 +153,52 @@ public:
    * @param inverse  if true, the derivative for M^(-1)*v is evaluated.
    * @returns        3 x n dimensional matrix (n = number of Euler node values).
    */
-  Jacobian DerivOfRotVecMult(double t, const Vector3d& v, bool inverse) const;
+  Jacobian DerivOfRotVecMult(double t, const Vector3d& v, bool inverse) const override;
 
   /** @see GetQuaternionBaseToWorld(t)  */
   static Eigen::Quaterniond GetQuaternionBaseToWorld(const EulerAngles& pos);
 
+  /** @brief matrix of derivatives of each cell w.r.t node values.
+   *
+   * This 2d-array has the same dimensions as the rotation matrix M_IB, but
+   * each cell if filled with a row vector.
+   */
+  JacRowMatrix GetDerivativeOfRotationMatrixWrtNodes(double t) const override;
+
+  /**
+   * @brief The update counter of the underlying Euler-angle spline.
+   *
+   * Lets callers key their own caches on the spline state
+   * (@sa Spline::GetUpdateCount()).
+   */
+  int GetUpdateCount() const override { return euler_->GetUpdateCount(); };
+
 private:
   NodeSpline::Ptr euler_;
 
+  /// Dense 3xN scratch for the angular-derivative accumulation. Sparse
+  /// row surgery is slow in Eigen, so the node Jacobians are accumulated
+  /// densely (N is the node count, a few tens) and converted to the
+  /// sparse type once where the constraint interface requires it.
+  using MatrixRXd = Eigen::Matrix<double, 3, Eigen::Dynamic, Eigen::RowMajor>;
+  using RowVecXd  = Eigen::Matrix<double, 1, Eigen::Dynamic>;
+
+  /**
+   * @brief Sine and cosine of the Euler angles, computed once per query.
+   *
+   * M, Mdot, the rotation matrix and all their node derivatives are
+   * assembled from these six values, so each trig function is evaluated
+   * once per query time instead of once per matrix entry.
+   */
+  struct TrigState {
+    double sx_, cx_; ///< sine/cosine of the roll angle.
+    double sy_, cy_; ///< sine/cosine of the pitch angle.
+    double sz_, cz_; ///< sine/cosine of the yaw angle.
+  };
+
+  /** @brief Evaluates sine and cosine of the given Euler angles. */
+  static TrigState GetTrig(const EulerAngles& xyz);
+
   // Internal calculations for the conversion from euler rates to angular
   // velocities and accelerations. These are done using the matrix M defined
   // here: http://docs.leggedrobotics.com/kindr/cheatsheet_latest.pdf
@@ -166,37 +207,52 @@ private:
    *
    * Make sure euler rates are ordered roll-pitch-yaw. They are however applied
    * in the order yaw-pitch-role to determine the angular velocities.
+   *
+   * Built as a small dense kernel; converted to sparse only where needed
+   * for the node-Jacobian products.
    */
-  static MatrixSXd GetM(const EulerAngles& xyz);
+  static Eigen::Matrix3d GetM(const EulerAngles& xyz);
+
+  /** @see GetM(xyz), assembled from precomputed trig values. */
+  static Eigen::Matrix3d GetM(const TrigState& trig);
 
   /**
    *  @brief time derivative of GetM()
    */
-  static MatrixSXd GetMdot(const EulerAngles& xyz, const EulerRates& xyz_d);
+  static Eigen::Matrix3d GetMdot(const EulerAngles& xyz, const EulerRates& xyz_d);
+
+  /** @see GetMdot(xyz, xyz_d), assembled from precomputed trig values. */
+  static Eigen::Matrix3d GetMdot(const TrigState& trig, const EulerRates& xyz_d);
+
+  /** @see GetRotationMatrixBaseToWorld(xyz), from precomputed trig values. */
+  static MatrixSXd GetRotationMatrixBaseToWorld(const TrigState& trig);
 
   /**
    *  @brief Derivative of the @a dim row of matrix M with respect to
    *         the node values.
    *
    *  @param dim  Which dimension of the angular acceleration is desired.
-   *  @returns    the Jacobian w.r.t the coefficients for each of the 3 rows
-   *              of the matrix stacked on top of each other.
+   *  @returns    the dense Jacobian w.r.t the coefficients for each of the
+   *              3 rows of the matrix stacked on top of each other.
    */
-  Jacobian GetDerivMwrtNodes(double t, Dim3D dim) const;
+  MatrixRXd GetDerivMwrtNodes(double t, Dim3D dim) const;
 
   /** @brief Derivative of the @a dim row of the time derivative of M with
    *         respect to the node values.
    *
    *  @param dim Which dimension of the angular acceleration is desired.
    */
-  Jacobian GetDerivMdotwrtNodes(double t, Dim3D dim) const;
+  MatrixRXd GetDerivMdotwrtNodes(double t, Dim3D dim) const;
 
-  /** @brief matrix of derivatives of each cell w.r.t node values.
+  /**
+   * @brief Converts a densely accumulated Jacobian to the sparse type.
    *
-   * This 2d-array has the same dimensions as the rotation matrix M_IB, but
-   * each cell if filled with a row vector.
+   * Every output row mixes all three euler dimensions, so each row's
+   * column support is the union of the spline band columns over the dims.
+   * Zeros inside that band stay explicit entries, since they can turn
+   * nonzero as the orientation changes (the band itself cannot).
    */
-  JacRowMatrix GetDerivativeOfRotationMatrixWrtNodes(double t) const;
+  Jacobian ToSparseAtBoundary(double t, const MatrixRXd& dense) const;
 
   /** @see GetAngularAccelerationInWorld(t)  */
   static Vector3d GetAngularAccelerationInWorld(State euler);
@@ -207,8 +263,59 @@ private:
 
   JacobianRow GetJac(double t, Dx deriv, Dim3D dim) const;
   Jacobian jac_wrt_nodes_structure_;
+
+  /**
+   * @brief Memoized orientation quantities for the most recent query time.
+   *
+   * The constraints query the same time t many times per solver iteration
+   * (state, rotation matrix, M, Mdot, node Jacobians), and all of these
+   * derive from euler_->GetPoint(t). So they are computed once per query
+   * time and invalidated through the spline's update counter when the
+   * optimization variables change.
+   */
+  struct Cache {
+    double t_    = -1.0; ///< the query time the entries belong to.
+    int    epoch_ = -1;  ///< spline update count at computation time.
+
+    State ori_ = State(k3D, 3);
+    TrigState trig_;            ///< sin/cos of the angles, feeds all matrices.
+    Eigen::Matrix3d M_, Mdot_;  ///< dense kernels for the value products.
+    MatrixSXd M_sp_, Mdot_sp_;  ///< sparse views for the Jacobian products.
+    MatrixSXd w_R_b_;
+    bool trig_valid_    = false;
+    bool M_valid_       = false;
+    bool Mdot_valid_    = false;
+    bool M_sp_valid_    = false;
+    bool Mdot_sp_valid_ = false;
+    bool w_R_b_valid_   = false;
+
+    std::array<Jacobian, 3> jac_wrt_nodes_; ///< indexed by kPos, kVel, kAcc.
+    std::array<bool, 3> jac_valid_ = {{false, false, false}};
+  };
+  mutable Cache cache_;
+
+  /** @brief The Euler state at time t, computed once per (t, iteration). */
+  const State& GetCachedState(double t) const;
+
+  /** @see GetTrig(xyz), memoized for the query time. */
+  const TrigState& GetTrigCached(double t) const;
+
+  /** @see GetM(xyz), memoized for the query time. */
+  const Eigen::Matrix3d& GetMCached(double t) const;
+
+  /** @see GetMdot(xyz, xyz_d), memoized for the query time. */
+  const Eigen::Matrix3d& GetMdotCached(double t) const;
+
+  /** @brief Sparse view of GetMCached() for the node-Jacobian products. */
+  const MatrixSXd& GetMSparseCached(double t) const;
+
+  /** @brief Sparse view of GetMdotCached() for the node-Jacobian products. */
+  const MatrixSXd& GetMdotSparseCached(double t) const;
+
+  /** @brief The Euler-spline Jacobian at time t, memoized per derivative. */
+  const Jacobian& GetJacobianWrtNodesCached(double t, Dx deriv) const;
 };
 
 } /* namespace towr */
 
-#endif /* TOWR_VARIABLES_ANGULAR_STATE_CONVERTER_H_ */
+#endif /* TOWR_VARIABLES_EULER_CONVERTER_H_ */
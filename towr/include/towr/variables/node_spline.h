@@ -88,11 +88,48 @@ public:
    */
   Jacobian GetJacobianWrtNodes(int poly_id, double t_local, Dx dxdt) const;
 
+  /**
+   * @brief The Jacobians w.r.t. the nodes at multiple times in one pass.
+   * @param ts  The times along the spline, sorted ascending.
+   * @param dxdt  Whether the derivative of the pos, vel or acc is desired.
+   * @return One pxn Jacobian per requested time.
+   *
+   * Walks the polynomial segments monotonically once, amortizing the
+   * segment lookup over the whole time grid (@sa Spline::GetPoints()).
+   */
+  std::vector<Jacobian> GetJacobiansWrtNodes(const VecTimes& ts, Dx dxdt) const;
+
+  /**
+   * @brief The Jacobian w.r.t. nodes as a dense block of its active columns.
+   * @param t  The time along the spline at which the sensitivity is required.
+   * @param dxdt  Whether the derivative of the pos, vel or acc is desired.
+   * @param[out] jac  Dense p x w block holding columns
+   *                  [col_start, col_start+w); w is the band width of the
+   *                  polynomial active at t and zero if it touches no
+   *                  optimization variables.
+   * @param[out] col_start  The first column of the window.
+   *
+   * At any instant only the columns of the two bounding nodes are nonzero,
+   * so consumers multiplying this Jacobian through their chain rule can
+   * work on this narrow window instead of the full variable width, which
+   * grows linearly with the plan horizon.
+   */
+  void GetJacobianWrtNodesWindow(double t, Dx dxdt,
+                                 Eigen::MatrixXd& jac, int& col_start) const;
+
   /**
    * @returns The number of node variables being optimized over.
    */
   int GetNodeVariablesCount() const;
 
+  /**
+   * @returns Estimated heap bytes of the polynomials and Jacobian tables.
+   *
+   * Snapshot for the per-subsystem memory report
+   * (@sa TOWR::GetProblemStats()).
+   */
+  std::size_t GetHeapBytes() const;
+
   /**
    * @brief How the spline position changes when the polynomial durations change.
    * @param t  The time along the spline at which the sensitivity is required.
@@ -109,6 +146,42 @@ protected:
    */
   mutable Jacobian jac_wrt_nodes_structure_;
 
+  /**
+   * One value of a polynomial's banded Jacobian: which compressed slot it
+   * adds to and which of the four boundary sensitivities it carries.
+   */
+  struct BandEntry {
+    int slot;  ///< position in the compressed value array of the pattern.
+    int dwrt;  ///< index of the carried boundary sensitivity, flattened
+               ///< as 2*side + derivative (start/end node, pos/vel).
+    int row;   ///< the spline dimension of the entry.
+    int col;   ///< the optimization-variable column of the entry.
+  };
+
+  /**
+   * The banded Jacobian of one polynomial w.r.t the node values.
+   *
+   * Each row touches exactly the two nodes bounding the polynomial, and
+   * every nonzero carries one of only four scalars: the sensitivity w.r.t
+   * position or velocity of the start or end node. The tables encode only
+   * which nodes bound each polynomial and their optimization columns,
+   * which neither node-value nor phase-duration updates change, so all of
+   * them are assembled once at construction; an evaluation computes the
+   * four scalars and scatters them through the flat entry table, never
+   * touching the general sparse machinery or the node-info accessors.
+   * The sparse form is what the ifopt boundary expects.
+   */
+  struct PolyJacBand {
+    Jacobian pattern;               ///< compressed sparsity of the band.
+    std::vector<BandEntry> entries; ///< fixed value-to-slot mapping.
+    int col_min = 0;                ///< first column touched by the band.
+    int col_max = -1;               ///< last column touched by the band.
+  };
+  mutable std::vector<PolyJacBand> jac_wrt_nodes_band_per_poly_;
+
+  /** @brief Assembles sparsity and slot mapping of one polynomial's band. */
+  void BuildJacobianBand(int poly_id, PolyJacBand& band) const;
+
   /**
    * @brief Fills specific elements of the Jacobian with respect to nodes.
    * @param poly_id  The ID of the polynomial for which to get the sensitivity.
@@ -37,6 +37,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 namespace towr {
 
+class Spline;
 
 /**
  * @brief Position and velocity of nodes used to generate a Hermite spline.
@@ -93,12 +94,18 @@ public:
    */
   virtual std::vector<NodeValueInfo> GetNodeInfoAtOptIndex(int idx) const;
 
+  /// Returned by GetOptIndex() for node values not optimized over.
+  static const int NodeValueNotOptimized = -1;
+
   /**
    * @brief Index in the optimization vector for a specific nodes' pos/vel.
    * @param nvi Description of node value we want to know the index for.
-   * @return The position of this node value in the optimization variables.
+   * @return The position of this node value in the optimization variables,
+   *         or NodeValueNotOptimized if it is not optimized over (e.g. a
+   *         fixed value of a constant phase node).
    *
-   * Reverse of GetNodeInfoAtOptIndex().
+   * Reverse of GetNodeInfoAtOptIndex(), answered from a lookup table built
+   * once per variable set.
    */
   int GetOptIndex(const NodeValueInfo& nvi) const;
 
@@ -108,10 +115,24 @@ public:
    * Not all node position and velocities are independent or optimized over, so
    * usually the number of optimization variables is less than all nodes' pos/vel.
    *
+   * The values are kept in a contiguous vector in optimization-variable
+   * layout, so this is a plain copy and requires no gathering.
+   *
    * @sa GetNodeInfoAtOptIndex()
    */
   VectorXd GetValues () const override;
 
+  /**
+   * @brief Zero-copy access to the optimization variables.
+   *
+   * Same values as GetValues(), but handed out as a reference to the
+   * internal contiguous buffer instead of a copy. The ifopt interface
+   * forces GetValues() to return by value, so in-process consumers that
+   * only read the vector should prefer this accessor. The reference is
+   * invalidated by the next SetVariables() or node initialization.
+   */
+  const VectorXd& GetValuesRef() const;
+
   /**
    * @brief Sets some node positions and velocity from the optimization variables.
    * @param x The optimization variables.
@@ -129,6 +150,34 @@ public:
    */
   VecBound GetBounds () const override;
 
+  /**
+   * @brief Zero-copy access to the bounds.
+   *
+   * Same entries as GetBounds(), but handed out as a reference to the
+   * internal vector instead of a copy. The ifopt interface forces
+   * GetBounds() to return by value, so in-process consumers that only
+   * read the bounds should prefer this accessor.
+   */
+  const VecBound& GetBoundsRef() const;
+
+  /**
+   * @brief Presents the variables to the solver divided by @a scale.
+   * @param scale  The typical magnitude of the node values (e.g. the
+   *               nominal stance force for force nodes), > 0.
+   *
+   * Forces (hundreds of newtons) and positions (meters) otherwise live
+   * unscaled in the same variable vector, which costs solver iterations.
+   * The nodes themselves and everything computed from them stay in
+   * physical units; only the values, bounds and Jacobian columns at the
+   * solver boundary are scaled. Set before the first solver query and
+   * keep it fixed for the lifetime of the problem.
+   */
+  void SetVariableScaling(double scale);
+
+  /// The factor physical node values are divided by at the solver
+  /// boundary; Jacobian columns of this set must be multiplied by it.
+  double GetVariableScaling() const { return scale_; };
+
   /**
    * @returns All the nodes that can be used to reconstruct the spline.
    */
@@ -144,6 +193,17 @@ public:
    */
   const std::vector<Node> GetBoundaryNodes(int poly_id) const;
 
+  /**
+   * @returns The ids of the nodes whose values changed in the most recent
+   *          SetVariables() call, sorted ascending.
+   *
+   * During line search the solver often perturbs only few variables, so
+   * observers can restrict their updates to the affected nodes. Before the
+   * first SetVariables() (e.g. right after initialization) all node ids
+   * are returned, since no change information exists yet.
+   */
+  std::vector<int> GetChangedNodeIds() const;
+
   enum Side {Start=0, End};
   /**
    * @brief The node ID that belongs to a specific side of a specific polynomial.
@@ -173,6 +233,49 @@ public:
                                   const VectorXd& final_pos,
                                   double t_total);
 
+  /**
+   * @brief Sets nodes pos/vel by sampling an existing spline.
+   * @param spline  The spline to sample, e.g. from a previous solution.
+   * @param poly_durations  The durations of the polynomials these nodes will
+   *                        be combined with, defining the time of each node.
+   * @param t_offset  Time [s] by which the sampling is shifted into the
+   *                  spline, e.g. the replan interval when warm-starting a
+   *                  receding-horizon solve.
+   *
+   * Node times beyond the total duration of the spline are initialized
+   * with the final state of the spline.
+   */
+  void InitializeNodesFromSpline(const Spline& spline,
+                                 const VecDurations& poly_durations,
+                                 double t_offset = 0.0);
+
+  /**
+   * @brief Sets nodes pos/vel by least-squares fitting a sampled trajectory.
+   * @param t_sample  The time [s] of each sample, ascending, starting at zero.
+   * @param pos_sample  The position of each sample (same n_dim as the nodes).
+   * @param poly_durations  The durations of the polynomials these nodes will
+   *                        be combined with, defining the time of each node.
+   *
+   * In contrast to InitializeNodesTowardsGoal(), this seeds the spline from
+   * a reference trajectory, e.g. a logged execution of a similar motion.
+   * The node positions and velocities are chosen so the resulting Hermite
+   * spline fits the samples best in the least-squares sense. For a
+   * well-posed fit the reference should contain a few samples per
+   * polynomial; sample times beyond the node times are clamped.
+   */
+  void InitializeNodesFromReference(const std::vector<double>& t_sample,
+                                    const std::vector<VectorXd>& pos_sample,
+                                    const VecDurations& poly_durations);
+
+  /**
+   * @brief Overwrites every node with the given values.
+   * @param nodes  One Node (position and velocity) per spline node.
+   *
+   * For initialization stages that compute the node values directly,
+   * e.g. the foothold presolve (@sa Parameters::PresolveFootholds()).
+   */
+  void SetAllNodes(const std::vector<Node>& nodes);
+
   /**
    * @brief Restricts the first node in the spline.
    * @param deriv Which derivative (pos,vel,...) should be restricted.
@@ -191,6 +294,28 @@ public:
   void AddFinalBound(Dx deriv, const std::vector<int>& dimensions,
                      const VectorXd& val);
 
+  /**
+   * @brief Pins entire nodes to the given values through equality bounds.
+   * @param node_ids  The IDs of the nodes to pin.
+   * @param values    The position and velocity to pin each node to
+   *                  (same length as @a node_ids).
+   *
+   * Batched variant of AddStartBound()/AddFinalBound() covering position,
+   * velocity and all dimensions of each listed node in one pass, e.g. to
+   * hold part of a previous solution fixed when re-solving. Values not
+   * optimized over are skipped.
+   */
+  void SetNodeEqualityBounds(const std::vector<int>& node_ids,
+                             const std::vector<Node>& values);
+
+  /**
+   * @returns Estimated heap bytes held by this variable set.
+   *
+   * Capacity-based snapshot of the node storage, bounds and index caches,
+   * feeding the per-subsystem memory report (@sa TOWR::GetProblemStats()).
+   */
+  virtual std::size_t GetHeapBytes() const;
+
 protected:
   /**
    * @param n_dim  The number of dimensions (x,y,..) each node has.
@@ -215,6 +340,36 @@ private:
   std::vector<Node> nodes_;
   int n_dim_;
 
+  std::vector<int> changed_node_ids_; ///< nodes changed by last SetVariables().
+  bool all_nodes_changed_ = true;     ///< true until change tracking starts.
+
+  mutable VectorXd x_;           ///< scaled node values in optimization-variable layout.
+  mutable bool x_valid_ = false; ///< whether x_ mirrors the current node values.
+
+  double scale_ = 1.0; ///< @sa SetVariableScaling().
+  mutable VecBound scaled_bounds_;            ///< bounds_ divided by scale_.
+  mutable bool scaled_bounds_valid_ = false;  ///< rebuilt when bounds change.
+
+  /**
+   * @returns The cached mapping from optimization index to node values.
+   *
+   * The mapping is fixed once the variable set is constructed, so the
+   * virtual GetNodeInfoAtOptIndex() is resolved only once per index
+   * instead of on every GetValues()/SetVariables() call.
+   */
+  const std::vector<std::vector<NodeValueInfo>>& GetOptIndexMap() const;
+  mutable std::vector<std::vector<NodeValueInfo>> opt_idx_map_;
+
+  /**
+   * @returns The cached reverse mapping from node value to optimization
+   *          index (@sa GetOptIndex()), NodeValueNotOptimized where none.
+   */
+  const std::vector<int>& GetOptIndexLookup() const;
+  mutable std::vector<int> opt_index_lookup_;
+
+  /// Position of the given node value in the reverse lookup table.
+  int GetLookupKey(const NodeValueInfo& nvi) const;
+
   /**
    * @brief Notifies the subscribed observers that the node values changes.
    */
@@ -60,6 +60,13 @@ public:
 
   /**
    * @brief Callback method called every time the subject changes.
+   *
+   * The changed range is not pushed through this call; observers that
+   * want to refresh incrementally pull it from
+   * Nodes::GetChangedNodeIds(), which is valid for the duration of the
+   * callback. During the solver's line searches the deltas are often
+   * localized, so updating only the affected polynomials (as
+   * NodeSpline::UpdateNodes() does) skips most of the refresh work.
    */
   virtual void UpdateNodes() = 0;
 
@@ -117,9 +117,24 @@ public:
    */
   bool IsContactPhase(double t) const;
 
+  /**
+   * @returns The ids of the phases whose duration changed in the most
+   *          recent SetVariables() call, sorted ascending.
+   *
+   * When the total time is fixed the last phase changes along with any
+   * other, so it is usually included. Observers can restrict their
+   * refresh to the polynomials of these phases
+   * (@sa Nodes::GetChangedNodeIds()). Before the first SetVariables()
+   * all phase ids are returned, since no change information exists yet.
+   */
+  std::vector<int> GetChangedPhaseIds() const;
+
 private:
   VecDurations durations_;
 
+  std::vector<int> changed_phase_ids_; ///< phases changed by last SetVariables().
+  bool all_phases_changed_ = true;     ///< true until change tracking starts.
+
   double t_total_;
   bool initial_contact_state_; ///< true if first phase in contact
   ifopt::Bounds phase_duration_bounds_;
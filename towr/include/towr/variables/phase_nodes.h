@@ -88,9 +88,15 @@ public:
    * @param n_polys_in_changing_phase  How many polynomials should be used to
    *                                   paramerize each non-constant phase.
    * @param type  These nodes represent either force evolution or foot motions.
+   * @param optimize_node_velocities  If false, only the node values are
+   *                                  optimization variables and the node
+   *                                  derivatives stay at their initialized
+   *                                  value (zero rates), halving the
+   *                                  variable count of this set.
    */
   PhaseNodes (int phase_count, bool in_contact_start, const std::string& var_name,
-              int n_polys_in_changing_phase, Type type);
+              int n_polys_in_changing_phase, Type type,
+              bool optimize_node_velocities = true);
 
   virtual ~PhaseNodes() = default;
 
@@ -135,6 +141,16 @@ public:
    */
   NodeIds GetIndicesOfNonConstantNodes() const;
 
+  /**
+   * @brief Whether this node only repeats the values of a previous node.
+   *
+   * Consecutive nodes in a constant phase are filled from the same
+   * optimization variables, so any constraint placed on such a duplicate
+   * node is an exact copy of the one on the first node of that phase.
+   * Constraints can skip these nodes to avoid redundant rows.
+   */
+  bool IsDuplicateNode(int node_id) const;
+
   /**
    * @brief Converts durations of swing and stance phases to polynomial durations.
    * @param phase_durations  The durations of alternating swing and stance phases.
@@ -172,6 +188,18 @@ public:
    */
   virtual bool IsInConstantPhase(int polynomial_id) const;
 
+  /**
+   * @brief The IDs of all polynomials representing a specific phase.
+   * @param phase  The ID of the phase (swing, stance) within the spline.
+   *
+   * Lets consumers that know which phase durations changed translate
+   * this into the affected polynomials (@sa PhaseDurations::GetChangedPhaseIds()).
+   */
+  std::vector<int> GetPolynomialIdsInPhase(int phase) const;
+
+  /// Adds the phase lookup tables to the base-class estimate.
+  std::size_t GetHeapBytes() const override;
+
 private:
   /**
    * @brief Sets the bounds on the node variables to model foot motions.
@@ -195,6 +223,24 @@ private:
   // Optimized nodes are sometimes used twice in a constant phase.
   std::map<OptNodeIs, NodeIds > optnode_to_node_;
 
+  // Flat lookup tables for the per-node/per-index queries above. The phase
+  // structure is immutable after construction, but the queries run inside
+  // every constraint evaluation, so they are precomputed once here and
+  // answered by a single array read.
+  std::vector<bool> node_is_constant_;  ///< per node id (@sa IsConstantNode).
+  std::vector<int>  node_phase_;        ///< per node id, phase of left polynomial.
+  std::vector<int>  phase_first_poly_;  ///< per phase, first polynomial id.
+  NodeIds non_constant_node_ids_;       ///< @sa GetIndicesOfNonConstantNodes.
+  std::vector<bool> node_is_duplicate_; ///< per node id (@sa IsDuplicateNode).
+  std::vector<NodeIds> node_adjacent_polys_; ///< per node id.
+  std::vector<std::vector<NodeValueInfo>> opt_idx_to_nvi_; ///< per opt index.
+
+  /// false if the node derivatives are excluded from the optimization.
+  bool optimize_node_velocities_ = true;
+
+  /// Fills the lookup tables above; must run before the bounds are set.
+  void BuildLookupTables();
+
   /**
    * @returns the ID of the polynomial at the start of phase phase.
    */
@@ -203,7 +249,7 @@ private:
   static std::map<OptNodeIs, NodeIds>
   GetOptNodeToNodeMappings(const std::vector<PolyInfo>&);
 
-  std::vector<int> GetAdjacentPolyIds(int node_id) const;
+  const NodeIds& GetAdjacentPolyIds(int node_id) const;
 };
 
 } /* namespace towr */
@@ -83,6 +83,16 @@ private:
   Eigen::VectorXd GetDerivativeOfPosWrtPhaseDuration (double t) const;
 
   PhaseNodes::Ptr phase_nodes_; // retain pointer for extended functionality
+
+  /** Cache of the last duration-Jacobian. The motion and force spline of
+   *  each endeffector is queried repeatedly at the same t within one
+   *  iteration (e.g. by the dynamic constraint), so the previous result is
+   *  kept and invalidated through the coefficient update counter, which
+   *  increments when node values or phase durations change.
+   */
+  mutable double jac_durations_t_ = -1.0;
+  mutable int jac_durations_update_count_ = -1;
+  mutable Jacobian jac_durations_;
 };
 
 } /* namespace towr */
@@ -30,6 +30,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef TOWR_VARIABLES_POLYNOMIAL_H_
 #define TOWR_VARIABLES_POLYNOMIAL_H_
 
+#include <cassert>
 #include <string>
 #include <vector>
 
@@ -57,6 +58,7 @@ public:
   enum Coefficients { A=0, B, C, D, E, F, G, H, I, J};
   using CoeffIDVec = std::vector<Coefficients>;
   using VectorXd   = Eigen::VectorXd;
+  using CoeffVector = State::StateVector; ///< stack-allocated coefficients.
 
 public:
   /**
@@ -72,6 +74,20 @@ public:
    */
   State GetPoint(double t) const;
 
+  /**
+   * @brief Evaluates the polynomial at many local times in one pass.
+   * @param ts_local  Local times, each inside this polynomial's domain.
+   * @param[out] p,v,a  Position/velocity/acceleration, one column per time.
+   *
+   * One matrix product per derivative instead of a scalar coefficient sum
+   * per time, so Eigen can vectorize across the whole batch. Used by the
+   * constraints that sample each polynomial at many interior points.
+   */
+  void GetPoints(const std::vector<double>& ts_local,
+                 Eigen::MatrixXd& p,
+                 Eigen::MatrixXd& v,
+                 Eigen::MatrixXd& a) const;
+
   /**
    * @brief  The derivative of the polynomial with respect to the coefficients.
    *
@@ -81,14 +97,82 @@ public:
    */
   double GetDerivativeWrtCoeff(double t, Dx poly_deriv, Coefficients coeff) const;
 
+  /**
+   * @returns The values of one polynomial coefficient, e.g. A, per dimension.
+   */
+  const CoeffVector& GetCoefficients(Coefficients coeff) const { return coeff_.at(coeff); };
+
 protected:
-  std::vector<VectorXd> coeff_;
+  std::vector<CoeffVector> coeff_;
 
 private:
   CoeffIDVec coeff_ids_;
 };
 
 
+/**
+ * @brief A polynomial whose order is fixed at compile time.
+ *
+ * Every polynomial towr actually builds is a cubic, yet the generic
+ * evaluation in the base class loops over a runtime coefficient count,
+ * which keeps the compiler from unrolling and inlining the innermost
+ * kernel of the library. With the order as template parameter the
+ * Horner evaluation below has compile-time trip counts and flattens
+ * into straight-line code.
+ *
+ * The coefficients remain in the base-class storage (whose vectors are
+ * stack-backed, @sa State::StateVector), so there is a single source of
+ * truth that the generic code paths and accessors keep working on.
+ *
+ * @tparam Order  The highest exponent of t, e.g. 3 for a cubic.
+ */
+template<int Order>
+class PolynomialT : public Polynomial {
+public:
+  /**
+   * @param poly_dim  The dimensions of f(t), e.g. x,y,z.
+   */
+  explicit PolynomialT(int poly_dim) : Polynomial(Order, poly_dim) {}
+  virtual ~PolynomialT() = default;
+
+  /**
+   * @brief The state of the polynomial at time t, via Horner's scheme.
+   *
+   * Shadows (rather than overrides) the base-class evaluation: callers
+   * holding the concrete type -- as Spline does with its vector of
+   * cubics -- bind here statically, so the evaluation inlines without
+   * the dynamic-order loop and without any pow() calls.
+   */
+  State GetPoint(double t) const
+  {
+    assert(t >= 0.0);
+
+    int n_dim = coeff_[A].size();
+    State out(n_dim, 3);
+
+    // f(t) = A + t*(B + t*(C + t*D)); trip counts are compile-time
+    // constants, so these loops unroll completely.
+    CoeffVector p = coeff_[Order];
+    for (int c=Order-1; c>=0; --c)
+      p = t*p + coeff_[c];
+
+    CoeffVector v = Order*coeff_[Order];
+    for (int c=Order-1; c>=1; --c)
+      v = t*v + c*coeff_[c];
+
+    CoeffVector a = Order*(Order-1)*coeff_[Order];
+    for (int c=Order-1; c>=2; --c)
+      a = t*a + c*(c-1)*coeff_[c];
+
+    out.at(kPos) = p;
+    out.at(kVel) = v;
+    out.at(kAcc) = a;
+
+    return out;
+  }
+};
+
+
 /**
  * @brief  Represents a Cubic-Hermite-Polynomial
  *
@@ -108,7 +192,7 @@ private:
  *
  * See also matlab/cubic_hermite_polynomial.m for generation of derivatives.
  */
-class CubicHermitePolynomial : public Polynomial {
+class CubicHermitePolynomial : public PolynomialT<3> {
 public:
   CubicHermitePolynomial(int dim);
   virtual ~CubicHermitePolynomial() = default;
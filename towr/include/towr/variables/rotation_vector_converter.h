@@ -0,0 +1,196 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef TOWR_VARIABLES_ROTATION_VECTOR_CONVERTER_H_
+#define TOWR_VARIABLES_ROTATION_VECTOR_CONVERTER_H_
+
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+
+#include "angular_state_converter.h"
+#include "node_spline.h"
+
+namespace towr {
+
+/**
+ * @brief Converts rotation vectors and derivatives to angular quantities.
+ *
+ * Reads the 3-dimensional base orientation nodes as exponential-map
+ * rotation vectors phi = theta*axis, so the orientation is
+ * R = exp(skew(phi)) (Rodrigues' formula) and the world-frame angular
+ * velocity follows through the left Jacobian of SO(3):
+ *
+ *     w     = Jl(phi) * phi_d
+ *     w_dot = Jl(phi) * phi_dd + Jl_dot(phi, phi_d) * phi_d
+ *
+ * Compared to the Euler-ZYX pipeline this mapping is singularity-free for
+ * all rotations below 2*pi and is built from one set of scalar coefficients
+ * in theta, rather than the trigonometric M/Mdot matrices and their node
+ * derivatives. The angular-velocity mapping and all node Jacobians are in
+ * closed form; see e.g. "A micro Lie theory for state estimation in
+ * robotics" (Sola et al.) for the left-Jacobian identities used.
+ *
+ * @sa AngularStateConverter for the interface shared with EulerConverter,
+ *     and Parameters::UseRotationVectorBase() for enabling this
+ *     parameterization in the optimization problem.
+ */
+class RotationVectorConverter : public AngularStateConverter {
+public:
+  using RotationVector = Vector3d; ///< theta * unit rotation axis.
+  using Matrix3d       = Eigen::Matrix3d;
+
+  RotationVectorConverter () = default;
+
+  /**
+   * @brief Constructs and links this object to the rotation-vector values.
+   * @param rotation_vector  The orientation spline defined by node values,
+   *                         interpreted as rotation vectors.
+   */
+  RotationVectorConverter (const NodeSpline::Ptr& rotation_vector);
+  virtual ~RotationVectorConverter () = default;
+
+  // for documentation, see the interface class AngularStateConverter
+  MatrixSXd GetRotationMatrixBaseToWorld(double t) const override;
+  Vector3d GetAngularVelocityInWorld(double t) const override;
+  Vector3d GetAngularAccelerationInWorld(double t) const override;
+  Jacobian GetDerivOfAngVelWrtNodes(double t) const override;
+  Jacobian GetDerivOfAngAccWrtNodes(double t) const override;
+  Jacobian DerivOfRotVecMult(double t, const Vector3d& v, bool inverse) const override;
+  JacRowMatrix GetDerivativeOfRotationMatrixWrtNodes(double t) const override;
+  int GetUpdateCount() const override { return rv_->GetUpdateCount(); };
+
+  /** @see GetRotationMatrixBaseToWorld(t), for a specific rotation vector. */
+  static Matrix3d GetRotationMatrix(const RotationVector& phi);
+
+  /**
+   * @brief The rotation vector describing the same orientation as the
+   *        given Euler-ZYX angles (roll, pitch, yaw).
+   *
+   * Used to translate the user-facing Euler-angle boundary states into
+   * this parameterization when it is active.
+   */
+  static RotationVector FromEulerAngles(const Vector3d& xyz);
+
+  /** @brief The left Jacobian Jl of SO(3), mapping phi_d to the world-frame
+   *  angular velocity. */
+  static Matrix3d GetLeftJacobian(const RotationVector& phi);
+
+private:
+  NodeSpline::Ptr rv_;
+
+  /**
+   * @brief The scalar coefficients of the exponential map at angle theta.
+   *
+   * The rotation matrix, the left Jacobian and all their derivatives are
+   * polynomials in skew(phi) weighted by these ratios of sin/cos and theta,
+   * so they are computed once per angle. The _t members carry an extra
+   * division by theta (finite for theta->0), which is how the coefficients
+   * appear in the derivative formulas. Near zero every entry switches to
+   * its Taylor expansion.
+   */
+  struct ExpMapCoeff {
+    double p_;    ///< sin(th)/th
+    double dp_t_; ///< d/dth of p_, divided by th.
+    double a_;    ///< (1-cos(th))/th^2
+    double da_t_; ///< d/dth of a_, divided by th.
+    double dda_;  ///< second derivative of a_ w.r.t th.
+    double b_;    ///< (th-sin(th))/th^3
+    double db_t_; ///< d/dth of b_, divided by th.
+    double ddb_;  ///< second derivative of b_ w.r.t th.
+  };
+  static ExpMapCoeff GetCoeff(double theta);
+
+  /** @brief Derivative of Jl(phi)*v w.r.t phi, for v independent of phi. */
+  static Matrix3d GetDerivOfJlvWrtPhi(const RotationVector& phi,
+                                      const Vector3d& v);
+
+  /** @brief Derivative of R(phi)*v w.r.t phi, for v independent of phi. */
+  static Matrix3d GetDerivOfRvWrtPhi(const RotationVector& phi,
+                                     const Vector3d& v);
+
+  /** @brief The velocity product Jl_dot(phi, phi_d)*phi_d of the
+   *  angular acceleration. */
+  static Vector3d GetJldotPhid(const RotationVector& phi,
+                               const Vector3d& phi_d);
+
+  /** @brief Derivative of GetJldotPhid() w.r.t phi. */
+  static Matrix3d GetDerivOfJldotPhidWrtPhi(const RotationVector& phi,
+                                            const Vector3d& phi_d);
+
+  /** @brief Derivative of GetJldotPhid() w.r.t phi_d. */
+  static Matrix3d GetDerivOfJldotPhidWrtPhid(const RotationVector& phi,
+                                             const Vector3d& phi_d);
+
+  /**
+   * @brief Memoized quantities for the most recent query time.
+   *
+   * As in EulerConverter, the constraints query the same time t many times
+   * per solver iteration, and everything derives from rv_->GetPoint(t). The
+   * entries are keyed on the query time and the spline's update counter.
+   */
+  struct Cache {
+    double t_     = -1.0; ///< the query time the entries belong to.
+    int    epoch_ = -1;   ///< spline update count at computation time.
+
+    State rv_state_ = State(k3D, 3);
+    Matrix3d R_, Jl_;  ///< dense kernels for the value products.
+    MatrixSXd R_sp_, Jl_sp_; ///< sparse views for the Jacobian products.
+    bool R_valid_     = false;
+    bool Jl_valid_    = false;
+    bool R_sp_valid_  = false;
+    bool Jl_sp_valid_ = false;
+
+    std::array<Jacobian, 3> jac_wrt_nodes_; ///< indexed by kPos, kVel, kAcc.
+    std::array<bool, 3> jac_valid_ = {{false, false, false}};
+  };
+  mutable Cache cache_;
+
+  /** @brief The rotation-vector state at time t, computed once per
+   *  (t, iteration). */
+  const State& GetCachedState(double t) const;
+
+  /** @see GetRotationMatrix(phi), memoized for the query time. */
+  const Matrix3d& GetRotationMatrixCached(double t) const;
+
+  /** @see GetLeftJacobian(phi), memoized for the query time. */
+  const Matrix3d& GetLeftJacobianCached(double t) const;
+
+  /** @brief Sparse view of GetRotationMatrixCached(). */
+  const MatrixSXd& GetRotationMatrixSparseCached(double t) const;
+
+  /** @brief Sparse view of GetLeftJacobianCached(). */
+  const MatrixSXd& GetLeftJacobianSparseCached(double t) const;
+
+  /** @brief The spline Jacobian at time t, memoized per derivative. */
+  const Jacobian& GetJacobianWrtNodesCached(double t, Dx deriv) const;
+};
+
+} /* namespace towr */
+
+#endif /* TOWR_VARIABLES_ROTATION_VECTOR_CONVERTER_H_ */
@@ -30,6 +30,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef TOWR_VARIABLES_SPLINE_H_
 #define TOWR_VARIABLES_SPLINE_H_
 
+#include <array>
 #include <vector>
 
 #include "polynomial.h"
@@ -65,6 +66,18 @@ public:
    */
   const State GetPoint(int poly_id, double t_local) const;
 
+  /**
+   * @brief Evaluates the spline at multiple times in one pass.
+   * @param ts  The times at which the state is desired, sorted ascending.
+   * @returns One state per requested time.
+   *
+   * Walks the polynomial segments monotonically once, so the per-sample
+   * segment lookup is amortized over the whole time grid. This is the
+   * preferred way to evaluate the spline on the fixed grids used by the
+   * time-discretized constraints.
+   */
+  std::vector<State> GetPoints(const VecTimes& ts) const;
+
   /**
    * @returns The segment (e.g. phase, polynomial) at time t_global.
    * @param t_global  The global time in the spline.
@@ -72,6 +85,15 @@ public:
    */
   static int GetSegmentID(double t_global, const VecTimes& durations);
 
+  /**
+   * @returns The polynomial of this spline active at time t_global.
+   * @param t_global  The global time in the spline.
+   *
+   * Uses the precomputed cumulative-duration index, so lookup is
+   * O(log n) instead of a linear scan over all polynomial durations.
+   */
+  int GetSegmentID(double t_global) const;
+
   /**
    * @returns The total time of the spline.
    */
@@ -82,10 +104,43 @@ public:
    */
   int GetPolynomialCount() const;
 
+  /**
+   * @returns the poly_id-th polynomial of this spline (read-only).
+   */
+  const CubicHermitePolynomial& GetPolynomial(int poly_id) const;
+
+  /**
+   * @returns Counter that increments whenever the polynomial coefficients
+   *          are updated, so when node values or durations change.
+   *
+   * Users caching quantities derived from this spline can compare this
+   * counter to cheaply detect whether their cached values are still valid.
+   */
+  int GetUpdateCount() const;
+
   /**
    * @returns the durations of each polynomial.
+   *
+   * The vector is cached and only rebuilt when the durations change, so
+   * repeated queries don't allocate.
+   */
+  const VecTimes& GetPolyDurations() const;
+
+  /// The cubic coefficients packed as planes (@sa GetCoeffPlanes()).
+  using CoeffPlanes = std::array<Eigen::MatrixXd, 4>;
+
+  /**
+   * @brief All polynomial coefficients in one contiguous block per plane.
+   *
+   * Plane c holds coefficient c (A..D) of every polynomial of this
+   * spline, one column per segment -- a structure-of-arrays view where a
+   * polynomial is just a column offset. Each plane is a single aligned
+   * Eigen allocation, so batched evaluation streams through four dense
+   * blocks instead of chasing the per-polynomial coefficient storage.
+   * Refreshed lazily via GetUpdateCount(), so the per-polynomial storage
+   * stays the single source of truth.
    */
-  VecTimes GetPolyDurations() const;
+  const CoeffPlanes& GetCoeffPlanes() const;
 
 protected:
   VecPoly cubic_polys_; ///< the sequence of polynomials making up the spline.
@@ -93,16 +148,52 @@ protected:
   /**
    * @brief How much time of the current segment has passed at t_global.
    * @param t_global The global time [s] along the spline.
-   * @param d The durations of each segment.
    * @return The segment id and the time passed in this segment.
    */
-  std::pair<int,double> GetLocalTime(double t_global, const VecTimes& d) const;
+  std::pair<int,double> GetLocalTime(double t_global) const;
+
+  /**
+   * @brief The segment ids and local times for a sorted grid of global times.
+   * @param ts  The global times [s] along the spline, sorted ascending.
+   * @return One (segment id, local time) pair per requested time.
+   *
+   * Advances through the segments monotonically instead of looking up each
+   * time individually.
+   */
+  std::vector<std::pair<int,double>> GetLocalTimes(const VecTimes& ts) const;
 
   /**
    * @brief Updates the cubic-Hermite polynomial coefficients using the
    *        currently set nodes values and durations.
    */
   void UpdatePolynomialCoeff();
+
+  /**
+   * @brief Updates the coefficients of only the given polynomials.
+   * @param poly_ids  The ids of the polynomials whose nodes changed.
+   *
+   * When only few node values change (e.g. during line search), the
+   * coefficients of the unaffected polynomials stay valid.
+   */
+  void UpdatePolynomialCoeff(const std::vector<int>& poly_ids);
+
+  /**
+   * @brief Rebuilds the cumulative-duration index used for segment lookup.
+   *
+   * Must be called whenever the durations of the polynomials change, e.g.
+   * when the optimized phase durations are updated.
+   */
+  void UpdateCumulativeDurations();
+
+private:
+  VecTimes poly_durations_;       ///< cached durations of each polynomial.
+  VecTimes cumulative_durations_; ///< running sum of the polynomial durations.
+  int update_count_ = 0;          ///< how often the coefficients were updated.
+
+  // the packed coefficient planes and the update count they were built at
+  // (@sa GetCoeffPlanes()).
+  mutable CoeffPlanes coeff_planes_;
+  mutable int planes_update_count_ = -1;
 };
 
 } /* namespace towr */
@@ -37,6 +37,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 namespace towr {
 
+class SplineProgram;
+
 /**
  * @brief Holds pointers to fully constructed splines, that are linked to the
  *        optimization variables.
@@ -66,6 +68,18 @@ struct SplineHolder {
 
   SplineHolder () = default;
 
+  /**
+   * @brief Copies the current solution into a self-contained snapshot.
+   *
+   * The splines held here observe the optimization variables, so querying
+   * them while another solve mutates those variables is a data race. The
+   * returned SplineProgram holds plain copies of the polynomial coefficients
+   * and durations with no links back, so any number of threads can evaluate
+   * it lock-free while the next solve runs, e.g. executing plan N while
+   * solving plan N+1. Callers must include <towr/spline_program.h>.
+   */
+  SplineProgram Freeze() const;
+
   NodeSpline::Ptr base_linear_;
   NodeSpline::Ptr base_angular_;
 
@@ -0,0 +1,100 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#ifndef TOWR_VARIABLES_SPLINE_STATE_GRID_H_
+#define TOWR_VARIABLES_SPLINE_STATE_GRID_H_
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "spline.h"
+
+namespace towr {
+
+/**
+ * @brief Shared cache of spline states on a fixed time grid.
+ *
+ * The time-discretized constraints evaluate the same splines at the same
+ * time instances whenever their discretization intervals match, e.g. the
+ * linear base spline is queried by the dynamic constraint and by the
+ * range-of-motion constraint of every endeffector. This class holds one
+ * canonical time grid and, per spline, the states at every grid instant.
+ * Constraints sharing the grid consult these cached states instead of
+ * evaluating the splines privately, so each spline is evaluated once per
+ * solver iterate no matter how many constraints read it.
+ *
+ * The per-spline states are recomputed in one batch pass
+ * (@sa Spline::GetPoints()) whenever the spline's update counter changed.
+ * This refresh is not thread-safe; constraints that evaluate their grid
+ * instants in parallel must refresh from a serial section first
+ * (@sa TimeDiscretizationConstraint::PrimeEvaluationCaches()).
+ *
+ * @ingroup Variables
+ */
+class SplineStateGrid {
+public:
+  using Ptr      = std::shared_ptr<SplineStateGrid>;
+  using VecTimes = std::vector<double>;
+
+  /**
+   * @brief Creates a cache for the given time grid.
+   * @param times  The time instances at which the splines are evaluated.
+   */
+  explicit SplineStateGrid (const VecTimes& times);
+  virtual ~SplineStateGrid () = default;
+
+  /**
+   * @returns The time instances of the grid.
+   */
+  const VecTimes& GetTimes() const { return times_; };
+
+  /**
+   * @brief The states of a spline at every grid instant.
+   * @param spline  The spline to evaluate, also used as the cache key.
+   * @returns One state per grid time, in grid order.
+   *
+   * Recomputes the whole grid when the spline's update counter changed
+   * since the last call, otherwise returns the cached states untouched.
+   */
+  const std::vector<State>& GetStates(const Spline* spline) const;
+
+private:
+  struct Entry {
+    int epoch = -1;            ///< Spline::GetUpdateCount() of the states.
+    std::vector<State> states; ///< the spline states at the grid times.
+  };
+
+  VecTimes times_; ///< the canonical time grid shared by the constraints.
+  mutable std::map<const Spline*, Entry> cache_;
+};
+
+} /* namespace towr */
+
+#endif /* TOWR_VARIABLES_SPLINE_STATE_GRID_H_ */
@@ -30,10 +30,12 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef TOWR_VARIABLES_STATE_H_
 #define TOWR_VARIABLES_STATE_H_
 
-#include <vector>
+#include <array>
 
 #include <Eigen/Dense>
 
+#include "cartesian_dimensions.h"
+
 
 namespace towr {
 
@@ -50,6 +52,16 @@ class State {
 public:
   using VectorXd = Eigen::VectorXd;
 
+  /**
+   * A runtime-sized vector whose storage lives on the stack (capacity 3D).
+   *
+   * Every state in this codebase is at most 3-dimensional, and splines
+   * return State objects by value in the hottest loops, so heap-allocating
+   * the derivatives would dominate the solve's allocation profile.
+   */
+  using StateVector = Eigen::Matrix<double, Eigen::Dynamic, 1,
+                                    Eigen::ColMajor, k3D, 1>;
+
   /**
    * @brief Constructs a state object.
    *
@@ -65,32 +77,34 @@ public:
    * @param   deriv  Index for that specific derivative (pos=0, vel=1, acc=2).
    * @return  Read-only n-dimensional position, velocity or acceleration.
    */
-  const VectorXd at(Dx deriv) const;
+  const StateVector& at(Dx deriv) const;
 
   /**
    * @brief   Read or write a specific state derivative by index.
    * @param   deriv  Index for that specific derivative (pos=0, vel=1, acc=2).
    * @return  Read/write n-dimensional position, velocity or acceleration.
    */
-  VectorXd& at(Dx deriv);
+  StateVector& at(Dx deriv);
 
   /**
    * @brief read access to the zero-derivative of the state, e.g. position.
    */
-  const VectorXd p() const;
+  const StateVector& p() const;
 
   /**
    * @brief read access to the first-derivative of the state, e.g. velocity.
    */
-  const VectorXd v() const;
+  const StateVector& v() const;
 
   /**
    * @brief read access to the second-derivative of the state, e.g. acceleration.
    */
-  const VectorXd a() const;
+  const StateVector& a() const;
 
 private:
-  std::vector<VectorXd> values_; ///< e.g. position, velocity and acceleration, ...
+  /// e.g. position, velocity and acceleration, stored without heap memory.
+  std::array<StateVector, kJerk+1> values_;
+  int n_derivatives_; ///< how many derivatives are actually used.
 };
 
 
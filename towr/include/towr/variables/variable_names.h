@@ -60,6 +60,53 @@ static std::string EESchedule(uint ee)
   return  contact_schedule + std::to_string(ee);
 }
 
+/**
+ * @brief Interned identity of an ifopt variable set.
+ *
+ * Dispatching on the string names constructs and compares temporary
+ * strings, which adds up in the loops that run per time instance during
+ * Jacobian assembly. Resolving the name once at the ifopt boundary
+ * reduces each dispatch to two integer comparisons; the string itself
+ * stays the identifier ifopt knows the variable set by.
+ */
+struct VarSetId {
+  enum Kind { BaseLin, BaseAng, EEMotion, EEForce, Schedule, Unknown };
+
+  Kind kind = Unknown;
+  uint ee   = 0; ///< only meaningful for the per-endeffector kinds.
+
+  bool Is(Kind k) const { return kind == k; };
+  bool Is(Kind k, uint ee_index) const { return kind == k && ee == ee_index; };
+};
+
+/**
+ * @brief Resolves a variable-set name to its interned identity.
+ */
+static VarSetId ParseVarSet(const std::string& name)
+{
+  auto starts_with = [&name](const std::string& prefix) {
+    return name.compare(0, prefix.size(), prefix) == 0;
+  };
+
+  VarSetId id;
+  if (name == base_lin_nodes) {
+    id.kind = VarSetId::BaseLin;
+  } else if (name == base_ang_nodes) {
+    id.kind = VarSetId::BaseAng;
+  } else if (starts_with(ee_motion_nodes)) {
+    id.kind = VarSetId::EEMotion;
+    id.ee   = std::stoul(name.substr(ee_motion_nodes.size()));
+  } else if (starts_with(ee_force_nodes)) {
+    id.kind = VarSetId::EEForce;
+    id.ee   = std::stoul(name.substr(ee_force_nodes.size()));
+  } else if (starts_with(contact_schedule) && name != contact_schedule) {
+    id.kind = VarSetId::Schedule;
+    id.ee   = std::stoul(name.substr(contact_schedule.size()));
+  }
+
+  return id;
+}
+
 } // namespace id
 } // namespace towr
 
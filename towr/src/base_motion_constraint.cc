@@ -53,34 +53,75 @@ BaseMotionConstraint::BaseMotionConstraint (double T, double dt,
   node_bounds_.at(LY) = ifopt::NoBound;//Bounds(-0.05, 0.05);
   node_bounds_.at(LZ) = Bounds(z_init-0.02, z_init+0.1); // allow to move dev_z cm up and down
 
+  // evaluation only reads from the splines, so the time grid can be
+  // evaluated concurrently.
+  parallelize_instances_ = true;
+
   int n_constraints_per_node = node_bounds_.size();
   SetRows(GetNumberOfNodes()*n_constraints_per_node);
+
+  // the bounds are fixed offsets around the initial state, so the full
+  // vector can be assembled here once instead of per solver iteration.
+  full_bounds_.resize(GetRows());
+  for (int k=0; k<GetNumberOfNodes(); ++k)
+    for (int dim=0; dim<n_constraints_per_node; ++dim)
+      full_bounds_.at(GetRow(k,dim)) = node_bounds_.at(dim);
+}
+
+BaseMotionConstraint::VecBound
+BaseMotionConstraint::GetBounds () const
+{
+  return full_bounds_;
+}
+
+void
+BaseMotionConstraint::SetStateGrid (const SplineStateGrid::Ptr& grid)
+{
+  assert(grid->GetTimes() == dts_);
+  state_grid_ = grid;
+}
+
+void
+BaseMotionConstraint::PrimeEvaluationCaches () const
+{
+  // refresh the shared states serially here; the parallel per-instance
+  // updates then only read from the cache.
+  if (state_grid_) {
+    state_grid_->GetStates(base_linear_.get());
+    state_grid_->GetStates(base_angular_.get());
+  }
 }
 
 void
 BaseMotionConstraint::UpdateConstraintAtInstance (double t, int k,
                                                   VectorXd& g) const
 {
-  g.middleRows(GetRow(k, LX), k3D) = base_linear_->GetPoint(t).p();
-  g.middleRows(GetRow(k, AX), k3D) = base_angular_->GetPoint(t).p();
+  if (state_grid_) {
+    g.middleRows(GetRow(k, LX), k3D) = state_grid_->GetStates(base_linear_.get()).at(k).p();
+    g.middleRows(GetRow(k, AX), k3D) = state_grid_->GetStates(base_angular_.get()).at(k).p();
+  } else {
+    g.middleRows(GetRow(k, LX), k3D) = base_linear_->GetPoint(t).p();
+    g.middleRows(GetRow(k, AX), k3D) = base_angular_->GetPoint(t).p();
+  }
 }
 
 void
 BaseMotionConstraint::UpdateBoundsAtInstance (double t, int k, VecBound& bounds) const
 {
+  // not called anymore; GetBounds() returns the precomputed vector.
   for (int dim=0; dim<node_bounds_.size(); ++dim)
-    bounds.at(GetRow(k,dim)) = node_bounds_.at(dim);
+    bounds.at(GetRow(k,dim)) = full_bounds_.at(GetRow(k,dim));
 }
 
 void
 BaseMotionConstraint::UpdateJacobianAtInstance (double t, int k,
-                                                std::string var_set,
+                                                const id::VarSetId& var_set,
                                                 Jacobian& jac) const
 {
-  if (var_set == id::base_ang_nodes)
+  if (var_set.Is(id::VarSetId::BaseAng))
     jac.middleRows(GetRow(k,AX), k3D) = base_angular_->GetJacobianWrtNodes(t, kPos);
 
-  if (var_set == id::base_lin_nodes)
+  if (var_set.Is(id::VarSetId::BaseLin))
     jac.middleRows(GetRow(k,LX), k3D) = base_linear_->GetJacobianWrtNodes(t, kPos);
 }
 
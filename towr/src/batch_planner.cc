@@ -0,0 +1,135 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <towr/batch_planner.h>
+
+#include <algorithm> // std::max, std::min
+#include <atomic>
+#include <thread>
+
+#include <ifopt/problem.h>
+
+#include <towr/nlp_factory.h>
+
+namespace towr {
+
+/// The worst violation of any constraint bound at the current variables.
+static double
+GetWorstViolation (ifopt::Problem& nlp)
+{
+  Eigen::VectorXd x = nlp.GetVariableValues();
+  Eigen::VectorXd g = nlp.EvaluateConstraints(x.data());
+  auto bounds = nlp.GetBoundsOnConstraints();
+
+  double worst = 0.0;
+  for (int i=0; i<g.rows(); ++i) {
+    worst = std::max(worst, bounds.at(i).lower_ - g(i));
+    worst = std::max(worst, g(i) - bounds.at(i).upper_);
+  }
+
+  return worst;
+}
+
+BatchPlanner::BatchPlanner (const Parameters& params, const RobotModel& model,
+                            HeightMap::Ptr terrain)
+{
+  params_  = params;
+  model_   = model;
+  terrain_ = terrain;
+}
+
+void
+BatchPlanner::SetInitialState (const BaseState& base, const FeetPos& feet)
+{
+  initial_base_ = base;
+  initial_ee_W_ = feet;
+}
+
+std::vector<BatchPlanner::GoalResult>
+BatchPlanner::Solve (const std::vector<BaseState>& goals,
+                     const SolverMaker& make_solver, int n_threads) const
+{
+  int n_goals = goals.size();
+  std::vector<GoalResult> results(n_goals);
+
+  if (n_threads <= 0)
+    n_threads = std::max(1u, std::thread::hardware_concurrency());
+  n_threads = std::min(n_threads, n_goals);
+
+  // the goals are claimed from a shared counter, so a pool of n_threads
+  // workers stays busy even when solve times differ widely per goal.
+  std::atomic<int> next_goal(0);
+
+  auto worker = [this, &goals, &results, &make_solver, &next_goal, n_goals]() {
+    int k;
+    while ((k = next_goal++) < n_goals) {
+      // model and gait are shared read-only; the terrain is shared too,
+      // which is safe because its query memos (HeightMap's derivative
+      // ring, CompositeHeightMap's surface memo) are thread-local. Only
+      // the goal and the problem built from it are per-candidate.
+      NlpFactory factory;
+      factory.initial_base_ = initial_base_;
+      factory.initial_ee_W_ = initial_ee_W_;
+      factory.params_       = params_;
+      factory.model_        = model_;
+      factory.terrain_      = terrain_;
+      factory.final_base_   = goals.at(k);
+
+      ifopt::Problem nlp;
+      for (auto c : factory.GetVariableSets())
+        nlp.AddVariableSet(c);
+      for (auto c : factory.GetConstraints())
+        nlp.AddConstraintSet(c);
+      for (auto c : factory.GetCosts())
+        nlp.AddCostSet(c);
+
+      make_solver()->Solve(nlp);
+
+      GoalResult& r = results.at(k);
+      r.solution  = factory.spline_holder_;
+      r.violation = GetWorstViolation(nlp);
+      r.feasible  = r.violation < 1e-4;
+      if (nlp.HasCostTerms()) {
+        Eigen::VectorXd x = nlp.GetVariableValues();
+        r.cost = nlp.EvaluateCostFunction(x.data());
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (int i=0; i<n_threads; ++i)
+    threads.emplace_back(worker);
+
+  for (auto& t : threads)
+    t.join();
+
+  return results;
+}
+
+} /* namespace towr */
@@ -49,7 +49,7 @@ BipedGaitGenerator::BipedGaitGenerator ()
 }
 
 void
-BipedGaitGenerator::SetCombo (Combos combo)
+BipedGaitGenerator::ExpandCombo (Combos combo)
 {
   switch (combo) {
     case C0: SetGaits({Stand, Walk1, Walk1, Walk1, Walk1, Stand}); break;
@@ -43,7 +43,6 @@ static Eigen::Matrix3d BuildInertiaTensor( double Ixx, double Iyy, double Izz,
   return I;
 }
 
-// builds a cross product matrix out of "in", so in x v = X(in)*v
 CentroidalModel::Jac
 Cross(const Eigen::Vector3d& in)
 {
@@ -70,7 +69,31 @@ CentroidalModel::CentroidalModel (double mass, const Eigen::Matrix3d& inertia_b,
                                   int ee_count)
     :DynamicModel(mass, ee_count)
 {
-  I_b = inertia_b.sparseView();
+  I_b   = inertia_b.sparseView();
+  I_b_d_ = inertia_b;
+}
+
+void
+CentroidalModel::SetCurrent (const ComPos& com_W, const Vector3d com_acc_W,
+                             const Matrix3d& w_R_b, const AngVel& omega_W,
+                             const Vector3d& omega_dot_W,
+                             const EELoad& force_W, const EEPos& pos_W)
+{
+  DynamicModel::SetCurrent(com_W, com_acc_W, w_R_b, omega_W, omega_dot_W,
+                           force_W, pos_W);
+
+  f_sum_.setZero(); tau_sum_.setZero();
+  for (int ee=0; ee<ee_pos_.size(); ++ee) {
+    const Vector3d& f = ee_force_.at(ee);
+    tau_sum_ += f.cross(com_pos_ - ee_pos_.at(ee));
+    f_sum_   += f;
+  }
+
+  // express inertia matrix in world frame based on current body orientation;
+  // computed dense and fixed-size, the sparse view is kept for the
+  // Jacobian products (regard 0.0 as non-zero, values can turn nonzero).
+  I_w_d_ = w_R_b_ * I_b_d_ * w_R_b_.transpose();
+  I_w_ = I_w_d_.sparseView(1.0, -1.0);
 }
 
 CentroidalModel::BaseAcc
@@ -78,117 +101,241 @@ CentroidalModel::GetDynamicViolation () const
 {
   // https://en.wikipedia.org/wiki/Newton%E2%80%93Euler_equations
 
-  Vector3d f_sum, tau_sum;
-  f_sum.setZero(); tau_sum.setZero();
+  // all operands are fixed-size, so this evaluates on the stack without
+  // touching the heap.
+  BaseAcc acc;
+  acc.segment(AX, k3D) = I_w_d_*omega_dot_
+                         + omega_.cross(I_w_d_*omega_)
+                         - tau_sum_;
+  acc.segment(LX, k3D) = m()*com_acc_
+                         - f_sum_
+                         - Vector3d(0.0, 0.0, -m()*g()); // gravity force
+  return acc;
+}
+
+DynamicModel::Ptr
+CentroidalModel::Clone () const
+{
+  return std::make_shared<CentroidalModel>(*this);
+}
 
-  for (int ee=0; ee<ee_pos_.size(); ++ee) {
-    Vector3d f = ee_force_.at(ee);
-    tau_sum += f.cross(com_pos_ - ee_pos_.at(ee));
+CentroidalModel::BaseAcc
+CentroidalModel::ComputeViolation (const ComPos& com_W, const Vector3d com_acc_W,
+                                   const Matrix3d& w_R_b, const AngVel& omega_W,
+                                   const Vector3d& omega_dot_W,
+                                   const EELoad& force_W, const EEPos& pos_W) const
+{
+  // same math as SetCurrent() + GetDynamicViolation(), but all
+  // intermediates are fixed-size and live on the stack, so the model
+  // stays untouched and nothing is heap-allocated.
+  Vector3d f_sum   = Vector3d::Zero();
+  Vector3d tau_sum = Vector3d::Zero();
+  for (int ee=0; ee<pos_W.size(); ++ee) {
+    const Vector3d& f = force_W.at(ee);
+    tau_sum += f.cross(com_W - pos_W.at(ee));
     f_sum   += f;
   }
 
-  // express inertia matrix in world frame based on current body orientation
-  Jac I_w = w_R_b_.sparseView() * I_b * w_R_b_.transpose().sparseView();
+  Matrix3d I_w = w_R_b * I_b_d_ * w_R_b.transpose();
 
   BaseAcc acc;
-  acc.segment(AX, k3D) = I_w*omega_dot_
-                         + Cross(omega_)*(I_w*omega_)
+  acc.segment(AX, k3D) = I_w*omega_dot_W
+                         + omega_W.cross(I_w*omega_W)
                          - tau_sum;
-  acc.segment(LX, k3D) = m()*com_acc_
+  acc.segment(LX, k3D) = m()*com_acc_W
                          - f_sum
                          - Vector3d(0.0, 0.0, -m()*g()); // gravity force
   return acc;
 }
 
-CentroidalModel::Jac
+void
+CentroidalModel::ComputeViolationsBatch (const StateArrays& s,
+                                         Matrix6Xd& out) const
+{
+  int n = s.GetCount();
+  int n_ee = s.ee_force.size();
+  out.resize(k6D, n);
+
+  // sum of the forces and their torque around the CoM; the cross product
+  // written out per coordinate row turns into elementwise products over
+  // contiguous rows, which the compiler vectorizes across the instants.
+  batch_f_sum_.setZero(k3D, n);
+  batch_tau_sum_.setZero(k3D, n);
+  for (int ee=0; ee<n_ee; ++ee) {
+    const Matrix3Xd& f = s.ee_force.at(ee);
+    batch_r_ = s.com_pos - s.ee_pos.at(ee);
+
+    batch_tau_sum_.row(X) += f.row(Y).cwiseProduct(batch_r_.row(Z))
+                           - f.row(Z).cwiseProduct(batch_r_.row(Y));
+    batch_tau_sum_.row(Y) += f.row(Z).cwiseProduct(batch_r_.row(X))
+                           - f.row(X).cwiseProduct(batch_r_.row(Z));
+    batch_tau_sum_.row(Z) += f.row(X).cwiseProduct(batch_r_.row(Y))
+                           - f.row(Y).cwiseProduct(batch_r_.row(X));
+
+    batch_f_sum_ += f;
+  }
+
+  // rotating the inertia stays per instant (two fixed-size 3x3 products),
+  // but its results are stored as rows so the cross product below is
+  // again elementwise.
+  batch_Iw_.resize(k3D, n);
+  batch_Iwd_.resize(k3D, n);
+  for (int k=0; k<n; ++k) {
+    Matrix3d I_w = s.w_R_b.at(k) * I_b_d_ * s.w_R_b.at(k).transpose();
+    batch_Iw_.col(k)  = I_w * s.omega.col(k);
+    batch_Iwd_.col(k) = I_w * s.omega_dot.col(k);
+  }
+
+  // angular rows: I_w*wd + w x (I_w*w) - tau_sum
+  out.row(AX) = batch_Iwd_.row(X)
+              + s.omega.row(Y).cwiseProduct(batch_Iw_.row(Z))
+              - s.omega.row(Z).cwiseProduct(batch_Iw_.row(Y))
+              - batch_tau_sum_.row(X);
+  out.row(AY) = batch_Iwd_.row(Y)
+              + s.omega.row(Z).cwiseProduct(batch_Iw_.row(X))
+              - s.omega.row(X).cwiseProduct(batch_Iw_.row(Z))
+              - batch_tau_sum_.row(Y);
+  out.row(AZ) = batch_Iwd_.row(Z)
+              + s.omega.row(X).cwiseProduct(batch_Iw_.row(Y))
+              - s.omega.row(Y).cwiseProduct(batch_Iw_.row(X))
+              - batch_tau_sum_.row(Z);
+
+  // linear rows: m*acc - sum(f) - gravity
+  out.middleRows(LX, k3D) = m()*s.com_acc - batch_f_sum_;
+  out.row(LZ).array() += m()*g();
+}
+
+const CentroidalModel::Jac&
 CentroidalModel::GetJacobianWrtBaseLin (const Jac& jac_pos_base_lin,
-                                        const Jac& jac_acc_base_lin) const
+                                        const Jac& jac_acc_base_lin,
+                                        JacWorkspace& ws) const
 {
   // build the com jacobian
   int n = jac_pos_base_lin.cols();
 
-  Jac jac_tau_sum(k3D, n);
-  for (const Vector3d& f : ee_force_) {
-    Jac jac_tau = Cross(f)*jac_pos_base_lin;
-    jac_tau_sum += jac_tau;
-  }
+  // the cross-product matrix is linear in the force, so the force sum
+  // computed in SetCurrent() yields a single sparse product.
+  ws.jac_tau = Cross(f_sum_)*jac_pos_base_lin;
 
-  Jac jac(k6D, n);
-  jac.middleRows(AX, k3D) = -jac_tau_sum;
-  jac.middleRows(LX, k3D) = m()*jac_acc_base_lin;
+  ws.jac_model.resize(k6D, n);
+  ws.jac_model.middleRows(AX, k3D) = -ws.jac_tau;
+  ws.jac_model.middleRows(LX, k3D) = m()*jac_acc_base_lin;
 
-  return jac;
+  return ws.jac_model;
 }
 
-CentroidalModel::Jac
-CentroidalModel::GetJacobianWrtBaseAng (const EulerConverter& base_euler,
-                                        double t) const
+const CentroidalModel::Jac&
+CentroidalModel::GetJacobianWrtBaseAng (const AngularStateConverter& base_angular,
+                                        double t, JacWorkspace& ws) const
 {
-  Jac I_w = w_R_b_.sparseView() * I_b * w_R_b_.transpose().sparseView();
-
   // Derivative of R*I_b*R^T * wd
   // 1st term of product rule (derivative of R)
-  Vector3d v11 = I_b*w_R_b_.transpose()*omega_dot_;
-  Jac jac11 = base_euler.DerivOfRotVecMult(t, v11, false);
+  Vector3d v11 = I_b_d_*w_R_b_.transpose()*omega_dot_;
+  Jac jac11 = base_angular.DerivOfRotVecMult(t, v11, false);
 
   // 2nd term of product rule (derivative of R^T)
-  Jac jac12 = w_R_b_.sparseView()*I_b*base_euler.DerivOfRotVecMult(t, omega_dot_, true);
+  Jac jac12 = w_R_b_.sparseView()*I_b*base_angular.DerivOfRotVecMult(t, omega_dot_, true);
 
   // 3rd term of product rule (derivative of wd)
-  Jac jac_ang_acc = base_euler.GetDerivOfAngAccWrtEulerNodes(t);
-  Jac jac13 = I_w * jac_ang_acc;
+  Jac jac_ang_acc = base_angular.GetDerivOfAngAccWrtNodes(t);
+  Jac jac13 = I_w_ * jac_ang_acc;
   Jac jac1 = jac11 + jac12 + jac13;
 
 
   // Derivative of w x Iw
   // w x d_dn(R*I_b*R^T*w) -(I*w x d_dnw)
   // right derivative same as above, just with velocity instead acceleration
-  Vector3d v21 = I_b*w_R_b_.transpose()*omega_;
-  Jac jac21 = base_euler.DerivOfRotVecMult(t, v21, false);
+  Vector3d v21 = I_b_d_*w_R_b_.transpose()*omega_;
+  Jac jac21 = base_angular.DerivOfRotVecMult(t, v21, false);
 
   // 2nd term of product rule (derivative of R^T)
-  Jac jac22 = w_R_b_.sparseView()*I_b*base_euler.DerivOfRotVecMult(t, omega_, true);
+  Jac jac22 = w_R_b_.sparseView()*I_b*base_angular.DerivOfRotVecMult(t, omega_, true);
 
   // 3rd term of product rule (derivative of omega)
-  Jac jac_ang_vel = base_euler.GetDerivOfAngVelWrtEulerNodes(t);
-  Jac jac23 = I_w * jac_ang_vel;
+  Jac jac_ang_vel = base_angular.GetDerivOfAngVelWrtNodes(t);
+  Jac jac23 = I_w_ * jac_ang_vel;
 
-  Jac jac2 = Cross(omega_)*(jac21+jac22+jac23) - Cross(I_w*omega_)*jac_ang_vel;
+  Jac jac2 = Cross(omega_)*(jac21+jac22+jac23) - Cross(I_w_d_*omega_)*jac_ang_vel;
 
 
   // Combine the two to get sensitivity to I_w*w + w x (I_w*w)
   int n = jac_ang_vel.cols();
-  Jac jac(k6D, n);
-  jac.middleRows(AX, k3D) = jac1 + jac2;
+  ws.jac_model.resize(k6D, n);
+  ws.jac_model.middleRows(AX, k3D) = jac1 + jac2;
 
-  return jac;
+  return ws.jac_model;
 }
 
-CentroidalModel::Jac
-CentroidalModel::GetJacobianWrtForce (const Jac& jac_force, EE ee) const
+const CentroidalModel::Jac&
+CentroidalModel::GetJacobianWrtForce (const Jac& jac_force, EE ee,
+                                      JacWorkspace& ws) const
 {
   Vector3d r = com_pos_ - ee_pos_.at(ee);
-  Jac jac_tau = -Cross(r)*jac_force;
+  ws.jac_tau = -Cross(r)*jac_force;
 
   int n = jac_force.cols();
-  Jac jac(k6D, n);
-  jac.middleRows(AX, k3D) = -jac_tau;
-  jac.middleRows(LX, k3D) = -jac_force;
+  ws.jac_model.resize(k6D, n);
+  ws.jac_model.middleRows(AX, k3D) = -ws.jac_tau;
+  ws.jac_model.middleRows(LX, k3D) = -jac_force;
 
-  return jac;
+  return ws.jac_model;
 }
 
-CentroidalModel::Jac
-CentroidalModel::GetJacobianWrtEEPos (const Jac& jac_ee_pos, EE ee) const
+const CentroidalModel::Jac&
+CentroidalModel::GetJacobianWrtEEPos (const Jac& jac_ee_pos, EE ee,
+                                      JacWorkspace& ws) const
 {
   Vector3d f = ee_force_.at(ee);
-  Jac jac_tau = Cross(f)*(-jac_ee_pos);
+  ws.jac_tau = Cross(f)*(-jac_ee_pos);
 
-  Jac jac(k6D, jac_tau.cols());
-  jac.middleRows(AX, k3D) = -jac_tau;
+  ws.jac_model.resize(k6D, ws.jac_tau.cols());
+  ws.jac_model.middleRows(AX, k3D) = -ws.jac_tau;
 
   // linear dynamics don't depend on endeffector position.
-  return jac;
+  return ws.jac_model;
+}
+
+/// dense counterpart of Cross() for the fixed-size window products.
+static Eigen::Matrix3d
+CrossD (const Eigen::Vector3d& in)
+{
+  Eigen::Matrix3d out;
+  out <<     0.0, -in(Z),  in(Y),
+           in(Z),    0.0, -in(X),
+          -in(Y),  in(X),    0.0;
+  return out;
+}
+
+void
+CentroidalModel::GetJacobianWrtBaseLinWindow (const Eigen::MatrixXd& jac_pos,
+                                              const Eigen::MatrixXd& jac_acc,
+                                              Eigen::MatrixXd& out) const
+{
+  int w = jac_pos.cols();
+  out.resize(k6D, w);
+  out.middleRows(AX, k3D).noalias() = -CrossD(f_sum_)*jac_pos;
+  out.middleRows(LX, k3D) = m()*jac_acc;
+}
+
+void
+CentroidalModel::GetJacobianWrtForceWindow (const Eigen::MatrixXd& jac_force,
+                                            EE ee, Eigen::MatrixXd& out) const
+{
+  Vector3d r = com_pos_ - ee_pos_.at(ee);
+
+  int w = jac_force.cols();
+  out.resize(k6D, w);
+  out.middleRows(AX, k3D).noalias() = CrossD(r)*jac_force;
+  out.middleRows(LX, k3D) = -jac_force;
+}
+
+void
+CentroidalModel::GetJacobianWrtEEPosWindow (const Eigen::MatrixXd& jac_ee_pos,
+                                            EE ee, Eigen::MatrixXd& out) const
+{
+  // only the torque rows; the linear dynamics don't depend on foot position.
+  out.resize(k3D, jac_ee_pos.cols());
+  out.noalias() = CrossD(ee_force_.at(ee))*jac_ee_pos;
 }
 
 } /* namespace towr */
@@ -0,0 +1,306 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <towr/terrain/composite_height_map.h>
+
+#include <algorithm> // std::min/max
+#include <cassert>
+#include <cmath>     // std::floor, std::sqrt
+#include <limits>
+
+namespace towr {
+
+/**
+ * Quintic smoothstep on [0,1]: C2, with vanishing first and second
+ * derivative at both ends, so blending with it keeps the composed
+ * surface twice continuously differentiable.
+ */
+static void
+Smoothstep (double t, double& s, double& ds, double& dds)
+{
+  if (t <= 0.0) { s = 0.0; ds = 0.0; dds = 0.0; return; }
+  if (t >= 1.0) { s = 1.0; ds = 0.0; dds = 0.0; return; }
+
+  s   = ((  6*t -  15)*t +  10)*t*t*t;
+  ds  = (( 30*t -  60)*t +  30)*t*t;
+  dds = ((120*t - 180)*t +  60)*t;
+}
+
+/**
+ * The per-axis border ramp of a patch: zero on the borders of [lo,hi],
+ * one beyond the margin m inside, C2 in between.
+ */
+static void
+Ramp (double x, double lo, double hi, double m,
+      double& r, double& dr, double& ddr)
+{
+  double a, da, dda;
+  Smoothstep((x - lo)/m, a, da, dda);
+  da  /= m;
+  dda /= m*m;
+
+  double b, db, ddb;
+  Smoothstep((hi - x)/m, b, db, ddb);
+  db  /= -m; // inner derivative of (hi-x)/m
+  ddb /= m*m;
+
+  r   = a*b;
+  dr  = da*b + a*db;
+  ddr = dda*b + 2*da*db + a*ddb;
+}
+
+
+CompositeHeightMap::CompositeHeightMap (double base_height,
+                                        double blend_margin)
+    : base_height_(base_height),
+      margin_(blend_margin)
+{
+  assert(blend_margin > 0.0);
+}
+
+void
+CompositeHeightMap::AddPatch (const HeightMap::Ptr& patch,
+                              double x_min, double x_max,
+                              double y_min, double y_max,
+                              double x_offset, double y_offset,
+                              double z_offset)
+{
+  assert(patch);
+  assert(x_min < x_max && y_min < y_max);
+
+  patches_.push_back({patch, x_min, x_max, y_min, y_max,
+                      x_offset, y_offset, z_offset});
+  index_built_ = false;
+  // the per-thread surface memos invalidate themselves via patches_.size()
+}
+
+void
+CompositeHeightMap::BuildIndex () const
+{
+  buckets_.clear();
+
+  if (patches_.empty()) {
+    index_built_ = true;
+    return;
+  }
+
+  double inf = std::numeric_limits<double>::infinity();
+  double x0 = inf, x1 = -inf, y0 = inf, y1 = -inf;
+  for (const auto& p : patches_) {
+    x0 = std::min(x0, p.x_min);    x1 = std::max(x1, p.x_max);
+    y0 = std::min(y0, p.y_min);    y1 = std::max(y1, p.y_max);
+  }
+
+  // a few buckets per patch on average keeps both the bucket count and
+  // the candidates per bucket small, independent of how many patches a
+  // course stacks up.
+  n_ = std::max(1, static_cast<int>(std::ceil(std::sqrt(2.0*patches_.size()))));
+  grid_x0_ = x0;
+  grid_y0_ = y0;
+  cell_x_  = std::max((x1-x0)/n_, 1e-10);
+  cell_y_  = std::max((y1-y0)/n_, 1e-10);
+
+  auto bucket_of = [this](double v, double v0, double cell) {
+    int i = static_cast<int>(std::floor((v-v0)/cell));
+    return std::min(std::max(i, 0), n_-1);
+  };
+
+  buckets_.assign(n_*n_, std::vector<int>());
+  for (int i=0; i<static_cast<int>(patches_.size()); ++i) {
+    const Patch& p = patches_.at(i);
+    int ix0 = bucket_of(p.x_min, grid_x0_, cell_x_);
+    int ix1 = bucket_of(p.x_max, grid_x0_, cell_x_);
+    int iy0 = bucket_of(p.y_min, grid_y0_, cell_y_);
+    int iy1 = bucket_of(p.y_max, grid_y0_, cell_y_);
+
+    // i ascends, so each bucket lists its patches in stacking order
+    for (int iy=iy0; iy<=iy1; ++iy)
+      for (int ix=ix0; ix<=ix1; ++ix)
+        buckets_.at(iy*n_ + ix).push_back(i);
+  }
+
+  index_built_ = true;
+}
+
+const std::vector<int>&
+CompositeHeightMap::GetCandidates (double x, double y) const
+{
+  static const std::vector<int> none;
+
+  if (!index_built_)
+    BuildIndex();
+
+  if (buckets_.empty())
+    return none;
+
+  int ix = static_cast<int>(std::floor((x-grid_x0_)/cell_x_));
+  int iy = static_cast<int>(std::floor((y-grid_y0_)/cell_y_));
+  if (ix < 0 || ix >= n_ || iy < 0 || iy >= n_)
+    return none; // outside every patch, only the base remains
+
+  return buckets_.at(iy*n_ + ix);
+}
+
+CompositeHeightMap::Weight
+CompositeHeightMap::GetWeight (const Patch& p, double x, double y) const
+{
+  double rx, drx, ddrx;
+  Ramp(x, p.x_min, p.x_max, margin_, rx, drx, ddrx);
+
+  double ry, dry, ddry;
+  Ramp(y, p.y_min, p.y_max, margin_, ry, dry, ddry);
+
+  // the weight separates into per-axis ramps, so its derivatives do too
+  Weight w;
+  w.w   = rx*ry;
+  w.dx  = drx*ry;
+  w.dy  = rx*dry;
+  w.dxx = ddrx*ry;
+  w.dxy = drx*dry;
+  w.dyy = rx*ddry;
+
+  return w;
+}
+
+const CompositeHeightMap::Surface&
+CompositeHeightMap::Evaluate (double x, double y) const
+{
+  // the memo is per thread: RunForEachEE queries GetHeight() from one
+  // thread per endeffector during construction, and the parallel solve
+  // paths share one terrain across solver threads -- a shared mutable
+  // slot would race even in a plain single-threaded solve's setup.
+  struct Memo {
+    const CompositeHeightMap* owner;
+    std::size_t n_patches; ///< invalidates the memo when patches are added.
+    Surface s;
+    double x, y;
+    bool valid;
+  };
+  static thread_local Memo memo = {nullptr, 0, {}, 0.0, 0.0, false};
+
+  if (memo.owner == this && memo.n_patches == patches_.size()
+      && memo.valid && x == memo.x && y == memo.y)
+    return memo.s;
+
+  Surface s;
+  s.h = base_height_; // flat base, all derivatives zero
+
+  for (int i : GetCandidates(x, y)) {
+    const Patch& p = patches_.at(i);
+
+    // the weight vanishes on and outside the rectangle's border
+    if (x <= p.x_min || x >= p.x_max || y <= p.y_min || y >= p.y_max)
+      continue;
+
+    Weight w = GetWeight(p, x, y);
+
+    double px = x - p.x_offset;
+    double py = y - p.y_offset;
+    const HeightMap& t = *p.terrain;
+
+    Surface q;
+    q.h   = t.GetHeight(px, py) + p.z_offset;
+    q.dx  = t.GetDerivativeOfHeightWrt(X_, px, py);
+    q.dy  = t.GetDerivativeOfHeightWrt(Y_, px, py);
+    q.dxx = t.GetSecondDerivativeOfHeightWrt(X_, X_, px, py);
+    q.dxy = t.GetSecondDerivativeOfHeightWrt(X_, Y_, px, py);
+    q.dyx = t.GetSecondDerivativeOfHeightWrt(Y_, X_, px, py);
+    q.dyy = t.GetSecondDerivativeOfHeightWrt(Y_, Y_, px, py);
+
+    // the patch overrides what is underneath: s <- s + w*(q - s),
+    // differentiated with the product rule
+    Surface n;
+    n.h   = s.h + w.w*(q.h - s.h);
+    n.dx  = s.dx + w.dx*(q.h - s.h) + w.w*(q.dx - s.dx);
+    n.dy  = s.dy + w.dy*(q.h - s.h) + w.w*(q.dy - s.dy);
+    n.dxx = s.dxx + w.dxx*(q.h - s.h) + 2*w.dx*(q.dx - s.dx)
+            + w.w*(q.dxx - s.dxx);
+    n.dxy = s.dxy + w.dxy*(q.h - s.h) + w.dx*(q.dy - s.dy)
+            + w.dy*(q.dx - s.dx) + w.w*(q.dxy - s.dxy);
+    n.dyx = s.dyx + w.dxy*(q.h - s.h) + w.dy*(q.dx - s.dx)
+            + w.dx*(q.dy - s.dy) + w.w*(q.dyx - s.dyx);
+    n.dyy = s.dyy + w.dyy*(q.h - s.h) + 2*w.dy*(q.dy - s.dy)
+            + w.w*(q.dyy - s.dyy);
+
+    s = n;
+  }
+
+  memo.owner     = this;
+  memo.n_patches = patches_.size();
+  memo.s     = s;
+  memo.x     = x;
+  memo.y     = y;
+  memo.valid = true;
+
+  return memo.s;
+}
+
+double
+CompositeHeightMap::GetHeight (double x, double y) const
+{
+  return Evaluate(x,y).h;
+}
+
+double
+CompositeHeightMap::GetHeightDerivWrtX (double x, double y) const
+{
+  return Evaluate(x,y).dx;
+}
+
+double
+CompositeHeightMap::GetHeightDerivWrtY (double x, double y) const
+{
+  return Evaluate(x,y).dy;
+}
+
+double
+CompositeHeightMap::GetHeightDerivWrtXX (double x, double y) const
+{
+  return Evaluate(x,y).dxx;
+}
+
+double
+CompositeHeightMap::GetHeightDerivWrtXY (double x, double y) const
+{
+  return Evaluate(x,y).dxy;
+}
+
+double
+CompositeHeightMap::GetHeightDerivWrtYX (double x, double y) const
+{
+  return Evaluate(x,y).dyx;
+}
+
+double
+CompositeHeightMap::GetHeightDerivWrtYY (double x, double y) const
+{
+  return Evaluate(x,y).dyy;
+}
+
+} /* namespace towr */
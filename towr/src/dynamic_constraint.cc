@@ -39,17 +39,161 @@ DynamicConstraint::DynamicConstraint (const DynamicModel::Ptr& m,
                                       const SplineHolder& spline_holder)
     :TimeDiscretizationConstraint(T, dt, "dynamic")
 {
-  model_ = m;
+  // own copy: SetCurrent() writes into the model per evaluation, so a
+  // shared model (e.g. from RobotModel::GetShared()) must not be mutated.
+  model_ = m->Clone();
 
   // link with up-to-date spline variables
   base_linear_  = spline_holder.base_linear_;
-  base_angular_ = EulerConverter(spline_holder.base_angular_);
+  base_angular_ = std::make_shared<EulerConverter>(spline_holder.base_angular_);
   ee_forces_    = spline_holder.ee_force_;
   ee_motion_    = spline_holder.ee_motion_;
 
+  ee_pos_.resize(m->GetEECount());
+  ee_force_.resize(m->GetEECount());
+
+  SetRows(GetNumberOfNodes()*k6D);
+}
+
+DynamicConstraint::DynamicConstraint (const DynamicModel::Ptr& m,
+                                      const VecTimes& dts,
+                                      const SplineHolder& spline_holder)
+    :TimeDiscretizationConstraint(dts, "dynamic")
+{
+  model_ = m->Clone(); // own copy, as above
+
+  // link with up-to-date spline variables
+  base_linear_  = spline_holder.base_linear_;
+  base_angular_ = std::make_shared<EulerConverter>(spline_holder.base_angular_);
+  ee_forces_    = spline_holder.ee_force_;
+  ee_motion_    = spline_holder.ee_motion_;
+
+  ee_pos_.resize(m->GetEECount());
+  ee_force_.resize(m->GetEECount());
+
   SetRows(GetNumberOfNodes()*k6D);
 }
 
+void
+DynamicConstraint::SetSolveMonitor (const SolveMonitor::Ptr& monitor)
+{
+  monitor_ = monitor;
+}
+
+void
+DynamicConstraint::SetAngularConverter (const AngularStateConverter::Ptr& converter)
+{
+  base_angular_ = converter;
+}
+
+void
+DynamicConstraint::SetStateGrid (const SplineStateGrid::Ptr& grid)
+{
+  assert(grid->GetTimes() == dts_);
+  state_grid_ = grid;
+}
+
+void
+DynamicConstraint::PrimeEvaluationCaches () const
+{
+  if (!state_grid_)
+    return;
+
+  state_grid_->GetStates(base_linear_.get());
+  for (int ee=0; ee<model_->GetEECount(); ++ee) {
+    state_grid_->GetStates(ee_forces_.at(ee).get());
+    state_grid_->GetStates(ee_motion_.at(ee).get());
+  }
+}
+
+std::size_t
+DynamicConstraint::GetHeapBytes () const
+{
+  auto sparse_bytes = [](const DynamicModel::Jac& m) {
+    return static_cast<std::size_t>(m.nonZeros())*(sizeof(double) + sizeof(int))
+         + static_cast<std::size_t>(m.outerSize()+1)*sizeof(int);
+  };
+
+  std::size_t bytes = TimeDiscretizationConstraint::GetHeapBytes();
+
+  // batch gather and violation storage
+  const auto& s = state_arrays_;
+  bytes += static_cast<std::size_t>(s.com_pos.size() + s.com_acc.size()
+         + s.omega.size() + s.omega_dot.size())*sizeof(double);
+  bytes += s.w_R_b.capacity()*sizeof(Eigen::Matrix3d);
+  for (const auto& m : s.ee_force)
+    bytes += static_cast<std::size_t>(m.size())*sizeof(double);
+  for (const auto& m : s.ee_pos)
+    bytes += static_cast<std::size_t>(m.size())*sizeof(double);
+  bytes += static_cast<std::size_t>(violations_.size())*sizeof(double);
+
+  // model-Jacobian workspaces, sparse and dense-window
+  bytes += sparse_bytes(jac_ws_.jac_model) + sparse_bytes(jac_ws_.jac_tau);
+  bytes += static_cast<std::size_t>(win_jac_a_.size() + win_jac_b_.size()
+         + win_out_.size())*sizeof(double);
+
+  return bytes;
+}
+
+Eigen::VectorXd
+DynamicConstraint::GetValues () const
+{
+  VectorXd g;
+
+  if (state_grid_) {
+    // batch path: gather all instants into coordinate rows once, then
+    // compute every violation in one vectorized kernel. The 6 x n result
+    // is column-major, so its memory layout already matches the row
+    // convention k6D*k + dim of GetRow().
+    auto t0 = StartMeasurement();
+    PrimeEvaluationCaches();
+    GatherStateArrays();
+    model_->ComputeViolationsBatch(state_arrays_, violations_);
+    g = Eigen::Map<const VectorXd>(violations_.data(), violations_.size());
+    StopValueMeasurement(t0);
+  } else {
+    g = TimeDiscretizationConstraint::GetValues();
+  }
+
+  // the bounds of this constraint are all zero, so the maximum dynamic
+  // violation is simply the largest absolute entry.
+  if (monitor_)
+    monitor_->ReportEvaluation(g.cwiseAbs().maxCoeff());
+
+  return g;
+}
+
+void
+DynamicConstraint::GatherStateArrays () const
+{
+  assert(state_grid_);
+
+  int n = dts_.size();
+  int n_ee = model_->GetEECount();
+  state_arrays_.Resize(n, n_ee);
+
+  const auto& com = state_grid_->GetStates(base_linear_.get());
+  for (int k=0; k<n; ++k) {
+    double t = dts_.at(k);
+    state_arrays_.com_pos.col(k) = com.at(k).p();
+    state_arrays_.com_acc.col(k) = com.at(k).a();
+
+    // the converter caches per instant, so these stay scalar queries
+    state_arrays_.w_R_b.at(k)      = base_angular_->GetRotationMatrixBaseToWorld(t);
+    state_arrays_.omega.col(k)     = base_angular_->GetAngularVelocityInWorld(t);
+    state_arrays_.omega_dot.col(k) = base_angular_->GetAngularAccelerationInWorld(t);
+  }
+
+  for (int ee=0; ee<n_ee; ++ee) {
+    const auto& force  = state_grid_->GetStates(ee_forces_.at(ee).get());
+    const auto& motion = state_grid_->GetStates(ee_motion_.at(ee).get());
+    for (int k=0; k<n; ++k) {
+      state_arrays_.ee_force.at(ee).col(k) = force.at(k).p();
+      state_arrays_.ee_pos.at(ee).col(k)   = motion.at(k).p();
+    }
+  }
+}
+
 int
 DynamicConstraint::GetRow (int k, Dim6D dimension) const
 {
@@ -59,7 +203,7 @@ DynamicConstraint::GetRow (int k, Dim6D dimension) const
 void
 DynamicConstraint::UpdateConstraintAtInstance(double t, int k, VectorXd& g) const
 {
-  UpdateModel(t);
+  UpdateModel(t, k);
   g.segment(GetRow(k,AX), k6D) = model_->GetDynamicViolation();
 }
 
@@ -71,70 +215,141 @@ DynamicConstraint::UpdateBoundsAtInstance(double t, int k, VecBound& bounds) con
 }
 
 void
-DynamicConstraint::UpdateJacobianAtInstance(double t, int k, std::string var_set,
+DynamicConstraint::UpdateJacobianAtInstance(double t, int k,
+                                            const id::VarSetId& var_set,
                                             Jacobian& jac) const
 {
-  UpdateModel(t);
+  UpdateModel(t, k);
 
-  int n = jac.cols();
-  Jacobian jac_model(k6D,n);
+  int row = GetRow(k,AX);
+  int ee  = var_set.ee;
 
-  // sensitivity of dynamic constraint w.r.t base variables.
-  if (var_set == id::base_lin_nodes) {
-    Jacobian jac_base_lin_pos = base_linear_->GetJacobianWrtNodes(t,kPos);
-    Jacobian jac_base_lin_acc = base_linear_->GetJacobianWrtNodes(t,kAcc);
+  // emits a dense window block straight into the assembly buffer; the
+  // explicit zeros keep the assembled sparsity identical across
+  // evaluations, which the solver relies on.
+  auto emit_window = [this, row](int col_start) {
+    for (int r=0; r<win_out_.rows(); ++r)
+      for (int c=0; c<win_out_.cols(); ++c)
+        AddJacobianTriplet(row + r, col_start + c, win_out_(r,c));
+  };
 
-    jac_model = model_->GetJacobianWrtBaseLin(jac_base_lin_pos,
-                                              jac_base_lin_acc);
-  }
+  // the workspace matrices keep their heap buffers between the instants
+  // of the discretization grid, so the model's Jacobian products don't
+  // construct fresh result matrices at every instant.
+  switch (var_set.kind) {
+    // sensitivity of dynamic constraint w.r.t base variables.
+    case id::VarSetId::BaseLin: {
+      if (model_->HasWindowJacobians()) {
+        // only the columns of the two bounding nodes are nonzero at any
+        // instant, so the chain rule runs on that dense window and the
+        // per-instant cost stays independent of the horizon length.
+        int col_start, col_start_acc;
+        base_linear_->GetJacobianWrtNodesWindow(t, kPos, win_jac_a_, col_start);
+        base_linear_->GetJacobianWrtNodesWindow(t, kAcc, win_jac_b_, col_start_acc);
+        assert(col_start == col_start_acc); // same polynomial, same band
 
-  if (var_set == id::base_ang_nodes) {
-    jac_model = model_->GetJacobianWrtBaseAng(base_angular_, t);
-  }
+        model_->GetJacobianWrtBaseLinWindow(win_jac_a_, win_jac_b_, win_out_);
+        emit_window(col_start);
+        break;
+      }
 
+      Jacobian jac_base_lin_pos = base_linear_->GetJacobianWrtNodes(t,kPos);
+      Jacobian jac_base_lin_acc = base_linear_->GetJacobianWrtNodes(t,kAcc);
+
+      jac.middleRows(row, k6D) = model_->GetJacobianWrtBaseLin(jac_base_lin_pos,
+                                                               jac_base_lin_acc,
+                                                               jac_ws_);
+      break;
+    }
+
+    case id::VarSetId::BaseAng: {
+      jac.middleRows(row, k6D) = model_->GetJacobianWrtBaseAng(*base_angular_, t,
+                                                               jac_ws_);
+      break;
+    }
+
+    // sensitivity of dynamic constraint w.r.t. endeffector variables
+    case id::VarSetId::EEForce: {
+      if (model_->HasWindowJacobians()) {
+        int col_start;
+        ee_forces_.at(ee)->GetJacobianWrtNodesWindow(t, kPos, win_jac_a_, col_start);
+        model_->GetJacobianWrtForceWindow(win_jac_a_, ee, win_out_);
+        emit_window(col_start);
+        break;
+      }
 
-  // sensitivity of dynamic constraint w.r.t. endeffector variables
-  for (int ee=0; ee<model_->GetEECount(); ++ee) {
-    if (var_set == id::EEForceNodes(ee)) {
       Jacobian jac_ee_force = ee_forces_.at(ee)->GetJacobianWrtNodes(t,kPos);
-      jac_model = model_->GetJacobianWrtForce(jac_ee_force, ee);
+      jac.middleRows(row, k6D) = model_->GetJacobianWrtForce(jac_ee_force, ee,
+                                                             jac_ws_);
+      break;
     }
 
-    if (var_set == id::EEMotionNodes(ee)) {
+    case id::VarSetId::EEMotion: {
+      if (model_->HasWindowJacobians()) {
+        // only the three angular rows; the linear dynamics don't depend
+        // on foot position, matching the sparse path's empty rows.
+        int col_start;
+        ee_motion_.at(ee)->GetJacobianWrtNodesWindow(t, kPos, win_jac_a_, col_start);
+        model_->GetJacobianWrtEEPosWindow(win_jac_a_, ee, win_out_);
+        emit_window(col_start);
+        break;
+      }
+
       Jacobian jac_ee_pos = ee_motion_.at(ee)->GetJacobianWrtNodes(t,kPos);
-      jac_model = model_->GetJacobianWrtEEPos(jac_ee_pos, ee);
+      jac.middleRows(row, k6D) = model_->GetJacobianWrtEEPos(jac_ee_pos, ee,
+                                                             jac_ws_);
+      break;
     }
 
-    if (var_set == id::EESchedule(ee)) {
+    case id::VarSetId::Schedule: {
       Jacobian jac_f_dT = ee_forces_.at(ee)->GetJacobianOfPosWrtDurations(t);
-      jac_model += model_->GetJacobianWrtForce(jac_f_dT, ee);
+      Jacobian jac_model = model_->GetJacobianWrtForce(jac_f_dT, ee, jac_ws_);
 
       Jacobian jac_x_dT = ee_motion_.at(ee)->GetJacobianOfPosWrtDurations(t);
-      jac_model +=  model_->GetJacobianWrtEEPos(jac_x_dT, ee);
+      jac_model += model_->GetJacobianWrtEEPos(jac_x_dT, ee, jac_ws_);
+
+      jac.middleRows(row, k6D) = jac_model;
+      break;
     }
-  }
 
-  jac.middleRows(GetRow(k,AX), k6D) = jac_model;
+    default:
+      break; // no sensitivity w.r.t. this variable set
+  }
 }
 
 void
-DynamicConstraint::UpdateModel (double t) const
+DynamicConstraint::UpdateModel (double t, int k) const
 {
-  auto com = base_linear_->GetPoint(t);
+  // read the spline states from the shared grid cache when one is
+  // attached; this function runs once per instant and variable set during
+  // Jacobian assembly, so re-evaluating the splines each time adds up.
+  Eigen::Vector3d com_pos, com_acc;
+  if (state_grid_) {
+    const State& com = state_grid_->GetStates(base_linear_.get()).at(k);
+    com_pos = com.p();
+    com_acc = com.a();
+  } else {
+    State com = base_linear_->GetPoint(t);
+    com_pos = com.p();
+    com_acc = com.a();
+  }
 
-  Eigen::Matrix3d w_R_b = base_angular_.GetRotationMatrixBaseToWorld(t);
-  Eigen::Vector3d omega = base_angular_.GetAngularVelocityInWorld(t);
-  Eigen::Vector3d omega_dot = base_angular_.GetAngularAccelerationInWorld(t);
+  Eigen::Matrix3d w_R_b = base_angular_->GetRotationMatrixBaseToWorld(t);
+  Eigen::Vector3d omega = base_angular_->GetAngularVelocityInWorld(t);
+  Eigen::Vector3d omega_dot = base_angular_->GetAngularAccelerationInWorld(t);
 
-  int n_ee = model_->GetEECount();
-  std::vector<Eigen::Vector3d> ee_pos;
-  std::vector<Eigen::Vector3d> ee_force;
-  for (int ee=0; ee<n_ee; ++ee) {
-    ee_force.push_back(ee_forces_.at(ee)->GetPoint(t).p());
-    ee_pos.push_back(ee_motion_.at(ee)->GetPoint(t).p());
+  // filled in place, this function runs at every instant of the grid
+  for (int ee=0; ee<model_->GetEECount(); ++ee) {
+    if (state_grid_) {
+      ee_force_.at(ee) = state_grid_->GetStates(ee_forces_.at(ee).get()).at(k).p();
+      ee_pos_.at(ee)   = state_grid_->GetStates(ee_motion_.at(ee).get()).at(k).p();
+    } else {
+      ee_force_.at(ee) = ee_forces_.at(ee)->GetPoint(t).p();
+      ee_pos_.at(ee)   = ee_motion_.at(ee)->GetPoint(t).p();
+    }
   }
 
-  model_->SetCurrent(com.p(), com.a(), w_R_b, omega, omega_dot, ee_force, ee_pos);
+  model_->SetCurrent(com_pos, com_acc, w_R_b, omega, omega_dot, ee_force_, ee_pos_);
 }
 
 } /* namespace towr */
@@ -63,4 +63,46 @@ DynamicModel::SetCurrent (const ComPos& com_W, const Vector3d com_acc_W,
   ee_pos_    = pos_W;
 }
 
+void
+DynamicModel::StateArrays::Resize (int n_instants, int ee_count)
+{
+  com_pos.resize(3, n_instants);
+  com_acc.resize(3, n_instants);
+  omega.resize(3, n_instants);
+  omega_dot.resize(3, n_instants);
+  w_R_b.resize(n_instants);
+
+  ee_force.resize(ee_count);
+  ee_pos.resize(ee_count);
+  for (int ee=0; ee<ee_count; ++ee) {
+    ee_force.at(ee).resize(3, n_instants);
+    ee_pos.at(ee).resize(3, n_instants);
+  }
+}
+
+void
+DynamicModel::ComputeViolationsBatch (const StateArrays& states,
+                                      Matrix6Xd& out) const
+{
+  int n = states.GetCount();
+  int n_ee = states.ee_force.size();
+  out.resize(6, n);
+
+  // generic fallback: evaluate the instants one by one
+  EELoad force(n_ee);
+  EEPos pos(n_ee);
+  for (int k=0; k<n; ++k) {
+    for (int ee=0; ee<n_ee; ++ee) {
+      force.at(ee) = states.ee_force.at(ee).col(k);
+      pos.at(ee)   = states.ee_pos.at(ee).col(k);
+    }
+    out.col(k) = ComputeViolation(states.com_pos.col(k),
+                                  states.com_acc.col(k),
+                                  states.w_R_b.at(k),
+                                  states.omega.col(k),
+                                  states.omega_dot.col(k),
+                                  force, pos);
+  }
+}
+
 } /* namespace towr */
@@ -29,8 +29,10 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <towr/variables/euler_converter.h>
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <vector>
 
 namespace towr {
 
@@ -44,8 +46,7 @@ EulerConverter::EulerConverter (const NodeSpline::Ptr& euler)
 Eigen::Quaterniond
 EulerConverter::GetQuaternionBaseToWorld (double t) const
 {
-  State ori = euler_->GetPoint(t);
-  return GetQuaternionBaseToWorld(ori.p());
+  return GetQuaternionBaseToWorld(GetCachedState(t).p());
 }
 
 Eigen::Quaterniond
@@ -58,8 +59,8 @@ EulerConverter::GetQuaternionBaseToWorld (const EulerAngles& pos)
 Eigen::Vector3d
 EulerConverter::GetAngularVelocityInWorld (double t) const
 {
-  State ori = euler_->GetPoint(t);
-  return GetAngularVelocityInWorld(ori.p(), ori.v());
+  const State& ori = GetCachedState(t);
+  return GetMCached(t)*ori.v();
 }
 
 Eigen::Vector3d
@@ -72,8 +73,8 @@ EulerConverter::GetAngularVelocityInWorld (const EulerAngles& pos,
 Eigen::Vector3d
 EulerConverter::GetAngularAccelerationInWorld (double t) const
 {
-  State ori = euler_->GetPoint(t);
-  return GetAngularAccelerationInWorld(ori);
+  const State& ori = GetCachedState(t);
+  return GetMdotCached(t)*ori.v() + GetMCached(t)*ori.a();
 }
 
 Eigen::Vector3d
@@ -85,109 +86,118 @@ EulerConverter::GetAngularAccelerationInWorld (State ori)
 EulerConverter::Jacobian
 EulerConverter::GetDerivOfAngVelWrtEulerNodes(double t) const
 {
-  Jacobian jac = jac_wrt_nodes_structure_;
+  const State& ori = GetCachedState(t);
+  const Eigen::Matrix3d& M = GetMCached(t);
+  MatrixRXd dVel_du = MatrixRXd(GetJacobianWrtNodesCached(t, kVel));
 
-  State ori = euler_->GetPoint(t);
-  // convert to sparse, but also regard 0.0 as non-zero element, because
-  // could turn nonzero during the course of the program
-  JacobianRow vel = ori.v().transpose().sparseView(1.0, -1.0);
-  Jacobian dVel_du  = euler_->GetJacobianWrtNodes(t, kVel);
+  // accumulate densely; one conversion at the boundary below.
+  MatrixRXd jac(k3D, dVel_du.cols());
+  for (auto dim : {X,Y,Z})
+    jac.row(dim) = ori.v().transpose()*GetDerivMwrtNodes(t,dim)
+                   + M.row(dim)*dVel_du;
 
-  for (auto dim : {X,Y,Z}) {
-    Jacobian dM_du = GetDerivMwrtNodes(t,dim);
-    jac.row(dim) = vel*dM_du + GetM(ori.p()).row(dim)*dVel_du;
-  }
-
-  return jac;
+  return ToSparseAtBoundary(t, jac);
 }
 
 EulerConverter::Jacobian
 EulerConverter::GetDerivOfAngAccWrtEulerNodes (double t) const
 {
-  Jacobian jac = jac_wrt_nodes_structure_;
-
-
-  State ori = euler_->GetPoint(t);
-  // convert to sparse, but also regard 0.0 as non-zero element, because
-  // could turn nonzero during the course of the program
-  JacobianRow vel = ori.v().transpose().sparseView(1.0, -1.0);
-  JacobianRow acc = ori.a().transpose().sparseView(1.0, -1.0);
-
-  Jacobian dVel_du  = euler_->GetJacobianWrtNodes(t, kVel);
-  Jacobian dAcc_du  = euler_->GetJacobianWrtNodes(t, kAcc);
-
-
-  for (auto dim : {X,Y,Z}) {
-    Jacobian dMdot_du = GetDerivMdotwrtNodes(t,dim);
-    Jacobian dM_du    = GetDerivMwrtNodes(t,dim);
-
-    jac.row(dim) = vel                               * dMdot_du
-                   + GetMdot(ori.p(), ori.v()).row(dim)* dVel_du
-                   + acc                             * dM_du
-                   + GetM(ori.p()).row(dim)           * dAcc_du;
-  }
+  const State& ori = GetCachedState(t);
+  const Eigen::Matrix3d& M    = GetMCached(t);
+  const Eigen::Matrix3d& Mdot = GetMdotCached(t);
+  MatrixRXd dVel_du = MatrixRXd(GetJacobianWrtNodesCached(t, kVel));
+  MatrixRXd dAcc_du = MatrixRXd(GetJacobianWrtNodesCached(t, kAcc));
+
+  // accumulate densely; one conversion at the boundary below.
+  MatrixRXd jac(k3D, dVel_du.cols());
+  for (auto dim : {X,Y,Z})
+    jac.row(dim) = ori.v().transpose()*GetDerivMdotwrtNodes(t,dim)
+                   + Mdot.row(dim)*dVel_du
+                   + ori.a().transpose()*GetDerivMwrtNodes(t,dim)
+                   + M.row(dim)*dAcc_du;
+
+  return ToSparseAtBoundary(t, jac);
+}
 
-  return jac;
+EulerConverter::TrigState
+EulerConverter::GetTrig (const EulerAngles& xyz)
+{
+  TrigState trig;
+  trig.sx_ = sin(xyz(X)); trig.cx_ = cos(xyz(X));
+  trig.sy_ = sin(xyz(Y)); trig.cy_ = cos(xyz(Y));
+  trig.sz_ = sin(xyz(Z)); trig.cz_ = cos(xyz(Z));
+  return trig;
 }
 
-EulerConverter::MatrixSXd
+Eigen::Matrix3d
 EulerConverter::GetM (const EulerAngles& xyz)
 {
-  double z = xyz(Z);
-  double y = xyz(Y);
+  return GetM(GetTrig(xyz));
+}
+
+Eigen::Matrix3d
+EulerConverter::GetM (const TrigState& trig)
+{
+  double cz = trig.cz_; double sz = trig.sz_;
+  double cy = trig.cy_; double sy = trig.sy_;
 
   // Euler ZYX rates to angular velocity
   // http://docs.leggedrobotics.com/kindr/cheatsheet_latest.pdf
-  Jacobian M(k3D, k3D);
-
-       /* - */           M.coeffRef(0,Y) = -sin(z);  M.coeffRef(0,X) =  cos(y)*cos(z);
-       /* - */           M.coeffRef(1,Y) =  cos(z);  M.coeffRef(1,X) =  cos(y)*sin(z);
-  M.coeffRef(2,Z) = 1.0;          /* - */            M.coeffRef(2,X) =  -sin(y);
+  Eigen::Matrix3d M;
+  M << cy*cz, -sz, 0.0,
+       cy*sz,  cz, 0.0,
+         -sy, 0.0, 1.0;
 
   return M;
 }
 
-EulerConverter::MatrixSXd
+Eigen::Matrix3d
 EulerConverter::GetMdot (const EulerAngles& xyz,
                          const EulerRates& xyz_d)
 {
-  double z  = xyz(Z);
+  return GetMdot(GetTrig(xyz), xyz_d);
+}
+
+Eigen::Matrix3d
+EulerConverter::GetMdot (const TrigState& trig,
+                         const EulerRates& xyz_d)
+{
+  double cz = trig.cz_; double sz = trig.sz_;
+  double cy = trig.cy_; double sy = trig.sy_;
   double zd = xyz_d(Z);
-  double y  = xyz(Y);
   double yd = xyz_d(Y);
 
-  Jacobian Mdot(k3D, k3D);
+  Eigen::Matrix3d Mdot;
+  Mdot << -cz*sy*yd - cy*sz*zd, -cz*zd, 0.0,
+           cy*cz*zd - sy*sz*yd, -sz*zd, 0.0,
+                        -cy*yd,    0.0, 0.0;
 
-  Mdot.coeffRef(0,Y) = -cos(z)*zd; Mdot.coeffRef(0,X) = -cos(z)*sin(y)*yd - cos(y)*sin(z)*zd;
-  Mdot.coeffRef(1,Y) = -sin(z)*zd; Mdot.coeffRef(1,X) =  cos(y)*cos(z)*zd - sin(y)*sin(z)*yd;
-              /* - */              Mdot.coeffRef(2,X) = -cos(y)*yd;
-
- return Mdot;
+  return Mdot;
 }
 
-EulerConverter::Jacobian
+EulerConverter::MatrixRXd
 EulerConverter::GetDerivMwrtNodes (double t, Dim3D ang_acc_dim) const
 {
-  State ori = euler_->GetPoint(t);
+  const TrigState& trig = GetTrigCached(t);
+  double cz = trig.cz_; double sz = trig.sz_;
+  double cy = trig.cy_; double sy = trig.sy_;
 
-  double z = ori.p()(Z);
-  double y = ori.p()(Y);
-  JacobianRow jac_z = GetJac(t, kPos, Z);
-  JacobianRow jac_y = GetJac(t, kPos, Y);
+  RowVecXd jac_z = RowVecXd(GetJac(t, kPos, Z));
+  RowVecXd jac_y = RowVecXd(GetJac(t, kPos, Y));
 
-  Jacobian jac = jac_wrt_nodes_structure_;
+  MatrixRXd jac = MatrixRXd::Zero(k3D, jac_z.cols());
 
   switch (ang_acc_dim) {
     case X: // basically derivative of top row (3 elements) of matrix M
-      jac.row(Y) = -cos(z)*jac_z;
-      jac.row(X) = -cos(z)*sin(y)*jac_y - cos(y)*sin(z)*jac_z;
+      jac.row(Y) = -cz*jac_z;
+      jac.row(X) = -cz*sy*jac_y - cy*sz*jac_z;
       break;
     case Y: // middle row of M
-      jac.row(Y) = -sin(z)*jac_z;
-      jac.row(X) = cos(y)*cos(z)*jac_z - sin(y)*sin(z)*jac_y;
+      jac.row(Y) = -sz*jac_z;
+      jac.row(X) = cy*cz*jac_z - sy*sz*jac_y;
       break;
     case Z: // bottom row of M
-      jac.row(X) = -cos(y)*jac_y;
+      jac.row(X) = -cy*jac_y;
       break;
     default:
       assert(false);
@@ -200,22 +210,31 @@ EulerConverter::GetDerivMwrtNodes (double t, Dim3D ang_acc_dim) const
 EulerConverter::MatrixSXd
 EulerConverter::GetRotationMatrixBaseToWorld (double t) const
 {
-  State ori = euler_->GetPoint(t);
-  return GetRotationMatrixBaseToWorld(ori.p());
+  if (!cache_.w_R_b_valid_) {
+    cache_.w_R_b_ = GetRotationMatrixBaseToWorld(GetTrigCached(t));
+    cache_.w_R_b_valid_ = true;
+  }
+  return cache_.w_R_b_;
 }
 
 EulerConverter::MatrixSXd
 EulerConverter::GetRotationMatrixBaseToWorld (const EulerAngles& xyz)
 {
-  double x = xyz(X);
-  double y = xyz(Y);
-  double z = xyz(Z);
+  return GetRotationMatrixBaseToWorld(GetTrig(xyz));
+}
+
+EulerConverter::MatrixSXd
+EulerConverter::GetRotationMatrixBaseToWorld (const TrigState& trig)
+{
+  double cx = trig.cx_; double sx = trig.sx_;
+  double cy = trig.cy_; double sy = trig.sy_;
+  double cz = trig.cz_; double sz = trig.sz_;
 
   Eigen::Matrix3d M;
   //  http://docs.leggedrobotics.com/kindr/cheatsheet_latest.pdf (Euler ZYX)
-  M << cos(y)*cos(z), cos(z)*sin(x)*sin(y) - cos(x)*sin(z), sin(x)*sin(z) + cos(x)*cos(z)*sin(y),
-       cos(y)*sin(z), cos(x)*cos(z) + sin(x)*sin(y)*sin(z), cos(x)*sin(y)*sin(z) - cos(z)*sin(x),
-             -sin(y),                        cos(y)*sin(x),                        cos(x)*cos(y);
+  M << cy*cz, cz*sx*sy - cx*sz, sx*sz + cx*cz*sy,
+       cy*sz, cx*cz + sx*sy*sz, cx*sy*sz - cz*sx,
+         -sy,            cy*sx,            cx*cy;
 
   return M.sparseView(1.0, -1.0);
 }
@@ -224,18 +243,18 @@ EulerConverter::Jacobian
 EulerConverter::DerivOfRotVecMult (double t, const Vector3d& v, bool inverse) const
 {
   JacRowMatrix Rd = GetDerivativeOfRotationMatrixWrtNodes(t);
-  Jacobian jac = jac_wrt_nodes_structure_;
+  MatrixRXd jac = MatrixRXd::Zero(k3D, jac_wrt_nodes_structure_.cols());
 
   for (int row : {X,Y,Z}) {
     for (int col : {X, Y, Z}) {
       // since for every rotation matrix R^(-1) = R^T, just swap rows and
       // columns for calculation of derivative of inverse rotation matrix
-      JacobianRow jac_row = inverse? Rd.at(col).at(row) : Rd.at(row).at(col);
-      jac.row(row) += v(col)*jac_row;
+      const JacobianRow& jac_row = inverse? Rd.at(col).at(row) : Rd.at(row).at(col);
+      jac.row(row) += v(col)*RowVecXd(jac_row);
     }
   }
 
-  return jac;
+  return ToSparseAtBoundary(t, jac);
 }
 
 EulerConverter::JacRowMatrix
@@ -243,57 +262,58 @@ EulerConverter::GetDerivativeOfRotationMatrixWrtNodes (double t) const
 {
   JacRowMatrix jac;
 
-  State ori = euler_->GetPoint(t);
-  double x = ori.p()(X);
-  double y = ori.p()(Y);
-  double z = ori.p()(Z);
+  const TrigState& trig = GetTrigCached(t);
+  double cx = trig.cx_; double sx = trig.sx_;
+  double cy = trig.cy_; double sy = trig.sy_;
+  double cz = trig.cz_; double sz = trig.sz_;
 
   JacobianRow jac_x = GetJac(t, kPos, X);
   JacobianRow jac_y = GetJac(t, kPos, Y);
   JacobianRow jac_z = GetJac(t, kPos, Z);
 
-  jac.at(X).at(X) = -cos(z)*sin(y)*jac_y - cos(y)*sin(z)*jac_z;
-  jac.at(X).at(Y) =  sin(x)*sin(z)*jac_x - cos(x)*cos(z)*jac_z - sin(x)*sin(y)*sin(z)*jac_z + cos(x)*cos(z)*sin(y)*jac_x + cos(y)*cos(z)*sin(x)*jac_y;
-  jac.at(X).at(Z) =  cos(x)*sin(z)*jac_x + cos(z)*sin(x)*jac_z - cos(z)*sin(x)*sin(y)*jac_x - cos(x)*sin(y)*sin(z)*jac_z + cos(x)*cos(y)*cos(z)*jac_y;
+  jac.at(X).at(X) = -cz*sy*jac_y - cy*sz*jac_z;
+  jac.at(X).at(Y) =  sx*sz*jac_x - cx*cz*jac_z - sx*sy*sz*jac_z + cx*cz*sy*jac_x + cy*cz*sx*jac_y;
+  jac.at(X).at(Z) =  cx*sz*jac_x + cz*sx*jac_z - cz*sx*sy*jac_x - cx*sy*sz*jac_z + cx*cy*cz*jac_y;
 
-  jac.at(Y).at(X) = cos(y)*cos(z)*jac_z - sin(y)*sin(z)*jac_y;
-  jac.at(Y).at(Y) = cos(x)*sin(y)*sin(z)*jac_x - cos(x)*sin(z)*jac_z - cos(z)*sin(x)*jac_x + cos(y)*sin(x)*sin(z)*jac_y + cos(z)*sin(x)*sin(y)*jac_z;
-  jac.at(Y).at(Z) = sin(x)*sin(z)*jac_z - cos(x)*cos(z)*jac_x - sin(x)*sin(y)*sin(z)*jac_x + cos(x)*cos(y)*sin(z)*jac_y + cos(x)*cos(z)*sin(y)*jac_z;
+  jac.at(Y).at(X) = cy*cz*jac_z - sy*sz*jac_y;
+  jac.at(Y).at(Y) = cx*sy*sz*jac_x - cx*sz*jac_z - cz*sx*jac_x + cy*sx*sz*jac_y + cz*sx*sy*jac_z;
+  jac.at(Y).at(Z) = sx*sz*jac_z - cx*cz*jac_x - sx*sy*sz*jac_x + cx*cy*sz*jac_y + cx*cz*sy*jac_z;
 
-  jac.at(Z).at(X) = -cos(y)*jac_y;
-  jac.at(Z).at(Y) =  cos(x)*cos(y)*jac_x - sin(x)*sin(y)*jac_y;
-  jac.at(Z).at(Z) = -cos(y)*sin(x)*jac_x - cos(x)*sin(y)*jac_y;
+  jac.at(Z).at(X) = -cy*jac_y;
+  jac.at(Z).at(Y) =  cx*cy*jac_x - sx*sy*jac_y;
+  jac.at(Z).at(Z) = -cy*sx*jac_x - cx*sy*jac_y;
 
   return jac;
 }
 
-EulerConverter::Jacobian
+EulerConverter::MatrixRXd
 EulerConverter::GetDerivMdotwrtNodes (double t, Dim3D ang_acc_dim) const
 {
-  State ori = euler_->GetPoint(t);
+  const State& ori = GetCachedState(t);
+  const TrigState& trig = GetTrigCached(t);
 
-  double z  = ori.p()(Z);
+  double cz = trig.cz_; double sz = trig.sz_;
+  double cy = trig.cy_; double sy = trig.sy_;
   double zd = ori.v()(Z);
-  double y  = ori.p()(Y);
   double yd = ori.v()(Y);
 
-  JacobianRow jac_z  = GetJac(t, kPos, Z);
-  JacobianRow jac_y  = GetJac(t, kPos, Y);
-  JacobianRow jac_zd = GetJac(t, kVel, Z);
-  JacobianRow jac_yd = GetJac(t, kVel, Y);
+  RowVecXd jac_z  = RowVecXd(GetJac(t, kPos, Z));
+  RowVecXd jac_y  = RowVecXd(GetJac(t, kPos, Y));
+  RowVecXd jac_zd = RowVecXd(GetJac(t, kVel, Z));
+  RowVecXd jac_yd = RowVecXd(GetJac(t, kVel, Y));
 
-  Jacobian jac = jac_wrt_nodes_structure_;
+  MatrixRXd jac = MatrixRXd::Zero(k3D, jac_z.cols());
   switch (ang_acc_dim) {
     case X: // derivative of top row (3 elements) of matrix M-dot
-      jac.row(Y) = sin(z)*zd*jac_z - cos(z)*jac_zd;
-      jac.row(X) = sin(y)*sin(z)*yd*jac_z - cos(y)*sin(z)*jac_zd - cos(y)*cos(z)*yd*jac_y - cos(y)*cos(z)*zd*jac_z - cos(z)*sin(y)*jac_yd + sin(y)*sin(z)*jac_y*zd;
+      jac.row(Y) = sz*zd*jac_z - cz*jac_zd;
+      jac.row(X) = sy*sz*yd*jac_z - cy*sz*jac_zd - cy*cz*yd*jac_y - cy*cz*zd*jac_z - cz*sy*jac_yd + sy*sz*jac_y*zd;
       break;
     case Y: // middle row of M
-      jac.row(Y) = - sin(z)*jac_zd - cos(z)*zd*jac_z;
-      jac.row(X) = cos(y)*cos(z)*jac_zd - sin(y)*sin(z)*jac_yd - cos(y)*sin(z)*yd*jac_y - cos(z)*sin(y)*yd*jac_z - cos(z)*sin(y)*jac_y*zd - cos(y)*sin(z)*zd*jac_z;
+      jac.row(Y) = - sz*jac_zd - cz*zd*jac_z;
+      jac.row(X) = cy*cz*jac_zd - sy*sz*jac_yd - cy*sz*yd*jac_y - cz*sy*yd*jac_z - cz*sy*jac_y*zd - cy*sz*zd*jac_z;
       break;
     case Z: // bottom Row of M
-      jac.row(X) = sin(y)*yd*jac_y - cos(y)*jac_yd;
+      jac.row(X) = sy*yd*jac_y - cy*jac_yd;
       break;
     default:
       assert(false);
@@ -306,7 +326,127 @@ EulerConverter::GetDerivMdotwrtNodes (double t, Dim3D ang_acc_dim) const
 EulerConverter::JacobianRow
 EulerConverter::GetJac (double t, Dx deriv, Dim3D dim) const
 {
-  return euler_->GetJacobianWrtNodes(t, deriv).row(dim);
+  return GetJacobianWrtNodesCached(t, deriv).row(dim);
+}
+
+EulerConverter::Jacobian
+EulerConverter::ToSparseAtBoundary (double t, const MatrixRXd& dense) const
+{
+  // the position Jacobian carries the band of the polynomial active at t,
+  // including explicit zeros, and all derivs share the same band.
+  const Jacobian& band = GetJacobianWrtNodesCached(t, kPos);
+
+  std::vector<int> cols;
+  cols.reserve(band.nonZeros());
+  for (int k=0; k<band.outerSize(); ++k)
+    for (Jacobian::InnerIterator it(band, k); it; ++it)
+      cols.push_back(it.col());
+  std::sort(cols.begin(), cols.end());
+  cols.erase(std::unique(cols.begin(), cols.end()), cols.end());
+
+  Jacobian jac(k3D, dense.cols());
+  jac.reserve(Eigen::VectorXi::Constant(k3D, cols.size()));
+  for (int row=0; row<k3D; ++row)
+    for (int col : cols)
+      jac.insert(row, col) = dense(row, col);
+
+  jac.makeCompressed();
+  return jac;
+}
+
+const State&
+EulerConverter::GetCachedState (double t) const
+{
+  int epoch = euler_->GetUpdateCount();
+  if (t != cache_.t_ || epoch != cache_.epoch_) {
+    cache_.t_     = t;
+    cache_.epoch_ = epoch;
+    cache_.ori_   = euler_->GetPoint(t);
+
+    cache_.trig_valid_    = false;
+    cache_.M_valid_       = false;
+    cache_.Mdot_valid_    = false;
+    cache_.M_sp_valid_    = false;
+    cache_.Mdot_sp_valid_ = false;
+    cache_.w_R_b_valid_   = false;
+    cache_.jac_valid_   = {{false, false, false}};
+  }
+
+  return cache_.ori_;
+}
+
+const EulerConverter::TrigState&
+EulerConverter::GetTrigCached (double t) const
+{
+  const State& ori = GetCachedState(t);
+  if (!cache_.trig_valid_) {
+    cache_.trig_ = GetTrig(ori.p());
+    cache_.trig_valid_ = true;
+  }
+
+  return cache_.trig_;
+}
+
+const Eigen::Matrix3d&
+EulerConverter::GetMCached (double t) const
+{
+  if (!cache_.M_valid_) {
+    cache_.M_ = GetM(GetTrigCached(t));
+    cache_.M_valid_ = true;
+  }
+
+  return cache_.M_;
+}
+
+const Eigen::Matrix3d&
+EulerConverter::GetMdotCached (double t) const
+{
+  const State& ori = GetCachedState(t);
+  if (!cache_.Mdot_valid_) {
+    cache_.Mdot_ = GetMdot(GetTrigCached(t), ori.v());
+    cache_.Mdot_valid_ = true;
+  }
+
+  return cache_.Mdot_;
+}
+
+const EulerConverter::MatrixSXd&
+EulerConverter::GetMSparseCached (double t) const
+{
+  if (!cache_.M_sp_valid_) {
+    // regard 0.0 as non-zero element, because the values can turn nonzero
+    // during the course of the program
+    cache_.M_sp_ = GetMCached(t).sparseView(1.0, -1.0);
+    cache_.M_sp_valid_ = true;
+  }
+
+  return cache_.M_sp_;
+}
+
+const EulerConverter::MatrixSXd&
+EulerConverter::GetMdotSparseCached (double t) const
+{
+  if (!cache_.Mdot_sp_valid_) {
+    // regard 0.0 as non-zero element, because the values can turn nonzero
+    // during the course of the program
+    cache_.Mdot_sp_ = GetMdotCached(t).sparseView(1.0, -1.0);
+    cache_.Mdot_sp_valid_ = true;
+  }
+
+  return cache_.Mdot_sp_;
+}
+
+const EulerConverter::Jacobian&
+EulerConverter::GetJacobianWrtNodesCached (double t, Dx deriv) const
+{
+  GetCachedState(t); // synchronizes cache with query time and iteration
+
+  if (!cache_.jac_valid_.at(deriv)) {
+    cache_.jac_wrt_nodes_.at(deriv) = euler_->GetJacobianWrtNodes(t, deriv);
+    cache_.jac_valid_.at(deriv) = true;
+  }
+
+  return cache_.jac_wrt_nodes_.at(deriv);
 }
 
 } /* namespace towr */
@@ -0,0 +1,111 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <towr/evaluation_trace.h>
+
+#include <fstream>
+#include <stdexcept>
+
+namespace towr {
+
+EvaluationTrace::EvaluationTrace (std::size_t capacity)
+{
+  spans_.resize(capacity);
+  epoch_ = Clock::now();
+}
+
+int
+EvaluationTrace::RegisterName (const std::string& name)
+{
+  for (std::size_t i=0; i<names_.size(); ++i)
+    if (names_.at(i) == name)
+      return i;
+
+  names_.push_back(name);
+  return names_.size()-1;
+}
+
+void
+EvaluationTrace::Record (int name_id, SpanKind kind,
+                         Clock::time_point t0, Clock::time_point t1)
+{
+  if (n_spans_ >= spans_.size()) {
+    n_dropped_++;
+    return;
+  }
+
+  using std::chrono::nanoseconds;
+  using std::chrono::duration_cast;
+
+  Span& s = spans_[n_spans_++];
+  s.name_id     = name_id;
+  s.kind        = kind;
+  s.t_start_ns  = duration_cast<nanoseconds>(t0 - epoch_).count();
+  s.duration_ns = duration_cast<nanoseconds>(t1 - t0).count();
+}
+
+void
+EvaluationTrace::Clear ()
+{
+  n_spans_ = 0;
+  n_dropped_ = 0;
+  epoch_ = Clock::now();
+}
+
+void
+EvaluationTrace::WriteChromeTrace (const std::string& path) const
+{
+  std::ofstream file(path, std::ios::trunc);
+  if (!file)
+    throw std::runtime_error("EvaluationTrace: cannot open " + path);
+
+  // complete ("X") trace events with microsecond timestamps; value and
+  // Jacobian evaluations get their own track (tid) so the two phases of
+  // each solver iteration line up visually.
+  file << "{\"traceEvents\":[";
+  for (std::size_t i=0; i<n_spans_; ++i) {
+    const Span& s = spans_[i];
+    if (i > 0)
+      file << ",";
+    file << "\n{\"name\":\"" << names_.at(s.name_id) << "\""
+         << ",\"cat\":\"" << (s.kind==Values? "values":"jacobian") << "\""
+         << ",\"ph\":\"X\""
+         << ",\"pid\":1"
+         << ",\"tid\":" << (s.kind==Values? 1:2)
+         << ",\"ts\":" << s.t_start_ns/1000.0
+         << ",\"dur\":" << s.duration_ns/1000.0
+         << "}";
+  }
+  file << "\n]}\n";
+
+  if (!file)
+    throw std::runtime_error("EvaluationTrace: writing " + path + " failed");
+}
+
+} /* namespace towr */
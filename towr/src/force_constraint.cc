@@ -29,6 +29,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <towr/constraints/force_constraint.h>
 
+#include <algorithm> // std::max
+
 #include <towr/variables/variable_names.h>
 
 namespace towr {
@@ -55,10 +57,52 @@ ForceConstraint::InitVariableDependedQuantities (const VariablesPtr& x)
 
   pure_stance_force_node_ids_ = ee_force_->GetIndicesOfNonConstantNodes();
 
+  // one cached terrain frame per phase, rebuilt lazily (@sa GetFrame()).
+  int n_phases = 0;
+  for (int f_node_id : pure_stance_force_node_ids_)
+    n_phases = std::max(n_phases, ee_force_->GetPhase(f_node_id) + 1);
+  frames_.assign(n_phases, TerrainFrame());
+
   int constraint_count = pure_stance_force_node_ids_.size()*n_constraints_per_node_;
   SetRows(constraint_count);
 }
 
+const ForceConstraint::TerrainFrame&
+ForceConstraint::GetFrame (int phase) const
+{
+  TerrainFrame& fr = frames_.at(phase);
+  Eigen::Vector2d p = ee_motion_->GetValueAtStartOfPhase(phase).topRows<k2D>();
+
+  if (fr.valid && (p - fr.p).cwiseAbs().maxCoeff() <= frame_tolerance_)
+    return fr;
+
+  Vector3d n  = terrain_->GetNormalizedBasis(HeightMap::Normal,   p.x(), p.y());
+  Vector3d t1 = terrain_->GetNormalizedBasis(HeightMap::Tangent1, p.x(), p.y());
+  Vector3d t2 = terrain_->GetNormalizedBasis(HeightMap::Tangent2, p.x(), p.y());
+
+  fr.pyramid.row(0) = n;           // unilateral force
+  fr.pyramid.row(1) = t1 - mu_*n;  // f_t1 <  mu*n
+  fr.pyramid.row(2) = t1 + mu_*n;  // f_t1 > -mu*n
+  fr.pyramid.row(3) = t2 - mu_*n;  // f_t2 <  mu*n
+  fr.pyramid.row(4) = t2 + mu_*n;  // f_t2 > -mu*n
+
+  for (auto dim : {X_,Y_}) {
+    Vector3d dn  = terrain_->GetDerivativeOfNormalizedBasisWrt(HeightMap::Normal,   dim, p.x(), p.y());
+    Vector3d dt1 = terrain_->GetDerivativeOfNormalizedBasisWrt(HeightMap::Tangent1, dim, p.x(), p.y());
+    Vector3d dt2 = terrain_->GetDerivativeOfNormalizedBasisWrt(HeightMap::Tangent2, dim, p.x(), p.y());
+
+    fr.pyramid_deriv[dim].row(0) = dn;
+    fr.pyramid_deriv[dim].row(1) = dt1 - mu_*dn;
+    fr.pyramid_deriv[dim].row(2) = dt1 + mu_*dn;
+    fr.pyramid_deriv[dim].row(3) = dt2 - mu_*dn;
+    fr.pyramid_deriv[dim].row(4) = dt2 + mu_*dn;
+  }
+
+  fr.p = p;
+  fr.valid = true;
+  return fr;
+}
+
 Eigen::VectorXd
 ForceConstraint::GetValues () const
 {
@@ -66,23 +110,14 @@ ForceConstraint::GetValues () const
 
   int row=0;
   auto force_nodes = ee_force_->GetNodes();
+
+  // the foothold and therefore the terrain basis is identical for all
+  // force nodes of one stance phase, so the frame is cached per phase;
+  // all five pyramid rows of a node are one fixed-size product.
   for (int f_node_id : pure_stance_force_node_ids_) {
-    int phase  = ee_force_->GetPhase(f_node_id);
-    Vector3d p = ee_motion_->GetValueAtStartOfPhase(phase); // doesn't change during stance phase
-    Vector3d n = terrain_->GetNormalizedBasis(HeightMap::Normal, p.x(), p.y());
-    Vector3d f = force_nodes.at(f_node_id).p();
-
-    // unilateral force
-    g(row++) = f.transpose() * n; // >0 (unilateral forces)
-
-    // frictional pyramid
-    Vector3d t1 = terrain_->GetNormalizedBasis(HeightMap::Tangent1, p.x(), p.y());
-    g(row++) = f.transpose() * (t1 - mu_*n); // t1 < mu*n
-    g(row++) = f.transpose() * (t1 + mu_*n); // t1 > -mu*n
-
-    Vector3d t2 = terrain_->GetNormalizedBasis(HeightMap::Tangent2, p.x(), p.y());
-    g(row++) = f.transpose() * (t2 - mu_*n); // t2 < mu*n
-    g(row++) = f.transpose() * (t2 + mu_*n); // t2 > -mu*n
+    const TerrainFrame& fr = GetFrame(ee_force_->GetPhase(f_node_id));
+    g.segment<5>(row) = fr.pyramid * force_nodes.at(f_node_id).p();
+    row += n_constraints_per_node_;
   }
 
   return g;
@@ -109,64 +144,61 @@ ForceConstraint::FillJacobianBlock (std::string var_set,
                                     Jacobian& jac) const
 {
   if (var_set == ee_force_->GetName()) {
+    jac_ws_force_.Start(jac);
+
+    // chain rule for the optional variable scaling of the force set.
+    const double s = ee_force_->GetVariableScaling();
+
     int row = 0;
     for (int f_node_id : pure_stance_force_node_ids_) {
-      // unilateral force
-      int phase   = ee_force_->GetPhase(f_node_id);
-      Vector3d p  = ee_motion_->GetValueAtStartOfPhase(phase); // doesn't change during phase
-      Vector3d n  = terrain_->GetNormalizedBasis(HeightMap::Normal,   p.x(), p.y());
-      Vector3d t1 = terrain_->GetNormalizedBasis(HeightMap::Tangent1, p.x(), p.y());
-      Vector3d t2 = terrain_->GetNormalizedBasis(HeightMap::Tangent2, p.x(), p.y());
+      // the terrain basis only changes between stance phases
+      const TerrainFrame& fr = GetFrame(ee_force_->GetPhase(f_node_id));
 
       for (auto dim : {X,Y,Z}) {
         int idx = ee_force_->GetOptIndex(Nodes::NodeValueInfo(f_node_id, kPos, dim));
 
-        int row_reset=row;
-
-        jac.coeffRef(row_reset++, idx) = n(dim);              // unilateral force
-        jac.coeffRef(row_reset++, idx) = t1(dim)-mu_*n(dim);  // f_t1 <  mu*n
-        jac.coeffRef(row_reset++, idx) = t1(dim)+mu_*n(dim);  // f_t1 > -mu*n
-        jac.coeffRef(row_reset++, idx) = t2(dim)-mu_*n(dim);  // f_t2 <  mu*n
-        jac.coeffRef(row_reset++, idx) = t2(dim)+mu_*n(dim);  // f_t2 > -mu*n
+        // the pyramid column of this force dimension holds all five rows
+        for (int c=0; c<n_constraints_per_node_; ++c)
+          jac_ws_force_.Write(row+c, idx, s*fr.pyramid(c,dim));
       }
 
       row += n_constraints_per_node_;
     }
+
+    jac_ws_force_.Finish();
   }
 
 
   if (var_set == ee_motion_->GetName()) {
+    jac_ws_motion_.Start(jac);
+
+    // chain rule for the optional variable scaling of the motion set.
+    const double s = ee_motion_->GetVariableScaling();
+
     int row = 0;
     auto force_nodes = ee_force_->GetNodes();
     for (int f_node_id : pure_stance_force_node_ids_) {
       int phase  = ee_force_->GetPhase(f_node_id);
       int ee_node_id = ee_motion_->GetNodeIDAtStartOfPhase(phase);
 
-      Vector3d p = ee_motion_->GetValueAtStartOfPhase(phase); // doesn't change during pahse
+      // the basis derivatives only change between stance phases
+      const TerrainFrame& fr = GetFrame(phase);
+
       Vector3d f = force_nodes.at(f_node_id).p();
 
       for (auto dim : {X_,Y_}) {
-        Vector3d dn  = terrain_->GetDerivativeOfNormalizedBasisWrt(HeightMap::Normal, dim, p.x(), p.y());
-        Vector3d dt1 = terrain_->GetDerivativeOfNormalizedBasisWrt(HeightMap::Tangent1, dim, p.x(), p.y());
-        Vector3d dt2 = terrain_->GetDerivativeOfNormalizedBasisWrt(HeightMap::Tangent2, dim, p.x(), p.y());
-
         int idx = ee_motion_->GetOptIndex(Nodes::NodeValueInfo(ee_node_id, kPos, dim));
-        int row_reset=row;
-
-        // unilateral force
-        jac.coeffRef(row_reset++, idx) = f.transpose()*dn;
 
-        // friction force tangent 1 derivative
-        jac.coeffRef(row_reset++, idx) = f.transpose()*(dt1-mu_*dn);
-        jac.coeffRef(row_reset++, idx) = f.transpose()*(dt1+mu_*dn);
-
-        // friction force tangent 2 derivative
-        jac.coeffRef(row_reset++, idx) = f.transpose()*(dt2-mu_*dn);
-        jac.coeffRef(row_reset++, idx) = f.transpose()*(dt2+mu_*dn);
+        // all five rows of this foothold dimension in one product
+        Eigen::Matrix<double,5,1> vals = s * (fr.pyramid_deriv[dim] * f);
+        for (int c=0; c<n_constraints_per_node_; ++c)
+          jac_ws_motion_.Write(row+c, idx, vals(c));
       }
 
       row += n_constraints_per_node_;
     }
+
+    jac_ws_motion_.Finish();
   }
 }
 
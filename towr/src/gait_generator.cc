@@ -51,26 +51,58 @@ GaitGenerator::MakeGaitGenerator(int leg_count)
   }
 }
 
+void
+GaitGenerator::SetCombo (Combos combo)
+{
+  ComboGait& entry = library_.at(combo);
+
+  if (!entry.built) {
+    ExpandCombo(combo);
+    entry.times                = times_;
+    entry.contacts             = contacts_;
+    entry.normalized_durations = normalized_durations_;
+    entry.built                = true;
+  } else {
+    times_                = entry.times;
+    contacts_             = entry.contacts;
+    normalized_durations_ = entry.normalized_durations;
+  }
+}
+
+void
+GaitGenerator::PrecomputeGaitLibrary ()
+{
+  // expanding a combo overwrites the current gait, so restore it afterwards
+  auto times                = times_;
+  auto contacts             = contacts_;
+  auto normalized_durations = normalized_durations_;
+
+  for (int combo=0; combo<COMBO_COUNT; ++combo)
+    SetCombo(static_cast<Combos>(combo));
+
+  times_                = times;
+  contacts_             = contacts;
+  normalized_durations_ = normalized_durations;
+}
+
 GaitGenerator::VecTimes
 GaitGenerator::GetPhaseDurations (double t_total, EE ee) const
 {
   // scale total time tu t_total
+  const VecTimes& normalized = GetNormalizedPhaseDurations(ee);
+
   std::vector<double> durations;
-  for (auto d : GetNormalizedPhaseDurations(ee))
+  durations.reserve(normalized.size());
+  for (auto d : normalized)
     durations.push_back(d*t_total);
 
   return durations;
 }
 
-GaitGenerator::VecTimes
+const GaitGenerator::VecTimes&
 GaitGenerator::GetNormalizedPhaseDurations (EE ee) const
 {
-  auto v = GetPhaseDurations().at(ee); // shorthand
-  double total_time = std::accumulate(v.begin(), v.end(), 0.0);
-  std::transform(v.begin(), v.end(), v.begin(),
-                 [total_time](double t_phase){ return t_phase/total_time;});
-
-  return v;
+  return normalized_durations_.at(ee);
 }
 
 GaitGenerator::FootDurations
@@ -126,6 +158,14 @@ GaitGenerator::SetGaits (const std::vector<Gaits>& gaits)
     times_.insert      (times_.end(), t.begin(), t.end());
     contacts_.insert(contacts_.end(), c.begin(), c.end());
   }
+
+  // normalize once here, so the per-foot queries are plain lookups.
+  normalized_durations_ = GetPhaseDurations();
+  for (auto& v : normalized_durations_) {
+    double total_time = std::accumulate(v.begin(), v.end(), 0.0);
+    std::transform(v.begin(), v.end(), v.begin(),
+                   [total_time](double t_phase){ return t_phase/total_time;});
+  }
 }
 
 GaitGenerator::GaitInfo
@@ -0,0 +1,226 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <towr/terrain/grid_height_map.h>
+
+#include <algorithm> // std::min, std::max
+#include <cmath>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace towr {
+
+GridHeightMap::GridHeightMap (const std::string& filename)
+{
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw std::runtime_error("GridHeightMap: cannot open " + filename);
+
+  struct stat sb;
+  fstat(fd, &sb);
+  file_size_ = sb.st_size;
+
+  if (file_size_ < sizeof(FileHeader)) {
+    close(fd);
+    throw std::runtime_error("GridHeightMap: file too small: " + filename);
+  }
+
+  // the kernel pages the samples in on demand, so even large elevation
+  // maps cost neither parsing time nor a copy of the data.
+  void* addr = mmap(nullptr, file_size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd); // the mapping keeps the file alive
+  if (addr == MAP_FAILED)
+    throw std::runtime_error("GridHeightMap: mmap failed: " + filename);
+
+  header_  = reinterpret_cast<const FileHeader*>(addr);
+  heights_ = reinterpret_cast<const double*>(
+                 reinterpret_cast<const char*>(addr) + sizeof(FileHeader));
+  row_stride_ = header_->n_x;
+
+  std::size_t n_samples = static_cast<std::size_t>(header_->n_x)*header_->n_y;
+  bool valid = header_->n_x >= 2 && header_->n_y >= 2
+            && header_->resolution > 0.0
+            && file_size_ >= sizeof(FileHeader) + n_samples*sizeof(double);
+  if (!valid) {
+    munmap(addr, file_size_);
+    throw std::runtime_error("GridHeightMap: inconsistent header: " + filename);
+  }
+}
+
+GridHeightMap::~GridHeightMap ()
+{
+  if (header_ != nullptr)
+    munmap(const_cast<FileHeader*>(header_), file_size_);
+}
+
+double
+GridHeightMap::GetSample (int ix, int iy) const
+{
+  return heights_[iy*row_stride_ + ix];
+}
+
+void
+GridHeightMap::GetCell (double x, double y, int& idx, int& idy,
+                        double& u, double& v) const
+{
+  double gx = (x - header_->origin_x)/header_->resolution;
+  double gy = (y - header_->origin_y)/header_->resolution;
+
+  idx = std::min(std::max(static_cast<int>(std::floor(gx)), 0),
+                 static_cast<int>(header_->n_x) - 2);
+  idy = std::min(std::max(static_cast<int>(std::floor(gy)), 0),
+                 static_cast<int>(header_->n_y) - 2);
+
+  u = std::min(std::max(gx - idx, 0.0), 1.0);
+  v = std::min(std::max(gy - idy, 0.0), 1.0);
+}
+
+double
+GridHeightMap::GetHeight (double x, double y) const
+{
+  int ix, iy; double u, v;
+  GetCell(x, y, ix, iy, u, v);
+
+  return (1-u)*(1-v)*GetSample(ix,   iy)
+       +    u *(1-v)*GetSample(ix+1, iy)
+       + (1-u)*   v *GetSample(ix,   iy+1)
+       +    u *   v *GetSample(ix+1, iy+1);
+}
+
+void
+GridHeightMap::GetHeights (const Eigen::Matrix2Xd& xy,
+                           Eigen::VectorXd& heights) const
+{
+  int n = xy.cols();
+  heights.resize(n);
+
+  // cell coordinates for all queries at once
+  Eigen::ArrayXd gx = (xy.row(0).transpose().array() - header_->origin_x)/header_->resolution;
+  Eigen::ArrayXd gy = (xy.row(1).transpose().array() - header_->origin_y)/header_->resolution;
+
+  Eigen::ArrayXd h00(n), h10(n), h01(n), h11(n);
+  Eigen::ArrayXd u(n), v(n);
+
+  // the sample gather is inherently scalar, but pulling it out of the
+  // blend lets the expression below vectorize over all queries.
+  for (int i=0; i<n; ++i) {
+    int ix = std::min(std::max(static_cast<int>(std::floor(gx(i))), 0),
+                      static_cast<int>(header_->n_x) - 2);
+    int iy = std::min(std::max(static_cast<int>(std::floor(gy(i))), 0),
+                      static_cast<int>(header_->n_y) - 2);
+
+    u(i) = std::min(std::max(gx(i) - ix, 0.0), 1.0);
+    v(i) = std::min(std::max(gy(i) - iy, 0.0), 1.0);
+
+    h00(i) = GetSample(ix,   iy);
+    h10(i) = GetSample(ix+1, iy);
+    h01(i) = GetSample(ix,   iy+1);
+    h11(i) = GetSample(ix+1, iy+1);
+  }
+
+  heights = ((1-u)*(1-v)*h00 + u*(1-v)*h10 + (1-u)*v*h01 + u*v*h11).matrix();
+}
+
+void
+GridHeightMap::GetHeightDerivatives (const Eigen::Matrix2Xd& xy,
+                                     Eigen::Matrix2Xd& derivs) const
+{
+  int n = xy.cols();
+  derivs.resize(2, n);
+
+  Eigen::ArrayXd gx = (xy.row(0).transpose().array() - header_->origin_x)/header_->resolution;
+  Eigen::ArrayXd gy = (xy.row(1).transpose().array() - header_->origin_y)/header_->resolution;
+
+  Eigen::ArrayXd h00(n), h10(n), h01(n), h11(n);
+  Eigen::ArrayXd u(n), v(n);
+
+  for (int i=0; i<n; ++i) {
+    int ix = std::min(std::max(static_cast<int>(std::floor(gx(i))), 0),
+                      static_cast<int>(header_->n_x) - 2);
+    int iy = std::min(std::max(static_cast<int>(std::floor(gy(i))), 0),
+                      static_cast<int>(header_->n_y) - 2);
+
+    u(i) = std::min(std::max(gx(i) - ix, 0.0), 1.0);
+    v(i) = std::min(std::max(gy(i) - iy, 0.0), 1.0);
+
+    h00(i) = GetSample(ix,   iy);
+    h10(i) = GetSample(ix+1, iy);
+    h01(i) = GetSample(ix,   iy+1);
+    h11(i) = GetSample(ix+1, iy+1);
+  }
+
+  double r = header_->resolution;
+  derivs.row(X_) = (((1-v)*(h10-h00) + v*(h11-h01))/r).matrix().transpose();
+  derivs.row(Y_) = (((1-u)*(h01-h00) + u*(h11-h10))/r).matrix().transpose();
+}
+
+double
+GridHeightMap::GetHeightDerivWrtX (double x, double y) const
+{
+  int ix, iy; double u, v;
+  GetCell(x, y, ix, iy, u, v);
+
+  return ((1-v)*(GetSample(ix+1, iy  ) - GetSample(ix, iy  ))
+        +    v *(GetSample(ix+1, iy+1) - GetSample(ix, iy+1)))
+         / header_->resolution;
+}
+
+double
+GridHeightMap::GetHeightDerivWrtY (double x, double y) const
+{
+  int ix, iy; double u, v;
+  GetCell(x, y, ix, iy, u, v);
+
+  return ((1-u)*(GetSample(ix,   iy+1) - GetSample(ix,   iy))
+        +    u *(GetSample(ix+1, iy+1) - GetSample(ix+1, iy)))
+         / header_->resolution;
+}
+
+double
+GridHeightMap::GetHeightDerivWrtXY (double x, double y) const
+{
+  int ix, iy; double u, v;
+  GetCell(x, y, ix, iy, u, v);
+
+  return (GetSample(ix+1, iy+1) - GetSample(ix+1, iy)
+        - GetSample(ix,   iy+1) + GetSample(ix,   iy))
+         / std::pow(header_->resolution, 2);
+}
+
+double
+GridHeightMap::GetHeightDerivWrtYX (double x, double y) const
+{
+  return GetHeightDerivWrtXY(x, y);
+}
+
+} /* namespace towr */
@@ -30,31 +30,114 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <towr/terrain/height_map.h>
 #include <towr/terrain/examples/height_map_examples.h>
 
+#include <array>
 #include <cmath>
 
 namespace towr {
 
+namespace {
+// function-local singleton, so registrar objects in other translation
+// units never race the registry's construction during static init.
+std::map<int, HeightMap::MakerFcn>& GetTerrainRegistry ()
+{
+  static std::map<int, HeightMap::MakerFcn> registry;
+  return registry;
+}
+} // namespace
+
+void
+HeightMap::RegisterTerrain (int id, const MakerFcn& maker)
+{
+  GetTerrainRegistry()[id] = maker;
+}
+
 HeightMap::Ptr
-HeightMap::MakeTerrain (TerrainID type)
+HeightMap::MakeTerrain (int type)
+{
+  const auto& registry = GetTerrainRegistry();
+  auto it = registry.find(type);
+  assert(it != registry.end()); // Error: no terrain registered under this ID.
+  return it->second();
+}
+
+// the example terrains register themselves the same way a custom terrain
+// in user code would, so this file needs no patching to add one.
+static HeightMap::Registrar reg_flat     (HeightMap::FlatID,      []{ return std::make_shared<FlatGround>(); });
+static HeightMap::Registrar reg_block    (HeightMap::BlockID,     []{ return std::make_shared<Block>(); });
+static HeightMap::Registrar reg_stairs   (HeightMap::StairsID,    []{ return std::make_shared<Stairs>(); });
+static HeightMap::Registrar reg_gap      (HeightMap::GapID,       []{ return std::make_shared<Gap>(); });
+static HeightMap::Registrar reg_slope    (HeightMap::SlopeID,     []{ return std::make_shared<Slope>(); });
+static HeightMap::Registrar reg_chimney  (HeightMap::ChimneyID,   []{ return std::make_shared<Chimney>(); });
+static HeightMap::Registrar reg_chimneylr(HeightMap::ChimneyLRID, []{ return std::make_shared<ChimneyLR>(); });
+
+void
+HeightMap::GetHeights (const Eigen::Matrix2Xd& xy,
+                       Eigen::VectorXd& heights) const
+{
+  heights.resize(xy.cols());
+  for (int i=0; i<xy.cols(); ++i)
+    heights(i) = GetHeight(xy(0,i), xy(1,i));
+}
+
+void
+HeightMap::GetHeightDerivatives (const Eigen::Matrix2Xd& xy,
+                                 Eigen::Matrix2Xd& derivs) const
+{
+  derivs.resize(2, xy.cols());
+  for (int i=0; i<xy.cols(); ++i) {
+    derivs(X_, i) = GetHeightDerivWrtX(xy(0,i), xy(1,i));
+    derivs(Y_, i) = GetHeightDerivWrtY(xy(0,i), xy(1,i));
+  }
+}
+
+const HeightMap::DerivativeCacheEntry&
+HeightMap::GetCachedDerivatives (double x, double y) const
 {
-  switch (type) {
-    case FlatID:      return std::make_shared<FlatGround>(); break;
-    case BlockID:     return std::make_shared<Block>(); break;
-    case StairsID:    return std::make_shared<Stairs>(); break;
-    case GapID:       return std::make_shared<Gap>(); break;
-    case SlopeID:     return std::make_shared<Slope>(); break;
-    case ChimneyID:   return std::make_shared<Chimney>(); break;
-    case ChimneyLRID: return std::make_shared<ChimneyLR>(); break;
-    default: assert(false); break;
+  // one ring buffer per thread: the parallel solve paths (SolveMultiStart,
+  // SolveSplitHorizon, BatchPlanner) share one terrain across solver
+  // threads, so a shared mutable ring would race and could overwrite an
+  // entry while another thread still reads through its reference.
+  struct ThreadCache {
+    const HeightMap* owner;
+    std::array<DerivativeCacheEntry, kCacheSize> entries;
+    int next; ///< ring-buffer slot replaced on next miss.
+  };
+  static thread_local ThreadCache cache = {nullptr, {}, 0};
+
+  if (cache.owner != this) { // different terrain than last query: start fresh
+    cache.owner = this;
+    for (auto& stale : cache.entries)
+      stale.valid = false;
+    cache.next = 0;
   }
+
+  for (const auto& e : cache.entries)
+    if (e.valid && e.x == x && e.y == y)
+      return e;
+
+  DerivativeCacheEntry& e = cache.entries.at(cache.next);
+  cache.next = (cache.next+1)%kCacheSize;
+
+  e.x   = x;              e.y   = y;
+  e.dx  = GetHeightDerivWrtX(x,y);
+  e.dy  = GetHeightDerivWrtY(x,y);
+  e.dxx = GetHeightDerivWrtXX(x,y);
+  e.dxy = GetHeightDerivWrtXY(x,y);
+  e.dyx = GetHeightDerivWrtYX(x,y);
+  e.dyy = GetHeightDerivWrtYY(x,y);
+  e.valid = true;
+
+  return e;
 }
 
 double
 HeightMap::GetDerivativeOfHeightWrt (Dim2D dim, double x, double y) const
 {
+  const auto& e = GetCachedDerivatives(x, y);
+
   switch (dim) {
-    case X: return GetHeightDerivWrtX(x,y);
-    case Y: return GetHeightDerivWrtY(x,y);
+    case X: return e.dx;
+    case Y: return e.dy;
     default: assert(false); // derivative dimension not implemented
   }
 }
@@ -84,10 +167,12 @@ HeightMap::GetDerivativeOfNormalizedBasisWrt (Direction basis, Dim2D dim,
   // inner derivative
   Vector3d dv_wrt_dim = GetBasis(basis, x, y, {dim});
 
-  // outer derivative
+  // outer derivative: chain rule through the normalization,
+  // d(v/|v|)/ddim = (I - v_hat*v_hat^T)/|v| * dv/ddim
   Vector3d v = GetBasis(basis, x,y, {});
-  Vector3d dn_norm_wrt_n = GetDerivativeOfNormalizedVectorWrtNonNormalizedIndex(v, dim);
-  return dn_norm_wrt_n.cwiseProduct(dv_wrt_dim);
+  double norm = v.norm();
+  Vector3d v_hat = v/norm;
+  return (dv_wrt_dim - v_hat*v_hat.dot(dv_wrt_dim))/norm;
 }
 
 HeightMap::Vector3d
@@ -138,25 +223,18 @@ HeightMap::GetTangent2 (double x, double y, const DimDerivs& deriv) const
   return ty;
 }
 
-HeightMap::Vector3d
-HeightMap::GetDerivativeOfNormalizedVectorWrtNonNormalizedIndex (
-    const Vector3d& v, int idx) const
-{
-  // see notebook or
-  // http://blog.mmacklin.com/2012/05/
-  return 1/v.squaredNorm()*(v.norm() * Vector3d::Unit(idx) - v(idx)*v.normalized());
-}
-
 double
 HeightMap::GetSecondDerivativeOfHeightWrt (Dim2D dim1, Dim2D dim2,
                                            double x, double y) const
 {
+  const auto& e = GetCachedDerivatives(x, y);
+
   if (dim1 == X_) {
-    if (dim2 == X_) return GetHeightDerivWrtXX(x,y);
-    if (dim2 == Y_) return GetHeightDerivWrtXY(x,y);
+    if (dim2 == X_) return e.dxx;
+    if (dim2 == Y_) return e.dxy;
   } else {
-    if (dim2 == X_) return GetHeightDerivWrtYX(x,y);
-    if (dim2 == Y_) return GetHeightDerivWrtYY(x,y);
+    if (dim2 == X_) return e.dyx;
+    if (dim2 == Y_) return e.dyy;
   }
 
   assert(false); // second derivative not specified.
@@ -0,0 +1,290 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <towr/iterate_store.h>
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace towr {
+
+namespace {
+
+// on-disk layout of Save()/Load() (@sa SnapshotHeader in towr.cc).
+struct StoreHeader {
+  char magic[4];
+  uint32_t version;
+  int32_t keyframe_interval;
+  int32_t max_iterates;
+  int32_t n_values;
+  int32_t n_pushed;
+  uint32_t n_groups;
+};
+
+const char kStoreMagic[4] = {'T','W','R','I'};
+const uint32_t kStoreVersion = 1;
+
+} // namespace
+
+
+IterateStore::IterateStore (int keyframe_interval, int max_iterates)
+  : keyframe_interval_(keyframe_interval),
+    max_iterates_(max_iterates)
+{
+  assert(keyframe_interval_ >= 1);
+  assert(max_iterates_ >= keyframe_interval_); // room for one full group
+}
+
+void
+IterateStore::Push (const Eigen::VectorXd& x)
+{
+  assert(n_values_ == 0 || x.rows() == n_values_);
+  n_values_ = x.rows();
+
+  bool keyframe = n_pushed_ % keyframe_interval_ == 0;
+  if (keyframe) {
+    groups_.push_back(Group());
+    groups_.back().first_iteration = n_pushed_;
+  }
+
+  groups_.back().blobs.push_back(
+      Encode(x, keyframe? Eigen::VectorXd() : last_));
+  last_ = x;
+  n_pushed_++;
+
+  // retention: drop the oldest keyframe group whole, since its deltas
+  // are undecodable without it
+  while (GetCount() > max_iterates_ && groups_.size() > 1)
+    groups_.erase(groups_.begin());
+}
+
+void
+IterateStore::Clear ()
+{
+  groups_.clear();
+  last_.resize(0);
+  n_values_ = 0;
+  n_pushed_ = 0;
+}
+
+bool
+IterateStore::Contains (int iteration) const
+{
+  return iteration >= GetFirstIteration() && iteration < n_pushed_;
+}
+
+Eigen::VectorXd
+IterateStore::Get (int iteration) const
+{
+  assert(Contains(iteration));
+
+  // the group whose keyframe precedes (or is) the requested iteration
+  int g = groups_.size()-1;
+  while (groups_.at(g).first_iteration > iteration)
+    g--;
+  const Group& group = groups_.at(g);
+
+  // replay the deltas from the keyframe up to the requested iterate
+  Eigen::VectorXd x(n_values_);
+  for (int i=0; i<=iteration-group.first_iteration; ++i)
+    Decode(group.blobs.at(i), x);
+
+  return x;
+}
+
+int
+IterateStore::GetFirstIteration () const
+{
+  return groups_.empty()? 0 : groups_.front().first_iteration;
+}
+
+int
+IterateStore::GetCount () const
+{
+  return groups_.empty()? 0 : n_pushed_ - groups_.front().first_iteration;
+}
+
+std::size_t
+IterateStore::GetMemoryBytes () const
+{
+  std::size_t bytes = 0;
+  for (const auto& group : groups_)
+    for (const auto& blob : group.blobs)
+      bytes += blob.bytes.capacity();
+
+  return bytes;
+}
+
+IterateStore::Blob
+IterateStore::Encode (const Eigen::VectorXd& x, const Eigen::VectorXd& base) const
+{
+  Blob blob;
+  blob.keyframe = base.rows() == 0;
+
+  if (blob.keyframe) {
+    blob.bytes.resize(x.rows()*sizeof(double));
+    std::memcpy(blob.bytes.data(), x.data(), blob.bytes.size());
+    return blob;
+  }
+
+  // per value: XOR against the predecessor, then keep only the
+  // significant low-order bytes. Close doubles share sign, exponent and
+  // high mantissa bits, so the high-order bytes of the XOR are zero and
+  // an unchanged value costs a single length byte.
+  blob.bytes.reserve(x.rows()*2); // typical: length byte + 1-2 delta bytes
+  for (int i=0; i<x.rows(); ++i) {
+    uint64_t a, b;
+    std::memcpy(&a, &x(i), sizeof(a));
+    std::memcpy(&b, &base(i), sizeof(b));
+    uint64_t diff = a ^ b;
+
+    int n = 0; // significant low-order bytes
+    for (uint64_t d = diff; d != 0; d >>= 8)
+      n++;
+
+    blob.bytes.push_back(static_cast<unsigned char>(n));
+    for (int byte=0; byte<n; ++byte)
+      blob.bytes.push_back(static_cast<unsigned char>(diff >> 8*byte));
+  }
+
+  blob.bytes.shrink_to_fit(); // blobs live long; don't keep growth slack
+  return blob;
+}
+
+void
+IterateStore::Decode (const Blob& blob, Eigen::VectorXd& x) const
+{
+  if (blob.keyframe) {
+    assert(blob.bytes.size() == x.rows()*sizeof(double));
+    std::memcpy(x.data(), blob.bytes.data(), blob.bytes.size());
+    return;
+  }
+
+  std::size_t pos = 0;
+  for (int i=0; i<x.rows(); ++i) {
+    int n = blob.bytes.at(pos++);
+
+    uint64_t diff = 0;
+    for (int byte=0; byte<n; ++byte)
+      diff |= static_cast<uint64_t>(blob.bytes.at(pos++)) << 8*byte;
+
+    uint64_t a;
+    std::memcpy(&a, &x(i), sizeof(a));
+    a ^= diff;
+    std::memcpy(&x(i), &a, sizeof(a));
+  }
+}
+
+void
+IterateStore::Save (const std::string& path) const
+{
+  StoreHeader header;
+  std::memcpy(header.magic, kStoreMagic, sizeof(kStoreMagic));
+  header.version           = kStoreVersion;
+  header.keyframe_interval = keyframe_interval_;
+  header.max_iterates      = max_iterates_;
+  header.n_values          = n_values_;
+  header.n_pushed          = n_pushed_;
+  header.n_groups          = groups_.size();
+
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file)
+    throw std::runtime_error("IterateStore: cannot open " + path);
+
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+  for (const auto& group : groups_) {
+    int32_t first = group.first_iteration;
+    uint32_t n_blobs = group.blobs.size();
+    file.write(reinterpret_cast<const char*>(&first), sizeof(first));
+    file.write(reinterpret_cast<const char*>(&n_blobs), sizeof(n_blobs));
+
+    // the blobs ship compressed as stored
+    for (const auto& blob : group.blobs) {
+      uint32_t n_bytes = blob.bytes.size();
+      file.write(reinterpret_cast<const char*>(&n_bytes), sizeof(n_bytes));
+      file.write(reinterpret_cast<const char*>(blob.bytes.data()), n_bytes);
+    }
+  }
+
+  if (!file)
+    throw std::runtime_error("IterateStore: writing " + path + " failed");
+}
+
+void
+IterateStore::Load (const std::string& path)
+{
+  std::ifstream file(path, std::ios::binary);
+  if (!file)
+    throw std::runtime_error("IterateStore: cannot open " + path);
+
+  StoreHeader header;
+  file.read(reinterpret_cast<char*>(&header), sizeof(header));
+  if (!file
+      || std::memcmp(header.magic, kStoreMagic, sizeof(kStoreMagic)) != 0
+      || header.version != kStoreVersion)
+    throw std::runtime_error("IterateStore: " + path + " is not a valid store");
+
+  Clear();
+  keyframe_interval_ = header.keyframe_interval;
+  max_iterates_      = header.max_iterates;
+  n_values_          = header.n_values;
+  n_pushed_          = header.n_pushed;
+
+  for (uint32_t g=0; g<header.n_groups; ++g) {
+    Group group;
+    int32_t first; uint32_t n_blobs;
+    file.read(reinterpret_cast<char*>(&first), sizeof(first));
+    file.read(reinterpret_cast<char*>(&n_blobs), sizeof(n_blobs));
+    group.first_iteration = first;
+
+    for (uint32_t b=0; b<n_blobs; ++b) {
+      Blob blob;
+      uint32_t n_bytes;
+      file.read(reinterpret_cast<char*>(&n_bytes), sizeof(n_bytes));
+      blob.bytes.resize(n_bytes);
+      file.read(reinterpret_cast<char*>(blob.bytes.data()), n_bytes);
+      blob.keyframe = b == 0;
+      group.blobs.push_back(blob);
+    }
+
+    groups_.push_back(group);
+  }
+
+  if (!file)
+    throw std::runtime_error("IterateStore: " + path + " is truncated");
+
+  if (!groups_.empty())
+    last_ = Get(n_pushed_-1);
+}
+
+} /* namespace towr */
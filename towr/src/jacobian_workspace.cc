@@ -0,0 +1,108 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <towr/constraints/jacobian_workspace.h>
+
+#include <algorithm> // std::lower_bound
+#include <cassert>
+
+namespace towr {
+
+void
+JacobianWorkspace::Start (Jacobian& jac)
+{
+  jac_ = &jac;
+  write_count_ = 0;
+
+  if (pattern_recorded_)
+    jac = pattern_; // values are overwritten by the subsequent Write() calls
+}
+
+void
+JacobianWorkspace::Write (int row, int col, double value)
+{
+  assert(jac_); // Start() must bind the output Jacobian first
+
+  if (!pattern_recorded_) {
+    triplets_.emplace_back(row, col, value);
+    constant_flags_.push_back(false);
+  } else {
+    jac_->valuePtr()[ordered_indices_.at(write_count_)] = value;
+  }
+
+  write_count_++;
+}
+
+void
+JacobianWorkspace::WriteConstant (int row, int col, double value)
+{
+  assert(jac_); // Start() must bind the output Jacobian first
+
+  // later passes skip the entry; Start() already restored its first-pass
+  // value together with the pattern.
+  if (!pattern_recorded_) {
+    triplets_.emplace_back(row, col, value);
+    constant_flags_.push_back(true);
+  }
+}
+
+void
+JacobianWorkspace::Finish ()
+{
+  if (!pattern_recorded_) {
+    pattern_.resize(jac_->rows(), jac_->cols());
+    pattern_.setFromTriplets(triplets_.begin(), triplets_.end());
+    pattern_.makeCompressed();
+
+    // remember for every recorded non-constant entry its slot in the
+    // compressed value array, in the order the entries were written.
+    // Constant entries need no slot, their value lives in the pattern.
+    ordered_indices_.reserve(triplets_.size());
+    for (std::size_t i=0; i<triplets_.size(); ++i) {
+      if (constant_flags_.at(i))
+        continue;
+      const auto& t = triplets_.at(i);
+      const auto* inner = pattern_.innerIndexPtr();
+      const auto* row_begin = inner + pattern_.outerIndexPtr()[t.row()];
+      const auto* row_end   = inner + pattern_.outerIndexPtr()[t.row()+1];
+      const auto* it = std::lower_bound(row_begin, row_end, t.col());
+      ordered_indices_.push_back(it - inner);
+    }
+
+    *jac_ = pattern_; // first pass already recorded the correct values
+    triplets_ = {};
+    constant_flags_ = {};
+    pattern_recorded_ = true;
+  }
+
+  assert(write_count_ == ordered_indices_.size()); // same entries every pass
+  jac_ = nullptr;
+}
+
+} /* namespace towr */
@@ -0,0 +1,79 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <towr/memory_tally.h>
+
+#include <algorithm> // std::max
+
+namespace towr {
+
+void
+MemoryTally::Add (const std::string& subsystem, std::size_t bytes)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  Usage& u = usage_[subsystem];
+  u.live += bytes;
+  u.peak  = std::max(u.peak, u.live);
+}
+
+void
+MemoryTally::Release (const std::string& subsystem, std::size_t bytes)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  Usage& u = usage_[subsystem];
+  u.live -= std::min(bytes, u.live); // guard against unmatched releases
+}
+
+void
+MemoryTally::Set (const std::string& subsystem, std::size_t live_bytes)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  Usage& u = usage_[subsystem];
+  u.live = live_bytes;
+  u.peak = std::max(u.peak, u.live);
+}
+
+std::map<std::string, MemoryTally::Usage>
+MemoryTally::GetUsage () const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return usage_;
+}
+
+std::size_t
+MemoryTally::GetTotalLiveBytes () const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::size_t total = 0;
+  for (const auto& kv : usage_)
+    total += kv.second.live;
+  return total;
+}
+
+} /* namespace towr */
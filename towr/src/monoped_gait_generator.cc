@@ -35,7 +35,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 namespace towr {
 
 void
-MonopedGaitGenerator::SetCombo (Combos combo)
+MonopedGaitGenerator::ExpandCombo (Combos combo)
 {
   switch (combo) {
     case C0: SetGaits({Stand, Hop1, Hop1, Hop1, Hop1, Stand});       break;
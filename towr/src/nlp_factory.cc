@@ -29,9 +29,14 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <towr/nlp_factory.h>
 
+#include <cmath>   // std::abs
+#include <numeric> // std::accumulate
+#include <thread>
+
 #include <towr/variables/variable_names.h>
 #include <towr/variables/base_nodes.h>
 #include <towr/variables/phase_durations.h>
+#include <towr/variables/rotation_vector_converter.h>
 
 #include <towr/constraints/base_motion_constraint.h>
 #include <towr/constraints/dynamic_constraint.h>
@@ -50,7 +55,12 @@ namespace towr {
 NlpFactory::VariablePtrVec
 NlpFactory::GetVariableSets ()
 {
+  // a new problem starts here, so open a fresh arena for its objects
+  if (use_arena_)
+    arena_ = std::make_shared<ObjectArena>();
+
   VariablePtrVec vars;
+  vars.reserve(2 + 3*params_.GetEECount()); // base lin/ang + motion/force/schedule per EE
 
   auto base_motion = MakeBaseVariables();
   vars.insert(vars.end(), base_motion.begin(), base_motion.end());
@@ -66,6 +76,9 @@ NlpFactory::GetVariableSets ()
     vars.insert(vars.end(), contact_schedule.begin(), contact_schedule.end());
   }
 
+  if (use_initial_guess_)
+    ApplyInitialGuess(base_motion, ee_motion, ee_force, contact_schedule);
+
   // stores these readily constructed spline, independent of whether the
   // nodes and durations these depend on are optimized over
   spline_holder_ = SplineHolder(base_motion.at(0), // linear
@@ -75,9 +88,30 @@ NlpFactory::GetVariableSets ()
                                 ee_force,
                                 contact_schedule,
                                 params_.IsOptimizeTimings());
+
+  // keep the variable sets around, so a constructed problem can be
+  // re-solved with updated boundary states (@sa UpdateBoundaryState).
+  base_vars_      = std::move(base_motion);
+  ee_motion_vars_ = std::move(ee_motion);
+  ee_force_vars_  = std::move(ee_force);
+
   return vars;
 }
 
+void
+NlpFactory::RunForEachEE (const std::function<void(int)>& job) const
+{
+  // one thread per endeffector; for robots with many legs the per-EE sets
+  // dominate the problem construction time, and building them only reads
+  // the shared parameters, model and terrain.
+  std::vector<std::thread> threads;
+  for (int ee=0; ee<params_.GetEECount(); ee++)
+    threads.emplace_back(job, ee);
+
+  for (auto& t : threads)
+    t.join();
+}
+
 std::vector<Nodes::Ptr>
 NlpFactory::MakeBaseVariables () const
 {
@@ -85,40 +119,101 @@ NlpFactory::MakeBaseVariables () const
 
   int n_nodes = params_.GetBasePolyDurations().size() + 1;
 
-  auto spline_lin = std::make_shared<BaseNodes>(n_nodes, id::base_lin_nodes);
-
-  double x = final_base_.lin.p().x();
-  double y = final_base_.lin.p().y();
-  double z = terrain_->GetHeight(x,y) - model_.kinematic_model_->GetNominalStanceInBase().front().z();
-  Vector3d final_pos(x, y, z);
+  auto spline_lin = Create<BaseNodes>(n_nodes, id::base_lin_nodes);
 
-  spline_lin->InitializeNodesTowardsGoal(initial_base_.lin.p(), final_pos, params_.GetTotalTime());
+  spline_lin->InitializeNodesTowardsGoal(initial_base_.lin.p(), GetFinalBaseLinPos(), params_.GetTotalTime());
   spline_lin->AddStartBound(kPos, {X,Y,Z}, initial_base_.lin.p());
   spline_lin->AddStartBound(kVel, {X,Y,Z}, initial_base_.lin.v());
   spline_lin->AddFinalBound(kPos, params_.bounds_final_lin_pos,   final_base_.lin.p());
   spline_lin->AddFinalBound(kVel, params_.bounds_final_lin_vel, final_base_.lin.v());
   vars.push_back(spline_lin);
 
-  auto spline_ang = std::make_shared<BaseNodes>(n_nodes,  id::base_ang_nodes);
-  spline_ang->InitializeNodesTowardsGoal(initial_base_.ang.p(), final_base_.ang.p(), params_.GetTotalTime());
-  spline_ang->AddStartBound(kPos, {X,Y,Z}, initial_base_.ang.p());
+  auto spline_ang = Create<BaseNodes>(n_nodes,  id::base_ang_nodes);
+  Vector3d ang_initial = GetInitialBaseAng();
+  Vector3d ang_final   = GetFinalBaseAng();
+  spline_ang->InitializeNodesTowardsGoal(ang_initial, ang_final, params_.GetTotalTime());
+  spline_ang->AddStartBound(kPos, {X,Y,Z}, ang_initial);
   spline_ang->AddStartBound(kVel, {X,Y,Z}, initial_base_.ang.v());
-  spline_ang->AddFinalBound(kPos, params_.bounds_final_ang_pos, final_base_.ang.p());
+  spline_ang->AddFinalBound(kPos, params_.bounds_final_ang_pos, ang_final);
   spline_ang->AddFinalBound(kVel, params_.bounds_final_ang_vel, final_base_.ang.v());
   vars.push_back(spline_ang);
 
   return vars;
 }
 
+NlpFactory::Vector3d
+NlpFactory::GetFinalBaseLinPos () const
+{
+  double x = final_base_.lin.p().x();
+  double y = final_base_.lin.p().y();
+  double z = terrain_->GetHeight(x,y) - model_.kinematic_model_->GetNominalStanceInBase().front().z();
+
+  return Vector3d(x, y, z);
+}
+
+NlpFactory::Vector3d
+NlpFactory::GetInitialBaseAng () const
+{
+  // the user-facing boundary states stay Euler angles under either
+  // parameterization; convert where they touch the angular node values.
+  return params_.use_rotation_vector_base_
+      ? RotationVectorConverter::FromEulerAngles(initial_base_.ang.p())
+      : Vector3d(initial_base_.ang.p());
+}
+
+NlpFactory::Vector3d
+NlpFactory::GetFinalBaseAng () const
+{
+  return params_.use_rotation_vector_base_
+      ? RotationVectorConverter::FromEulerAngles(final_base_.ang.p())
+      : Vector3d(final_base_.ang.p());
+}
+
+void
+NlpFactory::UpdateBoundaryState ()
+{
+  // re-applying the bounds overwrites the previous values at the same
+  // variable indices, leaving everything else untouched.
+  auto spline_lin = base_vars_.at(0);
+  spline_lin->AddStartBound(kPos, {X,Y,Z}, initial_base_.lin.p());
+  spline_lin->AddStartBound(kVel, {X,Y,Z}, initial_base_.lin.v());
+  spline_lin->AddFinalBound(kPos, params_.bounds_final_lin_pos, final_base_.lin.p());
+  spline_lin->AddFinalBound(kVel, params_.bounds_final_lin_vel, final_base_.lin.v());
+
+  auto spline_ang = base_vars_.at(1);
+  spline_ang->AddStartBound(kPos, {X,Y,Z}, GetInitialBaseAng());
+  spline_ang->AddStartBound(kVel, {X,Y,Z}, initial_base_.ang.v());
+  spline_ang->AddFinalBound(kPos, params_.bounds_final_ang_pos, GetFinalBaseAng());
+  spline_ang->AddFinalBound(kVel, params_.bounds_final_ang_vel, final_base_.ang.v());
+
+  for (int ee=0; ee<params_.GetEECount(); ee++)
+    ee_motion_vars_.at(ee)->AddStartBound(kPos, {X,Y,Z}, initial_ee_W_.at(ee));
+}
+
+void
+NlpFactory::SwapTerrain (const HeightMap::Ptr& terrain)
+{
+  terrain_ = terrain;
+
+  // rebind the constraint sets of the constructed problem; everything else
+  // reads the terrain only during construction.
+  for (const auto& c : constraints_) {
+    if (auto tc = std::dynamic_pointer_cast<TerrainConstraint>(c))
+      tc->SetTerrain(terrain);
+    if (auto fc = std::dynamic_pointer_cast<ForceConstraint>(c))
+      fc->SetTerrain(terrain);
+  }
+}
+
 std::vector<PhaseNodes::Ptr>
 NlpFactory::MakeEndeffectorVariables () const
 {
-  std::vector<PhaseNodes::Ptr> vars;
+  std::vector<PhaseNodes::Ptr> vars(params_.GetEECount());
 
   // Endeffector Motions
   double T = params_.GetTotalTime();
-  for (int ee=0; ee<params_.GetEECount(); ee++) {
-    auto nodes = std::make_shared<PhaseNodes>(params_.GetPhaseCount(ee),
+  RunForEachEE([&](int ee) {
+    auto nodes = Create<PhaseNodes>(params_.GetPhaseCount(ee),
                                               params_.ee_in_contact_at_start_.at(ee),
                                               id::EEMotionNodes(ee),
                                               params_.ee_polynomials_per_swing_phase_,
@@ -134,25 +229,127 @@ NlpFactory::MakeEndeffectorVariables () const
     double z = terrain_->GetHeight(x,y);
     nodes->InitializeNodesTowardsGoal(initial_ee_W_.at(ee), Vector3d(x,y,z), T);
 
+    if (params_.presolve_footholds_)
+      PresolveFootholds(nodes, ee);
+
     nodes->AddStartBound(kPos, {X,Y,Z}, initial_ee_W_.at(ee));
-    vars.push_back(nodes);
-  }
+    vars.at(ee) = nodes;
+  });
 
   return vars;
 }
 
+void
+NlpFactory::PresolveFootholds (const PhaseNodes::Ptr& nodes, int ee) const
+{
+  double T = params_.GetTotalTime();
+  auto poly_durations =
+      nodes->ConvertPhaseToPolyDurations(params_.ee_phase_durations_.at(ee));
+
+  // time at which each node is located in the spline.
+  std::vector<double> node_time(poly_durations.size()+1, 0.0);
+  for (int i=0; i<poly_durations.size(); ++i)
+    node_time.at(i+1) = node_time.at(i) + poly_durations.at(i);
+
+  Vector3d dev       = model_.kinematic_model_->GetMaximumDeviationFromNominal();
+  Vector3d nominal_B = model_.kinematic_model_->GetNominalStanceInBase().at(ee);
+  Vector3d base0     = initial_base_.lin.p();
+  Vector3d base1     = GetFinalBaseLinPos();
+  double yaw0        = initial_base_.ang.p().z();
+  double yaw1        = final_base_.ang.p().z();
+
+  // the terrain slope at (x,y), by central differences on the height:
+  // the analytic derivative accessors keep a serial memo (@sa HeightMap)
+  // and this runs on one thread per endeffector.
+  auto slope = [this](double x, double y) {
+    const double eps = 1e-4;
+    double dhdx = (terrain_->GetHeight(x+eps,y) - terrain_->GetHeight(x-eps,y))/(2*eps);
+    double dhdy = (terrain_->GetHeight(x,y+eps) - terrain_->GetHeight(x,y-eps))/(2*eps);
+    return std::abs(dhdx) + std::abs(dhdy);
+  };
+
+  std::vector<Node> presolved = nodes->GetNodes();
+  int n_nodes = presolved.size();
+
+  for (int id=0; id<n_nodes; ++id) {
+    if (!nodes->IsConstantNode(id))
+      continue; // swing nodes are re-seeded from the footholds below
+
+    // the foothold this node would take on flat ground: the nominal
+    // stance below the base path interpolated to the node's time.
+    double s = node_time.at(id)/T;
+    double yaw = yaw0 + s*(yaw1 - yaw0);
+    Eigen::Matrix3d w_R_b =
+        EulerConverter::GetRotationMatrixBaseToWorld(Vector3d(0.0, 0.0, yaw));
+    Vector3d q = base0 + s*(base1 - base0) + w_R_b*nominal_B;
+
+    // sample the kinematic box around it for the flattest terrain spot;
+    // placed on the surface there, the node satisfies the terrain
+    // constraint exactly and leaves the friction cone the most margin.
+    // A small distance penalty keeps the foothold near the nominal when
+    // the terrain offers several equally flat spots.
+    const int n_samples = 5;
+    Vector3d best(q.x(), q.y(), 0.0);
+    double best_score = std::numeric_limits<double>::max();
+    for (int ix=0; ix<n_samples; ++ix)
+      for (int iy=0; iy<n_samples; ++iy) {
+        double rx = -1.0 + 2.0*ix/(n_samples-1);
+        double ry = -1.0 + 2.0*iy/(n_samples-1);
+        double x = q.x() + rx*dev.x();
+        double y = q.y() + ry*dev.y();
+
+        double score = slope(x,y) + 0.1*(rx*rx + ry*ry);
+        if (score < best_score) {
+          best_score = score;
+          best << x, y, 0.0;
+        }
+      }
+    best.z() = terrain_->GetHeight(best.x(), best.y());
+
+    presolved.at(id).at(kPos) = best;
+    presolved.at(id).at(kVel).setZero(); // stance feet don't move
+  }
+
+  // re-seed each swing node between its neighboring footholds, lifted
+  // above the higher of the two so the initial swing clears steps.
+  for (int id=0; id<n_nodes; ++id) {
+    if (nodes->IsConstantNode(id))
+      continue;
+
+    int prev = id, next = id;
+    while (prev > 0 && !nodes->IsConstantNode(prev)) --prev;
+    while (next < n_nodes-1 && !nodes->IsConstantNode(next)) ++next;
+    if (!nodes->IsConstantNode(prev) || !nodes->IsConstantNode(next))
+      continue; // unbounded swing at the spline edge; keep the seed
+
+    const Vector3d& p0 = presolved.at(prev).at(kPos);
+    const Vector3d& p1 = presolved.at(next).at(kPos);
+    double dt = node_time.at(next) - node_time.at(prev);
+    double u  = dt > 0.0? (node_time.at(id) - node_time.at(prev))/dt : 0.5;
+
+    Vector3d p = p0 + u*(p1 - p0);
+    p.z() = std::max(p0.z(), p1.z()) + 0.5*dev.z();
+
+    presolved.at(id).at(kPos) = p;
+    presolved.at(id).at(kVel) = dt > 0.0? Vector3d((p1-p0)/dt) : Vector3d::Zero();
+  }
+
+  nodes->SetAllNodes(presolved);
+}
+
 std::vector<PhaseNodes::Ptr>
 NlpFactory::MakeForceVariables () const
 {
-  std::vector<PhaseNodes::Ptr> vars;
+  std::vector<PhaseNodes::Ptr> vars(params_.GetEECount());
 
   double T = params_.GetTotalTime();
-  for (int ee=0; ee<params_.GetEECount(); ee++) {
-    auto nodes = std::make_shared<PhaseNodes>(params_.GetPhaseCount(ee),
+  RunForEachEE([&](int ee) {
+    auto nodes = Create<PhaseNodes>(params_.GetPhaseCount(ee),
                                               params_.ee_in_contact_at_start_.at(ee),
                                               id::EEForceNodes(ee),
                                               params_.force_polynomials_per_stance_phase_,
-                                              PhaseNodes::Force);
+                                              PhaseNodes::Force,
+                                              !params_.optimize_force_values_only_);
 
     // initialize with mass of robot distributed equally on all legs
     double m = model_.dynamic_model_->m();
@@ -160,8 +357,14 @@ NlpFactory::MakeForceVariables () const
 
     Vector3d f_stance(0.0, 0.0, m*g/params_.GetEECount());
     nodes->InitializeNodesTowardsGoal(f_stance, f_stance, T);
-    vars.push_back(nodes);
-  }
+
+    // present forces to the solver in units of the nominal stance force,
+    // so they share the magnitude of the position variables.
+    if (params_.scale_node_variables_)
+      nodes->SetVariableScaling(m*g/params_.GetEECount());
+
+    vars.at(ee) = nodes;
+  });
 
   return vars;
 }
@@ -170,26 +373,115 @@ std::vector<PhaseDurations::Ptr>
 NlpFactory::MakeContactScheduleVariables () const
 {
   std::vector<PhaseDurations::Ptr> vars;
+  vars.reserve(params_.GetEECount());
 
+  auto bounds = params_.GetPhaseDurationBounds(); // same for every EE
   for (int ee=0; ee<params_.GetEECount(); ee++) {
-    auto var = std::make_shared<PhaseDurations>(ee,
+    auto var = Create<PhaseDurations>(ee,
                                                 params_.ee_phase_durations_.at(ee),
                                                 params_.ee_in_contact_at_start_.at(ee),
-                                                params_.GetPhaseDurationBounds().front(),
-                                                params_.GetPhaseDurationBounds().back());
+                                                bounds.front(),
+                                                bounds.back());
     vars.push_back(var);
   }
 
   return vars;
 }
 
+void
+NlpFactory::ApplyInitialGuess (const std::vector<Nodes::Ptr>& base_motion,
+                               const std::vector<PhaseNodes::Ptr>& ee_motion,
+                               const std::vector<PhaseNodes::Ptr>& ee_force,
+                               const std::vector<PhaseDurations::Ptr>& schedule) const
+{
+  double t_shift = initial_guess_t_shift_;
+
+  // a second guess segment turns the initialization piecewise: the first
+  // guess covers the horizon up to the split, the second the remainder.
+  bool piecewise = initial_guess_split_time_ > 0.0
+                && initial_guess_second_.base_linear_ != nullptr;
+
+  auto base_durations = params_.GetBasePolyDurations();
+  if (piecewise) {
+    InitializeNodesPiecewise(base_motion.at(0), *initial_guess_.base_linear_,
+                             *initial_guess_second_.base_linear_, base_durations);
+    InitializeNodesPiecewise(base_motion.at(1), *initial_guess_.base_angular_,
+                             *initial_guess_second_.base_angular_, base_durations);
+  } else {
+    base_motion.at(0)->InitializeNodesFromSpline(*initial_guess_.base_linear_,  base_durations, t_shift);
+    base_motion.at(1)->InitializeNodesFromSpline(*initial_guess_.base_angular_, base_durations, t_shift);
+  }
+
+  for (int ee=0; ee<params_.GetEECount(); ee++) {
+    // carry over the previously optimized gait timings when the phase
+    // structure and time horizon still match.
+    auto prev_schedule = initial_guess_.phase_durations_.at(ee);
+    auto prev_durations = prev_schedule->GetPhaseDurations();
+    double prev_total = std::accumulate(prev_durations.begin(), prev_durations.end(), 0.0);
+    if (schedule.at(ee)->GetRows() == prev_schedule->GetRows()
+        && std::abs(prev_total - params_.GetTotalTime()) < 1e-6)
+      schedule.at(ee)->SetVariables(prev_schedule->GetValues());
+
+    auto phase_durations = schedule.at(ee)->GetPhaseDurations();
+    auto motion_durations = ee_motion.at(ee)->ConvertPhaseToPolyDurations(phase_durations);
+    auto force_durations  = ee_force.at(ee)->ConvertPhaseToPolyDurations(phase_durations);
+
+    if (piecewise) {
+      InitializeNodesPiecewise(ee_motion.at(ee), *initial_guess_.ee_motion_.at(ee),
+                               *initial_guess_second_.ee_motion_.at(ee), motion_durations);
+      InitializeNodesPiecewise(ee_force.at(ee), *initial_guess_.ee_force_.at(ee),
+                               *initial_guess_second_.ee_force_.at(ee), force_durations);
+    } else {
+      ee_motion.at(ee)->InitializeNodesFromSpline(*initial_guess_.ee_motion_.at(ee), motion_durations, t_shift);
+      ee_force.at(ee)->InitializeNodesFromSpline(*initial_guess_.ee_force_.at(ee), force_durations, t_shift);
+    }
+  }
+}
+
+void
+NlpFactory::InitializeNodesPiecewise (const Nodes::Ptr& nodes,
+                                      const Spline& first, const Spline& second,
+                                      const Parameters::VecTimes& poly_durations) const
+{
+  double t_split  = initial_guess_split_time_;
+  double T_second = second.GetTotalTime();
+
+  auto sampled = nodes->GetNodes(); // keeps the node dimension
+  assert(sampled.size() == poly_durations.size()+1);
+
+  double t = 0.0;
+  for (int i=0; i<sampled.size(); ++i) {
+    State s = t < t_split - 1e-9
+        ? first.GetPoint(std::min(t, first.GetTotalTime()))
+        : second.GetPoint(std::max(0.0, std::min(t - t_split, T_second)));
+
+    sampled.at(i).at(kPos) = s.p();
+    sampled.at(i).at(kVel) = s.v();
+
+    if (i < poly_durations.size())
+      t += poly_durations.at(i);
+  }
+
+  nodes->SetAllNodes(sampled);
+}
+
 NlpFactory::ContraintPtrVec
 NlpFactory::GetConstraints() const
 {
+  // the shared state grids cache spline states keyed on the current
+  // problem's spline objects, so start fresh for every construction.
+  state_grids_.clear();
+
   ContraintPtrVec constraints;
-  for (auto name : params_.constraints_)
-    for (auto c : GetConstraint(name))
-      constraints.push_back(c);
+  for (auto name : params_.constraints_) {
+    auto group = GetConstraint(name);
+    constraints.insert(constraints.end(),
+                       std::make_move_iterator(group.begin()),
+                       std::make_move_iterator(group.end()));
+  }
+
+  constraints_ = constraints;
+  ApplyProfiling(constraints_);
 
   return constraints;
 }
@@ -211,37 +503,72 @@ NlpFactory::GetConstraint (Parameters::ConstraintName name) const
 }
 
 
+SplineStateGrid::Ptr
+NlpFactory::GetStateGrid (double dt) const
+{
+  auto it = state_grids_.find(dt);
+  if (it != state_grids_.end())
+    return it->second;
+
+  auto grid = std::make_shared<SplineStateGrid>(
+      TimeDiscretizationConstraint::GetTimeGrid(params_.GetTotalTime(), dt));
+  state_grids_.emplace(dt, grid);
+  return grid;
+}
+
 NlpFactory::ContraintPtrVec
 NlpFactory::MakeBaseRangeOfMotionConstraint () const
 {
-  return {std::make_shared<BaseMotionConstraint>(params_.GetTotalTime(),
+  auto constraint = Create<BaseMotionConstraint>(params_.GetTotalTime(),
                                                  params_.dt_constraint_base_motion_,
-                                                 spline_holder_)};
+                                                 spline_holder_);
+  constraint->SetStateGrid(GetStateGrid(params_.dt_constraint_base_motion_));
+  return {constraint};
 }
 
 NlpFactory::ContraintPtrVec
 NlpFactory::MakeDynamicConstraint() const
 {
-  auto constraint = std::make_shared<DynamicConstraint>(model_.dynamic_model_,
-                                                        params_.GetTotalTime(),
-                                                        params_.dt_constraint_dynamic_,
-                                                        spline_holder_);
+  auto constraint = dynamic_constraint_times_.empty()
+      ? Create<DynamicConstraint>(model_.dynamic_model_,
+                                            params_.GetTotalTime(),
+                                            params_.dt_constraint_dynamic_,
+                                            spline_holder_)
+      : Create<DynamicConstraint>(model_.dynamic_model_,
+                                            dynamic_constraint_times_,
+                                            spline_holder_);
+  if (params_.use_rotation_vector_base_)
+    constraint->SetAngularConverter(
+        Create<RotationVectorConverter>(spline_holder_.base_angular_));
+  if (dynamic_constraint_times_.empty())
+    constraint->SetStateGrid(GetStateGrid(params_.dt_constraint_dynamic_));
+  constraint->SetSolveMonitor(solve_monitor_);
   return {constraint};
 }
 
 NlpFactory::ContraintPtrVec
 NlpFactory::MakeRangeOfMotionBoxConstraint () const
 {
-  ContraintPtrVec c;
+  ContraintPtrVec c(params_.GetEECount());
 
-  for (int ee=0; ee<params_.GetEECount(); ee++) {
-    auto rom = std::make_shared<RangeOfMotionConstraint>(model_.kinematic_model_,
+  // created up front: the grid registry must not be touched from the
+  // concurrent construction jobs below.
+  auto state_grid = GetStateGrid(params_.dt_constraint_range_of_motion_);
+
+  // constructing the time-discretized constraints builds the full
+  // discretization grid, so overlap this work across the endeffectors.
+  RunForEachEE([&](int ee) {
+    auto rom = Create<RangeOfMotionConstraint>(model_.kinematic_model_,
                                                          params_.GetTotalTime(),
                                                          params_.dt_constraint_range_of_motion_,
                                                          ee,
                                                          spline_holder_);
-    c.push_back(rom);
-  }
+    if (params_.use_rotation_vector_base_)
+      rom->SetAngularConverter(
+          Create<RotationVectorConverter>(spline_holder_.base_angular_));
+    rom->SetStateGrid(state_grid);
+    c.at(ee) = rom;
+  });
 
   return c;
 }
@@ -250,10 +577,11 @@ NlpFactory::ContraintPtrVec
 NlpFactory::MakeTotalTimeConstraint () const
 {
   ContraintPtrVec c;
+  c.reserve(params_.GetEECount());
   double T = params_.GetTotalTime();
 
   for (int ee=0; ee<params_.GetEECount(); ee++) {
-    auto duration_constraint = std::make_shared<TotalDurationConstraint>(T, ee);
+    auto duration_constraint = Create<TotalDurationConstraint>(T, ee);
     c.push_back(duration_constraint);
   }
 
@@ -264,9 +592,10 @@ NlpFactory::ContraintPtrVec
 NlpFactory::MakeTerrainConstraint () const
 {
   ContraintPtrVec constraints;
+  constraints.reserve(params_.GetEECount());
 
   for (int ee=0; ee<params_.GetEECount(); ee++) {
-    auto c = std::make_shared<TerrainConstraint>(terrain_, id::EEMotionNodes(ee));
+    auto c = Create<TerrainConstraint>(terrain_, id::EEMotionNodes(ee));
     constraints.push_back(c);
   }
 
@@ -277,9 +606,10 @@ NlpFactory::ContraintPtrVec
 NlpFactory::MakeForceConstraint () const
 {
   ContraintPtrVec constraints;
+  constraints.reserve(params_.GetEECount());
 
   for (int ee=0; ee<params_.GetEECount(); ee++) {
-    auto c = std::make_shared<ForceConstraint>(terrain_,
+    auto c = Create<ForceConstraint>(terrain_,
                                                params_.force_limit_in_normal_direction_,
                                                ee);
     constraints.push_back(c);
@@ -292,9 +622,10 @@ NlpFactory::ContraintPtrVec
 NlpFactory::MakeSwingConstraint () const
 {
   ContraintPtrVec constraints;
+  constraints.reserve(params_.GetEECount());
 
   for (int ee=0; ee<params_.GetEECount(); ee++) {
-    auto swing = std::make_shared<SwingConstraint>(id::EEMotionNodes(ee));
+    auto swing = Create<SwingConstraint>(id::EEMotionNodes(ee));
     constraints.push_back(swing);
   }
 
@@ -306,10 +637,10 @@ NlpFactory::MakeBaseAccConstraint () const
 {
   ContraintPtrVec constraints;
 
-  constraints.push_back(std::make_shared<SplineAccConstraint>
+  constraints.push_back(Create<SplineAccConstraint>
                         (spline_holder_.base_linear_, id::base_lin_nodes));
 
-  constraints.push_back(std::make_shared<SplineAccConstraint>
+  constraints.push_back(Create<SplineAccConstraint>
                         (spline_holder_.base_angular_, id::base_ang_nodes));
 
   return constraints;
@@ -319,13 +650,58 @@ NlpFactory::ContraintPtrVec
 NlpFactory::GetCosts() const
 {
   ContraintPtrVec costs;
-  for (const auto& pair : params_.costs_)
-    for (auto c : GetCost(pair.first, pair.second))
-      costs.push_back(c);
+  for (const auto& pair : params_.costs_) {
+    auto group = GetCost(pair.first, pair.second);
+    costs.insert(costs.end(),
+                 std::make_move_iterator(group.begin()),
+                 std::make_move_iterator(group.end()));
+  }
+
+  costs_ = costs;
+  ApplyProfiling(costs_);
 
   return costs;
 }
 
+void
+NlpFactory::SetProfilingEnabled (bool enable)
+{
+  profile_evaluations_ = enable;
+  ApplyProfiling(constraints_);
+  ApplyProfiling(costs_);
+}
+
+void
+NlpFactory::SetEvaluationTrace (const EvaluationTrace::Ptr& trace)
+{
+  trace_ = trace;
+  ApplyProfiling(constraints_);
+  ApplyProfiling(costs_);
+}
+
+void
+NlpFactory::ApplyProfiling (const ContraintPtrVec& sets) const
+{
+  for (const auto& c : sets)
+    if (auto profiler = std::dynamic_pointer_cast<EvaluationProfiler>(c)) {
+      profiler->SetProfilingEnabled(profile_evaluations_);
+      profiler->AttachTrace(trace_, c->GetName());
+    }
+}
+
+std::map<std::string, EvaluationStats>
+NlpFactory::GetEvaluationStats () const
+{
+  std::map<std::string, EvaluationStats> stats;
+
+  for (const auto& vec : {constraints_, costs_})
+    for (const auto& c : vec)
+      if (auto profiler = std::dynamic_pointer_cast<EvaluationProfiler>(c))
+        stats[c->GetName()] = profiler->GetEvaluationStats();
+
+  return stats;
+}
+
 NlpFactory::CostPtrVec
 NlpFactory::GetCost(const Parameters::CostName& name, double weight) const
 {
@@ -338,12 +714,14 @@ NlpFactory::GetCost(const Parameters::CostName& name, double weight) const
 NlpFactory::CostPtrVec
 NlpFactory::MakeForcesCost(double weight) const
 {
-  CostPtrVec cost;
-
+  // one cost component covering all force node sets; the gradient of
+  // each set is still filled separately per variable set.
+  std::vector<std::string> ids;
+  ids.reserve(params_.GetEECount());
   for (int ee=0; ee<params_.GetEECount(); ee++)
-    cost.push_back(std::make_shared<NodeCost>(id::EEForceNodes(ee), kPos, Z));
+    ids.push_back(id::EEForceNodes(ee));
 
-  return cost;
+  return {Create<NodeCost>(ids, std::vector<NodeCost::Penalty>{{kPos, Z}})};
 }
 
 } /* namespace towr */
@@ -29,47 +29,98 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <towr/costs/node_cost.h>
 
-#include <cmath>
+#include <algorithm>
 
 namespace towr {
 
 NodeCost::NodeCost (const std::string& nodes_id, Dx deriv, int dim)
+    : NodeCost(std::vector<std::string>{nodes_id}, {{deriv, dim}})
+{
+}
+
+NodeCost::NodeCost (const std::vector<std::string>& node_ids,
+                    const std::vector<Penalty>& penalties)
     : CostTerm("node")
 {
-  node_id_ = nodes_id;
-  deriv_ = deriv;
-  dim_   = dim;
+  node_ids_  = node_ids;
+  penalties_ = penalties;
 }
 
 void
 NodeCost::InitVariableDependedQuantities (const VariablesPtr& x)
 {
-  nodes_ = x->GetComponent<Nodes>(node_id_);
+  sets_.clear();
+
+  for (const auto& id : node_ids_) {
+    SetData d;
+    d.nodes = x->GetComponent<Nodes>(id);
+
+    // which optimization index feeds which gradient value is fixed by
+    // the (deriv, dim) selection, so resolve it once here; evaluations
+    // then only write values into the compressed structure.
+    d.structure.resize(1, d.nodes->GetRows());
+    for (int i=0; i<d.nodes->GetRows(); ++i)
+      for (const auto& nvi : d.nodes->GetNodeInfoAtOptIndex(i))
+        for (const auto& p : penalties_)
+          if (nvi.deriv_==p.first && nvi.dim_==p.second) {
+            d.structure.coeffRef(0, i) = 1.0;
+            d.entries.push_back({i, -1, nvi.id_, p.first, p.second});
+          }
+    d.structure.makeCompressed();
+
+    std::map<int,int> slot_of_col;
+    for (int k=0; k<d.structure.nonZeros(); ++k)
+      slot_of_col[d.structure.innerIndexPtr()[k]] = k;
+    for (auto& e : d.entries)
+      e.slot = slot_of_col.at(e.col);
+
+    sets_.emplace(id, std::move(d));
+  }
 }
 
 double
 NodeCost::GetCost () const
 {
-  double cost;
-  for (auto n : nodes_->GetNodes()) {
-    double val = n.at(deriv_)(dim_);
-    cost += std::pow(val,2);
-  }
+  auto t0 = StartMeasurement();
 
+  double cost = 0.0;
+  for (const auto& kv : sets_)
+    for (const auto& n : kv.second.nodes->GetNodes())
+      for (const auto& p : penalties_) {
+        double val = n.at(p.first)(p.second);
+        cost += val*val;
+      }
+
+  StopValueMeasurement(t0);
   return cost;
 }
 
 void
 NodeCost::FillJacobianBlock (std::string var_set, Jacobian& jac) const
 {
-  if (var_set == node_id_) {
-    for (int i=0; i<nodes_->GetRows(); ++i)
-      for (auto nvi : nodes_->GetNodeInfoAtOptIndex(i))
-        if (nvi.deriv_==deriv_ && nvi.dim_==dim_) {
-          double val = nodes_->GetNodes().at(nvi.id_).at(deriv_)(dim_);
-          jac.coeffRef(0, i) += 2.0*val;
-        }
-  }
+  auto it = sets_.find(var_set);
+  if (it == sets_.end())
+    return;
+
+  auto t0 = StartMeasurement();
+
+  // copy the compressed structure and write values in place; no sparse
+  // insertions happen in this per-iteration path.
+  const SetData& d = it->second;
+  Jacobian grad = d.structure;
+  double* vals = grad.valuePtr();
+  std::fill(vals, vals + grad.nonZeros(), 0.0);
+
+  // chain rule for the optional variable scaling of this node set.
+  const double s = d.nodes->GetVariableScaling();
+
+  const auto& nodes = d.nodes->GetNodes();
+  for (const auto& e : d.entries)
+    vals[e.slot] += 2.0*s*nodes.at(e.node_id).at(e.deriv)(e.dim);
+
+  jac = grad;
+
+  StopJacobianMeasurement(t0);
 }
 
 } /* namespace towr */
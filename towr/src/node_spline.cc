@@ -29,6 +29,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <towr/variables/node_spline.h>
 
+#include <algorithm> // std::fill
+
 #include <towr/variables/nodes.h>
 
 namespace towr {
@@ -40,17 +42,35 @@ NodeSpline::NodeSpline(NodeSubjectPtr const node_variables,
 {
   UpdateNodes();
   jac_wrt_nodes_structure_ = Jacobian(node_variables->GetDim(), node_variables->GetRows());
+
+  // assemble every polynomial's band table up front: the structure is
+  // fixed for the lifetime of the problem, and building eagerly keeps the
+  // first solver iteration free of this work.
+  jac_wrt_nodes_band_per_poly_.resize(GetPolynomialCount());
+  for (int id=0; id<GetPolynomialCount(); ++id)
+    BuildJacobianBand(id, jac_wrt_nodes_band_per_poly_.at(id));
 }
 
 void
 NodeSpline::UpdateNodes ()
 {
-  for (int i=0; i<cubic_polys_.size(); ++i) {
-    auto nodes = node_values_->GetBoundaryNodes(i);
-    cubic_polys_.at(i).SetNodes(nodes.front(), nodes.back());
-  }
+  // only the polynomials adjacent to a changed node need new coefficients;
+  // during line search the solver often perturbs few variables.
+  int n_polys = cubic_polys_.size();
+  std::vector<int> poly_ids;
+  for (int node_id : node_values_->GetChangedNodeIds())
+    for (int poly_id : {node_id-1, node_id}) {
+      if (poly_id < 0 || n_polys <= poly_id)
+        continue;
+      if (!poly_ids.empty() && poly_ids.back() == poly_id)
+        continue; // already refreshed through the neighboring node
+
+      auto nodes = node_values_->GetBoundaryNodes(poly_id);
+      cubic_polys_.at(poly_id).SetNodes(nodes.front(), nodes.back());
+      poly_ids.push_back(poly_id);
+    }
 
-  UpdatePolynomialCoeff();
+  UpdatePolynomialCoeff(poly_ids);
 }
 
 int
@@ -59,26 +79,146 @@ NodeSpline::GetNodeVariablesCount() const
   return node_values_->GetRows();
 }
 
+std::size_t
+NodeSpline::GetHeapBytes () const
+{
+  // compressed sparse storage: one value and inner index per nonzero,
+  // plus one offset per outer dimension.
+  auto sparse_bytes = [](const Jacobian& m) {
+    return static_cast<std::size_t>(m.nonZeros())*(sizeof(double) + sizeof(int))
+         + static_cast<std::size_t>(m.outerSize()+1)*sizeof(int);
+  };
+
+  std::size_t bytes = sparse_bytes(jac_wrt_nodes_structure_);
+  bytes += cubic_polys_.capacity()*sizeof(VecPoly::value_type);
+
+  bytes += jac_wrt_nodes_band_per_poly_.capacity()*sizeof(PolyJacBand);
+  for (const auto& band : jac_wrt_nodes_band_per_poly_) {
+    bytes += sparse_bytes(band.pattern);
+    bytes += band.entries.capacity()*sizeof(BandEntry);
+  }
+
+  return bytes;
+}
+
 NodeSpline::Jacobian
 NodeSpline::GetJacobianWrtNodes (double t_global, Dx dxdt) const
 {
   int id; double t_local;
-  std::tie(id, t_local) = GetLocalTime(t_global, GetPolyDurations());
+  std::tie(id, t_local) = GetLocalTime(t_global);
 
   return GetJacobianWrtNodes(id, t_local, dxdt);
 }
 
+std::vector<NodeSpline::Jacobian>
+NodeSpline::GetJacobiansWrtNodes (const VecTimes& ts, Dx dxdt) const
+{
+  std::vector<Jacobian> jacobians;
+  jacobians.reserve(ts.size());
+
+  for (const auto& p : GetLocalTimes(ts))
+    jacobians.push_back(GetJacobianWrtNodes(p.first, p.second, dxdt));
+
+  return jacobians;
+}
+
 NodeSpline::Jacobian
 NodeSpline::GetJacobianWrtNodes (int id, double t_local, Dx dxdt) const
 {
-  Jacobian jac = jac_wrt_nodes_structure_;
-  FillJacobianWrtNodes(id, t_local, dxdt, jac, false);
+  // sparsity and slot mapping of the band were assembled at construction;
+  // both are independent of dxdt and t_local, as these only affect values.
+  const PolyJacBand& band = jac_wrt_nodes_band_per_poly_.at(id);
+
+  // every nonzero of the band carries one of these four scalars, so they
+  // are computed once and scattered through the precomputed entry table.
+  // chain rule for the optional variable scaling: the solver optimizes
+  // value/scale, so every column is multiplied by the set's scale factor.
+  const double s = node_values_->GetVariableScaling();
+  const auto& poly = cubic_polys_.at(id);
+  const double dwrt[4] = {
+      s*poly.GetDerivativeWrtStartNode(dxdt, kPos, t_local),
+      s*poly.GetDerivativeWrtStartNode(dxdt, kVel, t_local),
+      s*poly.GetDerivativeWrtEndNode(dxdt, kPos, t_local),
+      s*poly.GetDerivativeWrtEndNode(dxdt, kVel, t_local)};
+
+  // copying the compressed pattern and writing values in-place avoids
+  // any sparse-matrix insertions in this hot path.
+  Jacobian jac = band.pattern;
+  double* vals = jac.valuePtr();
+  std::fill(vals, vals + jac.nonZeros(), 0.0);
+
+  for (const auto& e : band.entries)
+    vals[e.slot] += dwrt[e.dwrt];
+
+  return jac;
+}
+
+void
+NodeSpline::GetJacobianWrtNodesWindow (double t, Dx dxdt,
+                                       Eigen::MatrixXd& jac,
+                                       int& col_start) const
+{
+  int id; double t_local;
+  std::tie(id, t_local) = GetLocalTime(t);
+
+  const PolyJacBand& band = jac_wrt_nodes_band_per_poly_.at(id);
+  col_start = band.col_min;
+  int width = band.entries.empty()? 0 : band.col_max - band.col_min + 1;
+
+  // same four boundary sensitivities as the sparse accessor, scattered
+  // into a dense block spanning only the band's columns.
+  const double s = node_values_->GetVariableScaling();
+  const auto& poly = cubic_polys_.at(id);
+  const double dwrt[4] = {
+      s*poly.GetDerivativeWrtStartNode(dxdt, kPos, t_local),
+      s*poly.GetDerivativeWrtStartNode(dxdt, kVel, t_local),
+      s*poly.GetDerivativeWrtEndNode(dxdt, kPos, t_local),
+      s*poly.GetDerivativeWrtEndNode(dxdt, kVel, t_local)};
+
+  jac.setZero(jac_wrt_nodes_structure_.rows(), width);
+  for (const auto& e : band.entries)
+    jac(e.row, e.col - col_start) += dwrt[e.dwrt];
+}
+
+void
+NodeSpline::BuildJacobianBand (int poly_id, PolyJacBand& band) const
+{
+  band.pattern = jac_wrt_nodes_structure_;
+  FillJacobianWrtNodes(poly_id, 0.0, kPos, band.pattern, true);
 
   // needed to avoid Eigen::assert failure "wrong storage order" triggered
   // in dynamic_constraint.cc
-  jac.makeCompressed();
-
-  return jac;
+  band.pattern.makeCompressed();
+
+  // the value slot of a (dim, opt-index) nonzero in the compressed
+  // row-major pattern.
+  auto slot_of = [&band](int row, int col) {
+    for (int k=band.pattern.outerIndexPtr()[row];
+         k<band.pattern.outerIndexPtr()[row+1]; ++k)
+      if (band.pattern.innerIndexPtr()[k] == col)
+        return k;
+    assert(false); // every entry was just inserted above
+    return -1;
+  };
+
+  for (int idx=0; idx<band.pattern.cols(); ++idx)
+    for (auto nvi : node_values_->GetNodeInfoAtOptIndex(idx))
+      for (auto side : {Nodes::Side::Start, Nodes::Side::End})
+        if (node_values_->GetNodeId(poly_id, side) == nvi.id_)
+          band.entries.push_back({slot_of(nvi.dim_, idx),
+                                  2*(side==Nodes::Side::Start? 0 : 1)
+                                  + (nvi.deriv_==kVel? 1 : 0),
+                                  nvi.dim_, idx});
+
+  // the column window the dense narrow-block accessor hands out
+  // (@sa GetJacobianWrtNodesWindow())
+  if (!band.entries.empty()) {
+    band.col_min = band.col_max = band.entries.front().col;
+    for (const auto& e : band.entries) {
+      band.col_min = std::min(band.col_min, e.col);
+      band.col_max = std::max(band.col_max, e.col);
+    }
+  }
 }
 
 void
@@ -104,7 +244,7 @@ NodeSpline::FillJacobianWrtNodes (int poly_id, double t_local, Dx dxdt,
           if (fill_with_zeros)
             val = 0.0;
 
-          jac.coeffRef(nvi.dim_, idx) += val;
+          jac.coeffRef(nvi.dim_, idx) += node_values_->GetVariableScaling()*val;
         }
       }
     }
@@ -29,6 +29,10 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <towr/variables/nodes.h>
 
+#include <algorithm> // std::min
+#include <numeric>   // std::iota
+
+#include <towr/variables/spline.h>
 
 namespace towr {
 
@@ -54,16 +58,32 @@ Nodes::NodeValueInfo::NodeValueInfo(int node_id, Dx deriv, int node_dim)
   dim_   = node_dim;
 }
 
+const int Nodes::NodeValueNotOptimized;
+
 int
 Nodes::GetOptIndex(const NodeValueInfo& n) const
 {
-  // could also cache this as map for more efficiency, but adding complexity
-  for (int idx=0; idx<GetRows(); ++idx)
-    for ( NodeValueInfo node_info : GetNodeInfoAtOptIndex(idx))
-      if ( node_info == n )
-        return idx;
+  return GetOptIndexLookup().at(GetLookupKey(n));
+}
+
+int
+Nodes::GetLookupKey (const NodeValueInfo& nvi) const
+{
+  // nodes only carry position and velocity values, enumerated per node
+  return (nvi.id_*2 + nvi.deriv_)*n_dim_ + nvi.dim_;
+}
+
+const std::vector<int>&
+Nodes::GetOptIndexLookup () const
+{
+  if (opt_index_lookup_.empty()) {
+    opt_index_lookup_.assign(nodes_.size()*2*n_dim_, NodeValueNotOptimized);
+    for (int idx=0; idx<GetRows(); ++idx)
+      for (const auto& nvi : GetOptIndexMap().at(idx))
+        opt_index_lookup_.at(GetLookupKey(nvi)) = idx;
+  }
 
-  assert(false); // index representing these quantities doesn't exist
+  return opt_index_lookup_;
 }
 
 std::vector<Nodes::NodeValueInfo>
@@ -85,28 +105,110 @@ Nodes::GetNodeInfoAtOptIndex (int idx) const
   return nodes;
 }
 
+const std::vector<std::vector<Nodes::NodeValueInfo>>&
+Nodes::GetOptIndexMap () const
+{
+  if (opt_idx_map_.empty()) {
+    opt_idx_map_.resize(GetRows());
+    for (int idx=0; idx<GetRows(); ++idx)
+      opt_idx_map_.at(idx) = GetNodeInfoAtOptIndex(idx);
+  }
+
+  return opt_idx_map_;
+}
+
 Eigen::VectorXd
 Nodes::GetValues () const
 {
-  VectorXd x(GetRows());
+  return GetValuesRef(); // by-value return demanded by the ifopt interface
+}
 
-  for (int idx=0; idx<x.rows(); ++idx)
-    for (auto info : GetNodeInfoAtOptIndex(idx))
-      x(idx) = nodes_.at(info.id_).at(info.deriv_)(info.dim_);
+const Eigen::VectorXd&
+Nodes::GetValuesRef () const
+{
+  // gather only when the node values were changed outside of
+  // SetVariables(); otherwise x_ already mirrors them contiguously.
+  if (!x_valid_) {
+    x_.resize(GetRows());
+    for (int idx=0; idx<x_.rows(); ++idx)
+      for (const auto& info : GetOptIndexMap().at(idx))
+        x_(idx) = nodes_.at(info.id_).at(info.deriv_)(info.dim_) / scale_;
+    x_valid_ = true;
+  }
 
-  return x;
+  return x_;
 }
 
 void
 Nodes::SetVariables (const VectorXd& x)
 {
-  for (int idx=0; idx<x.rows(); ++idx)
-    for (auto info : GetNodeInfoAtOptIndex(idx))
-      nodes_.at(info.id_).at(info.deriv_)(info.dim_) = x(idx);
+  GetValuesRef(); // brings x_ in sync before comparing against it
+
+  changed_node_ids_.clear();
+  all_nodes_changed_ = false;
+
+  // ifopt re-sets the identical iterate before most evaluations, so one
+  // vectorized comparison usually replaces the element-wise diff below.
+  if ((x_.array() == x.array()).all())
+    return;
+
+  for (int idx=0; idx<x.rows(); ++idx) {
+    if (x_(idx) == x(idx))
+      continue;
+
+    x_(idx) = x(idx);
+    for (const auto& info : GetOptIndexMap().at(idx)) {
+      nodes_.at(info.id_).at(info.deriv_)(info.dim_) = scale_*x(idx);
+      changed_node_ids_.push_back(info.id_);
+    }
+  }
+
+  // ifopt re-sets the variables before every evaluation, so values and
+  // Jacobians queried at the same iterate arrive as identical re-sets.
+  // The observers are in sync then and need not even be notified.
+  if (changed_node_ids_.empty())
+    return;
+
+  // multiple values of the same node usually change together
+  std::sort(changed_node_ids_.begin(), changed_node_ids_.end());
+  auto last = std::unique(changed_node_ids_.begin(), changed_node_ids_.end());
+  changed_node_ids_.erase(last, changed_node_ids_.end());
 
   UpdateObservers();
 }
 
+std::vector<int>
+Nodes::GetChangedNodeIds () const
+{
+  if (all_nodes_changed_) {
+    std::vector<int> all_ids(nodes_.size());
+    std::iota(all_ids.begin(), all_ids.end(), 0);
+    return all_ids;
+  }
+
+  return changed_node_ids_;
+}
+
+std::size_t
+Nodes::GetHeapBytes () const
+{
+  // the per-node state vectors are stack-allocated (@sa state.h), so the
+  // node storage itself is one contiguous vector.
+  std::size_t bytes = nodes_.capacity()*sizeof(Node);
+
+  bytes += bounds_.capacity()*sizeof(ifopt::Bounds);
+  bytes += scaled_bounds_.capacity()*sizeof(ifopt::Bounds);
+  bytes += x_.size()*sizeof(double);
+  bytes += changed_node_ids_.capacity()*sizeof(int);
+  bytes += opt_index_lookup_.capacity()*sizeof(int);
+
+  bytes += opt_idx_map_.capacity()*sizeof(std::vector<NodeValueInfo>);
+  for (const auto& infos : opt_idx_map_)
+    bytes += infos.capacity()*sizeof(NodeValueInfo);
+
+  return bytes;
+}
+
 void
 Nodes::UpdateObservers() const
 {
@@ -150,7 +252,36 @@ Nodes::GetPolynomialCount() const
 Nodes::VecBound
 Nodes::GetBounds () const
 {
-  return bounds_;
+  return GetBoundsRef(); // by-value return demanded by the ifopt interface
+}
+
+const Nodes::VecBound&
+Nodes::GetBoundsRef () const
+{
+  if (scale_ == 1.0)
+    return bounds_;
+
+  // the bounds are stored in physical units; the solver-facing copy is
+  // rebuilt only when a bound was modified.
+  if (!scaled_bounds_valid_) {
+    scaled_bounds_ = bounds_;
+    for (auto& b : scaled_bounds_) {
+      b.lower_ /= scale_;
+      b.upper_ /= scale_;
+    }
+    scaled_bounds_valid_ = true;
+  }
+
+  return scaled_bounds_;
+}
+
+void
+Nodes::SetVariableScaling (double scale)
+{
+  assert(scale > 0.0);
+  scale_ = scale;
+  x_valid_ = false;
+  scaled_bounds_valid_ = false;
 }
 
 const std::vector<Node>
@@ -173,6 +304,104 @@ Nodes::InitializeNodesTowardsGoal(const VectorXd& initial_pos,
     n.at(kVel) = average_velocity;
     nodes_.at(i) = n;
   }
+
+  all_nodes_changed_ = true; // values changed outside of SetVariables()
+  x_valid_ = false;
+}
+
+void
+Nodes::InitializeNodesFromSpline (const Spline& spline,
+                                  const VecDurations& poly_durations,
+                                  double t_offset)
+{
+  assert(nodes_.size() == poly_durations.size()+1);
+  double T = spline.GetTotalTime();
+
+  double t = 0.0;
+  for (int i=0; i<nodes_.size(); ++i) {
+    State s = spline.GetPoint(std::min(t + t_offset, T));
+
+    Node n(n_dim_);
+    n.at(kPos) = s.p();
+    n.at(kVel) = s.v();
+    nodes_.at(i) = n;
+
+    if (i < poly_durations.size())
+      t += poly_durations.at(i);
+  }
+
+  all_nodes_changed_ = true; // values changed outside of SetVariables()
+  x_valid_ = false;
+}
+
+void
+Nodes::SetAllNodes (const std::vector<Node>& nodes)
+{
+  assert(nodes.size() == nodes_.size());
+  nodes_ = nodes;
+
+  all_nodes_changed_ = true; // values changed outside of SetVariables()
+  x_valid_ = false;
+}
+
+void
+Nodes::InitializeNodesFromReference (const std::vector<double>& t_sample,
+                                     const std::vector<VectorXd>& pos_sample,
+                                     const VecDurations& poly_durations)
+{
+  assert(nodes_.size() == poly_durations.size()+1);
+  assert(t_sample.size() == pos_sample.size());
+  assert(t_sample.size() >= 2);
+
+  // time at which each node is located in the spline.
+  std::vector<double> node_time(nodes_.size(), 0.0);
+  for (int i=0; i<poly_durations.size(); ++i)
+    node_time.at(i+1) = node_time.at(i) + poly_durations.at(i);
+
+  // Each sample is a linear combination of the position and velocity of
+  // the two nodes bounding its polynomial (cubic Hermite basis), so all
+  // node values together solve one linear least-squares problem per
+  // dimension. The unknowns are [p0 v0 p1 v1 ...], shared RHS columns.
+  int n_unknowns = 2*nodes_.size();
+  Eigen::MatrixXd A = Eigen::MatrixXd::Zero(t_sample.size(), n_unknowns);
+  Eigen::MatrixXd b = Eigen::MatrixXd::Zero(t_sample.size(), n_dim_);
+
+  for (int row=0; row<t_sample.size(); ++row) {
+    double t = std::min(std::max(t_sample.at(row), 0.0), node_time.back());
+
+    int poly = 0;
+    while (poly < poly_durations.size()-1 && t > node_time.at(poly+1))
+      poly++;
+
+    double dt = poly_durations.at(poly);
+    double u  = (t - node_time.at(poly))/dt;
+    double u2 = u*u;
+    double u3 = u2*u;
+
+    A(row, 2*poly+0) =  2*u3 - 3*u2 + 1;       // position of start node
+    A(row, 2*poly+1) = (u3 - 2*u2 + u)*dt;     // velocity of start node
+    A(row, 2*poly+2) = -2*u3 + 3*u2;           // position of end node
+    A(row, 2*poly+3) = (u3 - u2)*dt;           // velocity of end node
+
+    for (int dim=0; dim<n_dim_; ++dim)
+      b(row, dim) = pos_sample.at(row)(dim);
+  }
+
+  // normal equations with a small ridge, so sparsely sampled polynomials
+  // don't make the fit rank deficient.
+  Eigen::MatrixXd AtA = A.transpose()*A;
+  AtA.diagonal().array() += 1e-9;
+  Eigen::MatrixXd sol = AtA.ldlt().solve(A.transpose()*b);
+
+  for (int i=0; i<nodes_.size(); ++i) {
+    Node n(n_dim_);
+    n.at(kPos) = sol.row(2*i+0).transpose();
+    n.at(kVel) = sol.row(2*i+1).transpose();
+    nodes_.at(i) = n;
+  }
+
+  all_nodes_changed_ = true; // values changed outside of SetVariables()
+  x_valid_ = false;
 }
 
 void
@@ -187,10 +416,30 @@ Nodes::AddBounds(int node_id, Dx deriv,
 void
 Nodes::AddBound (const NodeValueInfo& nvi, double val)
 {
-  for (int idx=0; idx<GetRows(); ++idx)
-    for (auto info : GetNodeInfoAtOptIndex(idx))
-      if (info == nvi)
-        bounds_.at(idx) = ifopt::Bounds(val, val);
+  int idx = GetOptIndex(nvi);
+  if (idx != NodeValueNotOptimized) {
+    bounds_.at(idx) = ifopt::Bounds(val, val);
+    scaled_bounds_valid_ = false;
+  }
+}
+
+void
+Nodes::SetNodeEqualityBounds (const std::vector<int>& node_ids,
+                              const std::vector<Node>& values)
+{
+  assert(node_ids.size() == values.size());
+
+  for (int i=0; i<static_cast<int>(node_ids.size()); ++i)
+    for (auto deriv : {kPos, kVel})
+      for (int dim=0; dim<n_dim_; ++dim) {
+        int idx = GetOptIndex(NodeValueInfo(node_ids.at(i), deriv, dim));
+        if (idx != NodeValueNotOptimized) {
+          double val = values.at(i).at(deriv)(dim);
+          bounds_.at(idx) = ifopt::Bounds(val, val);
+        }
+      }
+
+  scaled_bounds_valid_ = false;
 }
 
 void
@@ -0,0 +1,85 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <towr/object_arena.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+
+namespace towr {
+
+ObjectArena::ObjectArena (std::size_t block_size)
+{
+  assert(block_size > 0);
+  block_size_ = block_size;
+}
+
+void*
+ObjectArena::Allocate (std::size_t size, std::size_t align)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  if (!blocks_.empty()) {
+    Block& b = blocks_.back();
+    auto base = reinterpret_cast<std::uintptr_t>(b.data_.get());
+    std::size_t start = ((base + b.used_ + align-1) & ~std::uintptr_t(align-1)) - base;
+    if (start + size <= b.size_) {
+      b.used_ = start + size;
+      bytes_used_ += size;
+      return b.data_.get() + start;
+    }
+  }
+
+  // over-sized requests get a block of their own, so the common block
+  // size stays small enough to be reused densely.
+  std::size_t n = std::max(block_size_, size + align);
+  blocks_.push_back(Block());
+  Block& b = blocks_.back();
+  b.data_.reset(new char[n]);
+  b.size_ = n;
+
+  std::size_t start = 0;
+  auto addr = reinterpret_cast<std::uintptr_t>(b.data_.get());
+  if (addr % align != 0)
+    start = align - addr%align;
+
+  b.used_ = start + size;
+  bytes_used_ += size;
+  return b.data_.get() + start;
+}
+
+std::size_t
+ObjectArena::GetBytesUsed () const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return bytes_used_;
+}
+
+} /* namespace towr */
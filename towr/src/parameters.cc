@@ -111,12 +111,44 @@ Parameters::PenalizeEndeffectorForces ()
   costs_.push_back({ForcesCostID, 1.0});
 }
 
+void
+Parameters::UseRotationVectorBase ()
+{
+  use_rotation_vector_base_ = true;
+}
+
+void
+Parameters::OptimizeForceValuesOnly ()
+{
+  optimize_force_values_only_ = true;
+}
+
+void
+Parameters::EnableVariableScaling ()
+{
+  scale_node_variables_ = true;
+}
+
+void
+Parameters::StopAtFeasible (double tolerance)
+{
+  assert(tolerance >= 0.0);
+  feasibility_tolerance_ = tolerance;
+}
+
+void
+Parameters::PresolveFootholds ()
+{
+  presolve_footholds_ = true;
+}
+
 Parameters::VecTimes
 Parameters::GetBasePolyDurations () const
 {
   std::vector<double> base_spline_timings_;
   double dt = duration_base_polynomial_;
   double t_left = GetTotalTime ();
+  base_spline_timings_.reserve(ceil(t_left/dt));
 
   double eps = 1e-10; // since repeated subtraction causes inaccuracies
   while (t_left > eps) {
@@ -144,15 +176,14 @@ Parameters::GetEECount() const
 double
 Parameters::GetTotalTime () const
 {
-  std::vector<double> T_feet;
-
-  for (const auto& v : ee_phase_durations_)
-    T_feet.push_back(std::accumulate(v.begin(), v.end(), 0.0));
+  // take first foot as reference
+  double T = ee_phase_durations_.empty()? 0.0
+      : std::accumulate(ee_phase_durations_.front().begin(),
+                        ee_phase_durations_.front().end(), 0.0);
 
   // safety check that all feet durations sum to same value
-  double T = T_feet.empty()? 0.0 : T_feet.front(); // take first foot as reference
-  for (double Tf : T_feet)
-    assert(fabs(Tf - T) < 1e-6);
+  for (const auto& v : ee_phase_durations_)
+    assert(fabs(std::accumulate(v.begin(), v.end(), 0.0) - T) < 1e-6);
 
   return T;
 }
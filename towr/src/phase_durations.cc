@@ -29,7 +29,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <towr/variables/phase_durations.h>
 
-#include <numeric> // std::accumulate
+#include <numeric> // std::accumulate, std::iota
 
 #include <towr/variables/variable_names.h>
 #include <towr/variables/spline.h> // for Spline::GetSegmentID()
@@ -68,25 +68,54 @@ PhaseDurations::UpdateObservers () const
 Eigen::VectorXd
 PhaseDurations::GetValues () const
 {
-  VectorXd x(GetRows());
-
-  for (int i=0; i<x.rows(); ++i)
-    x(i) = durations_.at(i);
-
-  return x;
+  // the optimized durations are the contiguous prefix of durations_
+  return Eigen::Map<const VectorXd>(durations_.data(), GetRows());
 }
 
 void
 PhaseDurations::SetVariables (const VectorXd& x)
 {
-  for (int i=0; i<GetRows(); ++i)
-    durations_.at(i) = x(i);
+  Eigen::Map<VectorXd> current(durations_.data(), GetRows());
+
+  // the solver pushes the full variable vector even when this set is
+  // untouched; one vectorized comparison rules that case out. The final
+  // duration only depends on the others (fixed total), so it cannot have
+  // changed either.
+  if ((current.array() == x.array()).all())
+    return;
+
+  changed_phase_ids_.clear();
+  all_phases_changed_ = false;
+
+  for (int i=0; i<GetRows(); ++i) {
+    if (durations_.at(i) != x(i)) {
+      durations_.at(i) = x(i);
+      changed_phase_ids_.push_back(i);
+    }
+  }
 
-  durations_.back() =  t_total_ - x.sum();
+  double t_last = t_total_ - x.sum();
+  if (durations_.back() != t_last) {
+    durations_.back() = t_last;
+    changed_phase_ids_.push_back(durations_.size()-1);
+  }
   assert(durations_.back()>0);
+
   UpdateObservers();
 }
 
+std::vector<int>
+PhaseDurations::GetChangedPhaseIds () const
+{
+  if (all_phases_changed_) {
+    std::vector<int> all_ids(durations_.size());
+    std::iota(all_ids.begin(), all_ids.end(), 0);
+    return all_ids;
+  }
+
+  return changed_phase_ids_;
+}
+
 PhaseDurations::VecBound
 PhaseDurations::GetBounds () const
 {
@@ -108,16 +108,21 @@ PhaseNodes::PhaseNodes (int phase_count,
                         bool is_in_contact_at_start,
                         const std::string& name,
                         int n_polys_in_changing_phase,
-                        Type type)
+                        Type type,
+                        bool optimize_node_velocities)
     :Nodes(3, name)
 {
   polynomial_info_ = BuildPolyInfos(phase_count, is_in_contact_at_start, n_polys_in_changing_phase, type);
   optnode_to_node_ = GetOptNodeToNodeMappings(polynomial_info_);
+  optimize_node_velocities_ = optimize_node_velocities;
 
-  int n_opt_variables = optnode_to_node_.size() * 2*GetDim();
+  int n_derivs_per_node = optimize_node_velocities_? 2 : 1;
+  int n_opt_variables = optnode_to_node_.size() * n_derivs_per_node*GetDim();
   int n_nodes = polynomial_info_.size()+1;
   InitMembers(n_nodes, n_opt_variables);
 
+  BuildLookupTables();
+
   if (type == Motion)
     SetBoundsEEMotion();
   else if (type == Force)
@@ -173,41 +178,84 @@ PhaseNodes::GetOptNodeToNodeMappings (const std::vector<PolyInfo>& polynomial_in
   return optnode_to_node;
 }
 
-std::vector<PhaseNodes::NodeValueInfo>
-PhaseNodes::GetNodeInfoAtOptIndex(int idx) const
+void
+PhaseNodes::BuildLookupTables ()
 {
-  std::vector<NodeValueInfo> vec_nvi;
-
-  // always two consecutive node pairs are equal
-  int n_opt_values_per_node_ = 2*GetDim();
-  int internal_id = idx%n_opt_values_per_node_; // 0...6 (p.x, p.y, p.z, v.x, v.y. v.z)
+  int n_nodes = GetNodes().size();
+  int last_node_id = n_nodes-1;
+
+  // polynomials adjacent to each node
+  node_adjacent_polys_.resize(n_nodes);
+  for (int id=0; id<n_nodes; ++id) {
+    if (id==0)
+      node_adjacent_polys_.at(id) = {0};
+    else if (id==last_node_id)
+      node_adjacent_polys_.at(id) = {last_node_id-1};
+    else
+      node_adjacent_polys_.at(id) = {id-1, id};
+  }
 
-  NodeValueInfo nvi;
-  nvi.deriv_ = internal_id<GetDim()? kPos : kVel;
-  nvi.dim_   = internal_id%GetDim();
+  // node is considered constant if either left or right polynomial
+  // belongs to a constant phase
+  node_is_constant_.resize(n_nodes);
+  node_phase_.resize(n_nodes);
+  for (int id=0; id<n_nodes; ++id) {
+    bool is_constant = false;
+    for (int poly_id : node_adjacent_polys_.at(id))
+      if (IsInConstantPhase(poly_id))
+        is_constant = true;
+
+    node_is_constant_.at(id) = is_constant;
+    node_phase_.at(id) = polynomial_info_.at(node_adjacent_polys_.at(id).front()).phase_;
+
+    if (!is_constant)
+      non_constant_node_ids_.push_back(id);
+  }
 
-  // one index can represent multiple node (during constant phase)
-  int opt_node = std::floor(idx/n_opt_values_per_node_);
-  for (auto node_id : optnode_to_node_.at(opt_node)) {
-    nvi.id_ = node_id;
-    vec_nvi.push_back(nvi);
+  // all nodes of an optimization-variable group after the first only
+  // repeat that first node's values
+  node_is_duplicate_.assign(n_nodes, false);
+  for (const auto& kv : optnode_to_node_)
+    for (std::size_t i=1; i<kv.second.size(); ++i)
+      node_is_duplicate_.at(kv.second.at(i)) = true;
+
+  // first polynomial of each phase
+  int n_phases = polynomial_info_.back().phase_+1;
+  phase_first_poly_.resize(n_phases);
+  for (int i=polynomial_info_.size()-1; i>=0; --i)
+    phase_first_poly_.at(polynomial_info_.at(i).phase_) = i;
+
+  // nodes represented by each optimization index
+  opt_idx_to_nvi_.resize(GetRows());
+  for (int idx=0; idx<GetRows(); ++idx) {
+    // always two consecutive node pairs are equal; if the derivatives are
+    // not optimized only the position values appear in the variable vector.
+    int n_opt_values_per_node_ = (optimize_node_velocities_? 2 : 1)*GetDim();
+    int internal_id = idx%n_opt_values_per_node_; // 0...6 (p.x, p.y, p.z, v.x, v.y. v.z)
+
+    NodeValueInfo nvi;
+    nvi.deriv_ = internal_id<GetDim()? kPos : kVel;
+    nvi.dim_   = internal_id%GetDim();
+
+    // one index can represent multiple node (during constant phase)
+    int opt_node = std::floor(idx/n_opt_values_per_node_);
+    for (auto node_id : optnode_to_node_.at(opt_node)) {
+      nvi.id_ = node_id;
+      opt_idx_to_nvi_.at(idx).push_back(nvi);
+    }
   }
+}
 
-  return vec_nvi;
+std::vector<PhaseNodes::NodeValueInfo>
+PhaseNodes::GetNodeInfoAtOptIndex(int idx) const
+{
+  return opt_idx_to_nvi_.at(idx);
 }
 
 bool
 PhaseNodes::IsConstantNode (int node_id) const
 {
-  bool is_constant = false;
-
-  // node is considered constant if either left or right polynomial
-  // belongs to a constant phase
-  for (int poly_id : GetAdjacentPolyIds(node_id))
-    if (IsInConstantPhase(poly_id))
-      is_constant = true;
-
-  return is_constant;
+  return node_is_constant_.at(node_id);
 }
 
 bool
@@ -219,13 +267,13 @@ PhaseNodes::IsInConstantPhase(int poly_id) const
 PhaseNodes::NodeIds
 PhaseNodes::GetIndicesOfNonConstantNodes() const
 {
-  NodeIds node_ids;
-
-  for (int id=0; id<GetNodes().size(); ++id)
-    if (!IsConstantNode(id))
-      node_ids.push_back(id);
+  return non_constant_node_ids_;
+}
 
-  return node_ids;
+bool
+PhaseNodes::IsDuplicateNode (int node_id) const
+{
+  return node_is_duplicate_.at(node_id);
 }
 
 int
@@ -233,17 +281,54 @@ PhaseNodes::GetPhase (int node_id) const
 {
   assert(!IsConstantNode(node_id)); // because otherwise it has two phases
 
-  int poly_id = GetAdjacentPolyIds(node_id).front();
-  return polynomial_info_.at(poly_id).phase_;
+  return node_phase_.at(node_id);
 }
 
 int
 PhaseNodes::GetPolyIDAtStartOfPhase (int phase) const
 {
-  int poly_id=0;
-  for (int i=0; i<polynomial_info_.size(); ++i)
-    if (polynomial_info_.at(i).phase_ == phase)
-      return i;
+  return phase_first_poly_.at(phase);
+}
+
+std::vector<int>
+PhaseNodes::GetPolynomialIdsInPhase (int phase) const
+{
+  std::vector<int> ids;
+
+  int first = phase_first_poly_.at(phase);
+  ids.reserve(polynomial_info_.at(first).n_polys_in_phase_);
+  for (int id=first;
+       id<GetPolynomialCount() && polynomial_info_.at(id).phase_ == phase;
+       ++id)
+    ids.push_back(id);
+
+  return ids;
+}
+
+std::size_t
+PhaseNodes::GetHeapBytes () const
+{
+  std::size_t bytes = Nodes::GetHeapBytes();
+
+  bytes += polynomial_info_.capacity()*sizeof(PolyInfo);
+  bytes += node_phase_.capacity()*sizeof(int);
+  bytes += phase_first_poly_.capacity()*sizeof(int);
+  bytes += non_constant_node_ids_.capacity()*sizeof(int);
+  bytes += node_is_constant_.capacity()/8;  // bit-packed
+  bytes += node_is_duplicate_.capacity()/8;
+
+  bytes += node_adjacent_polys_.capacity()*sizeof(NodeIds);
+  for (const auto& ids : node_adjacent_polys_)
+    bytes += ids.capacity()*sizeof(int);
+
+  bytes += opt_idx_to_nvi_.capacity()*sizeof(std::vector<NodeValueInfo>);
+  for (const auto& infos : opt_idx_to_nvi_)
+    bytes += infos.capacity()*sizeof(NodeValueInfo);
+
+  for (const auto& kv : optnode_to_node_)
+    bytes += sizeof(kv) + kv.second.capacity()*sizeof(int);
+
+  return bytes;
 }
 
 Eigen::Vector3d
@@ -260,22 +345,10 @@ PhaseNodes::GetNodeIDAtStartOfPhase (int phase) const
   return GetNodeId(poly_id, Side::Start);
 }
 
-std::vector<int>
+const PhaseNodes::NodeIds&
 PhaseNodes::GetAdjacentPolyIds (int node_id) const
 {
-  std::vector<int> poly_ids;
-  int last_node_id = GetNodes().size()-1;
-
-  if (node_id==0)
-    poly_ids.push_back(0);
-  else if (node_id==last_node_id)
-    poly_ids.push_back(last_node_id-1);
-  else {
-    poly_ids.push_back(node_id-1);
-    poly_ids.push_back(node_id);
-  }
-
-  return poly_ids;
+  return node_adjacent_polys_.at(node_id);
 }
 
 PhaseNodes::PolyInfo::PolyInfo(int phase, int poly_id_in_phase,
@@ -55,30 +55,52 @@ void
 PhaseSpline::UpdatePolynomialDurations()
 {
   auto phase_duration = phase_durations_->GetPhaseDurations();
-  auto poly_durations = phase_nodes_->ConvertPhaseToPolyDurations(phase_duration);
 
-  for (int i=0; i<cubic_polys_.size(); ++i) {
-    cubic_polys_.at(i).SetDuration(poly_durations.at(i));
+  // only polynomials whose own duration changed need new coefficients; a
+  // changed phase also shifts all later polynomials in time, but that is
+  // captured by the cumulative durations alone. Which phases changed is
+  // known by the subject, so only their polynomials are visited.
+  std::vector<int> changed_ids;
+  for (int phase : phase_durations_->GetChangedPhaseIds()) {
+    auto poly_ids = phase_nodes_->GetPolynomialIdsInPhase(phase);
+    double duration = phase_duration.at(phase)/poly_ids.size();
+
+    for (int id : poly_ids) {
+      if (cubic_polys_.at(id).GetDuration() == duration)
+        continue;
+
+      cubic_polys_.at(id).SetDuration(duration);
+      changed_ids.push_back(id);
+    }
   }
 
-  UpdatePolynomialCoeff();
+  UpdateCumulativeDurations();
+  UpdatePolynomialCoeff(changed_ids);
 }
 
 PhaseSpline::Jacobian
 PhaseSpline::GetJacobianOfPosWrtDurations (double t_global) const
 {
+  if (t_global == jac_durations_t_
+      && GetUpdateCount() == jac_durations_update_count_)
+    return jac_durations_;
+
   VectorXd dx_dT  = GetDerivativeOfPosWrtPhaseDuration(t_global);
   VectorXd xd     = GetPoint(t_global).v();
   int current_phase = GetSegmentID(t_global, phase_durations_->GetPhaseDurations());
 
-  return phase_durations_->GetJacobianOfPos(current_phase, dx_dT, xd);
+  jac_durations_t_ = t_global;
+  jac_durations_update_count_ = GetUpdateCount();
+  jac_durations_ = phase_durations_->GetJacobianOfPos(current_phase, dx_dT, xd);
+
+  return jac_durations_;
 }
 
 Eigen::VectorXd
 PhaseSpline::GetDerivativeOfPosWrtPhaseDuration (double t_global) const
 {
   int poly_id; double t_local;
-  std::tie(poly_id, t_local) = GetLocalTime(t_global, GetPolyDurations());
+  std::tie(poly_id, t_local) = GetLocalTime(t_global);
 
   VectorXd vel  = GetPoint(t_global).v();
   VectorXd dxdT = cubic_polys_.at(poly_id).GetDerivativeOfPosWrtDuration(t_local);
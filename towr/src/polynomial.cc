@@ -40,7 +40,7 @@ Polynomial::Polynomial (int order, int dim)
   int n_coeff = order+1;
   for (int c=A; c<n_coeff; ++c) {
     coeff_ids_.push_back(static_cast<Coefficients>(c));
-    coeff_.push_back(VectorXd::Zero(dim));
+    coeff_.push_back(CoeffVector::Zero(dim));
   }
 }
 
@@ -60,6 +60,35 @@ State Polynomial::GetPoint(double t_local) const
   return out;
 }
 
+void
+Polynomial::GetPoints (const std::vector<double>& ts_local,
+                       Eigen::MatrixXd& p,
+                       Eigen::MatrixXd& v,
+                       Eigen::MatrixXd& a) const
+{
+  int n_coeff = coeff_.size();
+  int n_times = ts_local.size();
+  int n_dim   = coeff_.front().size();
+
+  // the coefficients as one matrix, one column per coefficient
+  Eigen::MatrixXd coeff(n_dim, n_coeff);
+  for (Coefficients c : coeff_ids_)
+    coeff.col(c) = coeff_.at(c);
+
+  // the powers of every time, one column per time
+  Eigen::MatrixXd tp(n_coeff, n_times), tv(n_coeff, n_times), ta(n_coeff, n_times);
+  for (int j=0; j<n_times; ++j)
+    for (Coefficients c : coeff_ids_) {
+      tp(c,j) = GetDerivativeWrtCoeff(ts_local.at(j), kPos, c);
+      tv(c,j) = GetDerivativeWrtCoeff(ts_local.at(j), kVel, c);
+      ta(c,j) = GetDerivativeWrtCoeff(ts_local.at(j), kAcc, c);
+    }
+
+  p.noalias() = coeff*tp;
+  v.noalias() = coeff*tv;
+  a.noalias() = coeff*ta;
+}
+
 double
 Polynomial::GetDerivativeWrtCoeff (double t, Dx deriv, Coefficients c) const
 {
@@ -74,7 +103,7 @@ Polynomial::GetDerivativeWrtCoeff (double t, Dx deriv, Coefficients c) const
 
 
 CubicHermitePolynomial::CubicHermitePolynomial (int dim)
-    : Polynomial(3,dim),
+    : PolynomialT<3>(dim),
       n0_(dim),
       n1_(dim)
 {
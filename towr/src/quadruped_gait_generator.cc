@@ -74,7 +74,7 @@ QuadrupedGaitGenerator::QuadrupedGaitGenerator ()
 }
 
 void
-QuadrupedGaitGenerator::SetCombo (Combos combo)
+QuadrupedGaitGenerator::ExpandCombo (Combos combo)
 {
   switch (combo) {
     case C0: SetGaits({Stand, Walk2, Walk2, Walk2, Walk2E, Stand}); break; // overlap-walk
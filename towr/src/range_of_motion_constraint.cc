@@ -39,16 +39,76 @@ RangeOfMotionConstraint::RangeOfMotionConstraint (const KinematicModel::Ptr& mod
     :TimeDiscretizationConstraint(T, dt, "rangeofmotion-" + std::to_string(ee))
 {
   base_linear_  = spline_holder.base_linear_;
-  base_angular_ = EulerConverter(spline_holder.base_angular_);
+  base_angular_ = std::make_shared<EulerConverter>(spline_holder.base_angular_);
   ee_motion_    = spline_holder.ee_motion_.at(ee);
 
   max_deviation_from_nominal_ = model->GetMaximumDeviationFromNominal();
   nominal_ee_pos_B_           = model->GetNominalStanceInBase().at(ee);
   ee_ = ee;
 
+  // the deviation box is a constant of the kinematic model, so the bounds
+  // are identical for every node and assembled once here.
+  node_bounds_.resize(k3D);
+  for (int dim=0; dim<k3D; ++dim) {
+    ifopt::Bounds b;
+    b += nominal_ee_pos_B_(dim);
+    b.upper_ += max_deviation_from_nominal_(dim);
+    b.lower_ -= max_deviation_from_nominal_(dim);
+    node_bounds_.at(dim) = b;
+  }
+
+  // the parallel per-instance updates only read from the splines and the
+  // caches primed in PrimeEvaluationCaches(); in particular the angular
+  // converter's single-slot memo is never queried under the parallel loop.
+  parallelize_instances_ = true;
+
   SetRows(GetNumberOfNodes()*k3D);
 }
 
+void
+RangeOfMotionConstraint::SetAngularConverter (const AngularStateConverter::Ptr& converter)
+{
+  base_angular_ = converter;
+}
+
+void
+RangeOfMotionConstraint::SetStateGrid (const SplineStateGrid::Ptr& grid)
+{
+  assert(grid->GetTimes() == dts_);
+  state_grid_ = grid;
+}
+
+void
+RangeOfMotionConstraint::PrimeEvaluationCaches () const
+{
+  // refresh the shared states serially here; the parallel per-instance
+  // updates then only read from the cache.
+  if (state_grid_) {
+    state_grid_->GetStates(base_linear_.get());
+    state_grid_->GetStates(ee_motion_.get());
+  }
+
+  // fill the per-grid rotation cache while still single-threaded: the
+  // angular converter memoizes one query time at a time, so hitting it
+  // from the parallel instance loop would race on that slot.
+  for (int k=0; k<GetNumberOfNodes(); ++k)
+    GetRotationWorldToBase(dts_.at(k), k);
+}
+
+RangeOfMotionConstraint::Vector3d
+RangeOfMotionConstraint::GetBaseLinPos (double t, int k) const
+{
+  return state_grid_? state_grid_->GetStates(base_linear_.get()).at(k).p()
+                    : base_linear_->GetPoint(t).p();
+}
+
+RangeOfMotionConstraint::Vector3d
+RangeOfMotionConstraint::GetEEPos (double t, int k) const
+{
+  return state_grid_? state_grid_->GetStates(ee_motion_.get()).at(k).p()
+                    : ee_motion_->GetPoint(t).p();
+}
+
 int
 RangeOfMotionConstraint::GetRow (int node, int dim) const
 {
@@ -58,9 +118,9 @@ RangeOfMotionConstraint::GetRow (int node, int dim) const
 void
 RangeOfMotionConstraint::UpdateConstraintAtInstance (double t, int k, VectorXd& g) const
 {
-  Vector3d base_W  = base_linear_->GetPoint(t).p();
-  Vector3d pos_ee_W = ee_motion_->GetPoint(t).p();
-  EulerConverter::MatrixSXd b_R_w = base_angular_.GetRotationMatrixBaseToWorld(t).transpose();
+  Vector3d base_W   = GetBaseLinPos(t, k);
+  Vector3d pos_ee_W = GetEEPos(t, k);
+  const AngularStateConverter::MatrixSXd& b_R_w = GetRotationWorldToBase(t, k);
 
   Vector3d vector_base_to_ee_W = pos_ee_W - base_W;
   Vector3d vector_base_to_ee_B = b_R_w*(vector_base_to_ee_W);
@@ -71,42 +131,107 @@ RangeOfMotionConstraint::UpdateConstraintAtInstance (double t, int k, VectorXd&
 void
 RangeOfMotionConstraint::UpdateBoundsAtInstance (double t, int k, VecBound& bounds) const
 {
-  for (int dim=0; dim<k3D; ++dim) {
-    ifopt::Bounds b;
-    b += nominal_ee_pos_B_(dim);
-    b.upper_ += max_deviation_from_nominal_(dim);
-    b.lower_ -= max_deviation_from_nominal_(dim);
-    bounds.at(GetRow(k,dim)) = b;
+  for (int dim=0; dim<k3D; ++dim)
+    bounds.at(GetRow(k,dim)) = node_bounds_.at(dim);
+}
+
+const AngularStateConverter::MatrixSXd&
+RangeOfMotionConstraint::GetRotationWorldToBase (double t, int k) const
+{
+  int epoch = base_angular_->GetUpdateCount();
+  if (epoch != b_R_w_epoch_) {
+    b_R_w_cache_.resize(dts_.size());
+    b_R_w_valid_.assign(dts_.size(), false);
+    b_R_w_epoch_ = epoch;
+  }
+
+  if (!b_R_w_valid_.at(k)) {
+    b_R_w_cache_.at(k) = base_angular_->GetRotationMatrixBaseToWorld(t).transpose();
+    b_R_w_valid_.at(k) = true;
   }
+
+  return b_R_w_cache_.at(k);
 }
 
 void
 RangeOfMotionConstraint::UpdateJacobianAtInstance (double t, int k,
-                                                   std::string var_set,
+                                                   const id::VarSetId& var_set,
                                                    Jacobian& jac) const
 {
-  EulerConverter::MatrixSXd b_R_w = base_angular_.GetRotationMatrixBaseToWorld(t).transpose();
+  const AngularStateConverter::MatrixSXd& b_R_w = GetRotationWorldToBase(t, k);
   int row_start = GetRow(k,X);
 
-  if (var_set == id::base_lin_nodes) {
+  if (var_set.Is(id::VarSetId::BaseLin)) {
     jac.middleRows(row_start, k3D) = -1*b_R_w*base_linear_->GetJacobianWrtNodes(t, kPos);
   }
 
-  if (var_set == id::base_ang_nodes) {
-    Vector3d base_W   = base_linear_->GetPoint(t).p();
-    Vector3d ee_pos_W = ee_motion_->GetPoint(t).p();
+  if (var_set.Is(id::VarSetId::BaseAng)) {
+    Vector3d base_W   = GetBaseLinPos(t, k);
+    Vector3d ee_pos_W = GetEEPos(t, k);
     Vector3d r_W = ee_pos_W - base_W;
-    jac.middleRows(row_start, k3D) = base_angular_.DerivOfRotVecMult(t,r_W, true);
+    jac.middleRows(row_start, k3D) = base_angular_->DerivOfRotVecMult(t,r_W, true);
   }
 
-  if (var_set == id::EEMotionNodes(ee_)) {
+  if (var_set.Is(id::VarSetId::EEMotion, ee_)) {
     jac.middleRows(row_start, k3D) = b_R_w*ee_motion_->GetJacobianWrtNodes(t,kPos);
   }
 
-  if (var_set == id::EESchedule(ee_)) {
+  if (var_set.Is(id::VarSetId::Schedule, ee_)) {
     jac.middleRows(row_start, k3D) = b_R_w*ee_motion_->GetJacobianOfPosWrtDurations(t);
   }
 }
 
+void
+RangeOfMotionConstraint::FillHessianBlock (std::string row_var_set,
+                                           std::string col_var_set,
+                                           const Eigen::VectorXd& lambda,
+                                           Hessian& hes) const
+{
+  bool rows_angular = (row_var_set == id::base_ang_nodes);
+  bool cols_angular = (col_var_set == id::base_ang_nodes);
+  if (rows_angular == cols_angular)
+    return; // only the angular cross blocks carry (provided) curvature
+
+  // whether the other variables enter as endeffector (+) or base (-) position
+  std::string other = rows_angular? col_var_set : row_var_set;
+  double sign;
+  NodeSpline::Ptr other_spline;
+  if (other == id::base_lin_nodes) {
+    sign = -1.0;
+    other_spline = base_linear_;
+  } else if (other == id::EEMotionNodes(ee_)) {
+    sign = +1.0;
+    other_spline = ee_motion_;
+  } else {
+    return;
+  }
+
+  int k = 0;
+  for (double t : dts_) {
+    auto Rd     = base_angular_->GetDerivativeOfRotationMatrixWrtNodes(t);
+    Jacobian J  = other_spline->GetJacobianWrtNodes(t, kPos);
+
+    // one row per world axis: the multiplier-weighted rotation derivatives
+    int n_ang = Rd.at(X).at(X).size();
+    Jacobian A(k3D, n_ang);
+    for (int w : {X,Y,Z})
+      for (int dim : {X,Y,Z})
+        A.row(w) += lambda(GetRow(k,dim))*Rd.at(w).at(dim);
+
+    Jacobian At = A.transpose();
+    Jacobian block = At*J;
+    block *= sign;
+
+    if (rows_angular) {
+      hes += block;
+    } else {
+      Jacobian block_t = block.transpose();
+      hes += block_t;
+    }
+
+    k++;
+  }
+}
+
 } /* namespace xpp */
 
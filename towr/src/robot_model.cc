@@ -29,6 +29,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <towr/models/robot_model.h>
 
+#include <array>
+
 #include <towr/models/examples/monoped_model.h>
 #include <towr/models/examples/biped_model.h>
 #include <towr/models/examples/hyq_model.h>
@@ -36,30 +38,62 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 namespace towr {
 
+namespace {
+// function-local singleton, so registrar objects in other translation
+// units never race the registry's construction during static init.
+std::map<int, RobotModel::MakerFcn>& GetRobotRegistry ()
+{
+  static std::map<int, RobotModel::MakerFcn> registry;
+  return registry;
+}
+
+/// Builds a model from its kinematic and dynamic example classes.
+template <typename K, typename D>
+RobotModel MakeExampleModel ()
+{
+  RobotModel model;
+  model.kinematic_model_ = std::make_shared<K>();
+  model.dynamic_model_   = std::make_shared<D>();
+  return model;
+}
+
+// the example robots register themselves the same way a custom robot in
+// user code would, so this file needs no patching to add one.
+RobotModel::Registrar reg_monoped(RobotModel::Monoped, MakeExampleModel<MonopedKinematicModel, MonopedDynamicModel>);
+RobotModel::Registrar reg_biped  (RobotModel::Biped,   MakeExampleModel<BipedKinematicModel,   BipedDynamicModel>);
+RobotModel::Registrar reg_hyq    (RobotModel::Hyq,     MakeExampleModel<HyqKinematicModel,     HyqDynamicModel>);
+RobotModel::Registrar reg_anymal (RobotModel::Anymal,  MakeExampleModel<AnymalKinematicModel,  AnymalDynamicModel>);
+} // namespace
+
+void
+RobotModel::RegisterRobot (int id, const MakerFcn& maker)
+{
+  GetRobotRegistry()[id] = maker;
+}
+
+RobotModel
+RobotModel::MakeRobot (int robot)
+{
+  const auto& registry = GetRobotRegistry();
+  auto it = registry.find(robot);
+  assert(it != registry.end()); // Error: no robot registered under this ID.
+  return it->second();
+}
 
 RobotModel::RobotModel(Robot robot)
 {
-  switch (robot) {
-    case Monoped:
-      dynamic_model_   = std::make_shared<MonopedDynamicModel>();
-      kinematic_model_ = std::make_shared<MonopedKinematicModel>();
-      break;
-    case Biped:
-      dynamic_model_   = std::make_shared<BipedDynamicModel>();
-      kinematic_model_ = std::make_shared<BipedKinematicModel>();
-      break;
-    case Hyq:
-      dynamic_model_   = std::make_shared<HyqDynamicModel>();
-      kinematic_model_ = std::make_shared<HyqKinematicModel>();
-      break;
-    case Anymal:
-      dynamic_model_   = std::make_shared<AnymalDynamicModel>();
-      kinematic_model_ = std::make_shared<AnymalKinematicModel>();
-      break;
-    default:
-      assert(false); // Error: Robot model not implemented.
-      break;
-  }
+  *this = MakeRobot(robot);
+}
+
+const RobotModel&
+RobotModel::GetShared (Robot robot)
+{
+  // built on first use; C++11 guarantees thread-safe initialization.
+  static const std::array<RobotModel, ROBOT_COUNT> registry = {
+      RobotModel(Monoped), RobotModel(Biped),
+      RobotModel(Hyq),     RobotModel(Anymal)};
+
+  return registry.at(robot);
 }
 
 
@@ -0,0 +1,390 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <towr/variables/rotation_vector_converter.h>
+
+#include <cmath>
+
+#include <towr/variables/euler_converter.h>
+
+namespace towr {
+
+namespace {
+
+Eigen::Matrix3d
+Skew (const Eigen::Vector3d& v)
+{
+  Eigen::Matrix3d s;
+  s <<    0.0, -v.z(),  v.y(),
+        v.z(),    0.0, -v.x(),
+       -v.y(),  v.x(),    0.0;
+  return s;
+}
+
+} // namespace
+
+
+RotationVectorConverter::RotationVectorConverter (const NodeSpline::Ptr& rv)
+{
+  rv_ = rv;
+}
+
+RotationVectorConverter::ExpMapCoeff
+RotationVectorConverter::GetCoeff (double theta)
+{
+  ExpMapCoeff c;
+  double th2 = theta*theta;
+
+  if (theta < 1e-4) {
+    // Taylor expansions; the truncation error is O(th^4) < 1e-16 here.
+    c.p_    = 1.0     - th2/6.0;
+    c.dp_t_ = -1.0/3.0 + th2/30.0;
+    c.a_    = 0.5     - th2/24.0;
+    c.da_t_ = -1.0/12.0 + th2/180.0;
+    c.dda_  = -1.0/12.0 + th2/60.0;
+    c.b_    = 1.0/6.0  - th2/120.0;
+    c.db_t_ = -1.0/60.0 + th2/1260.0;
+    c.ddb_  = -1.0/60.0 + th2/420.0;
+    return c;
+  }
+
+  double s = std::sin(theta);
+  double co = std::cos(theta);
+  double th3 = th2*theta;
+  double th4 = th3*theta;
+  double th5 = th4*theta;
+
+  c.p_    = s/theta;
+  c.dp_t_ = (theta*co - s)/th3;
+  c.a_    = (1.0 - co)/th2;
+  c.da_t_ = (theta*s - 2.0*(1.0 - co))/th4;
+  c.dda_  = (th2*co - 4.0*theta*s + 6.0 - 6.0*co)/th4;
+  c.b_    = (theta - s)/th3;
+  c.db_t_ = (3.0*s - 2.0*theta - theta*co)/th5;
+  c.ddb_  = (th2*s + 6.0*theta*co + 6.0*theta - 12.0*s)/th5;
+
+  return c;
+}
+
+Eigen::Matrix3d
+RotationVectorConverter::GetRotationMatrix (const RotationVector& phi)
+{
+  ExpMapCoeff c = GetCoeff(phi.norm());
+  Matrix3d S = Skew(phi);
+  return Matrix3d::Identity() + c.p_*S + c.a_*S*S;
+}
+
+RotationVectorConverter::RotationVector
+RotationVectorConverter::FromEulerAngles (const Vector3d& xyz)
+{
+  Matrix3d R = EulerConverter::GetRotationMatrixBaseToWorld(xyz);
+  Eigen::AngleAxisd aa(R);
+  return aa.angle()*aa.axis();
+}
+
+Eigen::Matrix3d
+RotationVectorConverter::GetLeftJacobian (const RotationVector& phi)
+{
+  ExpMapCoeff c = GetCoeff(phi.norm());
+  Matrix3d S = Skew(phi);
+  return Matrix3d::Identity() + c.a_*S + c.b_*S*S;
+}
+
+Eigen::Matrix3d
+RotationVectorConverter::GetDerivOfJlvWrtPhi (const RotationVector& phi,
+                                              const Vector3d& v)
+{
+  ExpMapCoeff c = GetCoeff(phi.norm());
+  Vector3d pxv  = phi.cross(v);
+  Vector3d pxxv = phi.cross(pxv);
+
+  // product rule on Jl(phi)*v = v + a*(phi x v) + b*(phi x (phi x v)):
+  // the coefficients vary along phi/|phi|, the cross products along all
+  // directions. The _t coefficients absorb the division by |phi|.
+  return c.da_t_*pxv*phi.transpose()
+       - c.a_*Skew(v)
+       + c.db_t_*pxxv*phi.transpose()
+       - c.b_*(Skew(pxv) + Skew(phi)*Skew(v));
+}
+
+Eigen::Matrix3d
+RotationVectorConverter::GetDerivOfRvWrtPhi (const RotationVector& phi,
+                                             const Vector3d& v)
+{
+  ExpMapCoeff c = GetCoeff(phi.norm());
+  Vector3d pxv  = phi.cross(v);
+  Vector3d pxxv = phi.cross(pxv);
+
+  // same structure as GetDerivOfJlvWrtPhi(), with the Rodrigues
+  // coefficients (p, a) in place of the left-Jacobian ones (a, b).
+  return c.dp_t_*pxv*phi.transpose()
+       - c.p_*Skew(v)
+       + c.da_t_*pxxv*phi.transpose()
+       - c.a_*(Skew(pxv) + Skew(phi)*Skew(v));
+}
+
+Eigen::Vector3d
+RotationVectorConverter::GetJldotPhid (const RotationVector& phi,
+                                       const Vector3d& phi_d)
+{
+  ExpMapCoeff c = GetCoeff(phi.norm());
+  Vector3d cr = phi.cross(phi_d);
+  Vector3d d  = phi.cross(cr);
+  double sh   = phi.dot(phi_d);
+
+  // Jl_dot*phi_d with both arguments phi_d; the terms linear in
+  // skew(phi_d)*phi_d vanish, leaving three cross-product terms.
+  return c.da_t_*sh*cr + c.db_t_*sh*d + c.b_*phi_d.cross(cr);
+}
+
+Eigen::Matrix3d
+RotationVectorConverter::GetDerivOfJldotPhidWrtPhi (const RotationVector& phi,
+                                                    const Vector3d& phi_d)
+{
+  double theta = phi.norm();
+  ExpMapCoeff c = GetCoeff(theta);
+  Vector3d cr = phi.cross(phi_d);
+  Vector3d d  = phi.cross(cr);
+  double sh   = phi.dot(phi_d);
+
+  // second radial derivatives of the coefficients, again divided by
+  // theta^2 so they stay finite for theta->0.
+  double g_tt, h_tt;
+  if (theta < 1e-4) {
+    g_tt = 1.0/90.0;
+    h_tt = 1.0/630.0;
+  } else {
+    double th2 = theta*theta;
+    g_tt = (c.dda_ - c.da_t_)/th2;
+    h_tt = (c.ddb_ - c.db_t_)/th2;
+  }
+
+  Matrix3d dc_dphi = -Skew(phi_d);
+  Matrix3d dd_dphi = -Skew(cr) - Skew(phi)*Skew(phi_d);
+
+  return cr*(sh*g_tt*phi.transpose() + c.da_t_*phi_d.transpose())
+       + c.da_t_*sh*dc_dphi
+       + d*(sh*h_tt*phi.transpose() + c.db_t_*phi_d.transpose())
+       + c.db_t_*sh*dd_dphi
+       + phi_d.cross(cr)*(c.db_t_*phi.transpose())
+       - c.b_*Skew(phi_d)*Skew(phi_d);
+}
+
+Eigen::Matrix3d
+RotationVectorConverter::GetDerivOfJldotPhidWrtPhid (const RotationVector& phi,
+                                                     const Vector3d& phi_d)
+{
+  ExpMapCoeff c = GetCoeff(phi.norm());
+  Vector3d cr = phi.cross(phi_d);
+  Vector3d d  = phi.cross(cr);
+  double sh   = phi.dot(phi_d);
+
+  Matrix3d S = Skew(phi);
+
+  return cr*(c.da_t_*phi.transpose())
+       + c.da_t_*sh*S
+       + d*(c.db_t_*phi.transpose())
+       + c.db_t_*sh*S*S
+       + c.b_*(-Skew(cr) + Skew(phi_d)*S);
+}
+
+RotationVectorConverter::MatrixSXd
+RotationVectorConverter::GetRotationMatrixBaseToWorld (double t) const
+{
+  return GetRotationMatrixSparseCached(t);
+}
+
+Eigen::Vector3d
+RotationVectorConverter::GetAngularVelocityInWorld (double t) const
+{
+  const State& rv = GetCachedState(t);
+  return GetLeftJacobianCached(t)*rv.v();
+}
+
+Eigen::Vector3d
+RotationVectorConverter::GetAngularAccelerationInWorld (double t) const
+{
+  const State& rv = GetCachedState(t);
+  return GetLeftJacobianCached(t)*rv.a() + GetJldotPhid(rv.p(), rv.v());
+}
+
+RotationVectorConverter::Jacobian
+RotationVectorConverter::GetDerivOfAngVelWrtNodes (double t) const
+{
+  const State& rv = GetCachedState(t);
+
+  const Jacobian& dPos_du = GetJacobianWrtNodesCached(t, kPos);
+  const Jacobian& dVel_du = GetJacobianWrtNodesCached(t, kVel);
+
+  MatrixSXd dw_dphi = GetDerivOfJlvWrtPhi(rv.p(), rv.v()).sparseView(1.0, -1.0);
+  return GetLeftJacobianSparseCached(t)*dVel_du + dw_dphi*dPos_du;
+}
+
+RotationVectorConverter::Jacobian
+RotationVectorConverter::GetDerivOfAngAccWrtNodes (double t) const
+{
+  const State& rv = GetCachedState(t);
+
+  const Jacobian& dPos_du = GetJacobianWrtNodesCached(t, kPos);
+  const Jacobian& dVel_du = GetJacobianWrtNodesCached(t, kVel);
+  const Jacobian& dAcc_du = GetJacobianWrtNodesCached(t, kAcc);
+
+  Matrix3d wrt_phi = GetDerivOfJlvWrtPhi(rv.p(), rv.a())
+                   + GetDerivOfJldotPhidWrtPhi(rv.p(), rv.v());
+  Matrix3d wrt_phi_d = GetDerivOfJldotPhidWrtPhid(rv.p(), rv.v());
+
+  MatrixSXd wrt_phi_sp   = wrt_phi.sparseView(1.0, -1.0);
+  MatrixSXd wrt_phi_d_sp = wrt_phi_d.sparseView(1.0, -1.0);
+
+  return GetLeftJacobianSparseCached(t)*dAcc_du
+       + wrt_phi_d_sp*dVel_du
+       + wrt_phi_sp*dPos_du;
+}
+
+RotationVectorConverter::Jacobian
+RotationVectorConverter::DerivOfRotVecMult (double t, const Vector3d& v,
+                                            bool inverse) const
+{
+  const State& rv = GetCachedState(t);
+
+  // R^(-1) = R^T = R(-phi), so the inverse derivative is the negated
+  // forward derivative evaluated at the negated rotation vector.
+  Matrix3d dRv_dphi = inverse ? Matrix3d(-GetDerivOfRvWrtPhi(-rv.p(), v))
+                              : GetDerivOfRvWrtPhi(rv.p(), v);
+
+  MatrixSXd dRv_dphi_sp = dRv_dphi.sparseView(1.0, -1.0);
+  return dRv_dphi_sp*GetJacobianWrtNodesCached(t, kPos);
+}
+
+RotationVectorConverter::JacRowMatrix
+RotationVectorConverter::GetDerivativeOfRotationMatrixWrtNodes (double t) const
+{
+  JacRowMatrix jac;
+
+  const State& rv = GetCachedState(t);
+  const Jacobian& dPos_du = GetJacobianWrtNodesCached(t, kPos);
+
+  // column col of R is R*e_col, so its phi-derivative comes from the
+  // rotated-vector formula with the unit vectors.
+  for (int col : {X,Y,Z}) {
+    MatrixSXd dRcol_dphi = GetDerivOfRvWrtPhi(rv.p(), Vector3d::Unit(col))
+                           .sparseView(1.0, -1.0);
+    MatrixSXd dRcol = dRcol_dphi*dPos_du;
+    for (int row : {X,Y,Z})
+      jac.at(row).at(col) = dRcol.row(row);
+  }
+
+  return jac;
+}
+
+const State&
+RotationVectorConverter::GetCachedState (double t) const
+{
+  int epoch = rv_->GetUpdateCount();
+  if (t != cache_.t_ || epoch != cache_.epoch_) {
+    cache_.t_        = t;
+    cache_.epoch_    = epoch;
+    cache_.rv_state_ = rv_->GetPoint(t);
+
+    cache_.R_valid_     = false;
+    cache_.Jl_valid_    = false;
+    cache_.R_sp_valid_  = false;
+    cache_.Jl_sp_valid_ = false;
+    cache_.jac_valid_   = {{false, false, false}};
+  }
+
+  return cache_.rv_state_;
+}
+
+const Eigen::Matrix3d&
+RotationVectorConverter::GetRotationMatrixCached (double t) const
+{
+  const State& rv = GetCachedState(t);
+
+  if (!cache_.R_valid_) {
+    cache_.R_ = GetRotationMatrix(rv.p());
+    cache_.R_valid_ = true;
+  }
+
+  return cache_.R_;
+}
+
+const Eigen::Matrix3d&
+RotationVectorConverter::GetLeftJacobianCached (double t) const
+{
+  const State& rv = GetCachedState(t);
+
+  if (!cache_.Jl_valid_) {
+    cache_.Jl_ = GetLeftJacobian(rv.p());
+    cache_.Jl_valid_ = true;
+  }
+
+  return cache_.Jl_;
+}
+
+const RotationVectorConverter::MatrixSXd&
+RotationVectorConverter::GetRotationMatrixSparseCached (double t) const
+{
+  GetCachedState(t); // synchronizes cache with query time and iteration
+
+  if (!cache_.R_sp_valid_) {
+    cache_.R_sp_ = GetRotationMatrixCached(t).sparseView(1.0, -1.0);
+    cache_.R_sp_valid_ = true;
+  }
+
+  return cache_.R_sp_;
+}
+
+const RotationVectorConverter::MatrixSXd&
+RotationVectorConverter::GetLeftJacobianSparseCached (double t) const
+{
+  GetCachedState(t); // synchronizes cache with query time and iteration
+
+  if (!cache_.Jl_sp_valid_) {
+    cache_.Jl_sp_ = GetLeftJacobianCached(t).sparseView(1.0, -1.0);
+    cache_.Jl_sp_valid_ = true;
+  }
+
+  return cache_.Jl_sp_;
+}
+
+const RotationVectorConverter::Jacobian&
+RotationVectorConverter::GetJacobianWrtNodesCached (double t, Dx deriv) const
+{
+  GetCachedState(t); // synchronizes cache with query time and iteration
+
+  if (!cache_.jac_valid_.at(deriv)) {
+    cache_.jac_wrt_nodes_.at(deriv) = rv_->GetJacobianWrtNodes(t, deriv);
+    cache_.jac_valid_.at(deriv) = true;
+  }
+
+  return cache_.jac_wrt_nodes_.at(deriv);
+}
+
+} /* namespace towr */
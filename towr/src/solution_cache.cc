@@ -0,0 +1,79 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <towr/solution_cache.h>
+
+#include <cassert>
+
+namespace towr {
+
+SolutionCache::SolutionCache (Policy policy, std::size_t max_entries)
+{
+  assert(max_entries > 0);
+  policy_      = policy;
+  max_entries_ = max_entries;
+}
+
+bool
+SolutionCache::Lookup (const Key& key, SplineHolder& solution)
+{
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    misses_++;
+    return false;
+  }
+
+  // move to the front of the LRU order
+  lru_.splice(lru_.begin(), lru_, it->second.second);
+
+  solution = it->second.first;
+  hits_++;
+  return true;
+}
+
+void
+SolutionCache::Insert (const Key& key, const SplineHolder& solution)
+{
+  auto it = entries_.find(key);
+  if (it != entries_.end()) {
+    it->second.first = solution;
+    lru_.splice(lru_.begin(), lru_, it->second.second);
+    return;
+  }
+
+  lru_.push_front(key);
+  entries_.insert({key, {solution, lru_.begin()}});
+
+  if (entries_.size() > max_entries_) {
+    entries_.erase(lru_.back());
+    lru_.pop_back();
+  }
+}
+
+} /* namespace towr */
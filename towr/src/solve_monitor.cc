@@ -0,0 +1,78 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <towr/solve_monitor.h>
+
+namespace towr {
+
+void
+SolveMonitor::SetProgressCallback (const ProgressCallback& callback)
+{
+  progress_callback_ = callback;
+}
+
+void
+SolveMonitor::SetTelemetryBuffer (const TelemetryBuffer::Ptr& buffer)
+{
+  telemetry_ = buffer;
+}
+
+void
+SolveMonitor::RequestCancel ()
+{
+  cancel_requested_ = true;
+}
+
+bool
+SolveMonitor::IsCancelRequested () const
+{
+  return cancel_requested_;
+}
+
+void
+SolveMonitor::ReportEvaluation (double violation)
+{
+  if (cancel_requested_)
+    throw SolveCancelled();
+
+  if (n_evals_ == 0)
+    t_start_ = std::chrono::steady_clock::now();
+
+  n_evals_++;
+
+  if (progress_callback_)
+    progress_callback_(n_evals_, violation);
+
+  if (telemetry_) {
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - t_start_;
+    telemetry_->Push({n_evals_, violation, elapsed.count()});
+  }
+}
+
+} /* namespace towr */
@@ -0,0 +1,145 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <towr/solver_replay.h>
+
+#include <chrono>
+#include <iomanip>
+#include <ostream>
+#include <stdexcept>
+
+namespace towr {
+
+void
+SolverReplay::AddConfig (const std::string& name,
+                         const SolverMaker& make_solver)
+{
+  configs_.push_back({name, make_solver});
+}
+
+void
+SolverReplay::AddProblem (const std::string& name, const ScenarioSetup& setup,
+                          const std::string& snapshot_path)
+{
+  problems_.push_back({name, setup, snapshot_path});
+}
+
+std::vector<SolverReplay::CellResult>
+SolverReplay::Run () const
+{
+  std::vector<CellResult> cells;
+  cells.reserve(problems_.size() * configs_.size());
+
+  for (const auto& problem : problems_) {
+    for (const auto& config : configs_) {
+      CellResult r;
+      r.problem = problem.name;
+      r.config  = config.name;
+
+      // a fresh facade per cell, so no state leaks between configurations.
+      TOWR towr;
+      problem.setup(towr);
+
+      auto t_start = std::chrono::steady_clock::now();
+      try {
+        if (!problem.snapshot_path.empty()) {
+          // SolveNLP() rebuilds the problem and would discard the restored
+          // variable values, so snapshot-seeded cells must re-solve the
+          // existing problem instead.
+          towr.RestoreProblemState(problem.snapshot_path);
+          towr.ResolveNLP(config.make_solver());
+        } else {
+          towr.SolveNLP(config.make_solver());
+        }
+        r.solved = true;
+      } catch (const std::exception&) {
+        // a diverging or crashing configuration is a result too; record
+        // the cell as unsolved and keep going.
+      }
+      auto t_stop = std::chrono::steady_clock::now();
+
+      r.wall_time_s =
+          std::chrono::duration<double>(t_stop - t_start).count();
+
+      if (r.solved) {
+        r.iterations = towr.GetIterationCount();
+        r.cost       = towr.GetObjective();
+        r.violation  = towr.GetConstraintViolation();
+      }
+
+      cells.push_back(r);
+    }
+  }
+
+  return cells;
+}
+
+void
+SolverReplay::PrintReport (const std::vector<CellResult>& cells,
+                           std::ostream& out)
+{
+  std::size_t w_problem = 7, w_config = 6; // headers set the minimum width.
+  for (const auto& c : cells) {
+    w_problem = std::max(w_problem, c.problem.size());
+    w_config  = std::max(w_config, c.config.size());
+  }
+
+  out << std::left
+      << std::setw(w_problem+2) << "problem"
+      << std::setw(w_config+2)  << "config"
+      << std::right
+      << std::setw(10) << "time [s]"
+      << std::setw(8)  << "iter"
+      << std::setw(14) << "cost"
+      << std::setw(14) << "violation"
+      << "\n";
+
+  for (const auto& c : cells) {
+    out << std::left
+        << std::setw(w_problem+2) << c.problem
+        << std::setw(w_config+2)  << c.config
+        << std::right << std::fixed
+        << std::setw(10) << std::setprecision(3) << c.wall_time_s;
+
+    if (c.solved)
+      out << std::setw(8) << c.iterations
+          << std::setw(14) << std::setprecision(4) << c.cost
+          << std::setw(14) << std::scientific << std::setprecision(2)
+          << c.violation;
+    else
+      out << std::setw(8) << "-"
+          << std::setw(14) << "failed"
+          << std::setw(14) << "-";
+
+    out.unsetf(std::ios::floatfield);
+    out << "\n";
+  }
+}
+
+} /* namespace towr */
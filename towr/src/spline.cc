@@ -29,7 +29,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <towr/variables/spline.h>
 
-#include <numeric> // std::accumulate
+#include <algorithm> // std::lower_bound
 
 namespace towr {
 
@@ -42,6 +42,7 @@ Spline::Spline(const VecTimes& poly_durations, int n_dim)
     cubic_polys_.at(i).SetDuration(poly_durations.at(i));
   }
 
+  UpdateCumulativeDurations();
   UpdatePolynomialCoeff();
 }
 
@@ -65,14 +66,30 @@ Spline::GetSegmentID(double t_global, const VecTimes& durations)
    assert(false); // this should never be reached
 }
 
+int
+Spline::GetSegmentID(double t_global) const
+{
+  double eps = 1e-10; // double precision
+  assert(t_global >= 0.0);
+
+  // first polynomial whose end time is not smaller than t_global
+  // (at junctions, returns previous polynomial)
+  auto it = std::lower_bound(cumulative_durations_.begin(),
+                             cumulative_durations_.end(),
+                             t_global-eps);
+  assert(it != cumulative_durations_.end());
+
+  return std::distance(cumulative_durations_.begin(), it);
+}
+
 std::pair<int,double>
-Spline::GetLocalTime (double t_global, const VecTimes& durations) const
+Spline::GetLocalTime (double t_global) const
 {
-  int id = GetSegmentID(t_global, durations);
+  int id = GetSegmentID(t_global);
 
   double t_local = t_global;
-  for (int i=0; i<id; i++)
-    t_local -= durations.at(i);
+  if (id > 0)
+    t_local -= cumulative_durations_.at(id-1);
 
   return std::make_pair(id, t_local);
 }
@@ -81,7 +98,7 @@ const State
 Spline::GetPoint(double t_global) const
 {
   int id; double t_local;
-  std::tie(id, t_local) = GetLocalTime(t_global, GetPolyDurations());
+  std::tie(id, t_local) = GetLocalTime(t_global);
 
   return GetPoint(id, t_local);
 }
@@ -92,11 +109,119 @@ Spline::GetPoint(int poly_id, double t_local) const
   return cubic_polys_.at(poly_id).GetPoint(t_local);
 }
 
+std::vector<State>
+Spline::GetPoints(const VecTimes& ts) const
+{
+  std::vector<State> states;
+  states.reserve(ts.size());
+
+  auto local_times = GetLocalTimes(ts);
+
+  // Horner evaluation streaming through the packed coefficient planes,
+  // so the whole grid touches four contiguous blocks instead of the
+  // scattered per-polynomial storage.
+  const CoeffPlanes& c = GetCoeffPlanes();
+  int n_dim = c[Polynomial::A].rows();
+
+  for (const auto& id_t : local_times) {
+    int s    = id_t.first;
+    double t = id_t.second;
+
+    State state(n_dim, 3);
+    state.at(kPos) = ((c[Polynomial::D].col(s)*t + c[Polynomial::C].col(s))*t
+                       + c[Polynomial::B].col(s))*t + c[Polynomial::A].col(s);
+    state.at(kVel) = (3*c[Polynomial::D].col(s)*t + 2*c[Polynomial::C].col(s))*t
+                       + c[Polynomial::B].col(s);
+    state.at(kAcc) = 6*c[Polynomial::D].col(s)*t + 2*c[Polynomial::C].col(s);
+    states.push_back(state);
+  }
+
+  return states;
+}
+
+const Spline::CoeffPlanes&
+Spline::GetCoeffPlanes () const
+{
+  if (planes_update_count_ != update_count_) {
+    int n_polys = cubic_polys_.size();
+    int n_dim   = cubic_polys_.front().GetCoefficients(Polynomial::A).size();
+
+    for (int c=Polynomial::A; c<=Polynomial::D; ++c) {
+      Eigen::MatrixXd& plane = coeff_planes_.at(c);
+      plane.resize(n_dim, n_polys);
+      for (int s=0; s<n_polys; ++s)
+        plane.col(s) = cubic_polys_.at(s).GetCoefficients(
+                           static_cast<Polynomial::Coefficients>(c));
+    }
+    planes_update_count_ = update_count_;
+  }
+
+  return coeff_planes_;
+}
+
+std::vector<std::pair<int,double>>
+Spline::GetLocalTimes (const VecTimes& ts) const
+{
+  double eps = 1e-10; // double precision
+
+  std::vector<std::pair<int,double>> local_times;
+  local_times.reserve(ts.size());
+
+  int id = 0;
+  int last_id = cumulative_durations_.size()-1;
+  for (double t : ts) {
+    assert(t >= 0.0);
+    assert(local_times.empty() || t >= ts.at(local_times.size()-1)); // sorted
+
+    // advance to first segment whose end time is not smaller than t
+    while (id < last_id && cumulative_durations_.at(id) < t-eps)
+      id++;
+
+    double t_local = id==0? t : t - cumulative_durations_.at(id-1);
+    local_times.push_back(std::make_pair(id, t_local));
+  }
+
+  return local_times;
+}
+
 void
 Spline::UpdatePolynomialCoeff()
 {
   for (auto& p : cubic_polys_)
     p.UpdateCoeff();
+
+  update_count_++;
+}
+
+void
+Spline::UpdatePolynomialCoeff(const std::vector<int>& poly_ids)
+{
+  for (int id : poly_ids)
+    cubic_polys_.at(id).UpdateCoeff();
+
+  if (!poly_ids.empty())
+    update_count_++;
+}
+
+int
+Spline::GetUpdateCount () const
+{
+  return update_count_;
+}
+
+void
+Spline::UpdateCumulativeDurations()
+{
+  poly_durations_.clear();
+  cumulative_durations_.clear();
+
+  double t = 0.0;
+  for (const auto& p : cubic_polys_) {
+    poly_durations_.push_back(p.GetDuration());
+
+    t += p.GetDuration();
+    cumulative_durations_.push_back(t);
+  }
 }
 
 int
@@ -105,21 +230,22 @@ Spline::GetPolynomialCount () const
   return cubic_polys_.size();
 }
 
-Spline::VecTimes
-Spline::GetPolyDurations() const
+const CubicHermitePolynomial&
+Spline::GetPolynomial (int poly_id) const
 {
-  VecTimes poly_durations;
-  for (const auto& p : cubic_polys_)
-    poly_durations.push_back(p.GetDuration());
+  return cubic_polys_.at(poly_id);
+}
 
-  return poly_durations;
+const Spline::VecTimes&
+Spline::GetPolyDurations() const
+{
+  return poly_durations_;
 }
 
 double
 Spline::GetTotalTime() const
 {
-  auto v = GetPolyDurations();
-  return std::accumulate(v.begin(), v.end(), 0.0);
+  return cumulative_durations_.back();
 }
 
 } /* namespace towr */
@@ -0,0 +1,241 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <towr/spline_program.h>
+
+#include <algorithm> // std::upper_bound
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace towr {
+
+namespace {
+
+/**
+ * The on-disk layout: this header followed by the four spline groups in
+ * member order (base linear, base angular, per-EE motion, per-EE force).
+ * Each spline is a uint32 segment count followed by its segments, each
+ * packed as the duration and the 12 coefficient doubles (column major).
+ *
+ * The dependency-free reader in spline_runtime.h parses this same
+ * layout; change the two together.
+ */
+struct FileHeader {
+  char magic[4];    ///< identifies a towr spline-program file.
+  uint32_t version; ///< layout version, bumped on record changes.
+  uint32_t n_ee;    ///< number of endeffector motion/force splines.
+};
+
+const char kMagic[4] = {'T','W','R','S'};
+const uint32_t kVersion = 1;
+
+} // namespace
+
+CubicSplineEvaluator::CubicSplineEvaluator (const std::vector<double>& durations,
+                                            const std::vector<CoeffMatrix>& coeff)
+    : durations_(durations),
+      coeff_(coeff)
+{
+  assert(durations_.size() == coeff_.size());
+
+  double t = 0.0;
+  for (double d : durations_) {
+    t += d;
+    cumulative_durations_.push_back(t);
+  }
+}
+
+CubicSplineEvaluator::CubicSplineEvaluator (const Spline& spline)
+{
+  durations_ = spline.GetPolyDurations();
+
+  for (int id=0; id<spline.GetPolynomialCount(); ++id) {
+    const auto& p = spline.GetPolynomial(id);
+    assert(p.GetCoefficients(Polynomial::A).size() == k3D);
+
+    CoeffMatrix m;
+    for (auto c : {Polynomial::A, Polynomial::B, Polynomial::C, Polynomial::D})
+      m.col(c) = p.GetCoefficients(c);
+    coeff_.push_back(m);
+  }
+
+  double t = 0.0;
+  for (double d : durations_) {
+    t += d;
+    cumulative_durations_.push_back(t);
+  }
+}
+
+State
+CubicSplineEvaluator::GetPoint (double t) const
+{
+  t = std::max(0.0, std::min(t, GetTotalTime()));
+
+  // first segment whose end time lies beyond t
+  auto it = std::upper_bound(cumulative_durations_.begin(),
+                             cumulative_durations_.end(), t);
+  int id = std::min<int>(it - cumulative_durations_.begin(),
+                         durations_.size()-1);
+  double t_local = t - (cumulative_durations_.at(id) - durations_.at(id));
+
+  const CoeffMatrix& m = coeff_.at(id);
+
+  State out(k3D, 3);
+  out.at(kPos) = m.col(0) + t_local*(m.col(1) + t_local*(m.col(2) + t_local*m.col(3)));
+  out.at(kVel) = m.col(1) + t_local*(2*m.col(2) + t_local*3*m.col(3));
+  out.at(kAcc) = 2*m.col(2) + t_local*6*m.col(3);
+
+  return out;
+}
+
+double
+CubicSplineEvaluator::GetTotalTime () const
+{
+  return cumulative_durations_.empty()? 0.0 : cumulative_durations_.back();
+}
+
+int
+CubicSplineEvaluator::GetSegmentCount () const
+{
+  return coeff_.size();
+}
+
+const std::vector<double>&
+CubicSplineEvaluator::GetDurations () const
+{
+  return durations_;
+}
+
+const CubicSplineEvaluator::CoeffMatrix&
+CubicSplineEvaluator::GetCoefficients (int segment) const
+{
+  return coeff_.at(segment);
+}
+
+SplineProgram::SplineProgram (const SplineHolder& solution)
+{
+  base_linear_  = CubicSplineEvaluator(*solution.base_linear_);
+  base_angular_ = CubicSplineEvaluator(*solution.base_angular_);
+
+  for (const auto& s : solution.ee_motion_)
+    ee_motion_.push_back(CubicSplineEvaluator(*s));
+
+  for (const auto& s : solution.ee_force_)
+    ee_force_.push_back(CubicSplineEvaluator(*s));
+}
+
+// defined here instead of spline_holder.cc, since the holder's own header
+// only forward-declares SplineProgram to avoid the upward include.
+SplineProgram
+SplineHolder::Freeze () const
+{
+  return SplineProgram(*this);
+}
+
+void
+SplineProgram::Save (const std::string& path) const
+{
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file)
+    throw std::runtime_error("SplineProgram: cannot open " + path);
+
+  FileHeader header;
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.n_ee    = ee_motion_.size();
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+  auto write_spline = [&file](const CubicSplineEvaluator& s) {
+    uint32_t n = s.GetSegmentCount();
+    file.write(reinterpret_cast<const char*>(&n), sizeof(n));
+
+    for (int id=0; id<s.GetSegmentCount(); ++id) {
+      double d = s.GetDurations().at(id);
+      file.write(reinterpret_cast<const char*>(&d), sizeof(d));
+      file.write(reinterpret_cast<const char*>(s.GetCoefficients(id).data()),
+                 sizeof(CubicSplineEvaluator::CoeffMatrix));
+    }
+  };
+
+  write_spline(base_linear_);
+  write_spline(base_angular_);
+  for (const auto& s : ee_motion_) write_spline(s);
+  for (const auto& s : ee_force_)  write_spline(s);
+
+  if (!file)
+    throw std::runtime_error("SplineProgram: writing " + path + " failed");
+}
+
+SplineProgram
+SplineProgram::Load (const std::string& path)
+{
+  std::ifstream file(path, std::ios::binary);
+  if (!file)
+    throw std::runtime_error("SplineProgram: cannot open " + path);
+
+  FileHeader header;
+  file.read(reinterpret_cast<char*>(&header), sizeof(header));
+  if (!file
+      || std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0
+      || header.version != kVersion)
+    throw std::runtime_error("SplineProgram: " + path + " is no spline-program file");
+
+  auto read_spline = [&file, &path]() {
+    uint32_t n = 0;
+    file.read(reinterpret_cast<char*>(&n), sizeof(n));
+
+    std::vector<double> durations(n);
+    std::vector<CubicSplineEvaluator::CoeffMatrix> coeff(n);
+    for (uint32_t id=0; id<n; ++id) {
+      file.read(reinterpret_cast<char*>(&durations.at(id)), sizeof(double));
+      file.read(reinterpret_cast<char*>(coeff.at(id).data()),
+                sizeof(CubicSplineEvaluator::CoeffMatrix));
+    }
+
+    if (!file)
+      throw std::runtime_error("SplineProgram: " + path + " is truncated");
+
+    return CubicSplineEvaluator(durations, coeff);
+  };
+
+  SplineProgram program;
+  program.base_linear_  = read_spline();
+  program.base_angular_ = read_spline();
+  for (uint32_t ee=0; ee<header.n_ee; ++ee)
+    program.ee_motion_.push_back(read_spline());
+  for (uint32_t ee=0; ee<header.n_ee; ++ee)
+    program.ee_force_.push_back(read_spline());
+
+  return program;
+}
+
+} /* namespace towr */
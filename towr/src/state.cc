@@ -29,39 +29,48 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <towr/variables/state.h>
 
+#include <cassert>
+
 
 namespace towr {
 
 State::State (int dim, int n_derivatives)
 {
-  values_ = std::vector<VectorXd>(n_derivatives, VectorXd::Zero(dim));
+  assert(dim <= k3D); // larger states require heap storage
+  assert(n_derivatives <= static_cast<int>(values_.size()));
+
+  n_derivatives_ = n_derivatives;
+  for (int deriv=0; deriv<n_derivatives; ++deriv)
+    values_.at(deriv).setZero(dim);
 }
 
-const Eigen::VectorXd
+const State::StateVector&
 State::at (Dx deriv) const
 {
-  return values_.at(deriv);
+  assert(deriv < n_derivatives_);
+  return values_[deriv];
 }
 
-Eigen::VectorXd&
+State::StateVector&
 State::at (Dx deriv)
 {
-  return values_.at(deriv);
+  assert(deriv < n_derivatives_);
+  return values_[deriv];
 }
 
-const Eigen::VectorXd
+const State::StateVector&
 State::p () const
 {
   return at(kPos);
 }
 
-const Eigen::VectorXd
+const State::StateVector&
 State::v () const
 {
   return at(kVel);
 }
 
-const Eigen::VectorXd
+const State::StateVector&
 State::a () const
 {
   return at(kAcc);
@@ -50,32 +50,50 @@ towr::SwingConstraint::InitVariableDependedQuantities (const VariablesPtr& x)
   int constraint_count =  pure_swing_node_ids_.size()*2*k2D;
 
   SetRows(constraint_count);
-}
 
-Eigen::VectorXd
-SwingConstraint::GetValues () const
-{
-  VectorXd g(GetRows());
+  // the constraint relates each swing node linearly to its two stance
+  // neighbors, so the entire Jacobian can be assembled here once instead
+  // of per solver iteration.
+  std::vector<Eigen::Triplet<double>> entries;
+  entries.reserve(constraint_count*3);
 
   int row = 0;
-  auto nodes = ee_motion_->GetNodes();
   for (int node_id : pure_swing_node_ids_) {
     // assumes two splines per swingphase and starting and ending in stance
-    auto curr = nodes.at(node_id);
-
-    Vector2d prev = nodes.at(node_id-1).p().topRows<k2D>();
-    Vector2d next = nodes.at(node_id+1).p().topRows<k2D>();
-
-    Vector2d distance_xy    = next - prev;
-    Vector2d xy_center      = prev + 0.5*distance_xy;
-    Vector2d des_vel_center = distance_xy/t_swing_avg_; // linear interpolation not accurate
     for (auto dim : {X,Y}) {
-      g(row++) = curr.p()(dim) - xy_center(dim);
-      g(row++) = curr.v()(dim) - des_vel_center(dim);
+      int curr_p = ee_motion_->GetOptIndex(Nodes::NodeValueInfo(node_id,   kPos, dim));
+      int curr_v = ee_motion_->GetOptIndex(Nodes::NodeValueInfo(node_id,   kVel, dim));
+      int next_p = ee_motion_->GetOptIndex(Nodes::NodeValueInfo(node_id+1, kPos, dim));
+      int prev_p = ee_motion_->GetOptIndex(Nodes::NodeValueInfo(node_id-1, kPos, dim));
+
+      // position centered between the stance neighbors
+      entries.push_back({row, curr_p,  1.0});
+      entries.push_back({row, next_p, -0.5});
+      entries.push_back({row, prev_p, -0.5});
+      row++;
+
+      // velocity matching the linear interpolation (not accurate)
+      entries.push_back({row, curr_v,  1.0});
+      entries.push_back({row, next_p, -1.0/t_swing_avg_});
+      entries.push_back({row, prev_p, +1.0/t_swing_avg_});
+      row++;
     }
   }
 
-  return g;
+  jac_const_.resize(constraint_count, ee_motion_->GetRows());
+  jac_const_.setFromTriplets(entries.begin(), entries.end());
+
+  // one scaling serves both uses of this matrix: GetValues() multiplies it
+  // with the scaled variables (s*A * x/s = A*x), and FillJacobianBlock()
+  // hands it out as the Jacobian w.r.t the scaled variables (s*A).
+  jac_const_ *= ee_motion_->GetVariableScaling();
+}
+
+Eigen::VectorXd
+SwingConstraint::GetValues () const
+{
+  // linear constraint: one sparse product over all swing nodes at once
+  return jac_const_ * ee_motion_->GetValuesRef();
 }
 
 SwingConstraint::VecBound
@@ -88,24 +106,8 @@ void
 SwingConstraint::FillJacobianBlock (std::string var_set,
                                     Jacobian& jac) const
 {
-  if (var_set == ee_motion_->GetName()) {
-    int row = 0;
-    for (int node_id : pure_swing_node_ids_) {
-      for (auto dim : {X,Y}) {
-        // position constraint
-        jac.coeffRef(row, ee_motion_->GetOptIndex(Nodes::NodeValueInfo(node_id,   kPos, dim))) =  1.0;  // current node
-        jac.coeffRef(row, ee_motion_->GetOptIndex(Nodes::NodeValueInfo(node_id+1, kPos, dim))) = -0.5;  // next node
-        jac.coeffRef(row, ee_motion_->GetOptIndex(Nodes::NodeValueInfo(node_id-1, kPos, dim))) = -0.5;  // previous node
-        row++;
-
-        // velocity constraint
-        jac.coeffRef(row, ee_motion_->GetOptIndex(Nodes::NodeValueInfo(node_id,   kVel, dim))) =  1.0;              // current node
-        jac.coeffRef(row, ee_motion_->GetOptIndex(Nodes::NodeValueInfo(node_id+1, kPos, dim))) = -1.0/t_swing_avg_; // next node
-        jac.coeffRef(row, ee_motion_->GetOptIndex(Nodes::NodeValueInfo(node_id-1, kPos, dim))) = +1.0/t_swing_avg_; // previous node
-        row++;
-      }
-    }
-  }
+  if (var_set == ee_motion_->GetName())
+    jac = jac_const_;
 }
 
 } /* namespace towr */
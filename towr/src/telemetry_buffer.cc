@@ -0,0 +1,82 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <towr/telemetry_buffer.h>
+
+namespace towr {
+
+TelemetryBuffer::TelemetryBuffer (std::size_t capacity)
+{
+  std::size_t n = 1;
+  while (n < capacity)
+    n <<= 1;
+
+  buffer_.resize(n);
+  mask_ = n-1;
+}
+
+bool
+TelemetryBuffer::Push (const SolveSample& sample)
+{
+  std::size_t tail = tail_.load(std::memory_order_relaxed);
+  std::size_t head = head_.load(std::memory_order_acquire);
+
+  if (tail - head > mask_) { // ring full, don't block the solver
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  buffer_.at(tail & mask_) = sample;
+  tail_.store(tail+1, std::memory_order_release); // publish to the consumer
+  return true;
+}
+
+std::vector<SolveSample>
+TelemetryBuffer::Drain ()
+{
+  std::size_t head = head_.load(std::memory_order_relaxed);
+  std::size_t tail = tail_.load(std::memory_order_acquire);
+
+  std::vector<SolveSample> samples;
+  samples.reserve(tail - head);
+
+  for (; head != tail; ++head)
+    samples.push_back(buffer_.at(head & mask_));
+
+  head_.store(head, std::memory_order_release); // free the slots
+  return samples;
+}
+
+std::size_t
+TelemetryBuffer::GetDroppedCount () const
+{
+  return dropped_.load(std::memory_order_relaxed);
+}
+
+} /* namespace towr */
@@ -46,9 +46,15 @@ TerrainConstraint::InitVariableDependedQuantities (const VariablesPtr& x)
 {
   ee_motion_ = x->GetComponent<PhaseNodes>(ee_motion_id_);
 
-  // skip first node, b/c already constrained by initial stance
-  for (int id=1; id<ee_motion_->GetNodes().size(); ++id)
+  // skip first node, b/c already constrained by initial stance.
+  // Also skip nodes that merely repeat the optimization variables of an
+  // earlier stance node; their rows would be exact duplicates and only
+  // enlarge the Jacobian and KKT system.
+  for (int id=1; id<ee_motion_->GetNodes().size(); ++id) {
+    if (ee_motion_->IsDuplicateNode(id))
+      continue;
     node_ids_.push_back(id);
+  }
 
   int constraint_count = node_ids_.size();
   SetRows(constraint_count);
@@ -59,11 +65,20 @@ TerrainConstraint::GetValues () const
 {
   VectorXd g(GetRows());
 
+  // collect all node positions and query the terrain once, so grid
+  // terrains can answer the whole batch vectorized.
   auto nodes = ee_motion_->GetNodes();
+  query_xy_.resize(2, node_ids_.size());
+  int col = 0;
+  for (int id : node_ids_)
+    query_xy_.col(col++) = nodes.at(id).p().topRows<k2D>();
+
+  terrain_->GetHeights(query_xy_, query_heights_);
+
   int row = 0;
   for (int id : node_ids_) {
-    Vector3d p = nodes.at(id).p();
-    g(row++) = p.z() - terrain_->GetHeight(p.x(), p.y());
+    g(row) = nodes.at(id).p().z() - query_heights_(row);
+    row++;
   }
 
   return g;
@@ -91,19 +106,35 @@ void
 TerrainConstraint::FillJacobianBlock (std::string var_set, Jacobian& jac) const
 {
   if (var_set == ee_motion_->GetName()) {
+    jac_ws_.Start(jac);
+
+    // slopes for all constrained nodes in one terrain query, so grid
+    // terrains answer the batch vectorized (@sa GetValues()).
     auto nodes = ee_motion_->GetNodes();
+    query_xy_.resize(2, node_ids_.size());
+    int col = 0;
+    for (int id : node_ids_)
+      query_xy_.col(col++) = nodes.at(id).p().topRows<k2D>();
+
+    terrain_->GetHeightDerivatives(query_xy_, query_derivs_);
+
+    // chain rule for the optional variable scaling of the motion set.
+    const double s = ee_motion_->GetVariableScaling();
+
     int row = 0;
     for (int id : node_ids_) {
+      // the z-column entry never changes, only the two slope entries do.
       int idx = ee_motion_->GetOptIndex(Nodes::NodeValueInfo(id, kPos, Z));
-      jac.coeffRef(row, idx) = 1.0;
+      jac_ws_.WriteConstant(row, idx, s);
 
-      Vector3d p = nodes.at(id).p();
       for (auto dim : {X,Y}) {
         int idx = ee_motion_->GetOptIndex(Nodes::NodeValueInfo(id, kPos, dim));
-        jac.coeffRef(row, idx) = -terrain_->GetDerivativeOfHeightWrt(To2D(dim), p.x(), p.y());
+        jac_ws_.Write(row, idx, -s*query_derivs_(To2D(dim), row));
       }
       row++;
     }
+
+    jac_ws_.Finish();
   }
 }
 
@@ -37,16 +37,25 @@ namespace towr {
 TimeDiscretizationConstraint::TimeDiscretizationConstraint (double T, double dt,
                                                             std::string name)
     :ConstraintSet(kSpecifyLater, name)
+{
+  dts_ = GetTimeGrid(T, dt);
+}
+
+TimeDiscretizationConstraint::VecTimes
+TimeDiscretizationConstraint::GetTimeGrid (double T, double dt)
 {
   double t = 0.0;
-  dts_ = {t};
+  VecTimes dts = {t};
 
   for (int i=0; i<floor(T/dt); ++i) {
     t += dt;
-    dts_.push_back(t);
+    // accumulated rounding can overshoot the final time, which would make
+    // the grid unsorted once T is appended below.
+    dts.push_back(t<T? t : T);
   }
 
-  dts_.push_back(T); // also ensure constraints at very last node/time.
+  dts.push_back(T); // also ensure constraints at very last node/time.
+  return dts;
 }
 
 TimeDiscretizationConstraint::TimeDiscretizationConstraint (const VecTimes& times,
@@ -65,12 +74,16 @@ TimeDiscretizationConstraint::GetNumberOfNodes () const
 TimeDiscretizationConstraint::VectorXd
 TimeDiscretizationConstraint::GetValues () const
 {
+  auto t0 = StartMeasurement();
+  PrimeEvaluationCaches();
   VectorXd g = VectorXd::Zero(GetRows());
 
-  int k = 0;
-  for (double t : dts_)
-    UpdateConstraintAtInstance(t, k++, g);
+  int n = dts_.size();
+#pragma omp parallel for schedule(static) if(parallelize_instances_)
+  for (int k=0; k<n; ++k)
+    UpdateConstraintAtInstance(dts_.at(k), k, g);
 
+  StopValueMeasurement(t0);
   return g;
 }
 
@@ -79,9 +92,10 @@ TimeDiscretizationConstraint::GetBounds () const
 {
   VecBound bounds(GetRows());
 
-  int k = 0;
-  for (double t : dts_)
-    UpdateBoundsAtInstance(t, k++, bounds);
+  int n = dts_.size();
+#pragma omp parallel for schedule(static) if(parallelize_instances_)
+  for (int k=0; k<n; ++k)
+    UpdateBoundsAtInstance(dts_.at(k), k, bounds);
 
   return bounds;
 }
@@ -90,9 +104,64 @@ void
 TimeDiscretizationConstraint::FillJacobianBlock (std::string var_set,
                                                   Jacobian& jac) const
 {
+  auto t0 = StartMeasurement();
+  PrimeEvaluationCaches();
+
+  // Each instance writes its rows into an otherwise empty scratch matrix
+  // and the entries are collected as triplets, so the output Jacobian is
+  // built in one setFromTriplets() pass instead of by repeated sparse
+  // row-range assignments into an ever larger matrix.
+  // Always serial: all instances append to the same triplet buffer.
+  triplets_.clear();
+
+  // resolve the variable-set name once for the whole pass
+  id::VarSetId var_id = id::ParseVarSet(var_set);
+
   int k = 0;
-  for (double t : dts_)
-    UpdateJacobianAtInstance(t, k++, var_set, jac);
+  for (double t : dts_) {
+    jac_instance_.resize(jac.rows(), jac.cols()); // keeps heap capacity
+    UpdateJacobianAtInstance(t, k, var_id, jac_instance_);
+
+    // only scan the rows this instant can write, so the gather stays O(1)
+    // in the length of the time grid.
+    int row_start, n_rows;
+    GetActiveRows(k++, row_start, n_rows);
+    for (int row=row_start; row<row_start+n_rows; ++row)
+      for (Jacobian::InnerIterator it(jac_instance_, row); it; ++it)
+        triplets_.push_back(Eigen::Triplet<double>(it.row(), it.col(), it.value()));
+  }
+
+  jac.setFromTriplets(triplets_.begin(), triplets_.end());
+  StopJacobianMeasurement(t0);
+}
+
+void
+TimeDiscretizationConstraint::GetActiveRows (int k, int& row_start,
+                                             int& n_rows) const
+{
+  n_rows    = GetRows()/GetNumberOfNodes();
+  row_start = k*n_rows;
+}
+
+void
+TimeDiscretizationConstraint::AddJacobianTriplet (int row, int col,
+                                                  double value) const
+{
+  triplets_.push_back(Eigen::Triplet<double>(row, col, value));
+}
+
+std::size_t
+TimeDiscretizationConstraint::GetHeapBytes () const
+{
+  std::size_t bytes = dts_.capacity()*sizeof(double);
+  bytes += triplets_.capacity()*sizeof(Eigen::Triplet<double>);
+
+  // compressed sparse scratch of one instant
+  bytes += static_cast<std::size_t>(jac_instance_.nonZeros())
+           *(sizeof(double) + sizeof(int))
+         + static_cast<std::size_t>(jac_instance_.outerSize()+1)*sizeof(int);
+
+  return bytes;
 }
 
 } /* namespace towr */
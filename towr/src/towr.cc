@@ -29,18 +29,114 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <towr/towr.h>
 
+#include <algorithm> // std::max
+#include <chrono>
+#include <cmath>     // std::floor
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>  // PrintCurrent() detour in LogProblemSummary()
+#include <limits>
+#include <numeric>   // std::accumulate
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include <towr/constraints/dynamic_constraint.h>
+#include <towr/variables/cartesian_dimensions.h>
+#include <towr/variables/nodes.h>
+
 namespace towr {
 
+/// Randomly scales the phase durations, keeping each foot's total duration.
+static void
+PerturbPhaseDurations (Parameters& params, int seed)
+{
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> jitter(-0.2, 0.2);
+
+  for (auto& phases : params.ee_phase_durations_) {
+    double total = std::accumulate(phases.begin(), phases.end(), 0.0);
+
+    for (double& d : phases)
+      d *= 1.0 + jitter(rng);
+
+    double scaled = std::accumulate(phases.begin(), phases.end(), 0.0);
+    for (double& d : phases)
+      d *= total/scaled;
+  }
+}
+
+/**
+ * The on-disk layout of a problem snapshot: this header, the structure
+ * fingerprint, then per variable set the name, row count and raw values
+ * (@sa TOWR::SaveProblemState()).
+ */
+struct SnapshotHeader {
+  char magic[4];          ///< identifies a towr problem snapshot.
+  uint32_t version;       ///< layout version, bumped on changes.
+  uint32_t n_sets;        ///< number of serialized variable sets.
+  uint32_t n_fingerprint; ///< doubles in the structure fingerprint.
+  int32_t iterations;     ///< solver iterations at snapshot time (informational).
+};
+
+static const char kSnapshotMagic[4] = {'T','W','R','S'};
+static const uint32_t kSnapshotVersion = 1;
+
+/// The worst violation of any constraint bound at the current variables.
+static double
+GetMaxConstraintViolation (ifopt::Problem& nlp)
+{
+  Eigen::VectorXd x = nlp.GetVariableValues();
+  Eigen::VectorXd g = nlp.EvaluateConstraints(x.data());
+  auto bounds = nlp.GetBoundsOnConstraints();
+
+  double worst = 0.0;
+  for (int i=0; i<g.rows(); ++i) {
+    worst = std::max(worst, bounds.at(i).lower_ - g(i));
+    worst = std::max(worst, g(i) - bounds.at(i).upper_);
+  }
+
+  return worst;
+}
+
 
 TOWR::TOWR () {
-  using namespace std;
-  cout << "\n";
-  cout << "************************************************************\n";
-  cout << " TOWR - Trajectory Optimizer for Walking Robots (v1.2.2)\n";
-  cout << "                \u00a9 Alexander W. Winkler\n";
-  cout << "           https://github.com/ethz-adrl/towr\n";
-  cout << "************************************************************";
-  cout << "\n\n";
+  // intentionally silent: planners construct one of these per replan
+  // cycle, and even the version banner is console I/O on the hot path.
+  // Install a sink through SetLogSink() to get the banner and per-solve
+  // reports.
+}
+
+void
+TOWR::SetLogSink (const LogSink& sink)
+{
+  log_sink_ = sink;
+
+  if (log_sink_)
+    log_sink_(
+        "************************************************************\n"
+        " TOWR - Trajectory Optimizer for Walking Robots (v1.2.2)\n"
+        "                \u00a9 Alexander W. Winkler\n"
+        "           https://github.com/ethz-adrl/towr\n"
+        "************************************************************\n");
+}
+
+void
+TOWR::LogProblemSummary ()
+{
+  if (!log_sink_)
+    return; // skip the formatting entirely, not just the output
+
+  // PrintCurrent() writes to stdout directly; detour the stream into a
+  // string so the report reaches the sink instead of the console.
+  std::ostringstream report;
+  std::streambuf* stdout_buf = std::cout.rdbuf(report.rdbuf());
+  nlp_.PrintCurrent();
+  std::cout.rdbuf(stdout_buf);
+
+  log_sink_(report.str());
 }
 
 void
@@ -63,11 +159,344 @@ TOWR::SetParameters(const BaseState& final_base,
 }
 
 void
+TOWR::SetInitialGuess(const SplineHolder& prior, double t_shift)
+{
+  factory_.initial_guess_ = prior;
+  factory_.initial_guess_t_shift_ = t_shift;
+  factory_.use_initial_guess_ = true;
+}
+
+SolveResult
 TOWR::SolveNLP(const ifopt::Solver::Ptr& solver)
 {
-  nlp_ = BuildNLP();
+  using Clock = std::chrono::steady_clock;
+  auto seconds_since = [](Clock::time_point t0) {
+    return std::chrono::duration<double>(Clock::now() - t0).count();
+  };
+  auto t_start = Clock::now();
+
+  SolveResult result;
+
+  if (telemetry_) {
+    // a solve started through SolveAsync() already has its monitor; a
+    // plain synchronous solve gets one just for the telemetry tap.
+    if (!factory_.solve_monitor_)
+      factory_.solve_monitor_ = std::make_shared<SolveMonitor>();
+    factory_.solve_monitor_->SetTelemetryBuffer(telemetry_);
+  }
+
+  SolutionCache::Key cache_key;
+  if (solution_cache_) {
+    cache_key = GetCacheKey();
+    SplineHolder cached;
+    if (solution_cache_->Lookup(cache_key, cached)) {
+      if (solution_cache_->GetPolicy() == SolutionCache::kReuse) {
+        // hand back the stored trajectory without building or solving
+        factory_.spline_holder_ = cached;
+        result.from_cache = true;
+        result.feasible   = true; // only feasible solves are inserted
+        result.t_total    = seconds_since(t_start);
+        return result;
+      }
+      SetInitialGuess(cached); // solve anyway, but from the previous optimum
+    }
+  }
+
+  auto t_build = Clock::now();
+  nlp_ = BuildNLP(factory_);
+  result.t_construction = seconds_since(t_build);
+  nlp_built_ = true;
+  structure_fingerprint_ = GetStructureFingerprint();
+
+  if (prewarm_)
+    PrewarmNLP();
+
+  auto t_solve = Clock::now();
   solver->Solve(nlp_);
-  nlp_.PrintCurrent();
+  result.t_solve = seconds_since(t_solve);
+  LogProblemSummary();
+
+  result.iterations = nlp_.GetIterationCount();
+
+  if (iterate_store_) {
+    // re-encode the solver's verbatim iterate history into the bounded
+    // compressed store; SetSolution() and forensics then no longer depend
+    // on the copies inside the problem
+    iterate_store_->Clear();
+    for (int iter=0; iter<result.iterations; ++iter) {
+      nlp_.SetOptVariables(iter);
+      iterate_store_->Push(nlp_.GetVariableValues());
+    }
+    if (result.iterations > 0)
+      nlp_.SetOptVariables(result.iterations-1); // back to the final iterate
+  }
+
+  // one constraint pass over the final iterate; the per-set breakdown is
+  // kept for GetConstraintReports() so outer loops don't repeat it
+  constraint_reports_ = EvaluateConstraintReports();
+  result.constraint_violation = 0.0;
+  for (const auto& r : constraint_reports_)
+    result.constraint_violation = std::max(result.constraint_violation,
+                                           r.second.max_violation);
+  result.feasible = result.constraint_violation < 1e-4; // as in SolveMultiStart()
+  if (nlp_.HasCostTerms()) {
+    Eigen::VectorXd x = nlp_.GetVariableValues();
+    result.objective = nlp_.EvaluateCostFunction(x.data());
+  }
+
+  // towr's share of the solver time; stays zero unless profiling is on,
+  // since the sets are freshly constructed their counters cover this solve
+  for (const auto& stats : factory_.GetEvaluationStats())
+    result.t_evaluation += stats.second.t_values + stats.second.t_jacobians;
+
+  // only feasible trajectories enter the cache: a kReuse hit is returned
+  // without re-checking, so caching an infeasible solve would hand it
+  // back later flagged as feasible.
+  if (solution_cache_ && result.feasible)
+    solution_cache_->Insert(cache_key, GetSolution());
+
+  // the buffers have grown to their per-solve peak by now
+  if (memory_tally_)
+    AccountMemory(nlp_, *memory_tally_);
+
+  result.t_total = seconds_since(t_start);
+  return result;
+}
+
+std::vector<double>
+TOWR::GetStructureFingerprint () const
+{
+  const Parameters& p = factory_.params_;
+
+  std::vector<double> fp;
+  fp.push_back(p.GetEECount());
+  for (int ee=0; ee<p.GetEECount(); ++ee)
+    fp.push_back(p.GetPhaseCount(ee));
+
+  fp.push_back(p.GetBasePolyDurations().size());
+  fp.push_back(p.ee_polynomials_per_swing_phase_);
+  fp.push_back(p.force_polynomials_per_stance_phase_);
+  fp.push_back(p.dt_constraint_dynamic_);
+  fp.push_back(p.dt_constraint_range_of_motion_);
+  fp.push_back(p.dt_constraint_base_motion_);
+  fp.push_back(p.GetTotalTime());
+  fp.push_back(p.IsOptimizeTimings());
+  fp.push_back(factory_.dynamic_constraint_times_.size());
+
+  for (auto c : p.constraints_)
+    fp.push_back(c);
+  for (const auto& pair : p.costs_)
+    fp.push_back(pair.first);
+
+  return fp;
+}
+
+void
+TOWR::SolveCoarseToFine (const ifopt::Solver::Ptr& solver,
+                         double coarsening)
+{
+  assert(coarsening >= 1.0);
+
+  Parameters fine = factory_.params_;
+
+  // derive the coarse level: fewer constraint rows and fewer node
+  // variables, but the same phases, horizon and boundary states.
+  Parameters coarse = fine;
+  coarse.dt_constraint_dynamic_         *= coarsening;
+  coarse.dt_constraint_range_of_motion_ *= coarsening;
+  coarse.dt_constraint_base_motion_     *= coarsening;
+  coarse.duration_base_polynomial_      *= coarsening;
+  coarse.ee_polynomials_per_swing_phase_ =
+      std::max(1, fine.ee_polynomials_per_swing_phase_/2);
+  coarse.force_polynomials_per_stance_phase_ =
+      std::max(1, fine.force_polynomials_per_stance_phase_/2);
+
+  factory_.params_ = coarse;
+  SolveNLP(solver);
+
+  // transfer the coarse solution by sampling its splines at the fine
+  // node times, then solve the problem actually asked for.
+  factory_.params_ = fine;
+  SetInitialGuess(GetSolution());
+  SolveNLP(solver);
+}
+
+void
+TOWR::SolveFeasible (const ifopt::Solver::Ptr& solver)
+{
+  const double tol = factory_.params_.feasibility_tolerance_;
+  assert(tol >= 0.0); // enable through Parameters::StopAtFeasible()
+
+  // the dynamic constraint reports its maximum violation to the monitor
+  // once per evaluation; requesting cancellation makes the following
+  // evaluation throw, which unwinds out of the solver.
+  auto monitor = std::make_shared<SolveMonitor>();
+  SolveMonitor* raw = monitor.get(); // capturing the Ptr would be circular
+  monitor->SetProgressCallback([raw, tol](int n_evals, double violation) {
+    if (violation <= tol)
+      raw->RequestCancel();
+  });
+  factory_.solve_monitor_ = monitor;
+
+  try {
+    SolveNLP(solver);
+  } catch (const SolveCancelled&) {
+    // expected: the dynamics reached the tolerance before optimality
+  }
+  factory_.solve_monitor_ = nullptr;
+
+  // the cancellation point may have been a line-search trial, which the
+  // problem does not record. Hand back the first stored iterate that
+  // satisfies *all* constraints to the tolerance; when the cheap dynamics
+  // proxy fired before such an iterate exists, keep the last one.
+  int n_iters = GetIterationCount();
+  for (int iter=0; iter<n_iters; ++iter) {
+    SetSolution(iter);
+    if (GetMaxConstraintViolation(nlp_) <= tol)
+      return;
+  }
+
+  if (n_iters > 0)
+    SetSolution(n_iters-1);
+}
+
+void
+TOWR::SolvePersistent (const ifopt::Solver::Ptr& solver)
+{
+  if (nlp_built_ && GetStructureFingerprint() == structure_fingerprint_)
+    ResolveNLP(solver); // same dimensions and sparsity, workspace reusable
+  else
+    SolveNLP(solver);
+}
+
+std::future<bool>
+TOWR::SolveAsync (const ifopt::Solver::Ptr& solver,
+                  const SolveMonitor::ProgressCallback& progress)
+{
+  monitor_ = std::make_shared<SolveMonitor>();
+  monitor_->SetProgressCallback(progress);
+
+  // the dynamic constraint built by the factory reports its evaluations
+  // to this monitor, providing the progress and cancellation hook.
+  factory_.solve_monitor_ = monitor_;
+
+  return std::async(std::launch::async, [this, solver] {
+    try {
+      SolveNLP(solver);
+      return true;
+    } catch (const SolveCancelled&) {
+      return false;
+    }
+  });
+}
+
+void
+TOWR::Cancel ()
+{
+  if (monitor_)
+    monitor_->RequestCancel();
+}
+
+void
+TOWR::SetTelemetry (const TelemetryBuffer::Ptr& buffer)
+{
+  telemetry_ = buffer;
+}
+
+void
+TOWR::SolveAdaptive (const ifopt::Solver::Ptr& solver,
+                     double tol, int max_refinements)
+{
+  // the uniform grid defined by the parameters is the coarse starting point
+  std::vector<double> grid;
+  double T  = factory_.params_.GetTotalTime();
+  double dt = factory_.params_.dt_constraint_dynamic_;
+
+  double t = 0.0;
+  grid.push_back(t);
+  for (int i=0; i<floor(T/dt); ++i) {
+    t += dt;
+    grid.push_back(t);
+  }
+  grid.push_back(T);
+
+  for (int pass=0; ; ++pass) {
+    factory_.dynamic_constraint_times_ = grid;
+    SolveNLP(solver);
+
+    if (pass == max_refinements)
+      break;
+
+    // measure how much the found solution violates the dynamics midway
+    // between the grid points, reusing the constraint machinery itself.
+    std::vector<double> midpoints;
+    for (std::size_t i=0; i+1<grid.size(); ++i)
+      midpoints.push_back(0.5*(grid.at(i) + grid.at(i+1)));
+
+    DynamicConstraint probe(factory_.model_.dynamic_model_, midpoints,
+                            factory_.spline_holder_);
+    Eigen::VectorXd g = probe.GetValues();
+
+    // insert samples only in the intervals the dynamics tunneled through
+    std::vector<double> refined;
+    bool violated = false;
+    for (std::size_t i=0; i<midpoints.size(); ++i) {
+      refined.push_back(grid.at(i));
+      if (g.segment(k6D*i, k6D).lpNorm<Eigen::Infinity>() > tol) {
+        refined.push_back(midpoints.at(i));
+        violated = true;
+      }
+    }
+    refined.push_back(grid.back());
+
+    if (!violated)
+      break; // coarser grid already holds in between the samples
+
+    SetInitialGuess(GetSolution()); // warm-start the refined problem
+    grid = refined;
+  }
+
+  factory_.dynamic_constraint_times_.clear();
+}
+
+void
+TOWR::ResolveNLP(const ifopt::Solver::Ptr& solver)
+{
+  assert(nlp_built_); // SolveNLP() must have constructed the problem before
+
+  // only the boundary values change; the variable values of the previous
+  // solution are kept as initialization for the next solve.
+  factory_.UpdateBoundaryState();
+
+  solver->Solve(nlp_);
+  LogProblemSummary();
+}
+
+void
+TOWR::ExtendHorizon (const std::vector<Parameters::VecTimes>& appended_phase_durations)
+{
+  assert(nlp_built_); // requires a constructed problem to extend
+  assert(appended_phase_durations.size() == factory_.params_.GetEECount());
+
+  // carry the optimized gait timings over into the parameters before
+  // appending, so the phases shared with the previous problem keep their
+  // solved durations instead of reverting to the nominal gait.
+  for (int ee=0; ee<factory_.params_.GetEECount(); ++ee) {
+    auto durations = factory_.spline_holder_.phase_durations_.at(ee)->GetPhaseDurations();
+    const auto& appended = appended_phase_durations.at(ee);
+    durations.insert(durations.end(), appended.begin(), appended.end());
+    factory_.params_.ee_phase_durations_.at(ee) = durations;
+  }
+
+  // every node of the extended problem samples the current solution;
+  // nodes beyond the previous horizon hold its final state, so only the
+  // appended tail starts from a crude initialization.
+  SetInitialGuess(GetSolution());
+
+  // the variable and constraint dimensions changed, so the next solve
+  // must construct the extended problem (SolvePersistent() notices the
+  // changed structure fingerprint by itself).
+  nlp_built_ = false;
 }
 
 SplineHolder
@@ -79,6 +508,14 @@ TOWR::GetSolution() const
 void
 TOWR::SetSolution(int solver_iteration)
 {
+  // prefer the compressed store: it also covers iterations restored from
+  // a file and outlives a rebuild of the problem's own history
+  if (iterate_store_ && iterate_store_->Contains(solver_iteration)) {
+    Eigen::VectorXd x = iterate_store_->Get(solver_iteration);
+    nlp_.SetVariables(x.data());
+    return;
+  }
+
   nlp_.SetOptVariables(solver_iteration);
 }
 
@@ -88,21 +525,562 @@ TOWR::GetIterationCount() const
   return nlp_.GetIterationCount();
 }
 
+double
+TOWR::GetObjective()
+{
+  assert(nlp_built_); // SolveNLP() must have constructed the problem before
+
+  Eigen::VectorXd x = nlp_.GetVariableValues();
+  return nlp_.EvaluateCostFunction(x.data());
+}
+
+double
+TOWR::GetConstraintViolation()
+{
+  assert(nlp_built_); // SolveNLP() must have constructed the problem before
+
+  return GetMaxConstraintViolation(nlp_);
+}
+
+const std::map<std::string, ConstraintReport>&
+TOWR::GetConstraintReports () const
+{
+  assert(nlp_built_); // SolveNLP() must have constructed the problem before
+
+  return constraint_reports_;
+}
+
+std::map<std::string, ConstraintReport>
+TOWR::EvaluateConstraintReports () const
+{
+  assert(nlp_built_); // SolveNLP() must have constructed the problem before
+
+  std::map<std::string, ConstraintReport> reports;
+
+  for (const auto& c : factory_.GetConstraintSets()) {
+    ConstraintReport report;
+    report.values = c->GetValues();
+
+    auto bounds = c->GetBounds();
+    double norm_sq = 0.0;
+    for (int i=0; i<report.values.rows(); ++i) {
+      double v = std::max(bounds.at(i).lower_ - report.values(i),
+                          report.values(i) - bounds.at(i).upper_);
+      v = std::max(v, 0.0);
+      report.max_violation = std::max(report.max_violation, v);
+      norm_sq += v*v;
+    }
+    report.violation_norm = std::sqrt(norm_sq);
+
+    reports[c->GetName()] = report;
+  }
+
+  return reports;
+}
+
+void
+TOWR::SwapTerrain (const HeightMap::Ptr& terrain)
+{
+  factory_.SwapTerrain(terrain);
+}
+
+void
+TOWR::SaveProblemState (const std::string& path) const
+{
+  assert(nlp_built_); // SolveNLP() must have constructed the problem before
+
+  auto sets = nlp_.GetOptVariables()->GetComponents();
+
+  SnapshotHeader header;
+  std::memcpy(header.magic, kSnapshotMagic, sizeof(kSnapshotMagic));
+  header.version       = kSnapshotVersion;
+  header.n_sets        = sets.size();
+  header.n_fingerprint = structure_fingerprint_.size();
+  header.iterations    = nlp_.GetIterationCount();
+
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file)
+    throw std::runtime_error("TOWR: cannot open " + path);
+
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  file.write(reinterpret_cast<const char*>(structure_fingerprint_.data()),
+             structure_fingerprint_.size()*sizeof(double));
+
+  for (const auto& set : sets) {
+    std::string name = set->GetName();
+    uint32_t name_len = name.size();
+    uint32_t rows = set->GetRows();
+
+    // GetValues() hands back the contiguous optimization-variable vector,
+    // so each set is one bulk write.
+    Eigen::VectorXd values = set->GetValues();
+
+    file.write(reinterpret_cast<const char*>(&name_len), sizeof(name_len));
+    file.write(name.data(), name_len);
+    file.write(reinterpret_cast<const char*>(&rows), sizeof(rows));
+    file.write(reinterpret_cast<const char*>(values.data()),
+               rows*sizeof(double));
+  }
+
+  if (!file)
+    throw std::runtime_error("TOWR: writing " + path + " failed");
+}
+
+void
+TOWR::RestoreProblemState (const std::string& path)
+{
+  std::ifstream file(path, std::ios::binary);
+  if (!file)
+    throw std::runtime_error("TOWR: cannot open " + path);
+
+  SnapshotHeader header;
+  file.read(reinterpret_cast<char*>(&header), sizeof(header));
+  if (!file
+      || std::memcmp(header.magic, kSnapshotMagic, sizeof(kSnapshotMagic)) != 0
+      || header.version != kSnapshotVersion)
+    throw std::runtime_error("TOWR: " + path + " is no problem snapshot");
+
+  std::vector<double> fingerprint(header.n_fingerprint);
+  file.read(reinterpret_cast<char*>(fingerprint.data()),
+            fingerprint.size()*sizeof(double));
+
+  if (!nlp_built_) {
+    nlp_ = BuildNLP(factory_);
+    nlp_built_ = true;
+    structure_fingerprint_ = GetStructureFingerprint();
+  }
+
+  // the snapshot holds no model/terrain/parameters, so it only fits a
+  // problem configured identically to the one it was taken from.
+  if (fingerprint != structure_fingerprint_)
+    throw std::runtime_error("TOWR: " + path
+        + " was taken from a differently structured problem");
+
+  for (uint32_t i=0; i<header.n_sets; ++i) {
+    uint32_t name_len, rows;
+    file.read(reinterpret_cast<char*>(&name_len), sizeof(name_len));
+    std::string name(name_len, '\0');
+    file.read(&name[0], name_len);
+    file.read(reinterpret_cast<char*>(&rows), sizeof(rows));
+
+    Eigen::VectorXd values(rows);
+    file.read(reinterpret_cast<char*>(values.data()), rows*sizeof(double));
+    if (!file)
+      throw std::runtime_error("TOWR: " + path + " is truncated");
+
+    auto set = nlp_.GetOptVariables()->GetComponent(name);
+    if (!set || set->GetRows() != static_cast<int>(rows))
+      throw std::runtime_error("TOWR: variable set " + name
+          + " does not match the constructed problem");
+
+    set->SetVariables(values); // observers update the solution splines
+  }
+}
+
+ProblemStats
+TOWR::GetProblemStats ()
+{
+  // constructing the problem is fast compared to solving it, so build it
+  // and measure the real counts instead of estimating them analytically.
+  ifopt::Problem nlp = BuildNLP(factory_);
+
+  ProblemStats stats;
+  stats.n_variables   = nlp.GetNumberOfOptimizationVariables();
+  stats.n_constraints = nlp.GetNumberOfConstraints();
+
+  for (const auto& v : nlp.GetOptVariables()->GetComponents())
+    stats.variable_rows[v->GetName()] = v->GetRows();
+
+  for (const auto& c : factory_.GetConstraintSets())
+    stats.constraint_rows[c->GetName()] = c->GetRows();
+
+  auto jac = nlp.GetJacobianOfConstraints();
+  stats.jacobian_nonzeros = jac.nonZeros();
+
+  double dense = static_cast<double>(stats.n_constraints)*stats.n_variables;
+  stats.jacobian_density = dense > 0.0? stats.jacobian_nonzeros/dense : 0.0;
+
+  // compressed storage: one value and one inner index per nonzero, plus
+  // one offset per row.
+  stats.jacobian_memory_bytes =
+      stats.jacobian_nonzeros*(sizeof(double) + sizeof(int))
+      + (stats.n_constraints+1)*sizeof(int);
+
+  // where the heap bytes of the towr-side containers go
+  MemoryTally tally;
+  AccountMemory(nlp, tally);
+  for (const auto& kv : tally.GetUsage())
+    stats.memory_bytes[kv.first] = kv.second.live;
+
+  return stats;
+}
+
+void
+TOWR::SetMemoryTally (const MemoryTally::Ptr& tally)
+{
+  memory_tally_ = tally;
+}
+
+void
+TOWR::AccountMemory (ifopt::Problem& nlp, MemoryTally& tally) const
+{
+  std::size_t bytes = 0;
+  for (const auto& v : nlp.GetOptVariables()->GetComponents())
+    if (auto nodes = std::dynamic_pointer_cast<Nodes>(v))
+      bytes += nodes->GetHeapBytes();
+  tally.Set("node_variables", bytes);
+
+  bytes = 0;
+  const SplineHolder& s = factory_.spline_holder_;
+  std::vector<NodeSpline::Ptr> splines = {s.base_linear_, s.base_angular_};
+  splines.insert(splines.end(), s.ee_motion_.begin(), s.ee_motion_.end());
+  splines.insert(splines.end(), s.ee_force_.begin(), s.ee_force_.end());
+  for (const auto& spline : splines)
+    if (spline)
+      bytes += spline->GetHeapBytes();
+  tally.Set("splines", bytes);
+
+  bytes = 0;
+  for (const auto& c : factory_.GetConstraintSets())
+    if (auto tdc = std::dynamic_pointer_cast<TimeDiscretizationConstraint>(c))
+      bytes += tdc->GetHeapBytes();
+  tally.Set("constraint_workspaces", bytes);
+}
+
+void
+TOWR::SetProfilingEnabled(bool enable)
+{
+  factory_.SetProfilingEnabled(enable);
+}
+
+void
+TOWR::SetEvaluationTrace(const EvaluationTrace::Ptr& trace)
+{
+  factory_.SetEvaluationTrace(trace);
+}
+
+void
+TOWR::SetArenaAllocation(bool enable)
+{
+  factory_.SetArenaAllocation(enable);
+}
+
+void
+TOWR::SetPrewarmEnabled(bool enable)
+{
+  prewarm_ = enable;
+}
+
+void
+TOWR::PrewarmNLP ()
+{
+  Eigen::VectorXd x = nlp_.GetVariableValues();
+
+  // one pass over every path the solver will exercise: values, bounds
+  // and Jacobian of the constraints, value and gradient of the costs.
+  // All lazily grown scratch buffers and caches reach their final
+  // capacity here instead of during the first solver iterations.
+  nlp_.EvaluateConstraints(x.data());
+  nlp_.GetBoundsOnConstraints();
+  nlp_.GetJacobianOfConstraints();
+
+  if (nlp_.HasCostTerms()) {
+    nlp_.EvaluateCostFunction(x.data());
+    nlp_.EvaluateCostFunctionGradient(x.data());
+  }
+}
+
+void
+TOWR::SetSolutionCache(const SolutionCache::Ptr& cache)
+{
+  solution_cache_ = cache;
+}
+
+void
+TOWR::SetIterateStore(const IterateStore::Ptr& store)
+{
+  iterate_store_ = store;
+}
+
+SolutionCache::Key
+TOWR::GetCacheKey () const
+{
+  // positions and angles quantized to 1 cm / 0.01 rad, durations to
+  // 1 ms: scenarios closer than that produce interchangeable plans.
+  const double q_state = 0.01;
+  const double q_time  = 1e-3;
+
+  SolutionCache::Key key;
+
+  auto add_vec = [&key](const Eigen::VectorXd& v, double q) {
+    for (int i=0; i<v.rows(); ++i)
+      key.push_back(std::lround(v(i)/q));
+  };
+
+  add_vec(factory_.initial_base_.lin.p(), q_state);
+  add_vec(factory_.initial_base_.lin.v(), q_state);
+  add_vec(factory_.initial_base_.ang.p(), q_state);
+  add_vec(factory_.initial_base_.ang.v(), q_state);
+
+  add_vec(factory_.final_base_.lin.p(), q_state);
+  add_vec(factory_.final_base_.lin.v(), q_state);
+  add_vec(factory_.final_base_.ang.p(), q_state);
+  add_vec(factory_.final_base_.ang.v(), q_state);
+
+  for (const auto& ee : factory_.initial_ee_W_)
+    add_vec(ee, q_state);
+
+  // the gait: phase durations and starting contact state per foot
+  for (const auto& T_phases : factory_.params_.ee_phase_durations_) {
+    key.push_back(T_phases.size());
+    for (double t : T_phases)
+      key.push_back(std::lround(t/q_time));
+  }
+  for (bool in_contact : factory_.params_.ee_in_contact_at_start_)
+    key.push_back(in_contact);
+  key.push_back(factory_.params_.IsOptimizeTimings());
+
+  // the terrain has no identity of its own, so describe it by its
+  // friction and by height probes along the straight start-goal line
+  key.push_back(std::lround(factory_.terrain_->GetFrictionCoeff()/q_state));
+
+  Eigen::Vector3d p0 = factory_.initial_base_.lin.p();
+  Eigen::Vector3d p1 = factory_.final_base_.lin.p();
+  int n_probes = 8;
+  for (int i=0; i<=n_probes; ++i) {
+    double s = double(i)/n_probes;
+    double x = (1.0-s)*p0.x() + s*p1.x();
+    double y = (1.0-s)*p0.y() + s*p1.y();
+    key.push_back(std::lround(factory_.terrain_->GetHeight(x,y)/q_state));
+  }
+
+  return key;
+}
+
+std::map<std::string, EvaluationStats>
+TOWR::GetEvaluationStats() const
+{
+  return factory_.GetEvaluationStats();
+}
+
 ifopt::Problem
-TOWR::BuildNLP()
+TOWR::BuildNLP(NlpFactory& factory)
 {
   ifopt::Problem nlp;
 
-  for (auto c : factory_.GetVariableSets())
+  for (auto c : factory.GetVariableSets())
     nlp.AddVariableSet(c);
 
-  for (auto c : factory_.GetConstraints())
+  for (auto c : factory.GetConstraints())
     nlp.AddConstraintSet(c);
 
-  for (auto c : factory_.GetCosts())
+  for (auto c : factory.GetCosts())
     nlp.AddCostSet(c);
 
   return nlp;
 }
 
+void
+TOWR::SolveMultiStart(const SolverMaker& make_solver, int n_candidates)
+{
+  struct Candidate {
+    NlpFactory factory;
+    ifopt::Problem nlp;
+    double violation = std::numeric_limits<double>::max();
+    double cost      = std::numeric_limits<double>::max();
+  };
+  std::vector<Candidate> candidates(n_candidates);
+
+  // IPOPT offers no safe way to abort a running solve through ifopt, so
+  // all candidates run to completion and the best feasible one wins.
+  std::vector<std::thread> threads;
+  for (int k=0; k<n_candidates; ++k) {
+    threads.emplace_back([this, k, &candidates, &make_solver]() {
+      Candidate& c = candidates.at(k);
+
+      c.factory = factory_;
+      if (k > 0) // candidate 0 keeps the nominal initialization
+        PerturbPhaseDurations(c.factory.params_, k);
+
+      c.nlp = BuildNLP(c.factory);
+      make_solver()->Solve(c.nlp);
+
+      c.violation = GetMaxConstraintViolation(c.nlp);
+      if (c.nlp.HasCostTerms()) {
+        Eigen::VectorXd x = c.nlp.GetVariableValues();
+        c.cost = c.nlp.EvaluateCostFunction(x.data());
+      }
+    });
+  }
+
+  for (auto& t : threads)
+    t.join();
+
+  // prefer the lowest cost among feasible candidates; if none converged,
+  // fall back to the least infeasible one.
+  double eps_feasible = 1e-4;
+  int best = 0;
+  for (int k=1; k<n_candidates; ++k) {
+    const Candidate& b = candidates.at(best);
+    const Candidate& c = candidates.at(k);
+
+    bool b_feasible = b.violation < eps_feasible;
+    bool c_feasible = c.violation < eps_feasible;
+
+    if (c_feasible && (!b_feasible || c.cost < b.cost))
+      best = k;
+    else if (!c_feasible && !b_feasible && c.violation < b.violation)
+      best = k;
+  }
+
+  factory_ = candidates.at(best).factory;
+  nlp_ = candidates.at(best).nlp;
+  nlp_built_ = true;
+  LogProblemSummary();
+}
+
+void
+TOWR::SolveSplitHorizon (const SolverMaker& make_solver, int rounds)
+{
+  assert(rounds >= 1);
+  const Parameters params = factory_.params_;
+  const double T = params.GetTotalTime();
+  const int n_ee = params.GetEECount();
+  const double eps = 1e-6;
+
+  // cut at the base-polynomial boundary closest to the middle, so the
+  // halves' base splines line up with the full problem's.
+  double dt_base = params.duration_base_polynomial_;
+  double t_mid = std::round(T/2.0/dt_base)*dt_base;
+  t_mid = std::max(dt_base, std::min(t_mid, T - dt_base));
+
+  // the halves keep their gait fixed even when the full problem optimizes
+  // phase durations; a drifting split instant would invalidate the
+  // consensus state.
+  Parameters half_template = params;
+  auto& hc = half_template.constraints_;
+  hc.erase(std::remove(hc.begin(), hc.end(), Parameters::TotalTime), hc.end());
+  half_template.ee_phase_durations_.clear();
+  half_template.ee_in_contact_at_start_.clear();
+
+  Parameters p1 = half_template, p2 = half_template;
+  for (int ee=0; ee<n_ee; ++ee) {
+    const auto& phases = params.ee_phase_durations_.at(ee);
+    bool in_contact = params.ee_in_contact_at_start_.at(ee);
+
+    // phases spanning the cut are split in two, keeping the contact state
+    Parameters::VecTimes first, second;
+    bool second_in_contact = in_contact;
+    bool contact_set = false;
+    double t_start = 0.0;
+    for (int i=0; i<phases.size(); ++i) {
+      double t_end = t_start + phases.at(i);
+      bool contact_i = in_contact == (i%2 == 0);
+      if (t_end <= t_mid + eps) {
+        first.push_back(phases.at(i));
+      } else if (t_start >= t_mid - eps) {
+        if (!contact_set) {
+          second_in_contact = contact_i;
+          contact_set = true;
+        }
+        second.push_back(phases.at(i));
+      } else { // spans the cut
+        first.push_back(t_mid - t_start);
+        second.push_back(t_end - t_mid);
+        second_in_contact = contact_i;
+        contact_set = true;
+      }
+      t_start = t_end;
+    }
+
+    p1.ee_phase_durations_.push_back(first);
+    p1.ee_in_contact_at_start_.push_back(in_contact);
+    p2.ee_phase_durations_.push_back(second);
+    p2.ee_in_contact_at_start_.push_back(second_in_contact);
+  }
+
+  // the consensus variables: base state and footholds at the split,
+  // seeded by interpolating between start and goal.
+  double w = t_mid/T;
+  BaseState mid;
+  mid.lin.at(kPos) = (1.0-w)*factory_.initial_base_.lin.p() + w*factory_.final_base_.lin.p();
+  mid.lin.at(kVel) = (factory_.final_base_.lin.p() - factory_.initial_base_.lin.p())/T;
+  mid.ang.at(kPos) = (1.0-w)*factory_.initial_base_.ang.p() + w*factory_.final_base_.ang.p();
+  mid.ang.at(kVel) = (factory_.final_base_.ang.p() - factory_.initial_base_.ang.p())/T;
+
+  FeetPos mid_ee = factory_.initial_ee_W_;
+  Eigen::Vector3d base_shift = mid.lin.p() - factory_.initial_base_.lin.p();
+  for (auto& p : mid_ee) {
+    p.topRows<k2D>() += base_shift.topRows<k2D>();
+    p.z() = factory_.terrain_->GetHeight(p.x(), p.y());
+  }
+
+  TOWR half1, half2;
+  SplineHolder sol1, sol2;
+
+  for (int round=0; round<rounds; ++round) {
+    // the first round leaves the crossing velocity (and height) to the
+    // first half, later rounds pin the averaged consensus state.
+    Parameters p1r = p1;
+    p1r.bounds_final_ang_pos = {X,Y,Z};
+    if (round == 0) {
+      p1r.bounds_final_lin_pos = {X,Y};
+      p1r.bounds_final_lin_vel = {};
+      p1r.bounds_final_ang_vel = {};
+    } else {
+      p1r.bounds_final_lin_pos = {X,Y,Z};
+      p1r.bounds_final_lin_vel = {X,Y,Z};
+      p1r.bounds_final_ang_vel = {X,Y,Z};
+    }
+
+    half1.SetInitialState(factory_.initial_base_, factory_.initial_ee_W_);
+    half1.SetParameters(mid, p1r, factory_.model_, factory_.terrain_);
+    half2.SetInitialState(mid, mid_ee);
+    half2.SetParameters(factory_.final_base_, p2, factory_.model_, factory_.terrain_);
+
+    if (round > 0) {
+      half1.SetInitialGuess(sol1);
+      half2.SetInitialGuess(sol2);
+    }
+
+    // both halves share this problem's terrain instance; that is safe
+    // because the terrain query memos are thread-local, everything else
+    // the halves touch is their own.
+    std::thread worker([&half1, &make_solver]() {
+      half1.SolveNLP(make_solver());
+    });
+    half2.SolveNLP(make_solver());
+    worker.join();
+
+    sol1 = half1.GetSolution();
+    sol2 = half2.GetSolution();
+
+    // consensus update: the second half's copy of the shared state is
+    // pinned to mid, so averaging it with the first half's endpoint
+    // pulls the two copies together.
+    State end_lin = sol1.base_linear_->GetPoint(t_mid);
+    State end_ang = sol1.base_angular_->GetPoint(t_mid);
+    mid.lin.at(kPos) = end_lin.p(); // x,y were pinned, z is adopted
+    mid.lin.at(kVel) = 0.5*(end_lin.v() + mid.lin.v());
+    mid.ang.at(kPos) = end_ang.p();
+    mid.ang.at(kVel) = 0.5*(end_ang.v() + mid.ang.v());
+
+    for (int ee=0; ee<n_ee; ++ee)
+      mid_ee.at(ee) = sol1.ee_motion_.at(ee)->GetPoint(t_mid).p();
+  }
+
+  // the stitched halves warm-start the problem actually asked for, which
+  // irons out the remaining disagreement at the seam.
+  factory_.initial_guess_ = sol1;
+  factory_.initial_guess_second_ = sol2;
+  factory_.initial_guess_split_time_ = t_mid;
+  factory_.initial_guess_t_shift_ = 0.0;
+  factory_.use_initial_guess_ = true;
+
+  SolveNLP(make_solver());
+
+  factory_.initial_guess_second_ = SplineHolder();
+  factory_.initial_guess_split_time_ = -1.0;
+}
+
 } /* namespace towr */
@@ -0,0 +1,242 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <towr/trajectory_io.h>
+
+#include <algorithm> // std::min
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <towr/variables/cartesian_dimensions.h>
+
+namespace towr {
+
+namespace {
+
+/**
+ * The on-disk layout: this header followed by n_states packed records of
+ * (19 + 13*n_ee) doubles each, holding time, base linear and angular state
+ * and per endeffector the motion, force and contact flag.
+ */
+struct FileHeader {
+  char magic[4];     ///< identifies a towr trajectory file.
+  uint32_t version;  ///< layout version, bumped on record changes.
+  uint32_t n_ee;     ///< number of endeffectors per state record.
+  uint32_t n_states; ///< number of state records in the file.
+  double dt;         ///< the sampling interval [s].
+};
+
+const char kMagic[4] = {'T','W','R','T'};
+const uint32_t kVersion = 1;
+
+int GetRecordSize (int n_ee)
+{
+  return 19 + 13*n_ee; // doubles per state record
+}
+
+} // namespace
+
+void
+TrajectoryIo::Write (const std::string& path, const SplineHolder& solution,
+                     double dt)
+{
+  double T = solution.base_linear_->GetTotalTime();
+
+  std::vector<double> ts;
+  for (double t=0.0; t<=T+1e-5; t+=dt)
+    ts.push_back(std::min(t, T));
+
+  // sample each spline in one batched pass over its polynomials
+  auto base_lin = solution.base_linear_->GetPoints(ts);
+  auto base_ang = solution.base_angular_->GetPoints(ts);
+
+  int n_ee = solution.ee_motion_.size();
+  std::vector<std::vector<State>> ee_motion, ee_force;
+  for (int ee=0; ee<n_ee; ++ee) {
+    ee_motion.push_back(solution.ee_motion_.at(ee)->GetPoints(ts));
+    ee_force.push_back(solution.ee_force_.at(ee)->GetPoints(ts));
+  }
+
+  std::size_t n_states = ts.size();
+  std::vector<double> buffer;
+  buffer.reserve(n_states*GetRecordSize(n_ee));
+
+  auto push_state = [&buffer](const State& s) {
+    for (auto deriv : {kPos, kVel, kAcc})
+      for (int dim=0; dim<k3D; ++dim)
+        buffer.push_back(s.at(deriv)(dim));
+  };
+
+  for (std::size_t k=0; k<n_states; ++k) {
+    buffer.push_back(ts.at(k));
+    push_state(base_lin.at(k));
+    push_state(base_ang.at(k));
+
+    for (int ee=0; ee<n_ee; ++ee) {
+      push_state(ee_motion.at(ee).at(k));
+
+      for (int dim=0; dim<k3D; ++dim)
+        buffer.push_back(ee_force.at(ee).at(k).p()(dim));
+
+      bool contact = solution.phase_durations_.at(ee)->IsContactPhase(ts.at(k));
+      buffer.push_back(contact? 1.0 : 0.0);
+    }
+  }
+
+  FileHeader header;
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version  = kVersion;
+  header.n_ee     = n_ee;
+  header.n_states = n_states;
+  header.dt       = dt;
+
+  // the whole trajectory is assembled above, so it hits the disk in one
+  // buffered write instead of one per sampled state.
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file)
+    throw std::runtime_error("TrajectoryIo: cannot open " + path);
+
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  file.write(reinterpret_cast<const char*>(buffer.data()),
+             buffer.size()*sizeof(double));
+  if (!file)
+    throw std::runtime_error("TrajectoryIo: writing " + path + " failed");
+}
+
+TrajectoryReader::TrajectoryReader (const std::string& path)
+{
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw std::runtime_error("TrajectoryReader: cannot open " + path);
+
+  struct stat sb;
+  if (fstat(fd, &sb) < 0) {
+    close(fd);
+    throw std::runtime_error("TrajectoryReader: cannot stat " + path);
+  }
+  mapped_size_ = sb.st_size;
+
+  if (mapped_size_ < sizeof(FileHeader)) {
+    close(fd);
+    throw std::runtime_error("TrajectoryReader: " + path + " is no trajectory file");
+  }
+
+  mapped_ = mmap(nullptr, mapped_size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd); // the mapping stays valid without the descriptor
+  if (mapped_ == MAP_FAILED) {
+    mapped_ = nullptr;
+    throw std::runtime_error("TrajectoryReader: cannot map " + path);
+  }
+
+  const auto* header = reinterpret_cast<const FileHeader*>(mapped_);
+  std::size_t expected = sizeof(FileHeader)
+      + static_cast<std::size_t>(header->n_states)
+        *GetRecordSize(header->n_ee)*sizeof(double);
+
+  if (std::memcmp(header->magic, kMagic, sizeof(kMagic)) != 0
+      || header->version != kVersion
+      || mapped_size_ < expected) {
+    munmap(mapped_, mapped_size_);
+    mapped_ = nullptr;
+    throw std::runtime_error("TrajectoryReader: " + path + " is no trajectory file");
+  }
+
+  n_states_ = header->n_states;
+  n_ee_     = header->n_ee;
+  dt_       = header->dt;
+  records_  = reinterpret_cast<const double*>(
+      static_cast<const char*>(mapped_) + sizeof(FileHeader));
+}
+
+TrajectoryReader::~TrajectoryReader ()
+{
+  if (mapped_ != nullptr)
+    munmap(mapped_, mapped_size_);
+}
+
+int
+TrajectoryReader::GetStateCount () const
+{
+  return n_states_;
+}
+
+int
+TrajectoryReader::GetEECount () const
+{
+  return n_ee_;
+}
+
+double
+TrajectoryReader::GetDt () const
+{
+  return dt_;
+}
+
+TrajectoryState
+TrajectoryReader::GetState (int k) const
+{
+  assert(0 <= k && k < n_states_);
+  const double* r = records_ + static_cast<std::size_t>(k)*GetRecordSize(n_ee_);
+
+  auto read_state = [&r](State& s) {
+    for (auto deriv : {kPos, kVel, kAcc})
+      for (int dim=0; dim<k3D; ++dim)
+        s.at(deriv)(dim) = *r++;
+  };
+
+  TrajectoryState state;
+  state.t_ = *r++;
+  read_state(state.base_lin_);
+  read_state(state.base_ang_);
+
+  for (int ee=0; ee<n_ee_; ++ee) {
+    State motion(3,3);
+    read_state(motion);
+    state.ee_motion_.push_back(motion);
+
+    Eigen::Vector3d f;
+    for (int dim=0; dim<k3D; ++dim)
+      f(dim) = *r++;
+    state.ee_force_.push_back(f);
+
+    state.ee_contact_.push_back(*r++ != 0.0);
+  }
+
+  return state;
+}
+
+} /* namespace towr */
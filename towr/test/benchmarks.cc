@@ -0,0 +1,202 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+/**
+ * Performance benchmarks (google-benchmark) for the hot paths of towr:
+ * full solves per robot, per-constraint Jacobian assembly, spline
+ * evaluation and terrain queries. Run before/after a change to validate
+ * performance claims:
+ *
+ *     ./towr_benchmarks --benchmark_repetitions=5
+ */
+
+#include <memory>
+
+#include <benchmark/benchmark.h>
+
+#include <towr/initialization/gait_generator.h>
+#include <towr/models/robot_model.h>
+#include <towr/nlp_factory.h>
+#include <towr/terrain/examples/height_map_examples.h>
+#include <towr/towr.h>
+
+#include <ifopt/ipopt_solver.h>
+
+using namespace towr;
+
+
+/**
+ * A representative flat-ground locomotion problem: the robot stands in
+ * nominal stance and must reach a goal 1m ahead with a default gait.
+ */
+static NlpFactory
+MakeFactory (RobotModel::Robot robot, bool optimize_phase_durations)
+{
+  NlpFactory factory;
+
+  RobotModel model(robot);
+  auto nominal_stance_B = model.kinematic_model_->GetNominalStanceInBase();
+  double robot_height = -nominal_stance_B.front().z();
+
+  BaseState initial_base;
+  initial_base.lin.at(kPos).z() = robot_height;
+  factory.initial_base_ = initial_base;
+
+  for (auto p : nominal_stance_B) {
+    p.z() = 0.0;
+    factory.initial_ee_W_.push_back(p);
+  }
+
+  BaseState goal;
+  goal.lin.at(kPos) << 1.0, 0.0, robot_height;
+  factory.final_base_ = goal;
+
+  Parameters params;
+  int n_ee = factory.initial_ee_W_.size();
+  auto gait = GaitGenerator::MakeGaitGenerator(n_ee);
+  gait->SetCombo(GaitGenerator::C0);
+  double total_duration = 2.0;
+  for (int ee=0; ee<n_ee; ++ee) {
+    params.ee_phase_durations_.push_back(gait->GetPhaseDurations(total_duration, ee));
+    params.ee_in_contact_at_start_.push_back(gait->IsInContactAtStart(ee));
+  }
+  params.SetSwingConstraint();
+  if (optimize_phase_durations)
+    params.OptimizePhaseDurations();
+
+  factory.model_ = model;
+  factory.params_ = params;
+  factory.terrain_ = std::make_shared<FlatGround>(0.0);
+
+  return factory;
+}
+
+/// Full IPOPT solve; range = {robot, optimize phase durations}.
+static void
+BM_Solve (benchmark::State& state)
+{
+  auto robot = static_cast<RobotModel::Robot>(state.range(0));
+  auto factory = MakeFactory(robot, state.range(1));
+
+  TOWR towr;
+  towr.SetInitialState(factory.initial_base_, factory.initial_ee_W_);
+  towr.SetParameters(factory.final_base_, factory.params_,
+                     factory.model_, factory.terrain_);
+
+  for (auto _ : state)
+    towr.SolveNLP(std::make_shared<ifopt::IpoptSolver>());
+}
+BENCHMARK(BM_Solve)
+    ->Args({RobotModel::Monoped, false})->Args({RobotModel::Monoped, true})
+    ->Args({RobotModel::Biped,   false})->Args({RobotModel::Biped,   true})
+    ->Args({RobotModel::Anymal,  false})->Args({RobotModel::Anymal,  true})
+    ->Unit(benchmark::kSecond);
+
+/// Spline evaluation along the trajectory, the hot loop of every constraint.
+static void
+BM_SplineGetPoint (benchmark::State& state)
+{
+  auto factory = MakeFactory(RobotModel::Anymal, false);
+  factory.GetVariableSets();
+  auto spline = factory.spline_holder_.base_linear_;
+
+  double T = spline->GetTotalTime();
+  double t = 0.0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(spline->GetPoint(t));
+    t += 0.01;
+    if (t > T) t = 0.0;
+  }
+}
+BENCHMARK(BM_SplineGetPoint);
+
+/// Jacobian of the spline position w.r.t. the node values.
+static void
+BM_SplineGetJacobianWrtNodes (benchmark::State& state)
+{
+  auto factory = MakeFactory(RobotModel::Anymal, false);
+  factory.GetVariableSets();
+  auto spline = factory.spline_holder_.base_linear_;
+
+  double T = spline->GetTotalTime();
+  double t = 0.0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(spline->GetJacobianWrtNodes(t, kPos));
+    t += 0.01;
+    if (t > T) t = 0.0;
+  }
+}
+BENCHMARK(BM_SplineGetJacobianWrtNodes);
+
+/// Height and normal queries of each example terrain.
+static void
+BM_TerrainQuery (benchmark::State& state)
+{
+  auto id = static_cast<HeightMap::TerrainID>(state.range(0));
+  auto terrain = HeightMap::MakeTerrain(id);
+  state.SetLabel(terrain_names.at(id));
+
+  double x = 0.0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(terrain->GetHeight(x, 0.0));
+    benchmark::DoNotOptimize(terrain->GetNormalizedBasis(HeightMap::Normal, x, 0.0));
+    x += 0.013;
+    if (x > 4.0) x = 0.0;
+  }
+}
+BENCHMARK(BM_TerrainQuery)->DenseRange(0, HeightMap::TERRAIN_COUNT-1);
+
+
+/**
+ * The constraint sets only exist once the problem is assembled, so their
+ * Jacobian benchmarks are registered at runtime, one per constraint set.
+ */
+int main (int argc, char** argv)
+{
+  auto factory = std::make_shared<NlpFactory>(MakeFactory(RobotModel::Anymal, true));
+  auto nlp = std::make_shared<ifopt::Problem>();
+
+  for (auto c : factory->GetVariableSets())
+    nlp->AddVariableSet(c);
+
+  for (auto c : factory->GetConstraints()) {
+    nlp->AddConstraintSet(c); // connects the constraint with its variables
+
+    std::string name = "BM_FillJacobian/" + c->GetName();
+    benchmark::RegisterBenchmark(name.c_str(),
+        [c, nlp, factory](benchmark::State& state) {
+          for (auto _ : state)
+            benchmark::DoNotOptimize(c->GetJacobian());
+        });
+  }
+
+  benchmark::Initialize(&argc, argv);
+  benchmark::RunSpecifiedBenchmarks();
+  return 0;
+}
@@ -0,0 +1,249 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+/**
+ * End-to-end latency regression benchmark with budget enforcement.
+ *
+ * Micro-benchmarks prove an optimization moved its own number; this guards
+ * the headline: wall time from SetInitialState() to GetSolution() for
+ * canonical scenarios (the hopper_example monoped, a quadruped trot on
+ * flat ground, a quadruped walk up stairs with optimized phase durations).
+ * Each scenario has a time and an iteration budget; exceeding either
+ * fails the run, so a regression anywhere in the evaluation pipeline
+ * breaks CI instead of silently eating the latency margin.
+ *
+ * The scenarios are fully deterministic (fixed states, gaits and terrain,
+ * no random initialization) and the IPOPT settings are pinned below, so
+ * runs on the same machine are comparable. Results go to stdout as one
+ * CSV row per scenario.
+ *
+ * Budgets can be overridden without recompiling by passing a file with
+ * one line per scenario: <name> <max_seconds> <max_iterations>.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <ifopt/ipopt_solver.h>
+
+#include <towr/initialization/gait_generator.h>
+#include <towr/models/robot_model.h>
+#include <towr/terrain/examples/height_map_examples.h>
+#include <towr/towr.h>
+
+using namespace towr;
+
+namespace {
+
+struct Budget {
+  double max_seconds;
+  int max_iterations;
+};
+
+// generous enough for an unloaded CI machine; tighten via the budget file
+// once a baseline for the specific hardware exists.
+std::map<std::string, Budget> budgets = {
+    {"monoped_hop_flat",   {30.0,   400}},
+    {"anymal_trot_flat",   {180.0,  800}},
+    {"anymal_walk_stairs", {600.0, 2000}},
+};
+
+/// identical solver configuration for every scenario and every run.
+ifopt::Solver::Ptr
+MakePinnedSolver ()
+{
+  auto solver = std::make_shared<ifopt::IpoptSolver>();
+  solver->SetOption("linear_solver", "mumps");
+  solver->SetOption("jacobian_approximation", "exact");
+  solver->SetOption("print_level", 0);
+  return solver;
+}
+
+/// feet in nominal stance projected onto the terrain, base at nominal height.
+void
+SetNominalInitialState (TOWR& towr, const RobotModel& model,
+                        const HeightMap::Ptr& terrain)
+{
+  TOWR::FeetPos feet;
+  double base_height = 0.0;
+  for (const auto& stance_B : model.kinematic_model_->GetNominalStanceInBase()) {
+    Eigen::Vector3d foot = stance_B;
+    foot.z() = terrain->GetHeight(foot.x(), foot.y());
+    base_height += foot.z() - stance_B.z();
+    feet.push_back(foot);
+  }
+
+  BaseState initial_base;
+  initial_base.lin.at(kPos).z() = base_height/feet.size();
+  towr.SetInitialState(initial_base, feet);
+}
+
+void
+SetGaitParameters (Parameters& params, GaitGenerator::Combos combo,
+                   double T, int n_ee)
+{
+  auto gait = GaitGenerator::MakeGaitGenerator(n_ee);
+  gait->SetCombo(combo);
+  for (int ee=0; ee<n_ee; ++ee) {
+    params.ee_phase_durations_.push_back(gait->GetPhaseDurations(T, ee));
+    params.ee_in_contact_at_start_.push_back(gait->IsInContactAtStart(ee));
+  }
+}
+
+/// the hopper_example.cc monoped: hop 1m forward on flat ground.
+void
+SetupMonopedHopFlat (TOWR& towr)
+{
+  auto terrain = std::make_shared<FlatGround>(0.0);
+  RobotModel model(RobotModel::Monoped);
+
+  BaseState initial_base;
+  initial_base.lin.at(kPos).z() = 0.5;
+  towr.SetInitialState(initial_base, {Eigen::Vector3d::Zero()});
+
+  BaseState goal;
+  goal.lin.at(kPos) << 1.0, 0.0, 0.5;
+
+  Parameters params;
+  params.ee_phase_durations_.push_back({0.4, 0.2, 0.4, 0.2, 0.4, 0.2, 0.2});
+  params.ee_in_contact_at_start_.push_back(true);
+  params.SetSwingConstraint();
+
+  towr.SetParameters(goal, params, model, terrain);
+}
+
+/// quadruped fly-trot 1.5m forward on flat ground, fixed phase durations.
+void
+SetupAnymalTrotFlat (TOWR& towr)
+{
+  auto terrain = std::make_shared<FlatGround>(0.0);
+  RobotModel model(RobotModel::Anymal);
+  SetNominalInitialState(towr, model, terrain);
+
+  BaseState goal;
+  goal.lin.at(kPos) << 1.5, 0.0, 0.42;
+
+  Parameters params;
+  SetGaitParameters(params, GaitGenerator::C1, 2.4, 4); // fly trot
+  params.SetSwingConstraint();
+
+  towr.SetParameters(goal, params, model, terrain);
+}
+
+/// quadruped overlap-walk up the stairs, phase durations optimized.
+void
+SetupAnymalWalkStairs (TOWR& towr)
+{
+  auto terrain = std::make_shared<Stairs>();
+  RobotModel model(RobotModel::Anymal);
+  SetNominalInitialState(towr, model, terrain);
+
+  BaseState goal;
+  goal.lin.at(kPos) << 1.5, 0.0, 0.42 + terrain->GetHeight(1.5, 0.0);
+
+  Parameters params;
+  SetGaitParameters(params, GaitGenerator::C0, 3.6, 4); // overlap-walk
+  params.SetSwingConstraint();
+  params.OptimizePhaseDurations();
+
+  towr.SetParameters(goal, params, model, terrain);
+}
+
+struct Scenario {
+  std::string name;
+  void (*setup)(TOWR&);
+};
+
+bool
+LoadBudgetFile (const std::string& path)
+{
+  std::ifstream file(path);
+  if (!file) {
+    std::fprintf(stderr, "cannot open budget file %s\n", path.c_str());
+    return false;
+  }
+
+  std::string name;
+  double seconds;
+  int iterations;
+  while (file >> name >> seconds >> iterations)
+    budgets[name] = {seconds, iterations};
+
+  return true;
+}
+
+} // namespace
+
+
+int main (int argc, char* argv[])
+{
+  if (argc > 1 && !LoadBudgetFile(argv[1]))
+    return 1;
+
+  std::vector<Scenario> scenarios = {
+      {"monoped_hop_flat",   SetupMonopedHopFlat},
+      {"anymal_trot_flat",   SetupAnymalTrotFlat},
+      {"anymal_walk_stairs", SetupAnymalWalkStairs},
+  };
+
+  std::printf("scenario,t_total_s,t_solve_s,iterations,objective,"
+              "violation,budget_s,budget_iters,pass\n");
+
+  bool all_ok = true;
+  for (const auto& scenario : scenarios) {
+    // the headline number: everything the planner pays per replan,
+    // problem setup and construction included
+    auto t_start = std::chrono::high_resolution_clock::now();
+
+    TOWR towr;
+    scenario.setup(towr);
+    SolveResult result = towr.SolveNLP(MakePinnedSolver());
+    towr.GetSolution();
+
+    double t_total = std::chrono::duration<double>(
+        std::chrono::high_resolution_clock::now() - t_start).count();
+
+    const Budget& budget = budgets.at(scenario.name);
+    bool ok = t_total <= budget.max_seconds
+           && result.iterations <= budget.max_iterations;
+    all_ok = all_ok && ok;
+
+    std::printf("%s,%.3f,%.3f,%d,%.4f,%.2e,%.1f,%d,%d\n",
+                scenario.name.c_str(), t_total, result.t_solve,
+                result.iterations, result.objective,
+                result.constraint_violation, budget.max_seconds,
+                budget.max_iterations, ok? 1 : 0);
+  }
+
+  return all_ok? 0 : 1;
+}
@@ -28,6 +28,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 ******************************************************************************/
 
 #include <cmath>
+#include <iostream>
 
 #include <towr/terrain/examples/height_map_examples.h>
 #include <towr/models/robot_model.h>
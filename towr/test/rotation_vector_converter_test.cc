@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+#include <Eigen/Dense>
+
+#include <towr/variables/base_nodes.h>
+#include <towr/variables/node_spline.h>
+#include <towr/variables/euler_converter.h>
+#include <towr/variables/rotation_vector_converter.h>
+
+namespace towr {
+
+using Vector3d = Eigen::Vector3d;
+using Matrix3d = Eigen::Matrix3d;
+using Jacobian = RotationVectorConverter::Jacobian;
+
+// a small fixture holding a 5-node orientation spline with non-trivial
+// node values, against which all analytic derivatives are finite-
+// difference checked.
+class RotationVectorConverterTest : public ::testing::Test {
+protected:
+  void SetUp() override
+  {
+    nodes_  = std::make_shared<BaseNodes>(5, "base_ang");
+    spline_ = std::make_shared<NodeSpline>(nodes_.get(),
+                                           std::vector<double>{0.4, 0.6, 0.3, 0.7});
+    x_.resize(nodes_->GetRows());
+    for (int i=0; i<x_.size(); ++i)
+      x_(i) = std::sin(3.7*i) * 1.2; // deterministic, covers theta near pi
+    nodes_->SetVariables(x_);
+  }
+
+  std::shared_ptr<BaseNodes> nodes_;
+  NodeSpline::Ptr spline_;
+  Eigen::VectorXd x_;
+  double h_ = 1e-6;
+};
+
+TEST_F(RotationVectorConverterTest, RotationMatrixIsOrthonormal)
+{
+  RotationVectorConverter conv(spline_);
+  for (double t : {0.05, 0.5, 1.1, 1.9}) {
+    Matrix3d R = Matrix3d(conv.GetRotationMatrixBaseToWorld(t));
+    EXPECT_NEAR((R*R.transpose() - Matrix3d::Identity()).norm(), 0.0, 1e-9);
+  }
+}
+
+TEST_F(RotationVectorConverterTest, AngularVelocityMatchesRotationDerivative)
+{
+  RotationVectorConverter conv(spline_);
+  for (double t : {0.05, 0.5, 1.1, 1.9}) {
+    Matrix3d R  = Matrix3d(conv.GetRotationMatrixBaseToWorld(t));
+    Matrix3d Rp = Matrix3d(conv.GetRotationMatrixBaseToWorld(t+h_));
+    Matrix3d Rm = Matrix3d(conv.GetRotationMatrixBaseToWorld(t-h_));
+
+    // w in world frame: skew(w) = Rdot * R^T
+    Matrix3d W = ((Rp - Rm)/(2*h_))*R.transpose();
+    Vector3d w_fd(W(2,1), W(0,2), W(1,0));
+    EXPECT_NEAR((conv.GetAngularVelocityInWorld(t) - w_fd).norm(), 0.0, 1e-5);
+
+    Vector3d wd_fd = (conv.GetAngularVelocityInWorld(t+h_)
+                      - conv.GetAngularVelocityInWorld(t-h_))/(2*h_);
+    EXPECT_NEAR((conv.GetAngularAccelerationInWorld(t) - wd_fd).norm(), 0.0, 1e-5);
+  }
+}
+
+TEST_F(RotationVectorConverterTest, NodeJacobiansMatchFiniteDifferences)
+{
+  RotationVectorConverter conv(spline_);
+  Vector3d v(0.3, -0.8, 0.5);
+
+  for (double t : {0.05, 0.5, 1.1, 1.9}) {
+    Jacobian jac_w   = conv.GetDerivOfAngVelWrtNodes(t);
+    Jacobian jac_wd  = conv.GetDerivOfAngAccWrtNodes(t);
+    Jacobian jac_Rv  = conv.DerivOfRotVecMult(t, v, false);
+    Jacobian jac_Rtv = conv.DerivOfRotVecMult(t, v, true);
+    auto Rd = conv.GetDerivativeOfRotationMatrixWrtNodes(t);
+
+    for (int i=0; i<x_.size(); ++i) {
+      Eigen::VectorXd xp = x_, xm = x_;
+      xp(i) += h_;
+      xm(i) -= h_;
+
+      nodes_->SetVariables(xp);
+      Vector3d w_p  = conv.GetAngularVelocityInWorld(t);
+      Vector3d wd_p = conv.GetAngularAccelerationInWorld(t);
+      Matrix3d R_p  = Matrix3d(conv.GetRotationMatrixBaseToWorld(t));
+
+      nodes_->SetVariables(xm);
+      Vector3d w_m  = conv.GetAngularVelocityInWorld(t);
+      Vector3d wd_m = conv.GetAngularAccelerationInWorld(t);
+      Matrix3d R_m  = Matrix3d(conv.GetRotationMatrixBaseToWorld(t));
+
+      Matrix3d dR_fd = (R_p - R_m)/(2*h_);
+      EXPECT_NEAR((Vector3d(jac_w.col(i))   - (w_p - w_m)/(2*h_)).norm(),   0.0, 1e-5);
+      EXPECT_NEAR((Vector3d(jac_wd.col(i))  - (wd_p - wd_m)/(2*h_)).norm(), 0.0, 1e-4);
+      EXPECT_NEAR((Vector3d(jac_Rv.col(i))  - dR_fd*v).norm(),              0.0, 1e-5);
+      EXPECT_NEAR((Vector3d(jac_Rtv.col(i)) - dR_fd.transpose()*v).norm(),  0.0, 1e-5);
+      for (int r=0; r<k3D; ++r)
+        for (int c=0; c<k3D; ++c)
+          EXPECT_NEAR(Rd.at(r).at(c).coeff(i), dR_fd(r,c), 1e-5);
+
+      nodes_->SetVariables(x_);
+    }
+  }
+}
+
+TEST_F(RotationVectorConverterTest, SmallAnglesStayFinite)
+{
+  // near-identity orientations exercise the Taylor branch of the
+  // exponential-map coefficients.
+  nodes_->SetVariables(Eigen::VectorXd::Constant(x_.size(), 1e-6));
+  RotationVectorConverter conv(spline_);
+
+  double t = 0.5;
+  EXPECT_TRUE(std::isfinite(conv.GetAngularVelocityInWorld(t).norm()));
+  EXPECT_TRUE(std::isfinite(conv.GetAngularAccelerationInWorld(t).norm()));
+  EXPECT_TRUE(std::isfinite(conv.GetDerivOfAngVelWrtNodes(t).norm()));
+  EXPECT_TRUE(std::isfinite(conv.GetDerivOfAngAccWrtNodes(t).norm()));
+}
+
+TEST(RotationVectorConverterStatic, FromEulerAnglesMatchesRotation)
+{
+  for (int k=0; k<20; ++k) {
+    Vector3d xyz(std::sin(1.3*k), 0.5*std::cos(2.1*k), std::sin(0.7*k)*2.0);
+    Matrix3d R_euler = Matrix3d(EulerConverter::GetRotationMatrixBaseToWorld(xyz));
+    Matrix3d R_rv = RotationVectorConverter::GetRotationMatrix(
+        RotationVectorConverter::FromEulerAngles(xyz));
+    EXPECT_NEAR((R_euler - R_rv).norm(), 0.0, 1e-10);
+  }
+}
+
+} /* namespace towr */
@@ -0,0 +1,222 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+/**
+ * Micro-benchmark and derivative validation for HeightMap terrains.
+ *
+ * For every terrain registered in HeightMap::MakeTerrain() this times
+ * GetHeight, GetNormalizedBasis and GetDerivativeOfNormalizedBasisWrt over
+ * randomized query positions, and cross-checks the analytic height and
+ * basis derivatives against central finite differences. A terrain with a
+ * wrong (or pathologically expensive) derivative does not fail a solve,
+ * it silently slows IPOPT down -- this harness catches both. Returns
+ * nonzero when any analytic derivative disagrees with finite differences,
+ * so it doubles as a regression test for newly added terrains.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include <towr/terrain/height_map.h>
+
+using namespace towr;
+
+namespace {
+
+const int kQueries      = 10000; ///< random positions per timed method.
+const double kEps       = 1e-5;  ///< finite-difference step.
+const double kTolerance = 1e-3;  ///< allowed analytic-vs-FD deviation.
+
+std::vector<Eigen::Vector2d>
+RandomQueries (int n)
+{
+  // fixed seed so runs are comparable; range covers where the example
+  // terrains have their features (steps, gaps, slopes along x).
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<double> x_dist(-1.0, 4.0);
+  std::uniform_real_distribution<double> y_dist(-1.5, 1.5);
+
+  std::vector<Eigen::Vector2d> queries;
+  queries.reserve(n);
+  for (int i=0; i<n; ++i)
+    queries.push_back(Eigen::Vector2d(x_dist(rng), y_dist(rng)));
+
+  return queries;
+}
+
+/// Wall time per call [ns] of f over all queries.
+template<typename F>
+double TimePerCall (const std::vector<Eigen::Vector2d>& queries, F f)
+{
+  auto t0 = std::chrono::steady_clock::now();
+  for (const auto& q : queries)
+    f(q.x(), q.y());
+  auto t1 = std::chrono::steady_clock::now();
+
+  return std::chrono::duration<double, std::nano>(t1-t0).count()
+         / queries.size();
+}
+
+/**
+ * Whether f is smooth enough at (x,y) in direction dim for a
+ * finite-difference check: at the steps and kinks of the example terrains
+ * the one-sided derivatives disagree and FD says nothing about the
+ * analytic value, so those positions are skipped.
+ */
+template<typename F>
+bool IsSmoothAt (F f, double x, double y, Dim2D dim)
+{
+  double hx = (dim==X_)? kEps : 0.0;
+  double hy = (dim==Y_)? kEps : 0.0;
+
+  double f0 = f(x, y);
+  double fp = f(x+hx, y+hy);
+  double fm = f(x-hx, y-hy);
+
+  double forward  = (fp - f0)/kEps;
+  double backward = (f0 - fm)/kEps;
+
+  return std::fabs(forward - backward) < kTolerance;
+}
+
+/// Central finite difference of f at (x,y) in direction dim.
+template<typename F>
+double FiniteDifference (F f, double x, double y, Dim2D dim)
+{
+  double hx = (dim==X_)? kEps : 0.0;
+  double hy = (dim==Y_)? kEps : 0.0;
+
+  return (f(x+hx, y+hy) - f(x-hx, y-hy)) / (2.0*kEps);
+}
+
+/// Cross-checks all analytic derivatives of one terrain; returns failures.
+int ValidateDerivatives (const HeightMap::Ptr& terrain, const char* name,
+                         const std::vector<Eigen::Vector2d>& queries)
+{
+  int failures = 0;
+
+  auto report = [&failures, name](const char* what, double x, double y,
+                                  double analytic, double fd) {
+    std::printf("  FAIL %-10s %s at (%.4f, %.4f): analytic %.6f vs fd %.6f\n",
+                name, what, x, y, analytic, fd);
+    failures++;
+  };
+
+  auto height = [&terrain](double x, double y) {
+    return terrain->GetHeight(x, y);
+  };
+
+  for (const auto& q : queries) {
+    for (auto dim : {X_, Y_}) {
+      // height derivative
+      if (IsSmoothAt(height, q.x(), q.y(), dim)) {
+        double analytic = terrain->GetDerivativeOfHeightWrt(dim, q.x(), q.y());
+        double fd = FiniteDifference(height, q.x(), q.y(), dim);
+        if (std::fabs(analytic - fd) > kTolerance*(1.0 + std::fabs(fd)))
+          report(dim==X_? "dh/dx":"dh/dy", q.x(), q.y(), analytic, fd);
+      }
+
+      // derivatives of the normalized basis vectors
+      for (auto dir : {HeightMap::Normal, HeightMap::Tangent1,
+                       HeightMap::Tangent2}) {
+        Eigen::Vector3d analytic =
+            terrain->GetDerivativeOfNormalizedBasisWrt(dir, dim, q.x(), q.y());
+
+        for (int k=0; k<3; ++k) {
+          auto basis_k = [&terrain, dir, k](double x, double y) {
+            return terrain->GetNormalizedBasis(dir, x, y)(k);
+          };
+
+          if (!IsSmoothAt(basis_k, q.x(), q.y(), dim))
+            continue;
+
+          double fd = FiniteDifference(basis_k, q.x(), q.y(), dim);
+          if (std::fabs(analytic(k) - fd) > kTolerance*(1.0 + std::fabs(fd)))
+            report("basis deriv", q.x(), q.y(), analytic(k), fd);
+        }
+      }
+    }
+  }
+
+  return failures;
+}
+
+} // namespace
+
+int main ()
+{
+  auto queries = RandomQueries(kQueries);
+
+  // derivative validation uses fewer positions; each checks dozens of
+  // virtual calls and the failure mode is systematic, not statistical.
+  auto check_queries = RandomQueries(500);
+
+  int failures = 0;
+
+  std::printf("%-10s %14s %14s %14s\n",
+              "terrain", "height [ns]", "basis [ns]", "basis-d [ns]");
+
+  for (int id=0; id<HeightMap::TERRAIN_COUNT; ++id) {
+    auto terrain_id = static_cast<HeightMap::TerrainID>(id);
+    auto terrain = HeightMap::MakeTerrain(terrain_id);
+    const char* name = terrain_names.at(terrain_id).c_str();
+
+    double t_height = TimePerCall(queries, [&terrain](double x, double y) {
+      volatile double h = terrain->GetHeight(x, y);
+      (void)h;
+    });
+
+    double t_basis = TimePerCall(queries, [&terrain](double x, double y) {
+      volatile double n =
+          terrain->GetNormalizedBasis(HeightMap::Normal, x, y).z();
+      (void)n;
+    });
+
+    double t_basis_deriv = TimePerCall(queries, [&terrain](double x, double y) {
+      volatile double d = terrain->GetDerivativeOfNormalizedBasisWrt(
+          HeightMap::Normal, X_, x, y).z();
+      (void)d;
+    });
+
+    std::printf("%-10s %14.1f %14.1f %14.1f\n",
+                name, t_height, t_basis, t_basis_deriv);
+
+    failures += ValidateDerivatives(terrain, name, check_queries);
+  }
+
+  if (failures > 0) {
+    std::printf("\n%d derivative mismatches\n", failures);
+    return 1;
+  }
+
+  return 0;
+}
@@ -30,13 +30,19 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef XPP_OPT_INCLUDE_XPP_ROS_NLP_OPTIMIZER_NODE_H_
 #define XPP_OPT_INCLUDE_XPP_ROS_NLP_OPTIMIZER_NODE_H_
 
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include <ros/ros.h>
 #include <rosbag/bag.h>
 
 #include <xpp_states/robot_state_cartesian.h>
 #include <xpp_msgs/RobotStateCartesian.h>
+#include <xpp_msgs/RobotStateCartesianTrajectory.h>
 #include <xpp_msgs/RobotParameters.h>
 #include <towr_ros/TowrCommand.h>
 
@@ -53,17 +59,28 @@ public:
   using Vector3d       = Eigen::Vector3d;
 
   TowrRos ();
-  virtual ~TowrRos () = default;
+
+  /**
+   * @brief Constructs the node on the given handle.
+   * @param node_handle  The handle to subscribe/advertise on. A nodelet
+   *                     passes its manager's handle here, so publications
+   *                     to subscribers in the same manager are handed
+   *                     over as shared pointers instead of serialized
+   *                     (@sa TowrRosNodelet).
+   */
+  explicit TowrRos (const ::ros::NodeHandle& node_handle);
+  virtual ~TowrRos ();
 
 private:
   void UserCommandCallback(const TowrCommandMsg& msg);
 
-  XppVec GetTrajectory() const;
+  XppVec GetTrajectory(const SplineHolder& solution) const;
 
   // publishing to rviz with ROS bag
   ::ros::Subscriber user_command_sub_;
   ::ros::Publisher initial_state_pub_;
   ::ros::Publisher robot_parameters_pub_;
+  ::ros::Publisher trajectory_pub_; ///< the full sampled trajectory, e.g. for controllers.
 
   void SetInitialFromNominal(const std::vector<Vector3d>& nomial_stance_B);
   void PublishInitial();
@@ -74,18 +91,117 @@ private:
   TOWR towr_;
   ifopt::IpoptSolver::Ptr solver_;
   double visualization_dt_; ///< discretization of output trajectory (1/TaskServoHz)
+  bool save_rosbag_;        ///< whether to also export the trajectory as rosbag.
 
 private:
   std::vector<XppVec>GetIntermediateSolutions();
   xpp_msgs::RobotParameters BuildRobotParametersMsg(const RobotModel& model) const;
 
-  void SaveOptimizationAsRosbag(const std::string& bag_name,
-                                const xpp_msgs::RobotParameters& robot_params,
-                                const TowrCommandMsg user_command_msg,
-                                bool include_iterations=false);
+  /**
+   * @brief Everything one bag file needs, frozen at solve time.
+   *
+   * The trajectories are sampled on the callback thread (cheap), so the
+   * writer thread only serializes to disk and never touches towr_ or any
+   * other mutable node state. The terrain is carried along because the
+   * next user command may already have replaced terrain_ while this bag
+   * is still being written.
+   */
+  struct BagJob {
+    std::string bag_name;
+    xpp_msgs::RobotParameters robot_params;
+    TowrCommandMsg user_command;
+    XppVec final_trajectory;
+    std::vector<XppVec> iteration_trajectories; ///< optional, see GetIntermediateSolutions().
+    HeightMap::Ptr terrain;
+  };
+
+  /// Hands a bag to the writer thread; never blocks the callback. When
+  /// the queue is full the oldest pending bag is dropped, since the most
+  /// recent solve is the one worth keeping.
+  void EnqueueBagJob(BagJob job);
+
+  /// Blocks until all queued bags are on disk (needed before playback).
+  void WaitForBagWriter();
+
+  /// Body of the writer thread: drains the queue until destruction.
+  void BagWriterLoop();
+
+  /// Serializes one job to disk; runs on the writer thread.
+  void WriteBag(const BagJob& job) const;
+
   void SaveTrajectoryInRosbag (rosbag::Bag&,
                                const std::vector<xpp::RobotStateCartesian>& traj,
-                               const std::string& topic) const;
+                               const std::string& topic,
+                               const HeightMap::Ptr& terrain) const;
+
+  std::thread bag_writer_;
+  std::deque<BagJob> bag_queue_;
+  std::mutex bag_mutex_;
+  std::condition_variable bag_cv_;
+  bool bag_writer_stop_ = false;
+  bool bag_writing_     = false; ///< a popped job is still being written.
+  enum {kMaxQueuedBags = 4};
+
+private:
+  /**
+   * @brief Everything identifying one candidate optimization problem.
+   *
+   * Two specs describing the same problem within tolerance allow a
+   * pre-solved candidate to stand in for a fresh solve; any mismatch
+   * (different gait, goal, terrain or start state) makes it stale.
+   */
+  struct GaitSpec {
+    int robot;
+    int terrain;
+    int gait;
+    double total_duration;
+    bool optimize_phase_durations;
+    BaseState goal;
+    BaseState initial_base;
+    std::vector<Vector3d> initial_ee_pos;
+
+    bool Matches(const GaitSpec& other, double tol) const;
+  };
+
+  /// A background-solved trajectory for one candidate spec.
+  struct GaitCandidate {
+    GaitSpec spec;
+    SplineHolder solution;
+    int generation; ///< the command cycle this candidate was solved for.
+  };
+
+  /// The spec the given user command describes (with the node's current
+  /// initial state filled in).
+  GaitSpec BuildGaitSpec(const TowrCommandMsg& msg) const;
+
+  /// The solver parameters for a spec; shared between the foreground
+  /// solve and the precompute workers.
+  static Parameters BuildParameters(const GaitSpec& spec, int n_ee);
+
+  /// Queues the other gait combos of the current command for background
+  /// solving; previously queued candidates become stale.
+  void SchedulePrecompute(const GaitSpec& solved_spec);
+
+  /// True if a background-solved candidate matches the spec; hands out
+  /// its trajectory.
+  bool LookupGaitCandidate(const GaitSpec& spec, SplineHolder& solution);
+
+  /// Body of each precompute worker: solves queued specs until destruction.
+  void PrecomputeLoop();
+
+  bool precompute_gaits_;          ///< whether the pipeline runs at all.
+  int precompute_top_k_;           ///< how many alternative gaits to solve.
+  int precompute_threads_;         ///< size of the worker pool.
+  double precompute_cpu_time_;     ///< per-candidate solver budget [s].
+  double precompute_state_tol_;    ///< stale check tolerance on states.
+
+  std::vector<std::thread> precompute_workers_;
+  std::deque<GaitSpec> precompute_queue_;
+  std::vector<GaitCandidate> gait_candidates_;
+  std::mutex precompute_mutex_;
+  std::condition_variable precompute_cv_;
+  bool precompute_stop_ = false;
+  int precompute_generation_ = 0; ///< bumped per user command.
 };
 
 } /* namespace towr */
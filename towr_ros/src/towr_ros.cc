@@ -29,6 +29,10 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <towr_ros/towr_ros.h>
 
+#include <cmath>
+
+#include <boost/make_shared.hpp>
+
 #include <std_msgs/Int32.h>
 
 #include <xpp_states/convert.h>
@@ -37,6 +41,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <towr/initialization/gait_generator.h>
 #include <towr/terrain/height_map.h>
+#include <towr/trajectory_io.h>
 #include <towr/variables/euler_converter.h>
 
 #include <towr_ros/topic_names.h>
@@ -46,9 +51,13 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 namespace towr {
 
 
-TowrRos::TowrRos ()
+TowrRos::TowrRos () : TowrRos(::ros::NodeHandle())
+{
+}
+
+TowrRos::TowrRos (const ::ros::NodeHandle& node_handle)
 {
-  ::ros::NodeHandle n;
+  ::ros::NodeHandle n = node_handle;
 
   user_command_sub_ = n.subscribe(towr_msgs::user_command, 1,
                                   &TowrRos::UserCommandCallback, this);
@@ -59,6 +68,9 @@ TowrRos::TowrRos ()
   robot_parameters_pub_  = n.advertise<xpp_msgs::RobotParameters>
                                     (xpp_msgs::robot_parameters, 1);
 
+  trajectory_pub_  = n.advertise<xpp_msgs::RobotStateCartesianTrajectory>
+                                    (xpp_msgs::robot_trajectory_desired, 1);
+
   solver_ = std::make_shared<ifopt::IpoptSolver>(); // could also use SNOPT here
   solver_->SetOption("linear_solver", "mumps");
   solver_->SetOption("jacobian_approximation", "exact");
@@ -66,6 +78,49 @@ TowrRos::TowrRos ()
   solver_->SetOption("print_level", 5);
 
   visualization_dt_ = 0.02;
+
+  // writing every sampled state as an individual rosbag record takes
+  // longer than some warm-started solves, so it can be turned off when
+  // only the binary trajectory file is needed.
+  n.param("save_rosbag", save_rosbag_, true);
+
+  // bag serialization happens off the callback thread, so the next user
+  // command is processed while the previous trajectory is still written.
+  bag_writer_ = std::thread(&TowrRos::BagWriterLoop, this);
+
+  // the gait-candidate pipeline solves the alternative gaits of the last
+  // command in the background, so re-issuing a command with a different
+  // gait can often be answered from a pre-solved candidate.
+  n.param("precompute_gaits", precompute_gaits_, false);
+  n.param("precompute_top_k", precompute_top_k_, 3);
+  n.param("precompute_threads", precompute_threads_, 2);
+  n.param("precompute_cpu_time", precompute_cpu_time_, 20.0);
+  n.param("precompute_state_tolerance", precompute_state_tol_, 1e-3);
+
+  if (precompute_gaits_)
+    for (int i=0; i<precompute_threads_; ++i)
+      precompute_workers_.push_back(std::thread(&TowrRos::PrecomputeLoop, this));
+}
+
+TowrRos::~TowrRos ()
+{
+  {
+    std::lock_guard<std::mutex> lock(bag_mutex_);
+    bag_writer_stop_ = true;
+  }
+  bag_cv_.notify_all();
+  if (bag_writer_.joinable())
+    bag_writer_.join(); // finishes writing any queued bags first
+
+  {
+    std::lock_guard<std::mutex> lock(precompute_mutex_);
+    precompute_stop_ = true;
+    precompute_queue_.clear(); // pending candidates are worthless now
+  }
+  precompute_cv_.notify_all();
+  for (auto& w : precompute_workers_)
+    if (w.joinable())
+      w.join(); // at most one in-flight solve each
 }
 
 void
@@ -109,45 +164,65 @@ TowrRos::UserCommandCallback(const TowrCommandMsg& msg)
   SetInitialFromNominal(model.kinematic_model_->GetNominalStanceInBase());
   PublishInitial();
 
-  // goal state
-  BaseState goal;
-  goal.lin.at(kPos) = xpp::Convert::ToXpp(msg.goal_lin.pos);
-  goal.lin.at(kVel) = xpp::Convert::ToXpp(msg.goal_lin.vel);
-  goal.ang.at(kPos) = xpp::Convert::ToXpp(msg.goal_ang.pos);
-  goal.ang.at(kVel) = xpp::Convert::ToXpp(msg.goal_ang.vel);
+  GaitSpec spec = BuildGaitSpec(msg);
+  int n_ee = model.kinematic_model_->GetNumberOfEndeffectors();
 
   // terrain
   auto terrain_id = static_cast<HeightMap::TerrainID>(msg.terrain);
   terrain_ = HeightMap::MakeTerrain(terrain_id);
 
-  // solver parameters
-  Parameters params;
-  int n_ee = model.kinematic_model_->GetNumberOfEndeffectors();
-  auto gait_gen_ = GaitGenerator::MakeGaitGenerator(n_ee);
-  auto id_gait   = static_cast<GaitGenerator::Combos>(msg.gait);
-  gait_gen_->SetCombo(id_gait);
-  for (int ee=0; ee<n_ee; ++ee) {
-    params.ee_phase_durations_.push_back(gait_gen_->GetPhaseDurations(msg.total_duration, ee));
-    params.ee_in_contact_at_start_.push_back(gait_gen_->IsInContactAtStart(ee));
-  }
-  params.SetSwingConstraint();
-  if (msg.optimize_phase_durations)
-    params.OptimizePhaseDurations();
-
   // TOWR
   towr_.SetInitialState(initial_base_, initial_ee_pos_);
-  towr_.SetParameters(goal, params, model, terrain_);
+  towr_.SetParameters(spec.goal, BuildParameters(spec, n_ee), model, terrain_);
 
 
   // Defaults to /home/user/.ros/
   std::string bag_file = "towr_trajectory.bag";
   if (msg.optimize) {
-    towr_.SolveNLP(solver_);
-    SaveOptimizationAsRosbag(bag_file, robot_params_msg, msg, false);
+    // a background worker may already have solved exactly this problem
+    // (typically: the same command re-issued with a different gait), in
+    // which case its trajectory replaces the foreground solve entirely.
+    SplineHolder solution;
+    if (!LookupGaitCandidate(spec, solution)) {
+      towr_.SolveNLP(solver_);
+      solution = towr_.GetSolution();
+    }
+
+    // while this plan is executed, solve the command's other gaits so
+    // the next request is usually pre-answered.
+    if (precompute_gaits_)
+      SchedulePrecompute(spec);
+
+    XppVec trajectory = GetTrajectory(solution);
+
+    // hand the full trajectory to controllers/visualizers as a shared
+    // pointer: subscribers in the same process (nodelet manager) receive
+    // the message without a serialize/deserialize round trip.
+    auto traj_msg = boost::make_shared<xpp_msgs::RobotStateCartesianTrajectory>(
+        xpp::Convert::ToRos(trajectory));
+    trajectory_pub_.publish(traj_msg);
+
+    // compact binary export of the trajectory (e.g. for controllers)
+    TrajectoryIo::Write("towr_trajectory.dat", solution, visualization_dt_);
+
+    if (save_rosbag_) {
+      // the trajectory was already sampled above (cheap); serialization
+      // happens on the writer thread (the 100s of ms of disk I/O).
+      BagJob job;
+      job.bag_name         = bag_file;
+      job.robot_params     = robot_params_msg;
+      job.user_command     = msg;
+      job.final_trajectory = std::move(trajectory);
+      job.terrain          = terrain_;
+      EnqueueBagJob(std::move(job));
+    }
   }
 
   // playback using terminal commands
-  if (msg.replay_trajectory || msg.optimize) {
+  if (save_rosbag_ && (msg.replay_trajectory || msg.optimize)) {
+    // playback reads the same file the writer thread produces, so it
+    // is the one consumer that must wait for the disk.
+    WaitForBagWriter();
     int success = system(("rosbag play --topics "
         + xpp_msgs::robot_state_desired + " "
         + xpp_msgs::terrain_info
@@ -155,8 +230,6 @@ TowrRos::UserCommandCallback(const TowrCommandMsg& msg)
         + " --quiet " + bag_file).c_str());
   }
 
-  // to publish entire trajectory (e.g. to send to controller)
-  // xpp_msgs::RobotStateCartesianTrajectory xpp_msg = xpp::Convert::ToRos(GetTrajectory());
 }
 
 std::vector<TowrRos::XppVec>
@@ -166,29 +239,48 @@ TowrRos::GetIntermediateSolutions ()
 
   for (int iter=0; iter<towr_.GetIterationCount(); ++iter) {
     towr_.SetSolution(iter);
-    trajectories.push_back(GetTrajectory());
+    trajectories.push_back(GetTrajectory(towr_.GetSolution()));
   }
 
   return trajectories;
 }
 
 TowrRos::XppVec
-TowrRos::GetTrajectory () const
+TowrRos::GetTrajectory (const SplineHolder& solution) const
 {
-  SplineHolder solution = towr_.GetSolution();
-
-  XppVec trajectory;
-  double t = 0.0;
   double T = solution.base_linear_->GetTotalTime();
+  int n_ee = solution.ee_motion_.size();
+
+  // build the time grid once, then evaluate each spline over the whole
+  // grid in a single monotonic pass instead of searching for the
+  // segment anew at every sample.
+  std::vector<double> ts;
+  ts.reserve(static_cast<int>(T/visualization_dt_) + 2);
+  for (double t=0.0; t<=T+1e-5; t+=visualization_dt_)
+    ts.push_back(t);
+  int n_t = ts.size();
+
+  auto base_lin = solution.base_linear_->GetPoints(ts);
+
+  std::vector<std::vector<State>> ee_motion(n_ee), ee_force(n_ee);
+  for (int ee=0; ee<n_ee; ++ee) {
+    ee_motion.at(ee) = solution.ee_motion_.at(ee)->GetPoints(ts);
+    ee_force.at(ee)  = solution.ee_force_.at(ee)->GetPoints(ts);
+  }
 
   EulerConverter base_angular(solution.base_angular_);
 
-  while (t<=T+1e-5) {
-    int n_ee = solution.ee_motion_.size();
+  XppVec trajectory;
+  trajectory.reserve(n_t);
+
+  for (int i=0; i<n_t; ++i) {
+    double t = ts.at(i);
     xpp::RobotStateCartesian state(n_ee);
 
-    state.base_.lin = ToXpp(solution.base_linear_->GetPoint(t));
+    state.base_.lin = ToXpp(base_lin.at(i));
 
+    // the converter memoizes per query time, so the three calls share
+    // one Euler-state evaluation.
     state.base_.ang.q  = base_angular.GetQuaternionBaseToWorld(t);
     state.base_.ang.w  = base_angular.GetAngularVelocityInWorld(t);
     state.base_.ang.wd = base_angular.GetAngularAccelerationInWorld(t);
@@ -197,13 +289,12 @@ TowrRos::GetTrajectory () const
       int ee_xpp = ToXppEndeffector(n_ee, ee_towr).first;
 
       state.ee_contact_.at(ee_xpp) = solution.phase_durations_.at(ee_towr)->IsContactPhase(t);
-      state.ee_motion_.at(ee_xpp)  = ToXpp(solution.ee_motion_.at(ee_towr)->GetPoint(t));
-      state.ee_forces_ .at(ee_xpp) = solution.ee_force_.at(ee_towr)->GetPoint(t).p();
+      state.ee_motion_.at(ee_xpp)  = ToXpp(ee_motion.at(ee_towr).at(i));
+      state.ee_forces_ .at(ee_xpp) = ee_force.at(ee_towr).at(i).p();
     }
 
     state.t_global_ = t;
     trajectory.push_back(state);
-    t += visualization_dt_;
   }
 
   return trajectory;
@@ -229,26 +320,235 @@ TowrRos::BuildRobotParametersMsg(const RobotModel& model) const
   return params_msg;
 }
 
+bool
+TowrRos::GaitSpec::Matches (const GaitSpec& other, double tol) const
+{
+  if (robot != other.robot || terrain != other.terrain || gait != other.gait)
+    return false;
+  if (optimize_phase_durations != other.optimize_phase_durations)
+    return false;
+  if (std::abs(total_duration - other.total_duration) > tol)
+    return false;
+
+  auto node_close = [tol](const Node& a, const Node& b) {
+    return (a.at(kPos) - b.at(kPos)).norm() <= tol
+        && (a.at(kVel) - b.at(kVel)).norm() <= tol;
+  };
+
+  if (!node_close(goal.lin, other.goal.lin) ||
+      !node_close(goal.ang, other.goal.ang))
+    return false;
+  if (!node_close(initial_base.lin, other.initial_base.lin) ||
+      !node_close(initial_base.ang, other.initial_base.ang))
+    return false;
+
+  if (initial_ee_pos.size() != other.initial_ee_pos.size())
+    return false;
+  for (uint ee=0; ee<initial_ee_pos.size(); ++ee)
+    if ((initial_ee_pos.at(ee) - other.initial_ee_pos.at(ee)).norm() > tol)
+      return false;
+
+  return true;
+}
+
+TowrRos::GaitSpec
+TowrRos::BuildGaitSpec (const TowrCommandMsg& msg) const
+{
+  GaitSpec spec;
+  spec.robot          = msg.robot;
+  spec.terrain        = msg.terrain;
+  spec.gait           = msg.gait;
+  spec.total_duration = msg.total_duration;
+  spec.optimize_phase_durations = msg.optimize_phase_durations;
+
+  spec.goal.lin.at(kPos) = xpp::Convert::ToXpp(msg.goal_lin.pos);
+  spec.goal.lin.at(kVel) = xpp::Convert::ToXpp(msg.goal_lin.vel);
+  spec.goal.ang.at(kPos) = xpp::Convert::ToXpp(msg.goal_ang.pos);
+  spec.goal.ang.at(kVel) = xpp::Convert::ToXpp(msg.goal_ang.vel);
+
+  // the state this node starts every plan from; a state estimator
+  // would project the robot's future state here instead.
+  spec.initial_base   = initial_base_;
+  spec.initial_ee_pos = initial_ee_pos_;
+
+  return spec;
+}
+
+Parameters
+TowrRos::BuildParameters (const GaitSpec& spec, int n_ee)
+{
+  Parameters params;
+
+  auto gait_gen = GaitGenerator::MakeGaitGenerator(n_ee);
+  gait_gen->SetCombo(static_cast<GaitGenerator::Combos>(spec.gait));
+  for (int ee=0; ee<n_ee; ++ee) {
+    params.ee_phase_durations_.push_back(
+        gait_gen->GetPhaseDurations(spec.total_duration, ee));
+    params.ee_in_contact_at_start_.push_back(gait_gen->IsInContactAtStart(ee));
+  }
+  params.SetSwingConstraint();
+  if (spec.optimize_phase_durations)
+    params.OptimizePhaseDurations();
+
+  return params;
+}
+
+void
+TowrRos::SchedulePrecompute (const GaitSpec& solved_spec)
+{
+  {
+    std::lock_guard<std::mutex> lock(precompute_mutex_);
+    ++precompute_generation_;
+
+    // jobs queued for the previous command are superseded, and candidates
+    // older than one command cycle are unlikely to ever match again.
+    precompute_queue_.clear();
+    for (auto it = gait_candidates_.begin(); it != gait_candidates_.end();)
+      it = (it->generation < precompute_generation_ - 1)
+         ? gait_candidates_.erase(it) : it + 1;
+
+    int queued = 0;
+    for (int gait = 0; gait < GaitGenerator::COMBO_COUNT; ++gait) {
+      if (gait == solved_spec.gait || queued == precompute_top_k_)
+        continue;
+
+      GaitSpec candidate = solved_spec;
+      candidate.gait = gait;
+      precompute_queue_.push_back(candidate);
+      ++queued;
+    }
+  }
+  precompute_cv_.notify_all();
+}
+
+bool
+TowrRos::LookupGaitCandidate (const GaitSpec& spec, SplineHolder& solution)
+{
+  std::lock_guard<std::mutex> lock(precompute_mutex_);
+
+  for (const auto& candidate : gait_candidates_)
+    if (candidate.spec.Matches(spec, precompute_state_tol_)) {
+      solution = candidate.solution;
+      ROS_INFO_STREAM("answered from pre-solved gait candidate (gait "
+                      << spec.gait << ")");
+      return true;
+    }
+
+  return false;
+}
+
+void
+TowrRos::PrecomputeLoop ()
+{
+  while (true) {
+    GaitSpec spec;
+    int generation;
+    {
+      std::unique_lock<std::mutex> lock(precompute_mutex_);
+      precompute_cv_.wait(lock, [this] {
+        return precompute_stop_ || !precompute_queue_.empty(); });
+      if (precompute_stop_)
+        return; // shutdown beats draining: pending solves take seconds
+      spec = std::move(precompute_queue_.front());
+      precompute_queue_.pop_front();
+      generation = precompute_generation_;
+    }
+
+    // everything is built locally: the workers never touch towr_,
+    // terrain_ or any other state of the callback thread.
+    RobotModel model(static_cast<RobotModel::Robot>(spec.robot));
+    auto terrain = HeightMap::MakeTerrain(
+        static_cast<HeightMap::TerrainID>(spec.terrain));
+    int n_ee = model.kinematic_model_->GetNumberOfEndeffectors();
+
+    TOWR towr;
+    towr.SetInitialState(spec.initial_base, spec.initial_ee_pos);
+    towr.SetParameters(spec.goal, BuildParameters(spec, n_ee), model, terrain);
+
+    auto solver = std::make_shared<ifopt::IpoptSolver>();
+    solver->SetOption("linear_solver", "mumps");
+    solver->SetOption("jacobian_approximation", "exact");
+    solver->SetOption("max_cpu_time", precompute_cpu_time_);
+    solver->SetOption("print_level", 0); // background solves stay quiet
+
+    auto result = towr.SolveNLP(solver);
+
+    // infeasible candidates are not worth caching; a stale-but-matching
+    // one is still fine since Matches() guards every lookup.
+    if (result.feasible) {
+      GaitCandidate candidate;
+      candidate.spec       = spec;
+      candidate.solution   = towr.GetSolution();
+      candidate.generation = generation;
+
+      std::lock_guard<std::mutex> lock(precompute_mutex_);
+      gait_candidates_.push_back(std::move(candidate));
+    }
+  }
+}
+
+void
+TowrRos::EnqueueBagJob (BagJob job)
+{
+  {
+    std::lock_guard<std::mutex> lock(bag_mutex_);
+    if (bag_queue_.size() >= kMaxQueuedBags)
+      bag_queue_.pop_front(); // disk can't keep up; keep the recent solves
+    bag_queue_.push_back(std::move(job));
+  }
+  bag_cv_.notify_all();
+}
+
+void
+TowrRos::WaitForBagWriter ()
+{
+  std::unique_lock<std::mutex> lock(bag_mutex_);
+  bag_cv_.wait(lock, [this] { return bag_queue_.empty() && !bag_writing_; });
+}
+
 void
-TowrRos::SaveOptimizationAsRosbag (const std::string& bag_name,
-                                   const xpp_msgs::RobotParameters& robot_params,
-                                   const TowrCommandMsg user_command_msg,
-                                   bool include_iterations)
+TowrRos::BagWriterLoop ()
+{
+  while (true) {
+    BagJob job;
+    {
+      std::unique_lock<std::mutex> lock(bag_mutex_);
+      bag_cv_.wait(lock, [this] { return bag_writer_stop_ || !bag_queue_.empty(); });
+      if (bag_queue_.empty())
+        return; // stop requested and nothing left to write
+      job = std::move(bag_queue_.front());
+      bag_queue_.pop_front();
+      bag_writing_ = true;
+    }
+
+    WriteBag(job);
+
+    {
+      std::lock_guard<std::mutex> lock(bag_mutex_);
+      bag_writing_ = false;
+    }
+    bag_cv_.notify_all(); // wake anyone blocked in WaitForBagWriter()
+  }
+}
+
+void
+TowrRos::WriteBag (const BagJob& job) const
 {
   rosbag::Bag bag;
-  bag.open(bag_name, rosbag::bagmode::Write);
+  bag.open(job.bag_name, rosbag::bagmode::Write);
   ::ros::Time t0(1e-6); // t=0.0 throws ROS exception
 
   // save the a-priori fixed optimization variables
-  bag.write(xpp_msgs::robot_parameters, t0, robot_params);
-  bag.write(towr_msgs::user_command+"_saved", t0, user_command_msg);
+  bag.write(xpp_msgs::robot_parameters, t0, job.robot_params);
+  bag.write(towr_msgs::user_command+"_saved", t0, job.user_command);
 
-  // save the trajectory of each iteration
-  if (include_iterations) {
-    auto trajectories = GetIntermediateSolutions();
-    int n_iterations = trajectories.size();
+  // save the trajectory of each iteration, if they were sampled
+  int n_iterations = job.iteration_trajectories.size();
+  if (n_iterations > 0) {
     for (int i=0; i<n_iterations; ++i)
-      SaveTrajectoryInRosbag(bag, trajectories.at(i), towr_msgs::nlp_iterations_name + std::to_string(i));
+      SaveTrajectoryInRosbag(bag, job.iteration_trajectories.at(i),
+                             towr_msgs::nlp_iterations_name + std::to_string(i),
+                             job.terrain);
 
     // save number of iterations the optimizer took
     std_msgs::Int32 m;
@@ -257,8 +557,8 @@ TowrRos::SaveOptimizationAsRosbag (const std::string& bag_name,
   }
 
   // save the final trajectory
-  auto final_trajectory = GetTrajectory();
-  SaveTrajectoryInRosbag(bag, final_trajectory, xpp_msgs::robot_state_desired);
+  SaveTrajectoryInRosbag(bag, job.final_trajectory, xpp_msgs::robot_state_desired,
+                         job.terrain);
 
   bag.close();
 }
@@ -266,7 +566,8 @@ TowrRos::SaveOptimizationAsRosbag (const std::string& bag_name,
 void
 TowrRos::SaveTrajectoryInRosbag (rosbag::Bag& bag,
                                  const XppVec& traj,
-                                 const std::string& topic) const
+                                 const std::string& topic,
+                                 const HeightMap::Ptr& terrain) const
 {
   for (const auto state : traj) {
     auto timestamp = ::ros::Time(state.t_global_ + 1e-6); // t=0.0 throws ROS exception
@@ -277,9 +578,9 @@ TowrRos::SaveTrajectoryInRosbag (rosbag::Bag& bag,
 
     xpp_msgs::TerrainInfo terrain_msg;
     for (auto ee : state.ee_motion_.ToImpl()) {
-      Vector3d n = terrain_->GetNormalizedBasis(HeightMap::Normal, ee.p_.x(), ee.p_.y());
+      Vector3d n = terrain->GetNormalizedBasis(HeightMap::Normal, ee.p_.x(), ee.p_.y());
       terrain_msg.surface_normals.push_back(xpp::Convert::ToRos<geometry_msgs::Vector3>(n));
-      terrain_msg.friction_coeff = terrain_->GetFrictionCoeff();
+      terrain_msg.friction_coeff = terrain->GetFrictionCoeff();
     }
 
     bag.write(xpp_msgs::terrain_info, timestamp, terrain_msg);
@@ -287,15 +588,3 @@ TowrRos::SaveTrajectoryInRosbag (rosbag::Bag& bag,
 }
 
 } /* namespace towr */
-
-
-
-int main(int argc, char *argv[])
-{
-  ros::init(argc, argv, "towr_ros");
-  towr::TowrRos towr_ros;
-  ros::spin();
-
-  return 1;
-}
-
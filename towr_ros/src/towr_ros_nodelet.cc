@@ -0,0 +1,67 @@
+/******************************************************************************
+Copyright (c) 2018, Alexander W. Winkler. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+******************************************************************************/
+
+#include <memory>
+
+#include <nodelet/nodelet.h>
+#include <pluginlib/class_list_macros.h>
+
+#include <towr_ros/towr_ros.h>
+
+namespace towr {
+
+/**
+ * @brief Runs TowrRos inside a nodelet manager.
+ *
+ * The sampled trajectories published by TowrRos are multi-megabyte
+ * messages; over regular node-to-node transport they pay a
+ * serialize/deserialize round trip through TCP loopback between solve
+ * completion and controller consumption. Loaded into the same manager as
+ * the consuming controller/visualization nodelets, the trajectory is
+ * published as a shared pointer and the handoff is a pointer move.
+ *
+ * Load with:
+ *     rosrun nodelet nodelet load towr_ros/TowrRosNodelet <manager>
+ * or through launch/towr_nodelet.launch.
+ */
+class TowrRosNodelet : public nodelet::Nodelet {
+private:
+  void onInit() override
+  {
+    // construction subscribes/advertises and starts the bag-writer
+    // thread; the callbacks run on the manager's spinner threads.
+    towr_ros_.reset(new TowrRos(getNodeHandle()));
+  }
+
+  std::unique_ptr<TowrRos> towr_ros_;
+};
+
+} /* namespace towr */
+
+PLUGINLIB_EXPORT_CLASS(towr::TowrRosNodelet, nodelet::Nodelet)